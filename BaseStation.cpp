@@ -0,0 +1,390 @@
+
+#include "BaseStation.h"
+#include "RedBot.h"
+#include "Clock.h"
+#include <error.h>
+
+
+BaseStation::BaseStation(
+        size_t workerCount
+        ) :
+    myWorkerCount((workerCount > 0) ? workerCount : 1),
+    myQueueSequence(0),
+    myIsStopRequested(false),
+    myTotalCycleCount(0),
+    myStartCycleCount(0),
+    myStartTime(),
+    myStopTime()
+{
+}
+
+BaseStation::~BaseStation()
+{
+    stop();
+
+    for(
+            std::vector<Entry*>::const_iterator entryIter = myEntries.begin();
+            entryIter != myEntries.end();
+            ++entryIter
+       )
+    {
+        delete (*entryIter);
+    }
+}
+
+size_t
+BaseStation::addRobot(
+        RedBot* robot,
+        double  period
+        )
+{
+    Entry* entry = new Entry();
+    entry->robot = robot;
+    entry->period = std::chrono::duration_cast<ScheduleClock::duration>(
+            std::chrono::duration<double>(period)
+            );
+    entry->requestedMode = FieldControlSystem::MODE_DISABLED;
+    entry->mode = FieldControlSystem::NUM_MODES;
+    entry->transferCount = robot->getTransferCount();
+    entry->errorCount = 0;
+    entry->cycleCount = 0;
+    entry->overrunCount = 0;
+    entry->isRetired = false;
+
+    myEntries.push_back(entry);
+
+    return (myEntries.size() - 1);
+}
+
+size_t
+BaseStation::getRobotCount() const
+{
+    return myEntries.size();
+}
+
+void
+BaseStation::setMode(
+        FieldControlSystem::Mode mode
+        )
+{
+    for(
+            size_t robotIdx = 0;
+            robotIdx < myEntries.size();
+            ++robotIdx
+       )
+    {
+        setMode(robotIdx, mode);
+    }
+}
+
+void
+BaseStation::setMode(
+        size_t                      robotIdx,
+        FieldControlSystem::Mode    mode
+        )
+{
+    myEntries[robotIdx]->requestedMode = mode;
+}
+
+FieldControlSystem::Mode
+BaseStation::getMode(
+        size_t robotIdx
+        ) const
+{
+    return myEntries[robotIdx]->requestedMode;
+}
+
+void
+BaseStation::start()
+{
+    if (myWorkers.empty() == false)
+    {
+        return;
+    }
+
+    myStartCycleCount = myTotalCycleCount;
+    myStartTime = ScheduleClock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+
+        myIsStopRequested = false;
+
+        // Every robot is due right away, in the order it was added
+        myRunQueue = std::priority_queue<QueueItem, std::vector<QueueItem>, LaterItem>();
+        for(
+                size_t robotIdx = 0;
+                robotIdx < myEntries.size();
+                ++robotIdx
+           )
+        {
+            if (myEntries[robotIdx]->isRetired == false)
+            {
+                myEntries[robotIdx]->deadline = myStartTime;
+                queueRobot(robotIdx);
+            }
+        }
+    }
+
+    for(
+            size_t workerIdx = 0;
+            workerIdx < myWorkerCount;
+            ++workerIdx
+       )
+    {
+        myWorkers.push_back(std::thread(&BaseStation::runWorker, this));
+    }
+}
+
+void
+BaseStation::stop()
+{
+    if (myWorkers.empty() == true)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        myIsStopRequested = true;
+    }
+    myCondition.notify_all();
+
+    for(
+            std::vector<std::thread>::iterator workerIter = myWorkers.begin();
+            workerIter != myWorkers.end();
+            ++workerIter
+       )
+    {
+        workerIter->join();
+    }
+    myWorkers.clear();
+
+    myStopTime = ScheduleClock::now();
+}
+
+bool
+BaseStation::isRunning() const
+{
+    return (myWorkers.empty() == false);
+}
+
+unsigned long
+BaseStation::getCycleCount(
+        size_t robotIdx
+        ) const
+{
+    return myEntries[robotIdx]->cycleCount;
+}
+
+unsigned long
+BaseStation::getTotalCycleCount() const
+{
+    return myTotalCycleCount;
+}
+
+unsigned long
+BaseStation::getOverrunCount(
+        size_t robotIdx
+        ) const
+{
+    return myEntries[robotIdx]->overrunCount;
+}
+
+bool
+BaseStation::isRetired(
+        size_t robotIdx
+        ) const
+{
+    return myEntries[robotIdx]->isRetired;
+}
+
+size_t
+BaseStation::getActiveRobotCount() const
+{
+    size_t activeCount = 0;
+
+    for(
+            std::vector<Entry*>::const_iterator entryIter = myEntries.begin();
+            entryIter != myEntries.end();
+            ++entryIter
+       )
+    {
+        if ((*entryIter)->isRetired == false)
+        {
+            ++activeCount;
+        }
+    }
+
+    return activeCount;
+}
+
+double
+BaseStation::getThroughput() const
+{
+    ScheduleClock::time_point endTime = (isRunning() == true) ? ScheduleClock::now() : myStopTime;
+    double elapsedTime = std::chrono::duration<double>(endTime - myStartTime).count();
+
+    if (elapsedTime <= 0.0)
+    {
+        return 0.0;
+    }
+
+    return ((myTotalCycleCount - myStartCycleCount) / elapsedTime);
+}
+
+void
+BaseStation::runWorker()
+{
+    std::unique_lock<std::mutex> lock(myMutex);
+
+    while (myIsStopRequested == false)
+    {
+        if (myRunQueue.empty() == true)
+        {
+            myCondition.wait(lock);
+            continue;
+        }
+
+        // A robot due earlier may be queued while waiting for this one
+        QueueItem item = myRunQueue.top();
+        if (item.deadline > ScheduleClock::now())
+        {
+            // Virtual time moves straight on to the deadline
+            Clock& clock = Clock::GetInstance();
+            if (clock.isRealTime() == true)
+            {
+                myCondition.wait_until(lock, item.deadline);
+            }
+            else
+            {
+                clock.sleepUntil(item.deadline.time_since_epoch().count());
+            }
+            continue;
+        }
+        myRunQueue.pop();
+
+        lock.unlock();
+        bool isActive = runCycle(item.robotIdx, *myEntries[item.robotIdx]);
+        lock.lock();
+
+        if (isActive == true)
+        {
+            queueRobot(item.robotIdx);
+        }
+    }
+}
+
+bool
+BaseStation::runCycle(
+        size_t  robotIdx,
+        Entry&  entry
+        )
+{
+    FieldControlSystem::Mode mode = entry.requestedMode;
+    if (mode != entry.mode)
+    {
+        entry.robot->modeInit(mode);
+        entry.mode = mode;
+    }
+
+    entry.robot->modePeriodic(entry.mode);
+
+    ++entry.cycleCount;
+    ++myTotalCycleCount;
+
+    scheduleNextCycle(entry, ScheduleClock::now());
+
+    return checkStatus(robotIdx, entry);
+}
+
+bool
+BaseStation::checkStatus(
+        size_t  robotIdx,
+        Entry&  entry
+        )
+{
+    // With the I/O thread running, the status is only new once a transfer
+    // has completed since it was last checked
+    unsigned long transferCount = entry.robot->getTransferCount();
+    if(
+            (transferCount == entry.transferCount) &&
+            (entry.robot->isConnected() == true)
+      )
+    {
+        return true;
+    }
+    entry.transferCount = transferCount;
+
+    switch (entry.robot->getStatus())
+    {
+        case RedBot::STATUS_GOOD:
+            entry.errorCount = 0;
+            return true;
+
+        case RedBot::STATUS_INCOHERENT:
+            entry.robot->recover();
+            break;
+
+        case RedBot::STATUS_UNRESPONSIVE:
+            entry.robot->resync();
+            break;
+
+        default:
+            break;
+    }
+
+    if (++entry.errorCount < MAX_ERROR_COUNT)
+    {
+        return true;
+    }
+
+    error(0, 0, "Robot %zu retired after %u errors in a row", robotIdx, entry.errorCount);
+    entry.isRetired = true;
+
+    return false;
+}
+
+void
+BaseStation::scheduleNextCycle(
+        Entry&                      entry,
+        ScheduleClock::time_point   completionTime
+        )
+{
+    // Robots without a period go behind every robot already waiting
+    if (entry.period == ScheduleClock::duration::zero())
+    {
+        entry.deadline = completionTime;
+        return;
+    }
+
+    entry.deadline += entry.period;
+    if (completionTime > entry.deadline)
+    {
+        // Start right away, on the schedule of the last deadline missed
+        ++entry.overrunCount;
+        entry.deadline += ((completionTime - entry.deadline) / entry.period) * entry.period;
+    }
+}
+
+void
+BaseStation::queueRobot(
+        size_t robotIdx
+        )
+{
+    QueueItem item;
+    item.deadline = myEntries[robotIdx]->deadline;
+    item.sequence = myQueueSequence++;
+    item.robotIdx = robotIdx;
+
+    myRunQueue.push(item);
+
+    // Workers waiting on a later deadline must see an earlier one
+    myCondition.notify_all();
+}
+
+BaseStation::ScheduleClock::time_point
+BaseStation::ScheduleClock::now()
+{
+    return time_point(duration(Clock::GetInstance().getTime()));
+}
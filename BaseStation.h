@@ -0,0 +1,400 @@
+#ifndef BASESTATION_H
+#define BASESTATION_H
+
+#include "FieldControlSystem.h"
+#include <stddef.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Forward declaration
+class RedBot;
+
+/**
+ * Drives several robots from a single process
+ *
+ * Each robot brings its own program and serial link and is given its own
+ * mode. Cycles are carried out by a small pool of worker threads, so the
+ * serial exchanges of several robots overlap and one slow or unresponsive
+ * robot only holds up the worker running it.
+ *
+ * Robots wait for their next cycle in a single run queue ordered by the time
+ * each cycle is due. A robot without a period is due again as soon as its
+ * cycle completes, which puts it behind every robot already waiting: robots
+ * then take turns in round-robin order and none can be starved. A robot with
+ * a period is due on deadlines spaced one period apart, and deadlines missed
+ * by an overrun are skipped as they are by frc::TimedRobot.
+ *
+ * A robot is only ever run by one worker at a time, so its program and
+ * components need not be thread-safe. State shared by programs, such as the
+ * command scheduler, is not protected, and programs using it must not be run
+ * with more than one worker.
+ */
+class BaseStation
+{
+    public:
+
+        /**
+         * Default number of worker threads
+         */
+        static const size_t DEFAULT_WORKER_COUNT = 4;
+
+        /**
+         * Number of cycles in a row with a bad status after which a robot is
+         * retired
+         */
+        static const unsigned int MAX_ERROR_COUNT = 5;
+
+        /**
+         * Constructor
+         */
+        BaseStation(
+                size_t workerCount = DEFAULT_WORKER_COUNT  /**< Number of workers, positive */
+                );
+
+        /**
+         * Destructor
+         *
+         * This stops the workers. The robots are not deleted.
+         */
+        ~BaseStation();
+
+        /**
+         * Adds a robot to drive
+         *
+         * Robots may only be added while the workers are stopped. The robot
+         * is initialized for its mode before its first cycle.
+         *
+         * \return Index of the robot
+         */
+        size_t addRobot(
+                RedBot* robot,          /**< Robot, not owned */
+                double  period = 0.0    /**< Period between cycles in seconds, or 0 to run back to back */
+                );
+
+        /**
+         * Provides the number of robots added
+         */
+        size_t getRobotCount() const;
+
+        /**
+         * Sets the mode of all robots
+         *
+         * Each robot is initialized for the new mode before its next cycle.
+         */
+        void setMode(
+                FieldControlSystem::Mode mode
+                );
+
+        /**
+         * Sets the mode of a single robot
+         *
+         * The robot is initialized for the new mode before its next cycle.
+         */
+        void setMode(
+                size_t                      robotIdx,
+                FieldControlSystem::Mode    mode
+                );
+
+        /**
+         * Provides the mode given to a robot
+         */
+        FieldControlSystem::Mode getMode(
+                size_t robotIdx
+                ) const;
+
+        /**
+         * Starts running cycles on the worker threads
+         */
+        void start();
+
+        /**
+         * Stops running cycles
+         *
+         * This waits for the cycles under way to complete.
+         */
+        void stop();
+
+        /**
+         * Indicates if the workers are running
+         */
+        bool isRunning() const;
+
+        /**
+         * Provides the number of cycles a robot has completed
+         */
+        unsigned long getCycleCount(
+                size_t robotIdx
+                ) const;
+
+        /**
+         * Provides the number of cycles completed across all robots
+         */
+        unsigned long getTotalCycleCount() const;
+
+        /**
+         * Provides the number of cycles of a robot that ran past the start of
+         * its next one
+         */
+        unsigned long getOverrunCount(
+                size_t robotIdx
+                ) const;
+
+        /**
+         * Indicates if a robot was retired after too many errors
+         *
+         * A retired robot is no longer run.
+         */
+        bool isRetired(
+                size_t robotIdx
+                ) const;
+
+        /**
+         * Provides the number of robots that are not retired
+         */
+        size_t getActiveRobotCount() const;
+
+        /**
+         * Provides the number of cycles completed per second across all
+         * robots while the workers ran
+         *
+         * This covers the time since the workers were last started, up to
+         * when they were stopped.
+         */
+        double getThroughput() const;
+
+    private:
+
+        /**
+         * Clock used for scheduling
+         *
+         * This keeps the time of the clock in use by the process.
+         */
+        struct ScheduleClock
+        {
+            typedef std::chrono::nanoseconds duration;
+            typedef duration::rep rep;
+            typedef duration::period period;
+            typedef std::chrono::time_point<ScheduleClock> time_point;
+
+            static const bool is_steady = true;
+
+            /**
+             * Provides the current time
+             */
+            static time_point now();
+        };
+
+        /**
+         * Robot driven by this station
+         */
+        struct Entry
+        {
+            /**
+             * Robot, not owned
+             */
+            RedBot* robot;
+
+            /**
+             * Period between cycles, or zero to run back to back
+             */
+            ScheduleClock::duration period;
+
+            /**
+             * Mode given to the robot
+             */
+            std::atomic<FieldControlSystem::Mode> requestedMode;
+
+            /**
+             * Mode the robot was last initialized for, or NUM_MODES
+             *
+             * This is only used by the worker running the robot.
+             */
+            FieldControlSystem::Mode mode;
+
+            /**
+             * Time the next cycle is due
+             */
+            ScheduleClock::time_point deadline;
+
+            /**
+             * Transfer count of the robot when its status was last checked
+             */
+            unsigned long transferCount;
+
+            /**
+             * Number of cycles in a row with a bad status
+             */
+            unsigned int errorCount;
+
+            /**
+             * Number of cycles completed
+             */
+            std::atomic<unsigned long> cycleCount;
+
+            /**
+             * Number of cycles that ran past the start of the next one
+             */
+            std::atomic<unsigned long> overrunCount;
+
+            /**
+             * Indicates if the robot was retired after too many errors
+             */
+            std::atomic<bool> isRetired;
+        };
+
+        /**
+         * Robot waiting in the run queue
+         */
+        struct QueueItem
+        {
+            /**
+             * Time the robot's next cycle is due
+             */
+            ScheduleClock::time_point deadline;
+
+            /**
+             * Order the robot was queued in, breaking ties between deadlines
+             */
+            unsigned long sequence;
+
+            /**
+             * Index of the robot
+             */
+            size_t robotIdx;
+        };
+
+        /**
+         * Orders the run queue so that the earliest deadline comes first
+         */
+        struct LaterItem
+        {
+            bool operator()(
+                    const QueueItem& lhs,
+                    const QueueItem& rhs
+                    ) const
+            {
+                return (
+                        (lhs.deadline > rhs.deadline) ||
+                        (
+                         (lhs.deadline == rhs.deadline) &&
+                         (lhs.sequence > rhs.sequence)
+                        )
+                       );
+            }
+        };
+
+        /**
+         * Runs cycles until asked to stop
+         *
+         * This is the body of the worker threads.
+         */
+        void runWorker();
+
+        /**
+         * Runs a single cycle of a robot and checks its status
+         *
+         * \return True if the robot may keep running, false if it is retired
+         */
+        bool runCycle(
+                size_t  robotIdx,
+                Entry&  entry
+                );
+
+        /**
+         * Checks the status of a robot after a cycle, recovering if needed
+         *
+         * \return True if the robot may keep running, false if it is retired
+         */
+        bool checkStatus(
+                size_t  robotIdx,
+                Entry&  entry
+                );
+
+        /**
+         * Sets the deadline of a robot's next cycle after one completed
+         */
+        void scheduleNextCycle(
+                Entry&                      entry,
+                ScheduleClock::time_point   completionTime
+                );
+
+        /**
+         * Queues a robot for its next cycle
+         *
+         * The mutex must be held by the caller.
+         */
+        void queueRobot(
+                size_t robotIdx
+                );
+
+        /**
+         * Number of worker threads
+         */
+        size_t myWorkerCount;
+
+        /**
+         * Robots driven by this station
+         */
+        std::vector<Entry*> myEntries;
+
+        /**
+         * Worker threads, while running
+         */
+        std::vector<std::thread> myWorkers;
+
+        /**
+         * Guards the run queue and the stop request
+         */
+        std::mutex myMutex;
+
+        /**
+         * Signals the workers that a robot was queued or that they must stop
+         */
+        std::condition_variable myCondition;
+
+        /**
+         * Robots waiting for their next cycle
+         */
+        std::priority_queue<QueueItem, std::vector<QueueItem>, LaterItem> myRunQueue;
+
+        /**
+         * Number of robots queued since construction
+         */
+        unsigned long myQueueSequence;
+
+        /**
+         * Indicates that the workers are asked to stop
+         */
+        bool myIsStopRequested;
+
+        /**
+         * Number of cycles completed across all robots
+         */
+        std::atomic<unsigned long> myTotalCycleCount;
+
+        /**
+         * Total cycle count when the workers were last started
+         */
+        unsigned long myStartCycleCount;
+
+        /**
+         * Time the workers were last started
+         */
+        ScheduleClock::time_point myStartTime;
+
+        /**
+         * Time the workers were last stopped
+         */
+        ScheduleClock::time_point myStopTime;
+
+        // Disabled copiers
+        BaseStation(const BaseStation&);
+        BaseStation& operator=(const BaseStation&);
+};
+
+#endif /* ifndef BASESTATION_H */
@@ -7,22 +7,27 @@ using namespace frc;
 
 
 Command::Command() :
-  mySubsystem(DefaultSubsystem::GetInstance()),
   myIsInterruptible(true),
-  myIsEndCalled(false)
+  myIsEndCalled(false),
+  myIsStarted(false),
+  myIsRunning(false),
+  myIsListed(false)
 {
 }
 
 void
 Command::Requires(Subsystem* subsystem)
 {
-  mySubsystem = subsystem;
+  if (subsystem->myIndex < Scheduler::MAX_SUBSYSTEMS)
+    {
+      myRequirements.set(subsystem->myIndex);
+    }
 }
 
 void
 Command::Start()
 {
-  mySubsystem->SetNextCommand(this);
+  Scheduler::GetInstance()->AddCommand(this);
 }
 
 bool
@@ -49,6 +54,24 @@ Command::IsEndCalled() const
   return myIsEndCalled;
 }
 
+bool
+Command::IsRunning() const
+{
+  return myIsRunning;
+}
+
+const LatencyHistogram&
+Command::GetExecuteTimes() const
+{
+  return myExecuteTimes;
+}
+
+const LatencyHistogram&
+Command::GetIsFinishedTimes() const
+{
+  return myIsFinishedTimes;
+}
+
 void
 Command::Initialize()
 {
@@ -1,6 +1,9 @@
 #ifndef COMMAND_H
 #define COMMAND_H
 
+#include "Scheduler.h"
+#include "LatencyHistogram.h"
+
 namespace frc
 {
   class Subsystem;
@@ -9,8 +12,7 @@ namespace frc
   {
   public:
 
-    friend class Subsystem;
-    friend class DefaultSubsystem;
+    friend class Scheduler;
 
     Command();
 
@@ -26,6 +28,14 @@ namespace frc
 
     bool IsEndCalled() const;
 
+    bool IsRunning() const;
+
+    // Time taken by each call to Execute
+    const LatencyHistogram& GetExecuteTimes() const;
+
+    // Time taken by each call to IsFinished made by the scheduler
+    const LatencyHistogram& GetIsFinishedTimes() const;
+
   protected:
 
     virtual void Initialize();
@@ -38,8 +48,6 @@ namespace frc
 
     virtual void Interrupted();
 
-    Subsystem* mySubsystem;
-
   private:
 
     void SetEndCalled(bool isEndCalled);
@@ -47,6 +55,26 @@ namespace frc
     bool myIsInterruptible;
 
     bool myIsEndCalled;
+
+    // Subsystems given to Requires
+    Scheduler::Requirements myRequirements;
+
+    // Subsystems held while running, which include the one a default
+    // command runs for
+    Scheduler::Requirements myHeldSubsystems;
+
+    // Indicates if the command waits to be taken by the scheduler
+    bool myIsStarted;
+
+    bool myIsRunning;
+
+    // Indicates if the command is in the scheduler's list of running
+    // commands, which it leaves at the end of the run it stops in
+    bool myIsListed;
+
+    LatencyHistogram myExecuteTimes;
+
+    LatencyHistogram myIsFinishedTimes;
   };
 }; /* namespace frc */
 
@@ -1,6 +1,6 @@
 
 #include "CommandGroup.h"
-#include "Subsystem.h"
+#include "Scheduler.h"
 #include <stdlib.h>
 
 using namespace frc;
@@ -49,7 +49,7 @@ CommandGroup::Start()
 
   myStepIterator = mySteps.begin();
 
-  mySubsystem->SetNextCommand(this);
+  Scheduler::GetInstance()->AddCommand(this);
 }
 
 void
@@ -0,0 +1,498 @@
+
+#include "DriverStation.h"
+#include <error.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <chrono>
+
+
+const char* const DriverStationClient::DEFAULT_HOST = "localhost";
+
+const char* const DriverStationClient::DEFAULT_PORT = "9999";
+
+void
+DriverStationMessage::Encode(
+        Type            type,
+        unsigned char   value,
+        unsigned char*  buffer
+        )
+{
+    buffer[0] = MARKER;
+    buffer[1] = type;
+    buffer[2] = value;
+}
+
+bool
+DriverStationMessage::Decode(
+        const unsigned char*    buffer,
+        Type&                   type,
+        unsigned char&          value
+        )
+{
+    if(
+            (buffer[0] != MARKER) ||
+            ((buffer[1] != TYPE_SUBSCRIBE) && (buffer[1] != TYPE_MODE))
+      )
+    {
+        return false;
+    }
+
+    type = (Type)buffer[1];
+    value = buffer[2];
+
+    return true;
+}
+
+DriverStationClient::DriverStationClient() :
+    mySocket(-1),
+    myTimeout(DEFAULT_TIMEOUT_MSEC),
+    myIsConnected(false),
+    myMode(FieldControlSystem::MODE_DISABLED),
+    myUpdateCount(0)
+{
+}
+
+DriverStationClient::~DriverStationClient()
+{
+    disconnect();
+}
+
+bool
+DriverStationClient::connect(
+        const char* host,
+        const char* port
+        )
+{
+    disconnect();
+
+    struct addrinfo getAddrHints;
+    memset(&getAddrHints, 0, sizeof(getAddrHints));
+    getAddrHints.ai_family = AF_INET;
+    getAddrHints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* getAddrResults;
+
+    int getAddrRetVal = getaddrinfo(
+            host,
+            port,
+            &getAddrHints,
+            &getAddrResults
+            );
+    if (getAddrRetVal != 0)
+    {
+        error(0, 0, "Could not get address of %s: %s", host, gai_strerror(getAddrRetVal));
+        return false;
+    }
+
+    for(
+            struct addrinfo* addrInfoIter = getAddrResults;
+            addrInfoIter != NULL;
+            addrInfoIter = addrInfoIter->ai_next
+       )
+    {
+        mySocket = socket(
+                addrInfoIter->ai_family,
+                addrInfoIter->ai_socktype,
+                addrInfoIter->ai_protocol
+                );
+        if (mySocket < 0)
+        {
+            continue;
+        }
+
+        if (::connect(mySocket, addrInfoIter->ai_addr, addrInfoIter->ai_addrlen) == 0)
+        {
+            break;
+        }
+
+        ::close(mySocket);
+        mySocket = -1;
+    }
+    freeaddrinfo(getAddrResults);
+
+    if (mySocket < 0)
+    {
+        error(0, errno, "Could not connect to driver station at %s:%s", host, port);
+        return false;
+    }
+
+    // Messages are tiny and should not wait to be coalesced
+    int noDelay = 1;
+    setsockopt(mySocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    unsigned char message[DriverStationMessage::SIZE];
+    DriverStationMessage::Encode(
+            DriverStationMessage::TYPE_SUBSCRIBE,
+            DriverStationMessage::VERSION,
+            message
+            );
+    if (send(mySocket, message, sizeof(message), MSG_NOSIGNAL) != sizeof(message))
+    {
+        error(0, errno, "Could not subscribe to driver station");
+        ::close(mySocket);
+        mySocket = -1;
+        return false;
+    }
+
+    myIsConnected = true;
+    myThread = std::thread(&DriverStationClient::receiveMessages, this);
+
+    return true;
+}
+
+void
+DriverStationClient::disconnect()
+{
+    if (mySocket < 0)
+    {
+        return;
+    }
+
+    // Wake the receiving thread up
+    shutdown(mySocket, SHUT_RDWR);
+    myThread.join();
+
+    ::close(mySocket);
+    mySocket = -1;
+    myIsConnected = false;
+}
+
+void
+DriverStationClient::setTimeout(
+        unsigned int timeoutMsec
+        )
+{
+    myTimeout = timeoutMsec;
+}
+
+unsigned int
+DriverStationClient::getTimeout() const
+{
+    return myTimeout;
+}
+
+bool
+DriverStationClient::isConnected() const
+{
+    return myIsConnected;
+}
+
+FieldControlSystem::Mode
+DriverStationClient::getMode() const
+{
+    return myMode;
+}
+
+unsigned long
+DriverStationClient::getUpdateCount() const
+{
+    return myUpdateCount;
+}
+
+void
+DriverStationClient::receiveMessages()
+{
+    unsigned char message[DriverStationMessage::SIZE];
+    size_t messageSize = 0;
+
+    struct pollfd pollInfo;
+    pollInfo.fd = mySocket;
+    pollInfo.events = POLLIN;
+
+    while (true)
+    {
+        // A driver station that hung, or a link that broke without closing,
+        // stops the heartbeats
+        int pollRetVal = poll(&pollInfo, 1, myTimeout);
+        if (pollRetVal < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (pollRetVal == 0)
+        {
+            error(0, 0, "Driver station sent nothing for %u ms", myTimeout);
+            break;
+        }
+
+        if (pollRetVal < 0)
+        {
+            break;
+        }
+
+        ssize_t readSize = recv(
+                mySocket,
+                message + messageSize,
+                sizeof(message) - messageSize,
+                0
+                );
+        if (readSize < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (readSize <= 0)
+        {
+            break;
+        }
+
+        messageSize += readSize;
+        if (messageSize < sizeof(message))
+        {
+            continue;
+        }
+        messageSize = 0;
+
+        DriverStationMessage::Type type;
+        unsigned char value = 0;
+        if(
+                (DriverStationMessage::Decode(message, type, value) == true) &&
+                (type == DriverStationMessage::TYPE_MODE) &&
+                (value < FieldControlSystem::NUM_MODES)
+          )
+        {
+            myMode = (FieldControlSystem::Mode)value;
+            ++myUpdateCount;
+        }
+    }
+
+    myIsConnected = false;
+}
+
+DriverStationServer::DriverStationServer() :
+    myListenSocket(-1),
+    myPort(0),
+    myHeartbeatInterval(DriverStationMessage::HEARTBEAT_INTERVAL_MSEC),
+    myIsClosing(false),
+    myMode(FieldControlSystem::MODE_DISABLED)
+{
+}
+
+DriverStationServer::~DriverStationServer()
+{
+    close();
+}
+
+bool
+DriverStationServer::listen(
+        unsigned short port
+        )
+{
+    close();
+
+    myListenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (myListenSocket < 0)
+    {
+        error(0, errno, "Could not open socket");
+        return false;
+    }
+
+    int reuseAddress = 1;
+    setsockopt(myListenSocket, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+
+    socklen_t addressSize = sizeof(address);
+    if(
+            (bind(myListenSocket, (struct sockaddr*)&address, sizeof(address)) != 0) ||
+            (::listen(myListenSocket, 4) != 0) ||
+            (getsockname(myListenSocket, (struct sockaddr*)&address, &addressSize) != 0)
+      )
+    {
+        error(0, errno, "Could not listen on port %hu", port);
+        ::close(myListenSocket);
+        myListenSocket = -1;
+        return false;
+    }
+    myPort = ntohs(address.sin_port);
+
+    myIsClosing = false;
+    myThread = std::thread(&DriverStationServer::acceptClients, this);
+    myHeartbeatThread = std::thread(&DriverStationServer::sendHeartbeats, this);
+
+    return true;
+}
+
+void
+DriverStationServer::close()
+{
+    if (myListenSocket < 0)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        myIsClosing = true;
+    }
+    myHeartbeatCondition.notify_one();
+    myHeartbeatThread.join();
+
+    // Wake the accepting thread up
+    shutdown(myListenSocket, SHUT_RDWR);
+    myThread.join();
+
+    ::close(myListenSocket);
+    myListenSocket = -1;
+
+    std::lock_guard<std::mutex> lock(myMutex);
+    for(
+            std::vector<int>::const_iterator clientIter = myClientSockets.begin();
+            clientIter != myClientSockets.end();
+            ++clientIter
+       )
+    {
+        ::close(*clientIter);
+    }
+    myClientSockets.clear();
+}
+
+unsigned short
+DriverStationServer::getPort() const
+{
+    return myPort;
+}
+
+size_t
+DriverStationServer::getClientCount() const
+{
+    std::lock_guard<std::mutex> lock(myMutex);
+    return myClientSockets.size();
+}
+
+void
+DriverStationServer::setMode(
+        FieldControlSystem::Mode mode
+        )
+{
+    std::lock_guard<std::mutex> lock(myMutex);
+
+    myMode = mode;
+    pushMode();
+}
+
+void
+DriverStationServer::setHeartbeatInterval(
+        unsigned int intervalMsec
+        )
+{
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        myHeartbeatInterval = intervalMsec;
+    }
+    myHeartbeatCondition.notify_one();
+}
+
+void
+DriverStationServer::pushMode()
+{
+    // Clients that are gone are dropped
+    std::vector<int>::iterator clientIter = myClientSockets.begin();
+    while (clientIter != myClientSockets.end())
+    {
+        if (SendMode(*clientIter, myMode) == true)
+        {
+            ++clientIter;
+            continue;
+        }
+
+        ::close(*clientIter);
+        clientIter = myClientSockets.erase(clientIter);
+    }
+}
+
+void
+DriverStationServer::acceptClients()
+{
+    while (true)
+    {
+        int clientSocket = accept(myListenSocket, NULL, NULL);
+        if (clientSocket < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        int noDelay = 1;
+        setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        unsigned char message[DriverStationMessage::SIZE];
+        DriverStationMessage::Type type;
+        unsigned char version = 0;
+        if(
+                (recv(clientSocket, message, sizeof(message), MSG_WAITALL) != sizeof(message)) ||
+                (DriverStationMessage::Decode(message, type, version) == false) ||
+                (type != DriverStationMessage::TYPE_SUBSCRIBE)
+          )
+        {
+            ::close(clientSocket);
+            continue;
+        }
+
+        // New subscribers are given the current mode right away
+        std::lock_guard<std::mutex> lock(myMutex);
+        if (SendMode(clientSocket, myMode) == false)
+        {
+            ::close(clientSocket);
+            continue;
+        }
+        myClientSockets.push_back(clientSocket);
+    }
+}
+
+void
+DriverStationServer::sendHeartbeats()
+{
+    std::unique_lock<std::mutex> lock(myMutex);
+
+    while (myIsClosing == false)
+    {
+        if (myHeartbeatInterval == 0)
+        {
+            myHeartbeatCondition.wait(lock);
+            continue;
+        }
+
+        // A change of settings restarts the wait
+        if(
+                myHeartbeatCondition.wait_for(
+                    lock,
+                    std::chrono::milliseconds(myHeartbeatInterval)
+                    ) == std::cv_status::timeout
+          )
+        {
+            pushMode();
+        }
+    }
+}
+
+bool
+DriverStationServer::SendMode(
+        int                         clientSocket,
+        FieldControlSystem::Mode    mode
+        )
+{
+    unsigned char message[DriverStationMessage::SIZE];
+    DriverStationMessage::Encode(
+            DriverStationMessage::TYPE_MODE,
+            (unsigned char)mode,
+            message
+            );
+
+    return (send(clientSocket, message, sizeof(message), MSG_NOSIGNAL) == sizeof(message));
+}
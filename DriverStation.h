@@ -0,0 +1,369 @@
+#ifndef DRIVERSTATION_H
+#define DRIVERSTATION_H
+
+#include "FieldControlSystem.h"
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Binary message exchanged with the driver station
+ *
+ * Every message is three bytes long: a marker byte, the message type and a
+ * value. A client subscribes once, with the protocol version as the value,
+ * and the driver station then pushes the current mode, and every later mode
+ * change, as mode messages. An unchanged mode is sent again as a heartbeat, so
+ * that subscribers can tell a driver station that hung from one that has
+ * nothing new to say.
+ */
+class DriverStationMessage
+{
+    public:
+
+        /**
+         * Byte starting every message
+         *
+         * This is not printable, so the driver station can tell subscribers
+         * apart from clients polling with text requests.
+         */
+        static const unsigned char MARKER = 0xD5;
+
+        /**
+         * Version of the message protocol
+         */
+        static const unsigned char VERSION = 1;
+
+        /**
+         * Number of bytes in a message
+         */
+        static const size_t SIZE = 3;
+
+        /**
+         * Milliseconds between heartbeats of the driver station
+         */
+        static const unsigned int HEARTBEAT_INTERVAL_MSEC = 1000;
+
+        /**
+         * Enumeration of message types
+         */
+        enum Type
+        {
+            TYPE_SUBSCRIBE = 0x01,  /**< Client asks for mode changes */
+            TYPE_MODE = 0x02        /**< Driver station gives the mode */
+        };
+
+        /**
+         * Writes a message to the given buffer of SIZE bytes
+         */
+        static void Encode(
+                Type            type,
+                unsigned char   value,
+                unsigned char*  buffer
+                );
+
+        /**
+         * Reads a message from the given buffer of SIZE bytes
+         *
+         * \return True if the buffer holds a message, false otherwise
+         */
+        static bool Decode(
+                const unsigned char*    buffer,
+                Type&                   type,
+                unsigned char&          value
+                );
+};
+
+/**
+ * Connection to the driver station that receives mode changes
+ *
+ * Mode changes are pushed by the driver station and received on a background
+ * thread, so reading the mode never waits on the network and a slow or
+ * stalled driver station cannot hold up the robot loop.
+ */
+class DriverStationClient
+{
+    public:
+
+        /**
+         * Host the driver station runs on by default
+         */
+        static const char* const DEFAULT_HOST;
+
+        /**
+         * Port the driver station listens on by default
+         */
+        static const char* const DEFAULT_PORT;
+
+        /**
+         * Default milliseconds without any message after which the driver
+         * station is taken as gone
+         *
+         * This allows a couple of heartbeats to be late.
+         */
+        static const unsigned int DEFAULT_TIMEOUT_MSEC =
+            3 * DriverStationMessage::HEARTBEAT_INTERVAL_MSEC;
+
+        /**
+         * Default constructor
+         */
+        DriverStationClient();
+
+        /**
+         * Destructor
+         *
+         * This disconnects from the driver station.
+         */
+        ~DriverStationClient();
+
+        /**
+         * Connects to the driver station and subscribes to mode changes
+         *
+         * \return True if connected, false otherwise
+         */
+        bool connect(
+                const char* host = DEFAULT_HOST,
+                const char* port = DEFAULT_PORT
+                );
+
+        /**
+         * Disconnects from the driver station
+         */
+        void disconnect();
+
+        /**
+         * Sets the milliseconds without any message after which the driver
+         * station is taken as gone
+         *
+         * This takes effect on the next connection.
+         */
+        void setTimeout(
+                unsigned int timeoutMsec
+                );
+
+        /**
+         * Provides the milliseconds without any message after which the
+         * driver station is taken as gone
+         */
+        unsigned int getTimeout() const;
+
+        /**
+         * Indicates if the driver station is connected
+         *
+         * This becomes false once the driver station closes the connection,
+         * or sends nothing, heartbeats included, for longer than the timeout.
+         * The last mode received is kept either way.
+         */
+        bool isConnected() const;
+
+        /**
+         * Provides the latest mode given by the driver station
+         *
+         * Robots are disabled until the driver station gives a mode.
+         */
+        FieldControlSystem::Mode getMode() const;
+
+        /**
+         * Provides the number of mode messages received
+         */
+        unsigned long getUpdateCount() const;
+
+    private:
+
+        /**
+         * Receives messages until the connection closes or times out
+         *
+         * This is the body of the receiving thread.
+         */
+        void receiveMessages();
+
+        /**
+         * Socket connected to the driver station, or -1
+         */
+        int mySocket;
+
+        /**
+         * Milliseconds without any message after which the driver station is
+         * taken as gone
+         */
+        unsigned int myTimeout;
+
+        /**
+         * Thread receiving messages
+         */
+        std::thread myThread;
+
+        /**
+         * Indicates if the driver station is connected
+         */
+        std::atomic<bool> myIsConnected;
+
+        /**
+         * Latest mode given by the driver station
+         */
+        std::atomic<FieldControlSystem::Mode> myMode;
+
+        /**
+         * Number of mode messages received
+         */
+        std::atomic<unsigned long> myUpdateCount;
+
+        // Disabled copiers
+        DriverStationClient(const DriverStationClient&);
+        DriverStationClient& operator=(const DriverStationClient&);
+};
+
+/**
+ * Stand-in driver station
+ *
+ * This serves mode changes to subscribed clients on a local port, for tests
+ * and for running robots without the driver station program.
+ */
+class DriverStationServer
+{
+    public:
+
+        /**
+         * Default constructor
+         */
+        DriverStationServer();
+
+        /**
+         * Destructor
+         *
+         * This stops listening and disconnects all clients.
+         */
+        ~DriverStationServer();
+
+        /**
+         * Starts listening for clients on the given local port
+         *
+         * \return True if listening, false otherwise
+         */
+        bool listen(
+                unsigned short port = 0 /**< Port, or 0 for any free one */
+                );
+
+        /**
+         * Stops listening and disconnects all clients
+         */
+        void close();
+
+        /**
+         * Provides the port listened on
+         */
+        unsigned short getPort() const;
+
+        /**
+         * Provides the number of subscribed clients
+         */
+        size_t getClientCount() const;
+
+        /**
+         * Sets the mode and pushes it to all subscribed clients
+         */
+        void setMode(
+                FieldControlSystem::Mode mode
+                );
+
+        /**
+         * Sets the milliseconds between heartbeats, or 0 for none
+         *
+         * Without heartbeats, the mode is only sent when it changes.
+         */
+        void setHeartbeatInterval(
+                unsigned int intervalMsec
+                );
+
+    private:
+
+        /**
+         * Accepts clients until closed
+         *
+         * This is the body of the accepting thread.
+         */
+        void acceptClients();
+
+        /**
+         * Sends the mode again at every heartbeat until closed
+         *
+         * This is the body of the heartbeat thread.
+         */
+        void sendHeartbeats();
+
+        /**
+         * Pushes the mode to all subscribed clients, dropping those that are
+         * gone
+         *
+         * The mutex must be held.
+         */
+        void pushMode();
+
+        /**
+         * Sends the mode to a client
+         *
+         * \return True if sent, false if the client is gone
+         */
+        static bool SendMode(
+                int                         clientSocket,
+                FieldControlSystem::Mode    mode
+                );
+
+        /**
+         * Listening socket, or -1
+         */
+        int myListenSocket;
+
+        /**
+         * Port listened on
+         */
+        unsigned short myPort;
+
+        /**
+         * Thread accepting clients
+         */
+        std::thread myThread;
+
+        /**
+         * Thread sending heartbeats
+         */
+        std::thread myHeartbeatThread;
+
+        /**
+         * Guards the mode, the clients and the heartbeat settings
+         */
+        mutable std::mutex myMutex;
+
+        /**
+         * Signals the heartbeat thread that its settings changed
+         */
+        std::condition_variable myHeartbeatCondition;
+
+        /**
+         * Milliseconds between heartbeats, or 0 for none
+         */
+        unsigned int myHeartbeatInterval;
+
+        /**
+         * Indicates that the heartbeat thread is asked to stop
+         */
+        bool myIsClosing;
+
+        /**
+         * Current mode
+         */
+        FieldControlSystem::Mode myMode;
+
+        /**
+         * Sockets of subscribed clients
+         */
+        std::vector<int> myClientSockets;
+
+        // Disabled copiers
+        DriverStationServer(const DriverStationServer&);
+        DriverStationServer& operator=(const DriverStationServer&);
+};
+
+#endif /* ifndef DRIVERSTATION_H */
@@ -29,7 +29,7 @@ FieldControlSystem::DestroyInstance()
 }
 
 FieldControlSystem::FieldControlSystem() :
-    myRobot(NULL),
+    myRobots(),
     myMode(MODE_DISABLED)
 {
 }
@@ -43,39 +43,67 @@ FieldControlSystem::Register(
         RedBot* robot
         )
 {
-    myRobot = robot;
+    myRobots.push_back(robot);
+}
+
+void
+FieldControlSystem::Unregister(
+        RedBot* robot
+        )
+{
+    myRobots.remove(robot);
 }
 
 void
 FieldControlSystem::EnableAutonomous()
 {
     myMode = MODE_AUTO;
-    myRobot->modeInit(MODE_AUTO);
+    InitRobots();
 }
 
 void
 FieldControlSystem::EnableTeleop()
 {
     myMode = MODE_TELEOP;
-    myRobot->modeInit(MODE_TELEOP);
+    InitRobots();
 }
 
 void
 FieldControlSystem::EnableTest()
 {
     myMode = MODE_TEST;
-    myRobot->modeInit(MODE_TEST);
+    InitRobots();
 }
 
 void
 FieldControlSystem::Step()
 {
-    myRobot->modePeriodic(myMode);
+    for(
+            std::list<RedBot*>::const_iterator robotIter = myRobots.begin();
+            robotIter != myRobots.end();
+            ++robotIter
+       )
+    {
+        (*robotIter)->modePeriodic(myMode);
+    }
 }
 
 void
 FieldControlSystem::Disable()
 {
     myMode = MODE_DISABLED;
-    myRobot->modeInit(MODE_DISABLED);
+    InitRobots();
+}
+
+void
+FieldControlSystem::InitRobots()
+{
+    for(
+            std::list<RedBot*>::const_iterator robotIter = myRobots.begin();
+            robotIter != myRobots.end();
+            ++robotIter
+       )
+    {
+        (*robotIter)->modeInit(myMode);
+    }
 }
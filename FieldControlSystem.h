@@ -1,6 +1,8 @@
 #ifndef FIELDCONTROLSYSTEM_H
 #define FIELDCONTROLSYSTEM_H
 
+#include <list>
+
 // Forward declaration
 class RedBot;
 
@@ -47,6 +49,15 @@ class FieldControlSystem
                 RedBot* robot
                 );
 
+        /**
+         * Removes a robot from this system
+         *
+         * The robot is no longer notified about mode changes.
+         */
+        void Unregister(
+                RedBot* robot
+                );
+
         /**
          * Instructs all robots to begin their autonomous modes
          */
@@ -87,11 +98,14 @@ class FieldControlSystem
         FieldControlSystem();
 
         /**
-         * Robot running on the field
-         *
-         * \todo Add support for multiple robots running at once
+         * Launches initialization process for the current mode on all robots
+         */
+        void InitRobots();
+
+        /**
+         * Robots running on the field, in order of registration
          */
-        RedBot* myRobot;
+        std::list<RedBot*> myRobots;
 
         /**
          * Current mode of the system
@@ -1,6 +1,13 @@
 
 #include "IOBuffer.h"
+#include "Clock.h"
 #include <poll.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
 
 
 InputFileBuffer::InputFileBuffer(
@@ -58,6 +65,22 @@ InputFileBuffer::read()
     }
 
     char readChar = (char)readVal;
+    if (myFraming == FRAMING_COBS)
+    {
+        if (readChar != '\0')
+        {
+            myByteBuffer << readChar;
+            myIsHeaderRead = true;
+        }
+        else if (myIsHeaderRead == true)
+        {
+            // Delimiter ends a non-empty frame
+            myIsPacketComplete = true;
+        }
+
+        return true;
+    }
+
     if (readChar == '\xFF')
     {
         if (myIsHeaderRead == false)
@@ -202,3 +225,668 @@ OutputFileBuffer::resync()
            );
     fflush(myOutputFile);
 }
+
+
+ByteRingBuffer::ByteRingBuffer() :
+    myHead(0),
+    mySize(0)
+{
+}
+
+size_t
+ByteRingBuffer::size() const
+{
+    return mySize;
+}
+
+bool
+ByteRingBuffer::empty() const
+{
+    return (mySize == 0);
+}
+
+bool
+ByteRingBuffer::push(
+        unsigned char byte
+        )
+{
+    if (mySize >= CAPACITY)
+    {
+        return false;
+    }
+
+    myBytes[(myHead + mySize) % CAPACITY] = byte;
+    ++mySize;
+
+    return true;
+}
+
+bool
+ByteRingBuffer::pop(
+        unsigned char& byte
+        )
+{
+    if (mySize == 0)
+    {
+        return false;
+    }
+
+    byte = myBytes[myHead];
+    myHead = (myHead + 1) % CAPACITY;
+    --mySize;
+
+    return true;
+}
+
+ssize_t
+ByteRingBuffer::fill(
+        int fd
+        )
+{
+    if (mySize >= CAPACITY)
+    {
+        return 0;
+    }
+
+    // Free space may wrap around the end of storage
+    size_t tail = (myHead + mySize) % CAPACITY;
+    struct iovec segments[2];
+    int segmentCount = 1;
+
+    segments[0].iov_base = &myBytes[tail];
+    if (tail >= myHead)
+    {
+        segments[0].iov_len = CAPACITY - tail;
+        segments[1].iov_base = &myBytes[0];
+        segments[1].iov_len = myHead;
+        segmentCount = (myHead > 0) ? 2 : 1;
+    }
+    else
+    {
+        segments[0].iov_len = myHead - tail;
+    }
+
+    ssize_t readCount = readv(fd, segments, segmentCount);
+    if (readCount > 0)
+    {
+        mySize += readCount;
+    }
+
+    return readCount;
+}
+
+ssize_t
+ByteRingBuffer::drain(
+        int fd
+        )
+{
+    if (mySize == 0)
+    {
+        return 0;
+    }
+
+    // Held bytes may wrap around the end of storage
+    struct iovec segments[2];
+    int segmentCount = 1;
+
+    segments[0].iov_base = &myBytes[myHead];
+    if ((myHead + mySize) > CAPACITY)
+    {
+        segments[0].iov_len = CAPACITY - myHead;
+        segments[1].iov_base = &myBytes[0];
+        segments[1].iov_len = mySize - segments[0].iov_len;
+        segmentCount = 2;
+    }
+    else
+    {
+        segments[0].iov_len = mySize;
+    }
+
+    ssize_t writeCount = writev(fd, segments, segmentCount);
+    if (writeCount > 0)
+    {
+        myHead = (myHead + writeCount) % CAPACITY;
+        mySize -= writeCount;
+    }
+
+    return writeCount;
+}
+
+void
+ByteRingBuffer::clear()
+{
+    myHead = 0;
+    mySize = 0;
+}
+
+
+DescriptorPoller::DescriptorPoller(
+        int         fd,
+        uint32_t    events
+        ) :
+    myEpollFD(epoll_create1(EPOLL_CLOEXEC)),
+    myTimerFD(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
+{
+    struct epoll_event event;
+
+    event.events = events;
+    event.data.fd = fd;
+    epoll_ctl(myEpollFD, EPOLL_CTL_ADD, fd, &event);
+
+    event.events = EPOLLIN;
+    event.data.fd = myTimerFD;
+    epoll_ctl(myEpollFD, EPOLL_CTL_ADD, myTimerFD, &event);
+}
+
+DescriptorPoller::~DescriptorPoller()
+{
+    close(myTimerFD);
+    close(myEpollFD);
+}
+
+bool
+DescriptorPoller::wait(
+        const struct timespec& deadline
+        )
+{
+    if(
+            (myEpollFD < 0) ||
+            (myTimerFD < 0)
+      )
+    {
+        return false;
+    }
+
+    Clock& clock = Clock::GetInstance();
+    if (clock.isRealTime() == false)
+    {
+        // The descriptor cannot be watched while virtual time passes, so
+        // whatever is ready by the deadline is taken then
+        if (isReady() == true)
+        {
+            return true;
+        }
+
+        clock.sleepUntil((deadline.tv_sec * Clock::NSEC_PER_SEC) + deadline.tv_nsec);
+        return isReady();
+    }
+
+    struct itimerspec timerSpec;
+    timerSpec.it_interval.tv_sec = 0;
+    timerSpec.it_interval.tv_nsec = 0;
+    timerSpec.it_value = deadline;
+
+    // A deadline that has already passed expires the timer immediately
+    if (timerfd_settime(myTimerFD, TFD_TIMER_ABSTIME, &timerSpec, NULL) < 0)
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        struct epoll_event events[2];
+
+        int eventCount = epoll_wait(myEpollFD, events, 2, -1);
+        if (eventCount < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        bool isReady = false;
+        bool isExpired = false;
+        for(
+                int eventIdx = 0;
+                eventIdx < eventCount;
+                ++eventIdx
+           )
+        {
+            if (events[eventIdx].data.fd == myTimerFD)
+            {
+                isExpired = true;
+            }
+            else
+            {
+                isReady = true;
+            }
+        }
+
+        if (isExpired == true)
+        {
+            uint64_t expirations;
+            ssize_t readCount = read(myTimerFD, &expirations, sizeof(expirations));
+            (void)readCount;
+        }
+
+        if (isReady == true)
+        {
+            return true;
+        }
+
+        if (isExpired == true)
+        {
+            return false;
+        }
+    }
+}
+
+bool
+DescriptorPoller::isReady()
+{
+    struct epoll_event events[2];
+
+    int eventCount = epoll_wait(myEpollFD, events, 2, 0);
+    for(
+            int eventIdx = 0;
+            eventIdx < eventCount;
+            ++eventIdx
+       )
+    {
+        if (events[eventIdx].data.fd != myTimerFD)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+DescriptorPoller::GetDeadline(
+        unsigned long       timeoutUsec,
+        struct timespec&    deadline
+        )
+{
+    long long currentTime = Clock::GetInstance().getTime();
+    deadline.tv_sec = currentTime / Clock::NSEC_PER_SEC;
+    deadline.tv_nsec = currentTime % Clock::NSEC_PER_SEC;
+
+    deadline.tv_sec += timeoutUsec / 1000000;
+    deadline.tv_nsec += (timeoutUsec % 1000000) * 1000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+}
+
+
+InputDescriptorBuffer::InputDescriptorBuffer(
+        int             inputFD,
+        unsigned long   timeoutUsec
+        ) :
+    myInputFD(inputFD),
+    myPoller(inputFD, EPOLLIN),
+    myPacketSize(0),
+    myTimeout(timeoutUsec),
+    myIsHeaderRead(false),
+    myIsPacketComplete(false),
+    myIsClosed(false),
+    myIsFrameDropped(false),
+    myLastReadChar('\0')
+{
+    fcntl(myInputFD, F_SETFL, fcntl(myInputFD, F_GETFL) | O_NONBLOCK);
+}
+
+InputDescriptorBuffer::~InputDescriptorBuffer()
+{
+}
+
+bool
+InputDescriptorBuffer::readPacket()
+{
+    struct timespec deadline;
+    DescriptorPoller::GetDeadline(myTimeout, deadline);
+
+    while (parseBytes() == false)
+    {
+        if (read() == true)
+        {
+            continue;
+        }
+
+        if(
+                (myIsClosed == true) ||
+                (myPoller.wait(deadline) == false)
+          )
+        {
+            break;
+        }
+    }
+
+    return isPacketComplete();
+}
+
+bool
+InputDescriptorBuffer::read()
+{
+    ssize_t readCount = myRing.fill(myInputFD);
+    if (readCount > 0)
+    {
+        return true;
+    }
+
+    if(
+            (readCount == 0) ||
+            (
+             (errno != EAGAIN) &&
+             (errno != EWOULDBLOCK) &&
+             (errno != EINTR)
+            )
+      )
+    {
+        myIsClosed = true;
+    }
+
+    return false;
+}
+
+bool
+InputDescriptorBuffer::parseBytes()
+{
+    unsigned char curByte;
+
+    while(
+            (myIsPacketComplete == false) &&
+            (myRing.pop(curByte) == true)
+         )
+    {
+        if (myFraming == FRAMING_COBS)
+        {
+            parseCobsByte(curByte);
+            continue;
+        }
+
+        char readChar = (char)curByte;
+        if (readChar == '\xFF')
+        {
+            if (myIsHeaderRead == false)
+            {
+                myIsHeaderRead = true;
+            }
+            else
+            {
+                if (myLastReadChar == '\xFF')
+                {
+                    // If back-to-back packet boundaries are found, then clear
+                    // the packet and use the current byte as the header
+                    clear();
+                    myIsHeaderRead = true;
+                }
+                else
+                {
+                    myIsPacketComplete = true;
+                }
+            }
+        }
+        else if (myIsHeaderRead == false)
+        {
+            // Discard noise between packets
+            continue;
+        }
+
+        if (myPacketSize >= MAX_PACKET_SIZE)
+        {
+            // Discard overlong packet
+            clear();
+            continue;
+        }
+
+        myPacketData[myPacketSize++] = curByte;
+        myLastReadChar = readChar;
+    }
+
+    return myIsPacketComplete;
+}
+
+void
+InputDescriptorBuffer::parseCobsByte(
+        unsigned char curByte
+        )
+{
+    if (curByte == 0x00)
+    {
+        // Delimiter ends a non-empty frame
+        if(
+                (myIsFrameDropped == false) &&
+                (myPacketSize > 0)
+          )
+        {
+            myIsPacketComplete = true;
+        }
+
+        myIsFrameDropped = false;
+        return;
+    }
+
+    if (myIsFrameDropped == true)
+    {
+        return;
+    }
+
+    if (myPacketSize >= MAX_PACKET_SIZE)
+    {
+        // Discard overlong frame up to its delimiter
+        clear();
+        myIsFrameDropped = true;
+        return;
+    }
+
+    myPacketData[myPacketSize++] = curByte;
+}
+
+bool
+InputDescriptorBuffer::isPacketComplete() const
+{
+    return myIsPacketComplete;
+}
+
+std::istream&
+InputDescriptorBuffer::getInputStream()
+{
+    myByteBuffer.clear();
+    myByteBuffer.str(std::string((const char*)myPacketData, myPacketSize));
+
+    return myByteBuffer;
+}
+
+bool
+InputDescriptorBuffer::getPacketData(
+        const unsigned char*&   data,
+        size_t&                 dataSize
+        )
+{
+    data = myPacketData;
+    dataSize = myPacketSize;
+
+    return true;
+}
+
+void
+InputDescriptorBuffer::clear()
+{
+    myPacketSize = 0;
+    myIsPacketComplete = false;
+    myIsHeaderRead = false;
+}
+
+void
+InputDescriptorBuffer::setTimeout(
+        unsigned long timeoutUsec
+        )
+{
+    myTimeout = timeoutUsec;
+}
+
+unsigned long
+InputDescriptorBuffer::getTimeout() const
+{
+    return myTimeout;
+}
+
+
+OutputDescriptorBuffer::OutputDescriptorBuffer(
+        int             outputFD,
+        unsigned long   timeoutUsec
+        ) :
+    myOutputFD(outputFD),
+    myPoller(outputFD, EPOLLOUT),
+    myByteBuffer(
+            std::ios::in |
+            std::ios::out |
+            std::ios::binary
+            ),
+    myQueuedCount(0),
+    myTimeout(timeoutUsec),
+    myIsPacketComplete(false),
+    myIsClosed(false)
+{
+    fcntl(myOutputFD, F_SETFL, fcntl(myOutputFD, F_GETFL) | O_NONBLOCK);
+}
+
+OutputDescriptorBuffer::~OutputDescriptorBuffer()
+{
+}
+
+bool
+OutputDescriptorBuffer::writePacket()
+{
+    if (isPacketComplete() == true)
+    {
+        return true;
+    }
+
+    struct timespec deadline;
+    DescriptorPoller::GetDeadline(myTimeout, deadline);
+
+    std::string packetData = myByteBuffer.str();
+    myIsPacketComplete = flush(
+            (const unsigned char*)packetData.data(),
+            packetData.size(),
+            myQueuedCount,
+            deadline
+            );
+
+    return isPacketComplete();
+}
+
+bool
+OutputDescriptorBuffer::writeData(
+        const unsigned char*    data,
+        size_t                  dataSize
+        )
+{
+    struct timespec deadline;
+    DescriptorPoller::GetDeadline(myTimeout, deadline);
+
+    myIsPacketComplete = flush(
+            data,
+            dataSize,
+            myQueuedCount,
+            deadline
+            );
+
+    return isPacketComplete();
+}
+
+bool
+OutputDescriptorBuffer::write()
+{
+    ssize_t writeCount = myRing.drain(myOutputFD);
+    if (writeCount > 0)
+    {
+        return true;
+    }
+
+    if(
+            (writeCount < 0) &&
+            (errno != EAGAIN) &&
+            (errno != EWOULDBLOCK) &&
+            (errno != EINTR)
+      )
+    {
+        myIsClosed = true;
+    }
+
+    return false;
+}
+
+bool
+OutputDescriptorBuffer::flush(
+        const unsigned char*    data,
+        size_t                  dataSize,
+        size_t&                 dataIdx,
+        const struct timespec&  deadline
+        )
+{
+    while (myIsClosed == false)
+    {
+        while(
+                (dataIdx < dataSize) &&
+                (myRing.push(data[dataIdx]) == true)
+             )
+        {
+            ++dataIdx;
+        }
+
+        if(
+                (dataIdx >= dataSize) &&
+                (myRing.empty() == true)
+          )
+        {
+            return true;
+        }
+
+        if (write() == true)
+        {
+            continue;
+        }
+
+        if (myPoller.wait(deadline) == false)
+        {
+            break;
+        }
+    }
+
+    return false;
+}
+
+bool
+OutputDescriptorBuffer::isPacketComplete() const
+{
+    return myIsPacketComplete;
+}
+
+std::ostream&
+OutputDescriptorBuffer::getOutputStream()
+{
+    return myByteBuffer;
+}
+
+void
+OutputDescriptorBuffer::clear()
+{
+    myByteBuffer.clear();
+    myByteBuffer.str("");
+    myQueuedCount = 0;
+    myIsPacketComplete = false;
+}
+
+void
+OutputDescriptorBuffer::resync()
+{
+    struct timespec deadline;
+    size_t resyncIdx = 0;
+    DescriptorPoller::GetDeadline(myTimeout, deadline);
+
+    flush(
+            (const unsigned char*)"\xFF\xFF\xFF\xFF\xFF",
+            5,
+            resyncIdx,
+            deadline
+            );
+}
@@ -2,6 +2,9 @@
 #define IOBUFFER_H
 
 #include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
 #include <sstream>
 
 
@@ -12,11 +15,50 @@ class InputBuffer
 {
     public:
 
+        /**
+         * Packet framing enumerations
+         */
+        enum Framing
+        {
+            FRAMING_BOUNDED,    /**< Packets start and end with a boundary byte */
+            FRAMING_COBS        /**< COBS frames end with a zero byte */
+        };
+
+        /**
+         * Default constructor
+         *
+         * Packets are framed by boundary bytes until told otherwise.
+         */
+        InputBuffer() :
+            myFraming(FRAMING_BOUNDED)
+        {
+        }
+
         /**
          * Destructor
          */
         virtual ~InputBuffer(){};
 
+        /**
+         * Sets how packets are framed in the input
+         *
+         * This takes effect from the next packet read.
+         */
+        void setFraming(
+                Framing framing
+                )
+        {
+            myFraming = framing;
+        }
+
+        /**
+         * Provides how packets are framed in the input
+         */
+        Framing getFraming() const
+        {
+            return myFraming;
+        }
+
         /**
          * Attempts to read a packet from an input source
          *
@@ -30,10 +72,34 @@ class InputBuffer
          */
         virtual std::istream& getInputStream() = 0;
 
+        /**
+         * Provides the bytes of the buffered packet without a stream
+         *
+         * Buffers that hold packet bytes in memory may provide them directly
+         * so that packets can be decoded without stream overhead.
+         *
+         * \return True if the bytes were provided, false if only the input
+         * stream is available
+         */
+        virtual bool getPacketData(
+                const unsigned char*&   data,
+                size_t&                 dataSize
+                )
+        {
+            return false;
+        }
+
         /**
          * Clears the contents of this buffer
          */
         virtual void clear() = 0;
+
+    protected:
+
+        /**
+         * How packets are framed in the input
+         */
+        Framing myFraming;
 };
 
 /**
@@ -61,6 +127,22 @@ class OutputBuffer
          */
         virtual std::ostream& getOutputStream() = 0;
 
+        /**
+         * Writes a single packet held in memory to an output destination
+         *
+         * By default the bytes are passed through the output stream.
+         *
+         * \return True if the write operation was successful, false otherwise
+         */
+        virtual bool writeData(
+                const unsigned char*    data,
+                size_t                  dataSize
+                )
+        {
+            getOutputStream().write((const char*)data, dataSize);
+            return writePacket();
+        }
+
         /**
          * Clears the contents of this buffer
          */
@@ -232,4 +314,477 @@ class OutputFileBuffer : public OutputBuffer
         bool myIsPacketComplete;
 };
 
+/**
+ * Fixed-capacity byte queue for bulk descriptor I/O
+ *
+ * Bytes are moved between the ring and a file descriptor with a single
+ * scatter/gather system call, so no per-byte system calls are made.
+ */
+class ByteRingBuffer
+{
+    public:
+
+        /**
+         * Number of bytes the ring can hold
+         */
+        static const size_t CAPACITY = 512;
+
+        /**
+         * Constructor
+         */
+        ByteRingBuffer();
+
+        /**
+         * Indicates the number of bytes held
+         */
+        size_t size() const;
+
+        /**
+         * Indicates if no bytes are held
+         */
+        bool empty() const;
+
+        /**
+         * Adds a byte to the back of the ring
+         *
+         * \return True if the byte was added, false if the ring is full
+         */
+        bool push(
+                unsigned char byte
+                );
+
+        /**
+         * Removes a byte from the front of the ring
+         *
+         * \return True if a byte was removed, false if the ring is empty
+         */
+        bool pop(
+                unsigned char& byte
+                );
+
+        /**
+         * Reads as many bytes as are available and fit from a descriptor
+         *
+         * \return Number of bytes read, 0 at end of input, or -1 on error
+         * with errno set
+         */
+        ssize_t fill(
+                int fd
+                );
+
+        /**
+         * Writes as many held bytes as the descriptor accepts
+         *
+         * \return Number of bytes written, or -1 on error with errno set
+         */
+        ssize_t drain(
+                int fd
+                );
+
+        /**
+         * Discards all held bytes
+         */
+        void clear();
+
+    private:
+
+        /**
+         * Storage for held bytes
+         */
+        unsigned char myBytes[CAPACITY];
+
+        /**
+         * Index of the first held byte
+         */
+        size_t myHead;
+
+        /**
+         * Number of held bytes
+         */
+        size_t mySize;
+};
+
+/**
+ * Waits for readiness of a file descriptor until an absolute deadline
+ *
+ * An epoll set holds the descriptor along with a timer descriptor armed for
+ * the deadline, giving microsecond deadline resolution.
+ *
+ * Deadlines are on the clock in use by the process. When that clock does not
+ * follow real time, waiting moves it on to the deadline unless the descriptor
+ * is already ready, and the descriptor is checked again then.
+ */
+class DescriptorPoller
+{
+    public:
+
+        /**
+         * Constructor given descriptor and epoll events to wait for
+         */
+        DescriptorPoller(
+                int         fd,
+                uint32_t    events
+                );
+
+        /**
+         * Destructor
+         *
+         * The watched descriptor is not closed when this object is destroyed.
+         */
+        ~DescriptorPoller();
+
+        /**
+         * Waits until the descriptor is ready or the deadline passes
+         *
+         * \return True if the descriptor became ready, false if the deadline
+         * passed or waiting failed
+         */
+        bool wait(
+                const struct timespec& deadline
+                );
+
+        /**
+         * Computes a deadline a number of microseconds from now
+         */
+        static void GetDeadline(
+                unsigned long       timeoutUsec,
+                struct timespec&    deadline
+                );
+
+    private:
+
+        /**
+         * Indicates if the descriptor is ready, without waiting
+         */
+        bool isReady();
+
+        /**
+         * Epoll instance watching the descriptor and the timer
+         */
+        int myEpollFD;
+
+        /**
+         * Timer descriptor armed for the current deadline
+         */
+        int myTimerFD;
+};
+
+/**
+ * Reads and buffers packets from a non-blocking file descriptor
+ *
+ * Available bytes are read in bulk into a ring buffer and framed into packets
+ * from there. Bytes past the end of a packet are kept for the next packet.
+ */
+class InputDescriptorBuffer : public InputBuffer
+{
+    public:
+
+        /**
+         * Default time allowed for a packet to arrive, in microseconds
+         */
+        static const unsigned long DEFAULT_TIMEOUT_USEC = 1000000;
+
+        /**
+         * Largest packet that can be buffered, boundary bytes included
+         *
+         * Longer byte runs are discarded as noise.
+         */
+        static const size_t MAX_PACKET_SIZE = 64;
+
+        /**
+         * Constructor with descriptor to read packets from
+         *
+         * The descriptor is switched to non-blocking mode.
+         */
+        InputDescriptorBuffer(
+                int             inputFD,
+                unsigned long   timeoutUsec = DEFAULT_TIMEOUT_USEC
+                );
+
+        /**
+         * Destructor
+         *
+         * The descriptor is not closed when this object is destroyed.
+         */
+        ~InputDescriptorBuffer();
+
+        /**
+         * Attempts to read a packet before the timeout elapses
+         *
+         * \return True if a complete packet is buffered, false otherwise
+         */
+        bool readPacket();
+
+        /**
+         * Reads all currently available bytes without blocking
+         *
+         * \return True if any bytes were read, false otherwise
+         */
+        bool read();
+
+        /**
+         * Indicates if a complete packet is currently buffered
+         */
+        bool isPacketComplete() const;
+
+        /**
+         * Provides an input stream to read complete packets from
+         */
+        std::istream& getInputStream();
+
+        /**
+         * Provides the bytes of the buffered packet without a stream
+         */
+        bool getPacketData(
+                const unsigned char*&   data,
+                size_t&                 dataSize
+                );
+
+        /**
+         * Clears the current packet from this buffer
+         *
+         * Bytes already read past the current packet are kept.
+         */
+        void clear();
+
+        /**
+         * Sets the time allowed for a packet to arrive, in microseconds
+         */
+        void setTimeout(
+                unsigned long timeoutUsec
+                );
+
+        /**
+         * Provides the time allowed for a packet to arrive, in microseconds
+         */
+        unsigned long getTimeout() const;
+
+    private:
+
+        /**
+         * Frames bytes from the ring into the current packet
+         *
+         * \return True if the current packet is complete
+         */
+        bool parseBytes();
+
+        /**
+         * Frames a single byte of COBS input into the current packet
+         */
+        void parseCobsByte(
+                unsigned char curByte
+                );
+
+        /**
+         * Descriptor to read packets from
+         */
+        int myInputFD;
+
+        /**
+         * Waits for the descriptor to become readable
+         */
+        DescriptorPoller myPoller;
+
+        /**
+         * Bytes read but not yet framed
+         */
+        ByteRingBuffer myRing;
+
+        /**
+         * Bytes of the current packet
+         */
+        unsigned char myPacketData[MAX_PACKET_SIZE];
+
+        /**
+         * Number of bytes in myPacketData
+         */
+        size_t myPacketSize;
+
+        /**
+         * Stream adapter over the current packet's bytes
+         */
+        std::stringstream myByteBuffer;
+
+        /**
+         * Time allowed for a packet to arrive, in microseconds
+         */
+        unsigned long myTimeout;
+
+        /**
+         * Indicates if the packet header byte has been read yet
+         */
+        bool myIsHeaderRead;
+
+        /**
+         * Indicates if complete packet is currently buffered
+         */
+        bool myIsPacketComplete;
+
+        /**
+         * Indicates if the descriptor has reached end of input or failed
+         */
+        bool myIsClosed;
+
+        /**
+         * Indicates if the rest of an overlong COBS frame is being discarded
+         */
+        bool myIsFrameDropped;
+
+        /**
+         * Last byte framed into the current packet
+         */
+        char myLastReadChar;
+};
+
+/**
+ * Buffers and writes packets to a non-blocking file descriptor
+ *
+ * Packet bytes are queued in a ring buffer and written out in bulk.
+ */
+class OutputDescriptorBuffer : public OutputBuffer
+{
+    public:
+
+        /**
+         * Default time allowed for a packet to be written, in microseconds
+         */
+        static const unsigned long DEFAULT_TIMEOUT_USEC = 1000000;
+
+        /**
+         * Constructor with descriptor to write packets to
+         *
+         * The descriptor is switched to non-blocking mode.
+         */
+        OutputDescriptorBuffer(
+                int             outputFD,
+                unsigned long   timeoutUsec = DEFAULT_TIMEOUT_USEC
+                );
+
+        /**
+         * Destructor
+         *
+         * The descriptor is not closed when this object is destroyed.
+         */
+        ~OutputDescriptorBuffer();
+
+        /**
+         * Attempts to write the buffered packet before the timeout elapses
+         *
+         * \return True if the complete packet has been written out, false
+         * otherwise
+         */
+        bool writePacket();
+
+        /**
+         * Writes a single packet held in memory before the timeout elapses
+         *
+         * The bytes are queued directly without passing through the output
+         * stream.
+         *
+         * \return True if the complete packet has been written out, false
+         * otherwise
+         */
+        bool writeData(
+                const unsigned char*    data,
+                size_t                  dataSize
+                );
+
+        /**
+         * Writes as many queued bytes as possible without blocking
+         *
+         * \return True if any bytes were written, false otherwise
+         */
+        bool write();
+
+        /**
+         * Indicates if a complete packet has been written out
+         */
+        bool isPacketComplete() const;
+
+        /**
+         * Provides an output stream to write complete packets to
+         */
+        std::ostream& getOutputStream();
+
+        /**
+         * Clears the contents of this buffer
+         *
+         * Bytes of a previous packet that are still queued are kept, so that
+         * a packet is never cut short on the wire.
+         */
+        void clear();
+
+        /**
+         * Sends a resynchronization sequence
+         */
+        void resync();
+
+        /**
+         * Sets the time allowed for a packet to be written, in microseconds
+         */
+        void setTimeout(
+                unsigned long timeoutUsec
+                );
+
+        /**
+         * Provides the time allowed for a packet to be written, in
+         * microseconds
+         */
+        unsigned long getTimeout() const;
+
+    private:
+
+        /**
+         * Queues bytes and writes them out until done or the deadline passes
+         *
+         * \return True if all bytes were written out
+         */
+        bool flush(
+                const unsigned char*    data,       /**< Bytes to write */
+                size_t                  dataSize,   /**< Number of bytes to write */
+                size_t&                 dataIdx,    /**< Index of next byte to queue */
+                const struct timespec&  deadline    /**< Time to give up at */
+                );
+
+        /**
+         * Descriptor to write packets to
+         */
+        int myOutputFD;
+
+        /**
+         * Waits for the descriptor to become writable
+         */
+        DescriptorPoller myPoller;
+
+        /**
+         * Bytes queued but not yet written
+         */
+        ByteRingBuffer myRing;
+
+        /**
+         * Buffer for packet bytes
+         */
+        std::stringstream myByteBuffer;
+
+        /**
+         * Number of bytes of the current packet queued so far
+         */
+        size_t myQueuedCount;
+
+        /**
+         * Time allowed for a packet to be written, in microseconds
+         */
+        unsigned long myTimeout;
+
+        /**
+         * Indicates if complete packet has been written
+         */
+        bool myIsPacketComplete;
+
+        /**
+         * Indicates if the descriptor has failed
+         */
+        bool myIsClosed;
+};
+
 #endif /* ifndef IOBUFFER_H */
@@ -4,11 +4,29 @@
 using namespace frc;
 
 
+IterativeRobot::IterativeRobot() :
+    myRobotContext()
+{
+    // Components built as members of the program register with it
+    RobotContext::SetCurrent(&myRobotContext);
+}
+
+RobotContext&
+IterativeRobot::GetRobotContext()
+{
+    return myRobotContext;
+}
+
 void
 IterativeRobot::RobotInit()
 {
 }
 
+void
+IterativeRobot::RobotPeriodic()
+{
+}
+
 void
 IterativeRobot::DisabledInit()
 {
@@ -1,6 +1,8 @@
 #ifndef ROBOTBASE_H
 #define ROBOTBASE_H
 
+#include "RobotContext.h"
+
 namespace frc
 {
 
@@ -9,16 +11,31 @@ namespace frc
  *
  * All implementations of the initialzation and periodic functions in this
  * abstract class are empty.
+ *
+ * Each program owns the registry of its components. The registry becomes the
+ * current one on the constructing thread as the program starts being
+ * constructed, so the components among the program's members register with
+ * it.
  */
 class IterativeRobot
 {
     public:
 
+        /**
+         * Default constructor
+         */
+        IterativeRobot();
+
         /**
          * Destructor
          */
         virtual ~IterativeRobot(){}
 
+        /**
+         * Provides the registry of this program's components
+         */
+        RobotContext& GetRobotContext();
+
         /**
          * Global initialization function
          *
@@ -27,6 +44,14 @@ class IterativeRobot
          */
         virtual void RobotInit();
 
+        /**
+         * Global periodic function
+         *
+         * This function is called once per cycle in every mode, after the
+         * mode's own periodic function.
+         */
+        virtual void RobotPeriodic();
+
         /**
          * Disabled mode initialization
          *
@@ -92,6 +117,13 @@ class IterativeRobot
          * 'test' mode.
          */
         virtual void TestPeriodic();
+
+    private:
+
+        /**
+         * Registry of this program's components
+         */
+        RobotContext myRobotContext;
 };
 
 }; /* namespace frc */
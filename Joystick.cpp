@@ -1,5 +1,6 @@
 
 #include "Joystick.h"
+#include "SessionLog.h"
 
 using namespace frc;
 
@@ -7,6 +8,7 @@ using namespace frc;
 Joystick::Joystick(
         int port
         ) :
+    myPort(port),
     mySDLStick(NULL)
 {
     if (SDL_Init(SDL_INIT_JOYSTICK) != 0)
@@ -44,23 +46,19 @@ Joystick::GetX(
         JoystickHand hand
         )
 {
-    if (mySDLStick == NULL)
+    if (SessionPlayer::GetInstance() != NULL)
     {
-        return 0.0;
+        return SessionPlayer::GetInstance()->replayAxis(myPort, 0);
     }
 
-    SDL_JoystickUpdate();
+    float xPosition = readAxis(0);
 
-    float xVal = SDL_JoystickGetAxis(mySDLStick, 0);
-
-    if (xVal >= 0)
+    if (SessionRecorder::GetInstance() != NULL)
     {
-        return (xVal / MAX_AXIS);
-    }
-    else
-    {
-        return (-1 * (xVal / MIN_AXIS));
+        SessionRecorder::GetInstance()->recordAxis(myPort, 0, xPosition);
     }
+
+    return xPosition;
 }
 
 float
@@ -68,23 +66,20 @@ Joystick::GetY(
         JoystickHand hand
         )
 {
-    if (mySDLStick == NULL)
+    if (SessionPlayer::GetInstance() != NULL)
     {
-        return 0.0;
+        return SessionPlayer::GetInstance()->replayAxis(myPort, 1);
     }
 
-    SDL_JoystickUpdate();
-
-    float yVal = SDL_JoystickGetAxis(mySDLStick, 1);
+    // Pushing the stick forward gives negative axis values
+    float yPosition = -readAxis(1);
 
-    if (yVal >= 0)
+    if (SessionRecorder::GetInstance() != NULL)
     {
-        return (-1 * (yVal / MAX_AXIS));
-    }
-    else
-    {
-        return (yVal / MIN_AXIS);
+        SessionRecorder::GetInstance()->recordAxis(myPort, 1, yPosition);
     }
+
+    return yPosition;
 }
 
 int
@@ -96,8 +91,44 @@ Joystick::GetButtonCount() const
 bool
 Joystick::GetRawButton(int buttonIdx) const
 {
+  if (SessionPlayer::GetInstance() != NULL)
+  {
+    return SessionPlayer::GetInstance()->replayButton(myPort, buttonIdx);
+  }
+
   SDL_JoystickUpdate();
-  return (SDL_JoystickGetButton(mySDLStick, buttonIdx) != 0);
+  bool isPressed = (SDL_JoystickGetButton(mySDLStick, buttonIdx) != 0);
+
+  if (SessionRecorder::GetInstance() != NULL)
+  {
+    SessionRecorder::GetInstance()->recordButton(myPort, buttonIdx, isPressed);
+  }
+
+  return isPressed;
+}
+
+float
+Joystick::readAxis(
+        int axis
+        ) const
+{
+    if (mySDLStick == NULL)
+    {
+        return 0.0;
+    }
+
+    SDL_JoystickUpdate();
+
+    float axisVal = SDL_JoystickGetAxis(mySDLStick, axis);
+
+    if (axisVal >= 0)
+    {
+        return (axisVal / MAX_AXIS);
+    }
+    else
+    {
+        return (-1 * (axisVal / MIN_AXIS));
+    }
 }
 
 // TwoDimController implementations
@@ -20,7 +20,9 @@ enum JoystickHand
  * Encapsulates a joystick or gamepad input device
  *
  * This class currently uses the Simple DirectMedia Layer (SDL) to use
- * connected joysticks.
+ * connected joysticks. While a session is recorded, every reading is
+ * recorded, and while one is replayed, readings come from the recording in
+ * place of the device.
  */
 class Joystick : public TwoDimController
 {
@@ -81,6 +83,15 @@ class Joystick : public TwoDimController
 
     private:
 
+        /**
+         * Reads the position of the stick on the given axis from the device
+         *
+         * \return Position from -1 to 1, positive for positive axis values
+         */
+        float readAxis(
+                int axis
+                ) const;
+
         /**
          * Maximum value for joystick axis
          */
@@ -91,6 +102,11 @@ class Joystick : public TwoDimController
          */
         const static int MIN_AXIS = -32768;
 
+        /**
+         * Port of this joystick
+         */
+        int myPort;
+
         /**
          * Handle to SDL joystick object
          */
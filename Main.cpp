@@ -2,23 +2,64 @@
 #include "FieldControlSystem.h"
 #include "RedBot.h"
 #include "RedBotPacket.h"
+#include "OutputCache.h"
 #include "IterativeRobot.h"
+#include "TimedRobot.h"
+#include "SerialPort.h"
+#include "DriverStation.h"
+#include "BaseStation.h"
+#include "FirmwareSimulator.h"
+#include "SessionLog.h"
+#include "Diagnostics.h"
+#include "Scheduler.h"
+#include "Main.h"
 #include <iostream>
 #include <argp.h>
 #include <errno.h>
 #include <error.h>
+#include <math.h>
 #include <sys/types.h>
-#include <sys/socket.h>
-#include <netdb.h>
 #include <string.h>
+#include <stdlib.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <vector>
 
 #define MAX_ERROR_COUNT 5
 
+#define DRIVER_STATION_POLL_USEC 10000
+
+/**
+ * Applies the link settings given as arguments to a robot
+ */
+void ConfigureRobot(
+        RedBot& robot,
+        size_t  robotIdx    /**< Index of the robot among those driven */
+        );
+
 /**
- * Attempts to connect to the driver station via a socket
+ * Provides the path of a robot's file given the path for all robots
+ *
+ * When several robots are driven, each one's index is appended to the path.
  */
-int ConnectToDriverStation();
+std::string GetRobotFilePath(
+        const std::string&  path,
+        size_t              robotIdx
+        );
+
+/**
+ * Runs a program against the simulated robot firmware in virtual time
+ */
+int RunSimulation(
+        frc::IterativeRobot& program
+        );
+
+/**
+ * Runs a program against a recorded session as fast as possible
+ */
+int RunReplay(
+        frc::IterativeRobot& program
+        );
 
 /**
  * Writes an error message for an invalid received packet
@@ -27,6 +68,13 @@ void WriteIncoherentMessage(
         const RedBot& robot
         );
 
+/**
+ * Writes the timing statistics of a fixed-period program's loop
+ */
+void WriteLoopStatistics(
+        const frc::TimedRobot& program
+        );
+
 /**
  * Parses arguments passed to program
  */
@@ -45,7 +93,7 @@ static struct argp_option options [] = {
         'd',
         "device-path",
         0,
-        "Path to serial device file that robot is connected to"
+        "Path to serial device file that robot is connected to (repeat to drive several robots from a base station)"
     },
     {
         "input-device",
@@ -61,6 +109,139 @@ static struct argp_option options [] = {
         0,
         "Path to output serial device that robot receives its input from"
     },
+    {
+        "window",
+        'w',
+        "window-size",
+        0,
+        "Number of requests to keep outstanding on the serial link at once"
+    },
+    {
+        "timeout",
+        't',
+        "microseconds",
+        0,
+        "Time to wait for each packet exchange on the serial link"
+    },
+    {
+        "batch",
+        'b',
+        NULL,
+        0,
+        "Batch each cycle's requests into frames sent in a single write"
+    },
+    {
+        "keep-alive",
+        'k',
+        "cycles",
+        0,
+        "Cycles between repeats of unchanged actuator commands (0 sends every command)"
+    },
+    {
+        "link-budget",
+        'l',
+        "bytes",
+        0,
+        "Request bytes sent per cycle, shared by priority (0 polls every component)"
+    },
+    {
+        "protocol",
+        'p',
+        "version",
+        0,
+        "Latest protocol version to negotiate with the robot (1 keeps bounded packets)"
+    },
+    {
+        "checksum",
+        'c',
+        "type",
+        0,
+        "Checksum to negotiate with the robot: none, crc8 or crc16"
+    },
+    {
+        "retries",
+        'R',
+        "count",
+        0,
+        "Times a corrupted exchange is retried while a checksum is in use"
+    },
+    {
+        "threaded",
+        'T',
+        NULL,
+        0,
+        "Exchange packets with the robot on a background thread while user code runs"
+    },
+    {
+        "baud",
+        'r',
+        "rate",
+        0,
+        "Baud rate of the serial link, which must match the robot firmware"
+    },
+    {
+        "latency-timer",
+        'L',
+        "milliseconds",
+        0,
+        "Latency timer of FTDI USB-serial adapters (0 leaves it unchanged)"
+    },
+    {
+        "workers",
+        'W',
+        "count",
+        0,
+        "Worker threads running the cycles of a base station's robots"
+    },
+    {
+        "trace",
+        'x',
+        "file",
+        0,
+        "Keep the trace of the latest packets exchanged with the robot in this file"
+    },
+    {
+        "fault-trace",
+        'X',
+        "file",
+        0,
+        "Write the trace of the latest packets exchanged with the robot to this file when an exchange fails"
+    },
+    {
+        "record",
+        'e',
+        "file",
+        0,
+        "Record the driver station modes, joystick readings and robot packets the program consumes to this file"
+    },
+    {
+        "replay",
+        'y',
+        "file",
+        0,
+        "Run the program against the session recorded in this file as fast as possible, without driver station or robot"
+    },
+    {
+        "simulate",
+        's',
+        "seconds",
+        0,
+        "Run for this much virtual time against the simulated robot firmware, without a driver station"
+    },
+    {
+        "mode",
+        'm',
+        "mode",
+        0,
+        "Mode to run a simulated robot in: disabled, auto, teleop or test"
+    },
+    {
+        "diagnostics",
+        'g',
+        "level",
+        0,
+        "Bytes of exchanges to keep for diagnostics: off, errors or full"
+    },
     0
 };
 
@@ -78,9 +259,9 @@ static struct argp parserConfig = {
 };
 
 /**
- * Path of serial I/O device that robot is connected to
+ * Paths of serial I/O devices that robots are connected to
  */
-static std::string InputOutputDevicePath;
+static std::vector<std::string> InputOutputDevicePaths;
 
 /**
  * Path of input device that robot sends output to
@@ -92,6 +273,98 @@ static std::string InputDevicePath;
  */
 static std::string OutputDevicePath;
 
+/**
+ * Number of requests to keep outstanding on the serial link at once
+ */
+static size_t PipelineWindow = 1;
+
+/**
+ * Indicates if each cycle's requests are batched into frames
+ */
+static bool IsFrameBatching = false;
+
+/**
+ * Time to wait for each packet exchange on the serial link, in microseconds
+ */
+static unsigned long ExchangeTimeout = InputDescriptorBuffer::DEFAULT_TIMEOUT_USEC;
+
+/**
+ * Number of cycles between repeats of unchanged actuator commands
+ */
+static unsigned int KeepAliveInterval = OutputCache::DEFAULT_KEEP_ALIVE_INTERVAL;
+
+/**
+ * Number of request bytes sent per cycle, or 0 for no limit
+ */
+static size_t LinkBudget = 0;
+
+/**
+ * Latest protocol version to negotiate with the robot
+ */
+static unsigned int MaxProtocolVersion = Packet::PROTOCOL_COBS;
+
+/**
+ * Checksum to negotiate with the robot
+ */
+static Crc::Type ChecksumType = Crc::TYPE_NONE;
+
+/**
+ * Number of times a corrupted exchange is retried
+ */
+static unsigned int MaxRetries = 3;
+
+/**
+ * Indicates if packets are exchanged on a background thread
+ */
+static bool IsThreadedIO = false;
+
+/**
+ * Baud rate of the serial link
+ */
+static unsigned long BaudRate = SerialPort::DEFAULT_BAUD_RATE;
+
+/**
+ * Latency timer of USB-serial adapters, in milliseconds
+ */
+static unsigned int LatencyTimer = SerialPort::DEFAULT_LATENCY_TIMER;
+
+/**
+ * Number of worker threads running a base station's cycles
+ */
+static size_t WorkerCount = BaseStation::DEFAULT_WORKER_COUNT;
+
+/**
+ * File to keep the trace of exchanged packets in, or empty for none
+ */
+static std::string TraceFilePath;
+
+/**
+ * File to write the trace of exchanged packets to on failures, or empty for
+ * none
+ */
+static std::string FaultTraceFilePath;
+
+/**
+ * File to record the session to, or empty for none
+ */
+static std::string RecordFilePath;
+
+/**
+ * File to replay a recorded session from, or empty to drive a real robot
+ */
+static std::string ReplayFilePath;
+
+/**
+ * Virtual time to simulate the robot for, in seconds, or 0 to drive a real
+ * robot
+ */
+static double SimulationTime = 0.0;
+
+/**
+ * Mode to run a simulated robot in
+ */
+static FieldControlSystem::Mode SimulationMode = FieldControlSystem::MODE_DISABLED;
+
 int
 WPIRBMain(
         int             argc,
@@ -100,8 +373,11 @@ WPIRBMain(
         )
 {
     RedBot* robot = NULL;
-    InputFileBuffer* inputBuffer = NULL;
-    OutputFileBuffer* outputBuffer = NULL;
+    InputDescriptorBuffer* inputBuffer = NULL;
+    OutputDescriptorBuffer* outputBuffer = NULL;
+    SerialPort inputPort;
+    SerialPort outputPort;
+    SessionRecorder recorder;
 
     argp_parse(
             &parserConfig,
@@ -112,59 +388,76 @@ WPIRBMain(
             NULL
             );
 
+    if (InputOutputDevicePaths.size() > 1)
+    {
+        std::cerr << "Error: several devices given to a single-robot program." << std::endl;
+        return 1;
+    }
+
+    if (SimulationTime > 0.0)
+    {
+        return RunSimulation(program);
+    }
+
+    if (ReplayFilePath.empty() == false)
+    {
+        return RunReplay(program);
+    }
+
     std::cout << "Program: connecting to driver station." << std::endl;
 
-    int socketFD = ConnectToDriverStation();
-    if (socketFD < 0)
+    DriverStationClient driverStation;
+    if (driverStation.connect() == false)
+    {
+        return 1;
+    }
+
+    if(
+            (RecordFilePath.empty() == false) &&
+            (recorder.open(RecordFilePath.c_str()) == false)
+      )
     {
         return 1;
     }
 
     std::cout << "Program: initializing program." << std::endl;
     program.RobotInit();
-    if (InputOutputDevicePath.empty() == false)
+    if (InputOutputDevicePaths.empty() == false)
     {
-        robot = new RedBot(
-                &program,
-                InputOutputDevicePath.c_str(),
-                new RedBotPacketGenerator()
-                );
+        if(
+                inputPort.open(
+                    InputOutputDevicePaths.front().c_str(),
+                    O_RDWR,
+                    BaudRate,
+                    LatencyTimer
+                    ) == false
+          )
+        {
+            return 1;
+        }
     }
     else if(
             (InputDevicePath.empty() == false) &&
             (OutputDevicePath.empty() == false)
            )
     {
-        FILE* inputDevice = fopen(InputDevicePath.c_str(), "r");
-        if (inputDevice == NULL)
+        if(
+                (inputPort.open(
+                    InputDevicePath.c_str(),
+                    O_RDONLY,
+                    BaudRate,
+                    LatencyTimer
+                    ) == false) ||
+                (outputPort.open(
+                    OutputDevicePath.c_str(),
+                    O_WRONLY,
+                    BaudRate,
+                    LatencyTimer
+                    ) == false)
+          )
         {
-            error(
-                    1,
-                    errno,
-                    "Could not open input device %s",
-                    InputDevicePath.c_str()
-                 );
+            return 1;
         }
-        inputBuffer = new InputFileBuffer(inputDevice);
-
-        FILE* outputDevice = fopen(OutputDevicePath.c_str(), "w");
-        if (outputDevice == NULL)
-        {
-            error(
-                    1,
-                    errno,
-                    "Could not open output device %s",
-                    OutputDevicePath.c_str()
-                 );
-        }
-        outputBuffer = new OutputFileBuffer(outputDevice);
-
-        robot = new RedBot(
-                &program,
-                inputBuffer,
-                outputBuffer,
-                new RedBotPacketGenerator()
-                );
     }
     else
     {
@@ -172,78 +465,80 @@ WPIRBMain(
         return 1;
     }
 
+    inputBuffer = new InputDescriptorBuffer(
+            inputPort.getDescriptor(),
+            ExchangeTimeout
+            );
+    outputBuffer = new OutputDescriptorBuffer(
+            outputPort.isOpen() ?
+                outputPort.getDescriptor() : inputPort.getDescriptor(),
+            ExchangeTimeout
+            );
+
+    robot = new RedBot(
+            &program,
+            inputBuffer,
+            outputBuffer,
+            new RedBotPacketGenerator()
+            );
+
+    OutputCache::SetKeepAliveInterval(KeepAliveInterval);
+    ConfigureRobot(*robot, 0);
+
+    // Nothing is recorded unless a log is open
+    if (recorder.isOpen() == true)
+    {
+        SessionRecorder::SetInstance(&recorder);
+        robot->setSessionRecorder(&recorder);
+    }
+
     FieldControlSystem::Mode robotMode = FieldControlSystem::MODE_DISABLED;
-    char dsResponseBuf [1024];
 
-    char dsRequestBuf [8];
-    strcpy(dsRequestBuf, "request");
-    dsRequestBuf[7] = '\0';
+    // Programs with a fixed period start each cycle on its deadline
+    frc::TimedRobot* timedProgram = dynamic_cast<frc::TimedRobot*>(&program);
 
     robot->modeInit(robotMode);
+    recorder.recordMode(robotMode);
     std::cout << "Program: beginning loop." << std::endl;
     size_t errorCount = 0;
+    unsigned long transferCount = robot->getTransferCount();
     while (errorCount < MAX_ERROR_COUNT)
     {
-        write(
-                socketFD,
-                (void*)dsRequestBuf,
-                7
-             );
-
-        ssize_t dsResponseSize = recv(
-                socketFD,
-                (void*)dsResponseBuf,
-                1024,
-                0
-                );
-        if (dsResponseSize < 0)
+        if (timedProgram != NULL)
         {
-            std::cerr << "Error: no response from driver station." << std::endl;
-            break;
+            timedProgram->WaitForNextCycle();
         }
-        else if (dsResponseSize > 0)
-        {
-            dsResponseBuf[dsResponseSize] = '\0';
-
-            std::stringstream modeStream;
-            int modeVal = 0;
-
-            modeStream << dsResponseBuf;
-            modeStream >> modeVal;
 
-            FieldControlSystem::Mode newMode = robotMode;
-
-            switch (modeVal)
-            {
-                case 0:
-                    newMode = FieldControlSystem::MODE_DISABLED;
-                    break;
-
-                case 1:
-                    newMode = FieldControlSystem::MODE_AUTO;
-                    break;
-
-                case 2:
-                    newMode = FieldControlSystem::MODE_TELEOP;
-                    break;
-
-                case 3:
-                    newMode = FieldControlSystem::MODE_TEST;
-                    break;
-
-                default:
-                    break;
-            };
+        // Mode changes are pushed by the driver station in the background
+        if (driverStation.isConnected() == false)
+        {
+            std::cerr << "Error: lost connection to driver station." << std::endl;
+            break;
+        }
 
-            if (newMode != robotMode)
-            {
-                robot->modeInit(newMode);
-                robotMode = newMode;
-            }
+        FieldControlSystem::Mode newMode = driverStation.getMode();
+        if (newMode != robotMode)
+        {
+            recorder.recordMode(newMode);
+            robot->modeInit(newMode);
+            robotMode = newMode;
         }
 
+        recorder.recordCycle();
         robot->modePeriodic(robotMode);
 
+        // With the I/O thread running, the status is only new once a transfer
+        // has completed since it was last checked
+        unsigned long newTransferCount = robot->getTransferCount();
+        if(
+                (newTransferCount == transferCount) &&
+                (robot->isConnected() == true)
+          )
+        {
+            continue;
+        }
+        transferCount = newTransferCount;
+
         if (robot->getStatus() != RedBot::STATUS_GOOD)
         {
             switch (robot->getStatus())
@@ -254,7 +549,7 @@ WPIRBMain(
 
                 case RedBot::STATUS_INCOHERENT:
                     WriteIncoherentMessage(*robot);
-                    robot->resync();
+                    robot->recover();
                     break;
 
                 case RedBot::STATUS_UNRESPONSIVE:
@@ -275,13 +570,225 @@ WPIRBMain(
         }
     }
 
+    if (timedProgram != NULL)
+    {
+        WriteLoopStatistics(*timedProgram);
+    }
+
+    SessionRecorder::SetInstance(NULL);
+
     delete robot;
     delete inputBuffer;
     delete outputBuffer;
 
+    inputPort.close();
+    outputPort.close();
+
     return (errorCount >= MAX_ERROR_COUNT);
 }
 
+int
+WPIRBStationMain(
+        int             argc,
+        char**          argv,
+        ProgramFactory  createProgram
+        )
+{
+    std::vector<SerialPort*> ports;
+    std::vector<frc::IterativeRobot*> programs;
+    std::vector<InputDescriptorBuffer*> inputBuffers;
+    std::vector<OutputDescriptorBuffer*> outputBuffers;
+    std::vector<RedBot*> robots;
+
+    argp_parse(
+            &parserConfig,
+            argc,
+            argv,
+            0,
+            NULL,
+            NULL
+            );
+
+    if (InputOutputDevicePaths.empty() == true)
+    {
+        std::cerr << "Error: no communication devices specified." << std::endl;
+        return 1;
+    }
+
+    std::cout << "Base station: connecting to driver station." << std::endl;
+
+    DriverStationClient driverStation;
+    if (driverStation.connect() == false)
+    {
+        return 1;
+    }
+
+    OutputCache::SetKeepAliveInterval(KeepAliveInterval);
+    BaseStation station(WorkerCount);
+
+    bool isOpen = true;
+    for(
+            std::vector<std::string>::const_iterator pathIter = InputOutputDevicePaths.begin();
+            pathIter != InputOutputDevicePaths.end();
+            ++pathIter
+       )
+    {
+        SerialPort* port = new SerialPort();
+        ports.push_back(port);
+
+        if (port->open(pathIter->c_str(), O_RDWR, BaudRate, LatencyTimer) == false)
+        {
+            isOpen = false;
+            break;
+        }
+
+        // Components register with the program they are built for
+        std::cout << "Base station: initializing program for " << *pathIter << "." << std::endl;
+        frc::IterativeRobot* program = createProgram();
+        programs.push_back(program);
+        program->RobotInit();
+
+        InputDescriptorBuffer* inputBuffer = new InputDescriptorBuffer(
+                port->getDescriptor(),
+                ExchangeTimeout
+                );
+        inputBuffers.push_back(inputBuffer);
+
+        OutputDescriptorBuffer* outputBuffer = new OutputDescriptorBuffer(
+                port->getDescriptor(),
+                ExchangeTimeout
+                );
+        outputBuffers.push_back(outputBuffer);
+
+        RedBot* robot = new RedBot(
+                program,
+                inputBuffer,
+                outputBuffer,
+                new RedBotPacketGenerator()
+                );
+        robots.push_back(robot);
+        ConfigureRobot(*robot, robots.size() - 1);
+
+        // Programs with a fixed period start each cycle on its deadline
+        frc::TimedRobot* timedProgram = dynamic_cast<frc::TimedRobot*>(program);
+        station.addRobot(
+                robot,
+                (timedProgram != NULL) ? timedProgram->GetPeriod() : 0.0
+                );
+    }
+
+    if (isOpen == true)
+    {
+        std::cout << "Base station: running " << robots.size() << " robots on "
+            << WorkerCount << " workers." << std::endl;
+        station.start();
+
+        // Mode changes are pushed by the driver station in the background and
+        // taken up by each robot before its next cycle
+        while (station.getActiveRobotCount() > 0)
+        {
+            if (driverStation.isConnected() == false)
+            {
+                std::cerr << "Error: lost connection to driver station." << std::endl;
+                break;
+            }
+
+            station.setMode(driverStation.getMode());
+            usleep(DRIVER_STATION_POLL_USEC);
+        }
+
+        station.stop();
+
+        for(
+                size_t robotIdx = 0;
+                robotIdx < robots.size();
+                ++robotIdx
+           )
+        {
+            std::cout << "Base station: " << InputOutputDevicePaths[robotIdx] << ": "
+                << station.getCycleCount(robotIdx) << " cycles, "
+                << station.getOverrunCount(robotIdx) << " overruns"
+                << (station.isRetired(robotIdx) ? ", retired." : ".") << std::endl;
+        }
+
+        std::cout << "Base station: " << station.getTotalCycleCount() << " cycles, "
+            << station.getThroughput() << " cycles per second." << std::endl;
+    }
+
+    // Robots go before the programs and links they use
+    int status = ((isOpen == false) || (station.getActiveRobotCount() < robots.size()));
+    for(
+            size_t robotIdx = 0;
+            robotIdx < robots.size();
+            ++robotIdx
+       )
+    {
+        delete robots[robotIdx];
+        delete inputBuffers[robotIdx];
+        delete outputBuffers[robotIdx];
+    }
+
+    for(
+            size_t programIdx = 0;
+            programIdx < programs.size();
+            ++programIdx
+       )
+    {
+        delete programs[programIdx];
+    }
+
+    for(
+            size_t portIdx = 0;
+            portIdx < ports.size();
+            ++portIdx
+       )
+    {
+        ports[portIdx]->close();
+        delete ports[portIdx];
+    }
+
+    return status;
+}
+
+void
+ConfigureRobot(
+        RedBot& robot,
+        size_t  robotIdx
+        )
+{
+    robot.setPipelineWindow(PipelineWindow);
+    robot.setFrameBatching(IsFrameBatching);
+    robot.setLinkBudget(LinkBudget);
+    robot.setMaxProtocolVersion(MaxProtocolVersion);
+    robot.setChecksumType(ChecksumType);
+    robot.setMaxRetries(MaxRetries);
+    robot.setThreadedIO(IsThreadedIO);
+
+    if (TraceFilePath.empty() == false)
+    {
+        robot.setTraceFile(GetRobotFilePath(TraceFilePath, robotIdx).c_str());
+    }
+
+    if (FaultTraceFilePath.empty() == false)
+    {
+        robot.setFaultTraceFile(GetRobotFilePath(FaultTraceFilePath, robotIdx).c_str());
+    }
+}
+
+std::string
+GetRobotFilePath(
+        const std::string&  path,
+        size_t              robotIdx
+        )
+{
+    if (InputOutputDevicePaths.size() <= 1)
+    {
+        return path;
+    }
+
+    return path + "." + std::to_string(robotIdx);
+}
+
 error_t
 ArgumentParser(
         int                 key,
@@ -294,7 +801,7 @@ ArgumentParser(
     switch (key)
     {
         case 'd':
-            InputOutputDevicePath = arg;
+            InputOutputDevicePaths.push_back(arg);
             break;
 
         case 'i':
@@ -305,6 +812,143 @@ ArgumentParser(
             OutputDevicePath = arg;
             break;
 
+        case 'w':
+            PipelineWindow = strtoul(arg, NULL, 10);
+            break;
+
+        case 'b':
+            IsFrameBatching = true;
+            break;
+
+        case 't':
+            ExchangeTimeout = strtoul(arg, NULL, 10);
+            break;
+
+        case 'k':
+            KeepAliveInterval = strtoul(arg, NULL, 10);
+            break;
+
+        case 'l':
+            LinkBudget = strtoul(arg, NULL, 10);
+            break;
+
+        case 'p':
+            MaxProtocolVersion = strtoul(arg, NULL, 10);
+            break;
+
+        case 'c':
+            if (strcmp(arg, "none") == 0)
+            {
+                ChecksumType = Crc::TYPE_NONE;
+            }
+            else if (strcmp(arg, "crc8") == 0)
+            {
+                ChecksumType = Crc::TYPE_CRC8;
+            }
+            else if (strcmp(arg, "crc16") == 0)
+            {
+                ChecksumType = Crc::TYPE_CRC16;
+            }
+            else
+            {
+                argp_error(state, "unknown checksum type %s", arg);
+            }
+            break;
+
+        case 'R':
+            MaxRetries = strtoul(arg, NULL, 10);
+            break;
+
+        case 'T':
+            IsThreadedIO = true;
+            break;
+
+        case 'r':
+            BaudRate = strtoul(arg, NULL, 10);
+            if (SerialPort::IsSupportedBaudRate(BaudRate) == false)
+            {
+                argp_error(state, "unsupported baud rate %s", arg);
+            }
+            break;
+
+        case 'L':
+            LatencyTimer = strtoul(arg, NULL, 10);
+            break;
+
+        case 'W':
+            WorkerCount = strtoul(arg, NULL, 10);
+            if (WorkerCount == 0)
+            {
+                argp_error(state, "at least one worker is needed");
+            }
+            break;
+
+        case 's':
+            SimulationTime = strtod(arg, NULL);
+            if (SimulationTime <= 0.0)
+            {
+                argp_error(state, "simulated time must be positive");
+            }
+            break;
+
+        case 'x':
+            TraceFilePath = arg;
+            break;
+
+        case 'X':
+            FaultTraceFilePath = arg;
+            break;
+
+        case 'e':
+            RecordFilePath = arg;
+            break;
+
+        case 'y':
+            ReplayFilePath = arg;
+            break;
+
+        case 'm':
+            if (strcmp(arg, "disabled") == 0)
+            {
+                SimulationMode = FieldControlSystem::MODE_DISABLED;
+            }
+            else if (strcmp(arg, "auto") == 0)
+            {
+                SimulationMode = FieldControlSystem::MODE_AUTO;
+            }
+            else if (strcmp(arg, "teleop") == 0)
+            {
+                SimulationMode = FieldControlSystem::MODE_TELEOP;
+            }
+            else if (strcmp(arg, "test") == 0)
+            {
+                SimulationMode = FieldControlSystem::MODE_TEST;
+            }
+            else
+            {
+                argp_error(state, "unknown mode %s", arg);
+            }
+            break;
+
+        case 'g':
+            if (strcmp(arg, "off") == 0)
+            {
+                Diagnostics::SetLevel(Diagnostics::LEVEL_OFF);
+            }
+            else if (strcmp(arg, "errors") == 0)
+            {
+                Diagnostics::SetLevel(Diagnostics::LEVEL_ERRORS);
+            }
+            else if (strcmp(arg, "full") == 0)
+            {
+                Diagnostics::SetLevel(Diagnostics::LEVEL_FULL);
+            }
+            else
+            {
+                argp_error(state, "unknown diagnostics level %s", arg);
+            }
+            break;
+
         default:
             status = ARGP_ERR_UNKNOWN;
             break;
@@ -314,65 +958,215 @@ ArgumentParser(
 }
 
 int
-ConnectToDriverStation()
+RunSimulation(
+        frc::IterativeRobot& program
+        )
 {
-    int socketFD = socket(AF_INET, SOCK_STREAM, 0);
-    if (socketFD < 0)
-    {
-        error(0, errno, "Could not open socket file");
-        return -1;
-    }
-
-    struct addrinfo getAddrHints;
-    getAddrHints.ai_flags = 0;
-    getAddrHints.ai_family = AF_INET;
-    getAddrHints.ai_socktype = SOCK_STREAM;
-    getAddrHints.ai_protocol = 0;
-    getAddrHints.ai_addrlen = 0;
-    getAddrHints.ai_addr = NULL;
-    getAddrHints.ai_canonname = NULL;
-    getAddrHints.ai_next = NULL;
-
-    struct addrinfo* getAddrResults;
-
-    int getAddrRetVal = getaddrinfo(
-            "localhost",
-            "9999",
-            &getAddrHints,
-            &getAddrResults
+    FirmwareSimulator simulator;
+    InputSimulatorBuffer inputBuffer(simulator);
+    OutputSimulatorBuffer outputBuffer(simulator);
+
+    // Everything that keeps time follows the simulated robot, which moves on
+    // whenever the program waits
+    SimulatedClock simulatedClock(simulator);
+    Clock::SetInstance(&simulatedClock);
+
+    std::cout << "Program: initializing program." << std::endl;
+    program.RobotInit();
+
+    RedBot robot(
+            &program,
+            &inputBuffer,
+            &outputBuffer,
+            new RedBotPacketGenerator()
             );
-    if (getAddrRetVal != 0)
+
+    OutputCache::SetKeepAliveInterval(KeepAliveInterval);
+    ConfigureRobot(robot, 0);
+
+    // Packets are exchanged as soon as they are sent, so there is no latency
+    // for an I/O thread to hide
+    robot.setThreadedIO(false);
+
+    // Cycles start one period apart in virtual time
+    frc::TimedRobot* timedProgram = dynamic_cast<frc::TimedRobot*>(&program);
+    double period =
+        (timedProgram != NULL) ? timedProgram->GetPeriod() : frc::TimedRobot::DEFAULT_PERIOD;
+    long long periodTime = llround(period * Clock::NSEC_PER_SEC);
+    unsigned long cycleCount = (unsigned long)ceil(SimulationTime / period);
+
+    MonotonicClock realClock;
+    long long startTime = realClock.getTime();
+
+    robot.modeInit(SimulationMode);
+    std::cout << "Program: beginning simulated loop." << std::endl;
+    unsigned long cycleIdx = 0;
+    for(
+            ;
+            cycleIdx < cycleCount;
+            ++cycleIdx
+       )
     {
-        std::cerr << "Error: could not get address information." << std::endl;
-        return -1;
+        if (timedProgram != NULL)
+        {
+            timedProgram->WaitForNextCycle();
+        }
+        else
+        {
+            simulatedClock.sleepUntil(cycleIdx * periodTime);
+        }
+
+        robot.modePeriodic(SimulationMode);
+
+        if (robot.getStatus() != RedBot::STATUS_GOOD)
+        {
+            std::cerr << "Error: simulated robot failed with status "
+                << robot.getStatus() << "." << std::endl;
+            break;
+        }
     }
 
-    bool isConnected = false;
+    // The last cycle lasts its full period
+    simulatedClock.sleepUntil(cycleIdx * periodTime);
+
+    double realTime = 1e-9 * (realClock.getTime() - startTime);
+    double virtualTime = 1e-9 * simulatedClock.getTime();
+
+    if (timedProgram != NULL)
+    {
+        WriteLoopStatistics(*timedProgram);
+    }
+
+    const SimulatedHardware& hardware = simulator.getHardware();
+    std::cout << "Simulation: " << cycleIdx << " cycles, "
+        << virtualTime << " s simulated in " << realTime << " s";
+    if (realTime > 0.0)
+    {
+        std::cout << " (" << (virtualTime / realTime) << " times real time)";
+    }
+    std::cout << "." << std::endl;
+
+    std::cout << "Simulation: encoders "
+        << hardware.getEncoderTicks(SimulatedHardware::WHEEL_LEFT) << "/"
+        << hardware.getEncoderTicks(SimulatedHardware::WHEEL_RIGHT) << " ticks, position ("
+        << hardware.getX() << ", " << hardware.getY() << ") ft, heading "
+        << (hardware.getHeading() * 180.0 / M_PI) << " degrees." << std::endl;
+
+    Clock::SetInstance(NULL);
+
+    return (cycleIdx < cycleCount);
+}
+
+int
+RunReplay(
+        frc::IterativeRobot& program
+        )
+{
+    SessionPlayer player;
+    if (player.load(ReplayFilePath.c_str()) == false)
+    {
+        return 1;
+    }
+
+    const std::vector<SessionPlayer::Cycle>& cycles = player.getCycles();
+    InputReplayBuffer inputBuffer(player);
+    OutputReplayBuffer outputBuffer;
+
+    // Everything that keeps time sees the time each cycle was recorded at,
+    // and nothing waits
+    ManualClock replayClock;
+    Clock::SetInstance(&replayClock);
+
+    std::cout << "Program: initializing program." << std::endl;
+    program.RobotInit();
+
+    RedBot robot(
+            &program,
+            &inputBuffer,
+            &outputBuffer,
+            new RedBotPacketGenerator()
+            );
+
+    OutputCache::SetKeepAliveInterval(KeepAliveInterval);
+    ConfigureRobot(robot, 0);
+
+    // Recorded packets are read as soon as they are asked for, and handed
+    // to the program on the cycle after, as the I/O thread would
+    robot.setThreadedIO(false);
+
+    SessionPlayer::SetInstance(&player);
+
+    MonotonicClock realClock;
+    LatencyHistogram cycleTimes;
+    long long startTime = realClock.getTime();
+
+    FieldControlSystem::Mode robotMode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(robotMode);
+    std::cout << "Program: beginning replayed loop." << std::endl;
     for(
-            struct addrinfo* addrInfoIter = getAddrResults;
-            addrInfoIter != NULL;
-            addrInfoIter = addrInfoIter->ai_next
+            std::vector<SessionPlayer::Cycle>::const_iterator cycleIter = cycles.begin();
+            cycleIter != cycles.end();
+            ++cycleIter
        )
     {
-        int connectRetVal = connect(
-                socketFD,
-                addrInfoIter->ai_addr,
-                addrInfoIter->ai_addrlen
-                );
-        if (connectRetVal == 0)
+        replayClock.setTime(cycleIter->time);
+
+        if (cycleIter->mode != robotMode)
         {
-            isConnected = true;
-            break;
+            robot.modeInit(cycleIter->mode);
+            robotMode = cycleIter->mode;
         }
+
+        long long cycleStartTime = realClock.getTime();
+        robot.modePeriodic(robotMode);
+        cycleTimes.add(1e-9 * (realClock.getTime() - cycleStartTime));
+
+        // Recovery reads what it read when recorded
+        switch (robot.getStatus())
+        {
+            case RedBot::STATUS_INCOHERENT:
+                robot.recover();
+                break;
+
+            case RedBot::STATUS_UNRESPONSIVE:
+                robot.resync();
+                break;
+
+            default:
+                break;
+        };
     }
-    freeaddrinfo(getAddrResults);
-    if (isConnected == false)
+
+    double realTime = 1e-9 * (realClock.getTime() - startTime);
+    double recordedTime =
+        (cycles.empty() == false) ? (1e-9 * (cycles.back().time - cycles.front().time)) : 0.0;
+
+    std::cout << "Replay: " << cycles.size() << " cycles, "
+        << recordedTime << " s recorded replayed in " << realTime << " s";
+    if (realTime > 0.0)
     {
-        std::cerr << "Error: could not connect to driver station." << std::endl;
-        return -1;
+        std::cout << " (" << (recordedTime / realTime) << " times real time)";
     }
-    
-    return socketFD;
+    std::cout << "." << std::endl;
+
+    if (cycleTimes.getCount() > 0)
+    {
+        std::cout << "Replay: cycle time mean "
+            << (1e3 * cycleTimes.getMean()) << " ms, 99th percentile "
+            << (1e3 * cycleTimes.getPercentile(99.0)) << " ms, max "
+            << (1e3 * cycleTimes.getMax()) << " ms." << std::endl;
+    }
+
+    if (player.getMismatchCount() > 0)
+    {
+        std::cerr << "Error: program diverged from the recorded session on "
+            << player.getMismatchCount() << " readings." << std::endl;
+    }
+
+    SessionPlayer::SetInstance(NULL);
+    Clock::SetInstance(NULL);
+
+    return (player.getMismatchCount() > 0);
 }
 
 void
@@ -380,25 +1174,79 @@ WriteIncoherentMessage(
         const RedBot& robot
         )
 {
-    std::list<std::string> lastRequestPackets;
-    std::list<std::string> lastResponsePackets;
+    // Find the latest received frame still in the trace
+    const TraceRing& trace = robot.getTrace();
+    uint64_t recordCount = trace.getRecordCount();
+    uint64_t oldestRecordIdx =
+        (recordCount > trace.getCapacity()) ? (recordCount - trace.getCapacity()) : 0;
 
-    robot.getLastBinaryTransaction(
-            lastRequestPackets,
-            lastResponsePackets
-            );
-    const std::string& invalidPacket = lastResponsePackets.back();
+    TraceRing::Record record;
+    bool isFound = false;
+    for(
+            uint64_t recordIdx = recordCount;
+            (recordIdx > oldestRecordIdx) && (isFound == false);
+            --recordIdx
+       )
+    {
+        isFound = (
+                (trace.getRecord(recordIdx - 1, record) == true) &&
+                (record.direction == TraceRing::DIRECTION_RECEIVED)
+                );
+    }
 
     std::cerr << "Error: invalid packet received: ";
 
     for(
-            size_t charIdx = 0;
-            charIdx < invalidPacket.length();
-            ++charIdx
+            size_t byteIdx = 0;
+            (isFound == true) && (byteIdx < record.getDataSize());
+            ++byteIdx
        )
     {
-        std::cerr << std::hex << "0x" << (0xFF & (unsigned int)invalidPacket[0]) << ' ';
+        std::cerr << std::hex << "0x" << (0xFF & (unsigned int)record.data[byteIdx]) << ' ';
+    }
+
+    std::cerr << std::dec << std::endl;
+}
+
+void
+WriteLoopStatistics(
+        const frc::TimedRobot& program
+        )
+{
+    const LatencyHistogram& executionTimes = program.GetExecutionTimes();
+    const LatencyHistogram& jitters = program.GetJitters();
+
+    std::cout << "Program: " << program.GetCycleCount() << " cycles of "
+        << (1e3 * program.GetPeriod()) << " ms, "
+        << program.GetOverrunCount() << " overruns." << std::endl;
+
+    if (executionTimes.getCount() > 0)
+    {
+        std::cout << "Program: execution time mean "
+            << (1e3 * executionTimes.getMean()) << " ms, 99th percentile "
+            << (1e3 * executionTimes.getPercentile(99.0)) << " ms, max "
+            << (1e3 * executionTimes.getMax()) << " ms." << std::endl;
     }
 
-    std::cerr << std::endl;
+    if (jitters.getCount() > 0)
+    {
+        std::cout << "Program: jitter mean "
+            << (1e3 * jitters.getMean()) << " ms, 99th percentile "
+            << (1e3 * jitters.getPercentile(99.0)) << " ms, max "
+            << (1e3 * jitters.getMax()) << " ms." << std::endl;
+    }
+
+    // Programs without commands never created a scheduler
+    frc::Scheduler* scheduler = frc::Scheduler::GetExistingInstance();
+    if(
+            (scheduler != NULL) &&
+            (scheduler->GetRunTimes().getCount() > 0)
+      )
+    {
+        const LatencyHistogram& runTimes = scheduler->GetRunTimes();
+        std::cout << "Scheduler: run time mean "
+            << (1e3 * runTimes.getMean()) << " ms, 99th percentile "
+            << (1e3 * runTimes.getPercentile(99.0)) << " ms, max "
+            << (1e3 * runTimes.getMax()) << " ms." << std::endl;
+    }
 }
@@ -16,4 +16,22 @@ WPIRBMain(
         frc::IterativeRobot& program /**< Robot program to run */
         );
 
+/**
+ * Function creating a new robot program
+ */
+typedef frc::IterativeRobot* (*ProgramFactory)();
+
+/**
+ * WPIRB base-station entry point
+ *
+ * This drives one robot per serial device given, each with its own program
+ * created by the given function, from a single process.
+ */
+int
+WPIRBStationMain(
+        int             argc,
+        char**          argv,
+        ProgramFactory  createProgram /**< Creates each robot's program */
+        );
+
 #endif /* ifndef MAIN_H */
@@ -2,9 +2,14 @@
 #include "RedBot.h"
 #include "IterativeRobot.h"
 #include "Packet.h"
+#include "Cobs.h"
+#include "SessionLog.h"
+#include "Diagnostics.h"
 #include "Component.h"
 #include <sstream>
 #include <algorithm>
+#include <iterator>
+#include <utility>
 
 #include <unistd.h>
 #include <fcntl.h>
@@ -15,33 +20,51 @@
 RedBot::RedBot(
         frc::IterativeRobot*     program,
         const char*         deviceName,
-        PacketGenerator*    packetGen
+        PacketGenerator*    packetGen,
+        unsigned long       baudRate
         ) :
     myProgram(program),
     myStatus(STATUS_DISCONNECTED),
+    myPipelineWindow(1),
+    myIsFrameBatching(false),
+    myLinkBudget(0),
+    myMaxProtocolVersion(Packet::PROTOCOL_BOUNDED),
+    myProtocolVersion(Packet::PROTOCOL_BOUNDED),
+    myIsProtocolNegotiated(false),
+    myChecksumType(Crc::TYPE_NONE),
+    myActiveChecksumType(Crc::TYPE_NONE),
+    myMaxRetries(OUR_DEFAULT_MAX_RETRIES),
+    myRetransmitCount(0),
+    myTransferCount(0),
     myIsUsingExternalBuffers(false),
     myDevice(NULL),
     myInputBuffer(NULL),
     myOutputBuffer(NULL),
+    myIsIOStopRequested(false),
+    myIsTransferRequested(false),
+    myIsResyncRequested(false),
+    myIsRecoverRequested(false),
+    myTrace(),
+    myTransactionStart(0),
+    myFaultTracePath(),
+    myRecorder(NULL),
     myPacketGenerator(packetGen)
 {
-    // Move all newly registered components to my own collection
-    myComponents = Component::GetRegisteredComponents();
-    Component::ClearRegisteredComponents();
+    // Use the components registered with the program
+    myComponents = program->GetRobotContext().getComponents();
+    buildRoutingTable();
+    buildSchedule();
 
     if (deviceName != NULL)
     {
         // Open device
-
-        myDevice = fopen(deviceName, "r+");
-        if (myDevice == NULL)
+        if (mySerialPort.open(deviceName, O_RDWR, baudRate) == false)
         {
-            error(0, errno, "Could not open %s", deviceName);
             return;
         }
 
-        myInputBuffer = new InputFileBuffer(myDevice);
-        myOutputBuffer = new OutputFileBuffer(myDevice);
+        myInputBuffer = new InputDescriptorBuffer(mySerialPort.getDescriptor());
+        myOutputBuffer = new OutputDescriptorBuffer(mySerialPort.getDescriptor());
         myStatus = STATUS_GOOD;
     }
 }
@@ -53,15 +76,35 @@ RedBot::RedBot(
         ) :
     myProgram(program),
     myStatus(STATUS_GOOD),
+    myPipelineWindow(1),
+    myIsFrameBatching(false),
+    myLinkBudget(0),
+    myMaxProtocolVersion(Packet::PROTOCOL_BOUNDED),
+    myProtocolVersion(Packet::PROTOCOL_BOUNDED),
+    myIsProtocolNegotiated(false),
+    myChecksumType(Crc::TYPE_NONE),
+    myActiveChecksumType(Crc::TYPE_NONE),
+    myMaxRetries(OUR_DEFAULT_MAX_RETRIES),
+    myRetransmitCount(0),
+    myTransferCount(0),
     myIsUsingExternalBuffers(false),
     myDevice(device),
     myInputBuffer(new InputFileBuffer(device)),
     myOutputBuffer(new OutputFileBuffer(device)),
+    myIsIOStopRequested(false),
+    myIsTransferRequested(false),
+    myIsResyncRequested(false),
+    myIsRecoverRequested(false),
+    myTrace(),
+    myTransactionStart(0),
+    myFaultTracePath(),
+    myRecorder(NULL),
     myPacketGenerator(packetGen)
 {
-    // Move all newly registered components to my own collection
-    myComponents = Component::GetRegisteredComponents();
-    Component::ClearRegisteredComponents();
+    // Use the components registered with the program
+    myComponents = program->GetRobotContext().getComponents();
+    buildRoutingTable();
+    buildSchedule();
 }
 
 RedBot::RedBot(
@@ -72,19 +115,41 @@ RedBot::RedBot(
         ) :
     myProgram(program),
     myStatus(STATUS_GOOD),
+    myPipelineWindow(1),
+    myIsFrameBatching(false),
+    myLinkBudget(0),
+    myMaxProtocolVersion(Packet::PROTOCOL_BOUNDED),
+    myProtocolVersion(Packet::PROTOCOL_BOUNDED),
+    myIsProtocolNegotiated(false),
+    myChecksumType(Crc::TYPE_NONE),
+    myActiveChecksumType(Crc::TYPE_NONE),
+    myMaxRetries(OUR_DEFAULT_MAX_RETRIES),
+    myRetransmitCount(0),
+    myTransferCount(0),
     myIsUsingExternalBuffers(true),
     myDevice(NULL),
     myInputBuffer(inputBuffer),
     myOutputBuffer(outputBuffer),
+    myIsIOStopRequested(false),
+    myIsTransferRequested(false),
+    myIsResyncRequested(false),
+    myIsRecoverRequested(false),
+    myTrace(),
+    myTransactionStart(0),
+    myFaultTracePath(),
+    myRecorder(NULL),
     myPacketGenerator(packetGen)
 {
-    // Move all newly registered components to my own collection
-    myComponents = Component::GetRegisteredComponents();
-    Component::ClearRegisteredComponents();
+    // Use the components registered with the program
+    myComponents = program->GetRobotContext().getComponents();
+    buildRoutingTable();
+    buildSchedule();
 }
 
 RedBot::~RedBot()
 {
+    setThreadedIO(false);
+
     // Close the serial device
     if (myDevice != NULL)
     {
@@ -92,11 +157,7 @@ RedBot::~RedBot()
     }
 
     // Discard the unused incoming packets
-    while (myIncomingPackets.empty() == false)
-    {
-        delete (myIncomingPackets.front());
-        myIncomingPackets.pop();
-    }
+    myIncomingPackets.clear();
 
     if (myIsUsingExternalBuffers == false)
     {
@@ -157,26 +218,18 @@ RedBot::modePeriodic(
     }
 
     // Process incoming packets
-    while (myIncomingPackets.empty() == false)
+    if (myIOThread.joinable() == true)
     {
-        Packet* packet = myIncomingPackets.front();
-        myIncomingPackets.pop();
-
-        for(
-                Components::const_iterator compIter = myComponents.begin();
-                compIter != myComponents.end();
-                ++compIter
-           )
         {
-            Component* component = *compIter;
-
-            if (component->processPacket(*packet) == true)
-            {
-                break;
-            }
+            std::lock_guard<std::mutex> lock(myIOMutex);
+            myCyclePackets.swap(myReceivedPackets);
         }
 
-        delete packet;
+        dispatchPackets(myCyclePackets);
+    }
+    else
+    {
+        dispatchPackets(myIncomingPackets);
     }
 
     // Run user's periodic function
@@ -202,57 +255,114 @@ RedBot::modePeriodic(
             break;
     };
 
+    myProgram->RobotPeriodic();
+
     // Exchange data with the robot
-    transferData();
+    if (myIOThread.joinable() == false)
+    {
+        transferData();
+        ++myTransferCount;
+        return;
+    }
+
+    // Components are only polled once the thread has taken the last batch.
+    // Until then their outputs keep replacing their own requests, so only the
+    // latest command is sent and requests do not pile up behind a slow link.
+    bool isTransferPending = false;
+    {
+        std::lock_guard<std::mutex> lock(myIOMutex);
+        isTransferPending = myIsTransferRequested;
+    }
+
+    if (isTransferPending == false)
+    {
+        collectPackets(myCyclePackets);
+    }
+
+    // Queue the requests for the I/O thread
+    {
+        std::lock_guard<std::mutex> lock(myIOMutex);
+
+        while (myCyclePackets.empty() == false)
+        {
+            myPendingPackets.push(myCyclePackets.pop());
+        }
+        myIsTransferRequested = true;
+    }
+    myIOCondition.notify_one();
 }
 
 void
-RedBot::transferData()
+RedBot::buildRoutingTable()
 {
-    if(
-            (myInputBuffer == NULL) ||
-            (myOutputBuffer == NULL)
-      )
-    {
-        return;
-    }
+    std::vector<RoutingKey> keys;
 
-    Packet* pingPacket = myPacketGenerator->createPingPacket();
+    myRoutingTable.clear();
 
-    // Confirm connectivity to robot
-    unsigned int initialPingCount = 0;
-    do
+    for(
+            Components::const_iterator compIter = myComponents.begin();
+            compIter != myComponents.end();
+            ++compIter
+       )
     {
-        Packet* inPacket;
+        Component* component = *compIter;
 
-        exchangePackets(
-                pingPacket,
-                inPacket
-                );
+        keys.clear();
+        component->getRoutingKeys(keys);
 
-        if (inPacket != NULL)
+        for(
+                std::vector<RoutingKey>::const_iterator keyIter = keys.begin();
+                keyIter != keys.end();
+                ++keyIter
+           )
         {
-            myIncomingPackets.push(inPacket);
+            // Earlier components keep keys that are claimed twice
+            myRoutingTable.insert(std::make_pair(*keyIter, component));
         }
     }
-    while(
-            (myStatus != STATUS_GOOD) &&
-            ((++initialPingCount) < 5)
-         );
+}
 
-    delete pingPacket;
+void
+RedBot::buildSchedule()
+{
+    mySchedule.clear();
 
-    if (initialPingCount >= 5)
+    for(
+            Components::const_iterator compIter = myComponents.begin();
+            compIter != myComponents.end();
+            ++compIter
+       )
     {
-        return;
+        ScheduleEntry entry;
+        entry.component = *compIter;
+        entry.deferredCycles = 0;
+
+        mySchedule.push_back(entry);
     }
+}
 
-    std::queue<Packet*> outgoingPackets;
+void
+RedBot::dispatchPacket(
+        const Packet& packet
+        )
+{
+    RoutingKey key;
+    Component* owner = NULL;
 
-    myLastTransactionSentData.clear();
-    myLastTransactionReceivedData.clear();
+    if (packet.getRoutingKey(key) == true)
+    {
+        std::unordered_map<RoutingKey, Component*>::const_iterator routeIter =
+            myRoutingTable.find(key);
+        if (routeIter != myRoutingTable.end())
+        {
+            owner = routeIter->second;
+            if (owner->processPacket(packet) == true)
+            {
+                return;
+            }
+        }
+    }
 
-    // Collect outgoing packets from components
     for(
             Components::const_iterator compIter = myComponents.begin();
             compIter != myComponents.end();
@@ -261,139 +371,1075 @@ RedBot::transferData()
     {
         Component* component = *compIter;
 
-        for(
-                size_t packetCount = 0;
-                packetCount < 10;
-                ++packetCount
-           )
+        if(
+                (component != owner) &&
+                (component->processPacket(packet) == true)
+          )
+        {
+            break;
+        }
+    }
+}
+
+void
+RedBot::dispatchPackets(
+        PacketQueue& packets
+        )
+{
+    while (packets.empty() == false)
+    {
+        PacketHandle packet = packets.pop();
+
+        dispatchPacket(*packet);
+    }
+}
+
+void
+RedBot::transferData()
+{
+    if (startTransfer() == false)
+    {
+        return;
+    }
+
+    collectPackets(myOutgoingPackets);
+    exchangeOutgoingPackets(myOutgoingPackets);
+}
+
+bool
+RedBot::startTransfer()
+{
+    if(
+            (myInputBuffer == NULL) ||
+            (myOutputBuffer == NULL)
+      )
+    {
+        return false;
+    }
+
+    if(
+            (myIsProtocolNegotiated == false) &&
+            (negotiateProtocol() == false)
+      )
+    {
+        return false;
+    }
+
+    if (myIsFrameBatching == false)
+    {
+        PacketHandle pingPacket = myPacketGenerator->createPingPacket();
+
+        // Confirm connectivity to robot
+        unsigned int initialPingCount = 0;
+        do
         {
-            Packet* outPacket = component->getNextPacket();
-            if (outPacket == NULL)
+            PacketHandle inPacket;
+
+            exchangePackets(
+                    pingPacket.get(),
+                    inPacket
+                    );
+
+            if (inPacket.isNull() == false)
             {
-                break;
+                queueIncomingPacket(std::move(inPacket));
             }
+        }
+        while(
+                (myStatus != STATUS_GOOD) &&
+                ((++initialPingCount) < 5)
+             );
 
-            outgoingPackets.push(outPacket);
+        if (initialPingCount >= 5)
+        {
+            return false;
         }
     }
 
-    // Send outgoing packets
-    while (outgoingPackets.empty() == false)
+    return true;
+}
+
+void
+RedBot::exchangeOutgoingPackets(
+        PacketQueue& outgoingPackets
+        )
+{
+    myTransactionStart = myTrace.getRecordCount();
+
+    size_t windowSize = myPipelineWindow;
+    if (myIsFrameBatching == true)
+    {
+        batchPackets(outgoingPackets);
+        windowSize = 1;
+    }
+
+    // Send outgoing packets, keeping up to a window's worth of requests
+    // outstanding. Responses arrive in the order requests were sent. The
+    // window is clamped to the size of this ring, so it never fills up.
+    PendingRequest pendingRequests[OUR_MAX_PIPELINE_WINDOW];
+    size_t pendingFront = 0;
+    size_t pendingCount = 0;
+    while(
+            (outgoingPackets.empty() == false) ||
+            (pendingCount > 0)
+         )
     {
-        Packet* outPacket = outgoingPackets.front();
-        Packet* inPacket = NULL;
+        if(
+                (outgoingPackets.empty() == false) &&
+                (pendingCount < windowSize)
+          )
+        {
+            PendingRequest& request = pendingRequests[
+                (pendingFront + pendingCount) % OUR_MAX_PIPELINE_WINDOW
+                ];
+            request.packet = outgoingPackets.pop();
+            request.retryCount = 0;
+
+            // A request that could not be sent gets no response
+            if (sendPacket(request.packet.get()) == true)
+            {
+                ++pendingCount;
+            }
+            continue;
+        }
 
-        outgoingPackets.pop();
+        PacketHandle inPacket;
 
-        exchangePackets(
-                outPacket,
-                inPacket
-                );
-        delete outPacket;
-        if (inPacket == NULL)
+        receivePacket(inPacket);
+
+        PendingRequest request = std::move(pendingRequests[pendingFront]);
+        pendingFront = (pendingFront + 1) % OUR_MAX_PIPELINE_WINDOW;
+        --pendingCount;
+        if (isRetryNeeded(request.retryCount) == true)
+        {
+            // Only the corrupted request is sent again, behind the requests
+            // that are already outstanding
+            ++request.retryCount;
+            ++myRetransmitCount;
+
+            if (sendPacket(request.packet.get()) == true)
+            {
+                pendingRequests[(pendingFront + pendingCount) % OUR_MAX_PIPELINE_WINDOW] =
+                    std::move(request);
+                ++pendingCount;
+            }
+            continue;
+        }
+
+        if (inPacket.isNull() == true)
         {
             continue;
         }
 
-        myIncomingPackets.push(inPacket);
+        // Responses to a frame arrive together in a single frame
+        queueIncomingPacket(std::move(inPacket));
+    }
+
+    // Frames are answered in full, so nothing is left to collect
+    if (myIsFrameBatching == true)
+    {
+        return;
     }
 
     // Continue pinging until no more incoming packets to process
-    pingPacket = myPacketGenerator->createPingPacket();
+    PacketHandle pingPacket = myPacketGenerator->createPingPacket();
     while (true)
     {
-        Packet* inPacket = NULL;
+        PacketHandle inPacket;
 
         exchangePackets(
-                pingPacket,
+                pingPacket.get(),
                 inPacket
                 );
-        if (inPacket == NULL)
+        if(
+                (inPacket.isNull() == true) ||
+                (inPacket->isAcknowledge() == true)
+          )
         {
             break;
         }
 
-        if (inPacket->isAcknowledge() == true)
+        // Pushed samples arrive in a frame in place of the acknowledgement
+        if (queueIncomingPacket(std::move(inPacket)) == true)
         {
-            delete inPacket;
             break;
         }
-        else
-        {
-            myIncomingPackets.push(inPacket);
-        }
     }
-    delete pingPacket;
 }
 
-void
-RedBot::exchangePackets(
-        Packet*     requestPacket,
-        Packet*&    responsePacket
+bool
+RedBot::queueIncomingPacket(
+        PacketHandle&& packet
         )
 {
-    std::ostringstream outgoingPacketStream;
-    std::string incomingPacketData;
+    if(
+            myPacketGenerator->unpackFramePacket(
+                *packet,
+                myIncomingPackets
+                ) == true
+      )
+    {
+        // The emptied frame is deleted along with its handle
+        packet.reset();
+        return true;
+    }
 
-    requestPacket->write(myOutputBuffer->getOutputStream());
-    myOutputBuffer->writePacket();
-    myOutputBuffer->clear();
+    myIncomingPackets.push(std::move(packet));
 
-    // Record sent data
-    outgoingPacketStream << *requestPacket;
-    myLastTransactionSentData.push_back(outgoingPacketStream.str());
+    return false;
+}
 
-    myInputBuffer->clear();
-    myInputBuffer->readPacket();
-    responsePacket = Packet::Read(
-            myInputBuffer->getInputStream(),
-            *myPacketGenerator,
-            &incomingPacketData // Record received data
-            );
+void
+RedBot::collectPackets(
+        PacketQueue& packets
+        )
+{
+    if (myLinkBudget == 0)
+    {
+        for(
+                Components::const_iterator compIter = myComponents.begin();
+                compIter != myComponents.end();
+                ++compIter
+           )
+        {
+            collectComponentPackets(**compIter, packets);
+        }
 
-    myLastTransactionReceivedData.push_back(incomingPacketData);
+        return;
+    }
 
-    // Decide on robot status
-    if (responsePacket == NULL)
+    // Order by priority, raised by the cycles spent waiting. Ties keep the
+    // order of the last cycle. This is an insertion sort so that the order is
+    // stable without allocating.
+    for(
+            size_t entryIdx = 1;
+            entryIdx < mySchedule.size();
+            ++entryIdx
+       )
     {
-        if (incomingPacketData.empty() == true)
+        ScheduleEntry entry = mySchedule[entryIdx];
+        unsigned int priority = entry.component->getPriority() + entry.deferredCycles;
+
+        size_t insertIdx = entryIdx;
+        while(
+                (insertIdx > 0) &&
+                ((mySchedule[insertIdx - 1].component->getPriority() +
+                  mySchedule[insertIdx - 1].deferredCycles) < priority)
+             )
         {
-            myStatus = STATUS_UNRESPONSIVE;
+            mySchedule[insertIdx] = mySchedule[insertIdx - 1];
+            --insertIdx;
         }
-        else
+
+        mySchedule[insertIdx] = entry;
+    }
+
+    size_t budgetUsed = 0;
+    for(
+            std::vector<ScheduleEntry>::iterator entryIter = mySchedule.begin();
+            entryIter != mySchedule.end();
+            ++entryIter
+       )
+    {
+        if (budgetUsed >= myLinkBudget)
         {
-            myStatus = STATUS_INCOHERENT;
+            ++entryIter->deferredCycles;
+            continue;
         }
+
+        entryIter->deferredCycles = 0;
+        budgetUsed += collectComponentPackets(*entryIter->component, packets);
     }
-    else
+}
+
+size_t
+RedBot::collectComponentPackets(
+        Component&      component,
+        PacketQueue&    packets
+        )
+{
+    unsigned char packetData[Packet::MAX_BINARY_SIZE];
+    size_t dataSize = 0;
+
+    for(
+            size_t packetCount = 0;
+            packetCount < 10;
+            ++packetCount
+       )
     {
-        myStatus = STATUS_GOOD;
+        PacketHandle outPacket = component.getNextPacket();
+        if (outPacket.isNull() == true)
+        {
+            break;
+        }
+
+        if (myLinkBudget > 0)
+        {
+            dataSize += encodePacket(*outPacket, packetData, sizeof(packetData));
+        }
+
+        packets.push(std::move(outPacket));
     }
+
+    return dataSize;
 }
 
-RedBot::Status
-RedBot::getStatus() const
+void
+RedBot::batchPackets(
+        PacketQueue& packets
+        )
 {
-    return myStatus;
+    do
+    {
+        PacketHandle framePacket = myPacketGenerator->createFramePacket(packets);
+        if (framePacket.isNull() == true)
+        {
+            if (packets.empty() == true)
+            {
+                break;
+            }
+
+            // Send unframeable packet on its own
+            framePacket = packets.pop();
+        }
+
+        myFramePackets.push(std::move(framePacket));
+    }
+    while (packets.empty() == false);
+
+    // The emptied queue is kept for the next batch
+    packets.swap(myFramePackets);
 }
 
 void
-RedBot::getLastBinaryTransaction(
-        std::list<std::string>& sentData,
-        std::list<std::string>& receivedData
+RedBot::exchangePackets(
+        const Packet*   requestPacket,
+        PacketHandle&   responsePacket
+        )
+{
+    responsePacket.reset();
+    if (sendPacket(requestPacket) == false)
+    {
+        return;
+    }
+    receivePacket(responsePacket);
+
+    unsigned int retryCount = 0;
+    while (isRetryNeeded(retryCount) == true)
+    {
+        ++retryCount;
+        ++myRetransmitCount;
+
+        if (sendPacket(requestPacket) == false)
+        {
+            return;
+        }
+        receivePacket(responsePacket);
+    }
+}
+
+bool
+RedBot::isRetryNeeded(
+        unsigned int retryCount
         ) const
 {
-    sentData = myLastTransactionSentData;
-    receivedData = myLastTransactionReceivedData;
+    // Without a checksum, incoherent data cannot be told from a loss of sync
+    return (
+            (myActiveChecksumType != Crc::TYPE_NONE) &&
+            (retryCount < myMaxRetries) &&
+            (myStatus == STATUS_INCOHERENT)
+           );
 }
 
-void
-RedBot::resync()
+bool
+RedBot::negotiateProtocol()
 {
-    // Send resync sequence
-    myOutputBuffer->resync();
+    PacketHandle versionPacket;
+    if (myMaxProtocolVersion != myProtocolVersion)
+    {
+        versionPacket = myPacketGenerator->createVersionPacket(myMaxProtocolVersion);
+    }
 
-    // Discard any incoming data
-    myInputBuffer->readPacket();
-    myInputBuffer->clear();
+    if (versionPacket.isNull() == false)
+    {
+        PacketHandle inPacket;
+        exchangePackets(versionPacket.get(), inPacket);
+
+        if (inPacket.isNull() == true)
+        {
+            return false;
+        }
+
+        // Robots that predate negotiation reply with an acknowledgement
+        unsigned int version = Packet::PROTOCOL_BOUNDED;
+        if(
+                (myPacketGenerator->getSelectedVersion(*inPacket, version) == false) ||
+                (version > myMaxProtocolVersion)
+          )
+        {
+            version = Packet::PROTOCOL_BOUNDED;
+        }
+        setProtocolVersion(version);
+    }
+
+    if (negotiateChecksum() == false)
+    {
+        return false;
+    }
+
+    myIsProtocolNegotiated = true;
+
+    return true;
+}
+
+bool
+RedBot::negotiateChecksum()
+{
+    PacketHandle checksumPacket;
+    if (myChecksumType != myActiveChecksumType)
+    {
+        checksumPacket = myPacketGenerator->createChecksumPacket(myChecksumType);
+    }
+
+    // Nothing to negotiate
+    if (checksumPacket.isNull() == true)
+    {
+        return true;
+    }
+
+    PacketHandle inPacket;
+    exchangePackets(checksumPacket.get(), inPacket);
+
+    if (inPacket.isNull() == true)
+    {
+        return false;
+    }
+
+    // Robots without checksums reply with an acknowledgement
+    Crc::Type checksum = Crc::TYPE_NONE;
+    if (myPacketGenerator->getSelectedChecksum(*inPacket, checksum) == false)
+    {
+        checksum = Crc::TYPE_NONE;
+    }
+    myActiveChecksumType = checksum;
+
+    return true;
+}
+
+void
+RedBot::setProtocolVersion(
+        unsigned int version
+        )
+{
+    myProtocolVersion = version;
+
+    if (myInputBuffer != NULL)
+    {
+        myInputBuffer->setFraming(
+                (version == Packet::PROTOCOL_COBS) ?
+                    InputBuffer::FRAMING_COBS : InputBuffer::FRAMING_BOUNDED
+                );
+    }
+}
+
+size_t
+RedBot::encodePacket(
+        const Packet&   packet,
+        unsigned char*  buffer,
+        size_t          bufferSize
+        ) const
+{
+    if (myProtocolVersion == Packet::PROTOCOL_COBS)
+    {
+        return packet.encodeCobs(buffer, bufferSize, myActiveChecksumType);
+    }
+
+    if (myActiveChecksumType != Crc::TYPE_NONE)
+    {
+        return packet.encodeChecked(buffer, bufferSize, myActiveChecksumType);
+    }
+
+    return packet.encode(buffer, bufferSize);
+}
+
+bool
+RedBot::sendPacket(
+        const Packet*   requestPacket
+        )
+{
+    unsigned char packetData[Packet::MAX_BINARY_SIZE];
+    size_t packetSize = encodePacket(*requestPacket, packetData, sizeof(packetData));
+
+    if(
+            (packetSize == 0) &&
+            (myProtocolVersion == Packet::PROTOCOL_BOUNDED) &&
+            (myActiveChecksumType == Crc::TYPE_NONE)
+      )
+    {
+        // Packet does not fit in memory, so fall back to the stream
+        std::ostringstream outgoingPacketStream;
+
+        requestPacket->write(myOutputBuffer->getOutputStream());
+        myOutputBuffer->writePacket();
+        myOutputBuffer->clear();
+
+        // Record sent data, which means writing the packet again
+        if (Diagnostics::IsEnabled(Diagnostics::LEVEL_FULL) == true)
+        {
+            outgoingPacketStream << *requestPacket;
+            std::string outgoingPacketData = outgoingPacketStream.str();
+            traceFrame(
+                    TraceRing::DIRECTION_SENT,
+                    (const unsigned char*)outgoingPacketData.data(),
+                    outgoingPacketData.size()
+                    );
+        }
+        return true;
+    }
+
+    if (packetSize == 0)
+    {
+        // Frames and checksums only exist in memory, so there is no stream
+        // to fall back to
+        error(0, 0, "Request packet does not fit in %zu bytes", sizeof(packetData));
+        myStatus = STATUS_INCOHERENT;
+        return false;
+    }
+
+    myOutputBuffer->writeData(packetData, packetSize);
+    myOutputBuffer->clear();
+
+    // Record sent data
+    traceFrame(TraceRing::DIRECTION_SENT, packetData, packetSize);
+
+    return true;
+}
+
+void
+RedBot::receivePacket(
+        PacketHandle& responsePacket
+        )
+{
+    // Bytes read through a stream, for buffers that do not hold them
+    std::string incomingPacketData;
+
+    const unsigned char* packetData = NULL;
+    size_t packetSize = 0;
+
+    // Bytes of the received frame, recorded in the trace
+    const unsigned char* receivedData = NULL;
+    size_t receivedSize = 0;
+
+    myInputBuffer->clear();
+    myInputBuffer->readPacket();
+
+    // Packets read through a stream are decoded from memory as well, so that
+    // their size and bytes do not depend on the diagnostics level
+    if (myInputBuffer->getPacketData(packetData, packetSize) == false)
+    {
+        std::istream& inputStream = myInputBuffer->getInputStream();
+        incomingPacketData.assign(
+                std::istreambuf_iterator<char>(inputStream),
+                std::istreambuf_iterator<char>()
+                );
+        packetData = (const unsigned char*)incomingPacketData.data();
+        packetSize = incomingPacketData.size();
+    }
+
+    if (myProtocolVersion == Packet::PROTOCOL_COBS)
+    {
+        responsePacket = Packet::DecodeCobs(
+                packetData,
+                packetSize,
+                *myPacketGenerator,
+                NULL,
+                myActiveChecksumType
+                );
+
+        // Record the frame up to its delimiter
+        receivedData = packetData;
+        while(
+                (receivedSize < packetSize) &&
+                (packetData[receivedSize] != Cobs::DELIMITER)
+             )
+        {
+            ++receivedSize;
+        }
+    }
+    else
+    {
+        responsePacket = Packet::Decode(
+                packetData,
+                packetSize,
+                *myPacketGenerator,
+                &receivedSize, // Record received data
+                NULL,
+                myActiveChecksumType
+                );
+        receivedData = packetData;
+    }
+
+    // Replays read the packet as the buffer provided it
+    if (myRecorder != NULL)
+    {
+        myRecorder->recordPacket(packetData, packetSize);
+    }
+
+    // Decide on robot status. A robot that received a corrupted request
+    // reports it in place of a response.
+    if(
+            (responsePacket.isNull() == false) &&
+            (responsePacket->isNegativeAcknowledge() == true)
+      )
+    {
+        responsePacket.reset();
+        myStatus = STATUS_INCOHERENT;
+    }
+    else if (responsePacket.isNull() == true)
+    {
+        if (receivedSize == 0)
+        {
+            myStatus = STATUS_UNRESPONSIVE;
+        }
+        else
+        {
+            myStatus = STATUS_INCOHERENT;
+        }
+    }
+    else
+    {
+        myStatus = STATUS_GOOD;
+    }
+
+    traceFrame(TraceRing::DIRECTION_RECEIVED, receivedData, receivedSize);
+}
+
+void
+RedBot::traceFrame(
+        TraceRing::Direction    direction,
+        const unsigned char*    data,
+        size_t                  dataSize
+        )
+{
+    Status status = myStatus;
+    bool isFault = (
+            (direction == TraceRing::DIRECTION_RECEIVED) &&
+            (status != STATUS_GOOD)
+            );
+
+    // Frames of good exchanges are only kept with full diagnostics
+    if(
+            Diagnostics::IsEnabled(
+                (isFault == true) ? Diagnostics::LEVEL_ERRORS : Diagnostics::LEVEL_FULL
+                ) == false
+      )
+    {
+        return;
+    }
+
+    myTrace.add(direction, status, data, dataSize);
+
+    if(
+            (isFault == true) &&
+            (myFaultTracePath.empty() == false)
+      )
+    {
+        myTrace.dump(myFaultTracePath.c_str());
+    }
+}
+
+RedBot::Status
+RedBot::getStatus() const
+{
+    return myStatus;
+}
+
+void
+RedBot::setPipelineWindow(
+        size_t windowSize
+        )
+{
+    if (windowSize < 1)
+    {
+        windowSize = 1;
+    }
+    else if (windowSize > OUR_MAX_PIPELINE_WINDOW)
+    {
+        windowSize = OUR_MAX_PIPELINE_WINDOW;
+    }
+
+    myPipelineWindow = windowSize;
+}
+
+size_t
+RedBot::getPipelineWindow() const
+{
+    return myPipelineWindow;
+}
+
+void
+RedBot::setFrameBatching(
+        bool isEnabled
+        )
+{
+    myIsFrameBatching = isEnabled;
+}
+
+bool
+RedBot::isFrameBatching() const
+{
+    return myIsFrameBatching;
+}
+
+void
+RedBot::setLinkBudget(
+        size_t budget
+        )
+{
+    myLinkBudget = budget;
+}
+
+size_t
+RedBot::getLinkBudget() const
+{
+    return myLinkBudget;
+}
+
+void
+RedBot::setMaxProtocolVersion(
+        unsigned int version
+        )
+{
+    if (version < Packet::PROTOCOL_BOUNDED)
+    {
+        version = Packet::PROTOCOL_BOUNDED;
+    }
+
+    myMaxProtocolVersion = version;
+    if (myProtocolVersion != myMaxProtocolVersion)
+    {
+        myIsProtocolNegotiated = false;
+    }
+}
+
+unsigned int
+RedBot::getMaxProtocolVersion() const
+{
+    return myMaxProtocolVersion;
+}
+
+unsigned int
+RedBot::getProtocolVersion() const
+{
+    return myProtocolVersion;
+}
+
+void
+RedBot::setChecksumType(
+        Crc::Type checksum
+        )
+{
+    myChecksumType = checksum;
+    if (myActiveChecksumType != myChecksumType)
+    {
+        myIsProtocolNegotiated = false;
+    }
+}
+
+Crc::Type
+RedBot::getChecksumType() const
+{
+    return myChecksumType;
+}
+
+Crc::Type
+RedBot::getActiveChecksumType() const
+{
+    return myActiveChecksumType;
+}
+
+void
+RedBot::setMaxRetries(
+        unsigned int maxRetries
+        )
+{
+    myMaxRetries = maxRetries;
+}
+
+unsigned int
+RedBot::getMaxRetries() const
+{
+    return myMaxRetries;
+}
+
+unsigned long
+RedBot::getRetransmitCount() const
+{
+    return myRetransmitCount;
+}
+
+void
+RedBot::setThreadedIO(
+        bool isEnabled
+        )
+{
+    if (isEnabled == myIOThread.joinable())
+    {
+        return;
+    }
+
+    if (isEnabled == true)
+    {
+        // Packets received before the thread started are dispatched first
+        while (myIncomingPackets.empty() == false)
+        {
+            myReceivedPackets.push(myIncomingPackets.pop());
+        }
+
+        myIsIOStopRequested = false;
+        myIOThread = std::thread(&RedBot::runIOThread, this);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(myIOMutex);
+        myIsIOStopRequested = true;
+    }
+    myIOCondition.notify_one();
+    myIOThread.join();
+
+    // Packets the thread received are dispatched in the next cycle
+    myIncomingPackets.swap(myReceivedPackets);
+}
+
+bool
+RedBot::isThreadedIO() const
+{
+    return myIOThread.joinable();
+}
+
+unsigned long
+RedBot::getTransferCount() const
+{
+    return myTransferCount;
+}
+
+size_t
+RedBot::getPendingPacketCount() const
+{
+    std::lock_guard<std::mutex> lock(myIOMutex);
+
+    return myPendingPackets.size();
+}
+
+void
+RedBot::runIOThread()
+{
+    std::unique_lock<std::mutex> lock(myIOMutex);
+
+    while (true)
+    {
+        while(
+                (myIsTransferRequested == false) &&
+                (myIsResyncRequested == false) &&
+                (myIsRecoverRequested == false) &&
+                (myIsIOStopRequested == false)
+             )
+        {
+            myIOCondition.wait(lock);
+        }
+
+        bool isTransferRequested = myIsTransferRequested;
+        bool isResyncRequested = myIsResyncRequested;
+        bool isRecoverRequested = myIsRecoverRequested;
+
+        // Stop once the work asked for is done
+        if(
+                (isTransferRequested == false) &&
+                (isResyncRequested == false) &&
+                (isRecoverRequested == false)
+          )
+        {
+            break;
+        }
+
+        myTransferPackets.swap(myPendingPackets);
+        myIsTransferRequested = false;
+        myIsResyncRequested = false;
+        myIsRecoverRequested = false;
+
+        lock.unlock();
+
+        // Recovery was asked for after the previous transfer
+        if (isResyncRequested == true)
+        {
+            resyncLink();
+        }
+        else if (isRecoverRequested == true)
+        {
+            recoverLink();
+        }
+
+        if (isTransferRequested == true)
+        {
+            if (startTransfer() == true)
+            {
+                exchangeOutgoingPackets(myTransferPackets);
+            }
+
+            // Requests are dropped if the robot could not be reached
+            myTransferPackets.clear();
+
+            ++myTransferCount;
+        }
+
+        lock.lock();
+
+        // Hand the received packets over, behind those not yet dispatched
+        while (myIncomingPackets.empty() == false)
+        {
+            myReceivedPackets.push(myIncomingPackets.pop());
+        }
+    }
+}
+
+void
+RedBot::getLastBinaryTransaction(
+        std::list<std::string>& sentData,
+        std::list<std::string>& receivedData
+        ) const
+{
+    sentData.clear();
+    receivedData.clear();
+
+    uint64_t recordCount = myTrace.getRecordCount();
+    TraceRing::Record record;
+    for(
+            uint64_t recordIdx = myTransactionStart;
+            recordIdx < recordCount;
+            ++recordIdx
+       )
+    {
+        if (myTrace.getRecord(recordIdx, record) == false)
+        {
+            continue;
+        }
+
+        std::list<std::string>& data = (record.direction == TraceRing::DIRECTION_SENT) ?
+            sentData : receivedData;
+        data.push_back(std::string((const char*)record.data, record.getDataSize()));
+    }
+}
+
+const TraceRing&
+RedBot::getTrace() const
+{
+    return myTrace;
+}
+
+bool
+RedBot::setTraceFile(
+        const char* path
+        )
+{
+    return myTrace.mapFile(path);
+}
+
+void
+RedBot::setFaultTraceFile(
+        const char* path
+        )
+{
+    myFaultTracePath = (path != NULL) ? path : "";
+}
+
+void
+RedBot::setSessionRecorder(
+        SessionRecorder* recorder
+        )
+{
+    myRecorder = recorder;
+}
+
+void
+RedBot::resync()
+{
+    if (myIOThread.joinable() == true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(myIOMutex);
+            myIsResyncRequested = true;
+        }
+        myIOCondition.notify_one();
+        return;
+    }
+
+    resyncLink();
+}
+
+void
+RedBot::recover()
+{
+    if (myIOThread.joinable() == true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(myIOMutex);
+            myIsRecoverRequested = true;
+        }
+        myIOCondition.notify_one();
+        return;
+    }
+
+    recoverLink();
+}
+
+void
+RedBot::resyncLink()
+{
+    // Send resync sequence, which also returns the robot to bounded packets
+    // without checksums
+    myOutputBuffer->resync();
+    setProtocolVersion(Packet::PROTOCOL_BOUNDED);
+    myActiveChecksumType = Crc::TYPE_NONE;
+    myIsProtocolNegotiated = false;
+
+    // Discard any incoming data. Replays discard a packet in its place.
+    myInputBuffer->readPacket();
+    myInputBuffer->clear();
+
+    if (myRecorder != NULL)
+    {
+        myRecorder->recordPacket(NULL, 0);
+    }
+}
+
+void
+RedBot::recoverLink()
+{
+    if (myActiveChecksumType == Crc::TYPE_NONE)
+    {
+        resyncLink();
+        return;
+    }
+
+    // Each read skips ahead to the next packet header. Up to a window's worth
+    // of late responses may be buffered, and those that are intact are kept.
+    for(
+            size_t packetCount = 0;
+            packetCount <= OUR_MAX_PIPELINE_WINDOW;
+            ++packetCount
+       )
+    {
+        PacketHandle inPacket;
+
+        receivePacket(inPacket);
+        if (inPacket.isNull() == false)
+        {
+            queueIncomingPacket(std::move(inPacket));
+        }
+        else if (myStatus == STATUS_UNRESPONSIVE)
+        {
+            break;
+        }
+    }
 }
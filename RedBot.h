@@ -4,10 +4,18 @@
 #include "FieldControlSystem.h"
 #include "IOBuffer.h"
 #include "Component.h"
+#include "PacketQueue.h"
+#include "SerialPort.h"
+#include "Crc.h"
+#include "TraceRing.h"
 #include <stdio.h>
-#include <termios.h>
+#include <atomic>
+#include <condition_variable>
 #include <list>
-#include <queue>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 // Forward declarations
 namespace frc
@@ -16,6 +24,7 @@ namespace frc
 };
 class Packet;
 class PacketGenerator;
+class SessionRecorder;
 
 /**
  * Handler for all communications with a robot
@@ -41,13 +50,14 @@ class RedBot
         /**
          * Constructor given program and serial device name
          *
-         * This attempts to open the named serial port to establish
-         * communication with the robot.
+         * This attempts to open the named serial port in raw mode at the given
+         * baud rate to establish communication with the robot.
          */
         RedBot(
                 frc::IterativeRobot*     program,
                 const char*         deviceName,
-                PacketGenerator*    packetGen
+                PacketGenerator*    packetGen,
+                unsigned long       baudRate = SerialPort::DEFAULT_BAUD_RATE
               );
 
         /**
@@ -104,29 +114,316 @@ class RedBot
          * Attempts to resynchronize with the robot
          *
          * A byte stream that should clear the robot's communication buffers is
-         * sent when this function is called.
+         * sent when this function is called. The robot returns to bounded
+         * packets without checksums, so both are negotiated again. With the
+         * I/O thread running, the thread does this before its next transfer.
          */
         void resync();
 
+        /**
+         * Recovers from incoherent data received from the robot
+         *
+         * With checksums in use, corrupted packets are told apart from valid
+         * ones, so the robot is not reset. Instead, incoming data is read up
+         * to the next valid packet header and every valid packet found is
+         * kept for the components. Without checksums this falls back to
+         * resync(). With the I/O thread running, the thread does this before
+         * its next transfer.
+         */
+        void recover();
+
         /**
          * Indicates the current status of the robot
          */
         Status getStatus() const;
 
+        /**
+         * Sets the number of requests that may be outstanding at once
+         *
+         * With a window of one, every request waits for its response before
+         * the next one is sent. Larger windows let several requests travel
+         * down the link before their responses are read back. The robot
+         * answers each request with exactly one response in the order the
+         * requests were received, so responses are matched to requests in
+         * sending order. The window is clamped to the range the robot's
+         * receive buffer can hold.
+         */
+        void setPipelineWindow(
+                size_t windowSize
+                );
+
+        /**
+         * Provides the number of requests that may be outstanding at once
+         */
+        size_t getPipelineWindow() const;
+
+        /**
+         * Enables or disables batching of component packets into frames
+         *
+         * With batching enabled, all packets collected from components in a
+         * cycle are sent in as few frame packets as possible, and the robot
+         * replies with a single frame of responses to each. The connectivity
+         * pings that normally bracket a transfer are skipped; an empty frame
+         * is exchanged instead when no component has anything to send.
+         * Frames are always exchanged one at a time regardless of the
+         * pipeline window, as a single frame may fill the robot's receive
+         * buffer.
+         */
+        void setFrameBatching(
+                bool isEnabled
+                );
+
+        /**
+         * Indicates if component packets are batched into frames
+         */
+        bool isFrameBatching() const;
+
+        /**
+         * Sets the number of request bytes that may be sent in each cycle
+         *
+         * With a budget, components are polled for packets in order of
+         * priority until the budget is spent, and the rest wait for a later
+         * cycle. Each cycle a component is passed over raises its priority by
+         * one so that none is starved. A component that is polled sends all
+         * of its packets, so the budget may be exceeded by the last one. A
+         * budget of 0 polls every component in every cycle.
+         */
+        void setLinkBudget(
+                size_t budget
+                );
+
+        /**
+         * Provides the number of request bytes that may be sent in each cycle
+         */
+        size_t getLinkBudget() const;
+
+        /**
+         * Sets the latest protocol version to negotiate with the robot
+         *
+         * Both ends start with bounded packets. With a later version allowed,
+         * the robot is asked for it before the next transfer and both ends
+         * switch to the version it selects. Robots that predate negotiation
+         * acknowledge the request and keep using bounded packets. Negotiation
+         * is repeated after a resync, as the resync sequence returns the
+         * robot to bounded packets.
+         */
+        void setMaxProtocolVersion(
+                unsigned int version
+                );
+
+        /**
+         * Provides the latest protocol version to negotiate with the robot
+         */
+        unsigned int getMaxProtocolVersion() const;
+
+        /**
+         * Provides the protocol version currently in use
+         */
+        unsigned int getProtocolVersion() const;
+
+        /**
+         * Sets the type of checksum to negotiate with the robot
+         *
+         * With a checksum in use, every packet carries one and corrupted
+         * packets are sent again rather than being taken as a loss of sync.
+         * Robots without checksum support acknowledge the request, and no
+         * checksum is used. Like the protocol version, the checksum is
+         * negotiated again after a resync.
+         */
+        void setChecksumType(
+                Crc::Type checksum
+                );
+
+        /**
+         * Provides the type of checksum to negotiate with the robot
+         */
+        Crc::Type getChecksumType() const;
+
+        /**
+         * Provides the type of checksum currently in use
+         */
+        Crc::Type getActiveChecksumType() const;
+
+        /**
+         * Sets the number of times a corrupted exchange is retried
+         *
+         * A request is sent again when the robot reports it corrupted, or when
+         * its response fails its checksum. Retries only take place while a
+         * checksum is in use.
+         */
+        void setMaxRetries(
+                unsigned int maxRetries
+                );
+
+        /**
+         * Provides the number of times a corrupted exchange is retried
+         */
+        unsigned int getMaxRetries() const;
+
+        /**
+         * Provides the number of requests sent again since construction
+         */
+        unsigned long getRetransmitCount() const;
+
+        /**
+         * Starts or stops the background I/O thread
+         *
+         * Without the thread, modePeriodic() runs the user's periodic function
+         * and then waits for a whole transfer with the robot. With it,
+         * transfers are carried out in the background and modePeriodic() only
+         * swaps packet buffers with the thread: the packets received in its
+         * last transfer are dispatched, the user's periodic function runs, and
+         * the packets the components produce are queued for the next
+         * transfer. User code and serial I/O then overlap, and the link is not
+         * left idle while user code runs. Components are only ever called from
+         * the thread that calls modePeriodic().
+         *
+         * Each call to modePeriodic() asks for one transfer. While the thread
+         * has not taken the requests queued for it yet, further calls leave
+         * the components unpolled, so that their outputs keep only the latest
+         * command and no backlog of stale requests builds up. Stopping the
+         * thread waits for the requested transfers to be carried out. Link
+         * settings must only be changed while the thread is stopped.
+         */
+        void setThreadedIO(
+                bool isEnabled
+                );
+
+        /**
+         * Indicates if the background I/O thread is running
+         */
+        bool isThreadedIO() const;
+
+        /**
+         * Provides the number of transfers carried out since construction
+         *
+         * With the I/O thread running, the robot's status only changes when
+         * this count does.
+         */
+        unsigned long getTransferCount() const;
+
+        /**
+         * Provides the number of requests queued for the I/O thread and not
+         * taken by it yet
+         */
+        size_t getPendingPacketCount() const;
+
         /**
          * Provides the last serialized binary transaction
+         *
+         * The frames are copied out of the trace, so frames overwritten since
+         * are left out.
          */
         void getLastBinaryTransaction(
                 std::list<std::string>& sentData,
                 std::list<std::string>& receivedData
                 ) const;
 
+        /**
+         * Provides the trace of the frames exchanged with the robot
+         *
+         * Each record's status is the robot's status once the frame was
+         * handled. Only the frames of failed exchanges are traced with
+         * diagnostics limited to errors, and none with diagnostics off.
+         */
+        const TraceRing& getTrace() const;
+
+        /**
+         * Keeps the trace in the given file from now on
+         *
+         * The file holds the latest frames at all times, even if the program
+         * ends abruptly. This must be set before the first cycle.
+         *
+         * \return True if the file was mapped, false otherwise
+         */
+        bool setTraceFile(
+                const char* path
+                );
+
+        /**
+         * Sets the file the trace is written to when an exchange fails
+         *
+         * The file is rewritten on each failure, so that it holds the frames
+         * leading up to the latest one. This must be set before the first
+         * cycle.
+         */
+        void setFaultTraceFile(
+                const char* path    /**< Path of the file, or NULL for none */
+                );
+
+        /**
+         * Sets the recorder of the packets read from the robot
+         *
+         * Every read is recorded, so that the session can be replayed
+         * through an InputReplayBuffer. Packets read through a stream rather
+         * than from memory are only recorded whole with full diagnostics.
+         * This must be set before the first cycle.
+         */
+        void setSessionRecorder(
+                SessionRecorder* recorder   /**< Recorder, or NULL for none */
+                );
+
     private:
 
         /**
-         * Baud rate enumerator for robot connection
+         * Largest number of requests that may be outstanding at once
+         *
+         * The robot's 64-byte serial receive buffer must be able to hold a
+         * full window of the largest request packets while it is busy
+         * replying.
+         */
+        static const size_t OUR_MAX_PIPELINE_WINDOW = 8;
+
+        /**
+         * Default number of times a corrupted exchange is retried
+         */
+        static const unsigned int OUR_DEFAULT_MAX_RETRIES = 3;
+
+        /**
+         * Request awaiting its response
+         */
+        struct PendingRequest
+        {
+            /**
+             * Request packet, kept to be sent again if corrupted
+             */
+            PacketHandle packet;
+
+            /**
+             * Number of times the request has been sent again
+             */
+            unsigned int retryCount;
+        };
+
+        /**
+         * Indexes the components by the routing keys they process
+         *
+         * When several components claim the same key, the first one keeps it.
          */
-        static const speed_t OUR_DEV_SPEED = B9600;
+        void buildRoutingTable();
+
+        /**
+         * Lists the components in the order they are polled under a budget
+         */
+        void buildSchedule();
+
+        /**
+         * Hands a received packet to the component that processes it
+         *
+         * The packet goes straight to the owner of its routing key. Packets
+         * without an owner, or that their owner declines, are offered to every
+         * component in turn.
+         */
+        void dispatchPacket(
+                const Packet& packet
+                );
+
+        /**
+         * Hands received packets to the components and discards them
+         */
+        void dispatchPackets(
+                PacketQueue& packets
+                );
 
         /**
          * Transfers data packets with the robot
@@ -135,12 +432,169 @@ class RedBot
          */
         void transferData();
 
+        /**
+         * Prepares the link for a transfer
+         *
+         * The protocol is negotiated if needed and, unless packets are batched
+         * into frames, connectivity is confirmed with a ping.
+         *
+         * \return True if the transfer can go ahead, false otherwise
+         */
+        bool startTransfer();
+
+        /**
+         * Sends the given requests and queues the packets received in return
+         *
+         * The queue is left empty.
+         */
+        void exchangeOutgoingPackets(
+                PacketQueue& outgoingPackets
+                );
+
+        /**
+         * Carries out the transfers asked for by modePeriodic()
+         *
+         * This is the body of the background I/O thread. It returns once
+         * asked to stop and no transfer is left to carry out.
+         */
+        void runIOThread();
+
+        /**
+         * Sends the resynchronization sequence and discards incoming data
+         */
+        void resyncLink();
+
+        /**
+         * Skips to the next valid packet, resynchronizing if that is not
+         * possible
+         */
+        void recoverLink();
+
+        /**
+         * Collects the outgoing packets of the components polled this cycle
+         */
+        void collectPackets(
+                PacketQueue& packets
+                );
+
+        /**
+         * Collects the outgoing packets of a single component
+         *
+         * \return Number of bytes the collected packets encode to
+         */
+        size_t collectComponentPackets(
+                Component&      component,
+                PacketQueue&    packets
+                );
+
+        /**
+         * Replaces the queued packets with frame packets that carry them
+         *
+         * Packets that cannot be framed are left in the queue as they are.
+         */
+        void batchPackets(
+                PacketQueue& packets
+                );
+
+        /**
+         * Queues a received packet to be dispatched to the components
+         *
+         * The packets carried by a frame are queued in its place.
+         *
+         * \return True if the packet was a frame, false otherwise
+         */
+        bool queueIncomingPacket(
+                PacketHandle&& packet
+                );
+
         /**
          * Executes a single packet exchange with the robot
+         *
+         * The exchange is retried if it was corrupted. Nothing is received
+         * for a request that could not be sent.
          */
         void exchangePackets(
-                Packet*     requestPacket,  /**< Packet to send to robot */
-                Packet*&    responsePacket  /**< Packet received from robot */
+                const Packet*   requestPacket,  /**< Packet to send to robot */
+                PacketHandle&   responsePacket  /**< Packet received from robot */
+                );
+
+        /**
+         * Asks the robot for the latest allowed protocol version
+         *
+         * \return True if the robot replied, false otherwise
+         */
+        bool negotiateProtocol();
+
+        /**
+         * Asks the robot for the checksum type to use
+         *
+         * \return True if the robot replied, false otherwise
+         */
+        bool negotiateChecksum();
+
+        /**
+         * Indicates if the request whose response was just received should be
+         * sent again
+         *
+         * This is the case when a checksum is in use, the request has retries
+         * left, and the response was corrupted or reported a corrupted
+         * request.
+         */
+        bool isRetryNeeded(
+                unsigned int retryCount
+                ) const;
+
+        /**
+         * Switches both directions of the link to the given protocol version
+         */
+        void setProtocolVersion(
+                unsigned int version
+                );
+
+        /**
+         * Encodes a packet for the protocol version in use
+         *
+         * \return Number of bytes written, or 0 if the buffer is too small
+         */
+        size_t encodePacket(
+                const Packet&   packet,
+                unsigned char*  buffer,
+                size_t          bufferSize
+                ) const;
+
+        /**
+         * Adds a frame to the trace, with the robot's current status
+         *
+         * A received frame that leaves the robot in error has the trace
+         * written to the fault trace file.
+         */
+        void traceFrame(
+                TraceRing::Direction    direction,
+                const unsigned char*    data,
+                size_t                  dataSize
+                );
+
+        /**
+         * Sends a single request packet to the robot
+         *
+         * A packet that cannot be framed under the protocol and checksum in
+         * use is not sent, and marks the robot as incoherent.
+         *
+         * \return True if the packet was sent, false otherwise
+         */
+        bool sendPacket(
+                const Packet*   requestPacket
+                );
+
+        /**
+         * Receives a single response packet from the robot
+         *
+         * The robot's status is updated according to whether a valid packet
+         * was received. A report of a corrupted request is not returned, and
+         * marks the robot as incoherent.
+         */
+        void receivePacket(
+                PacketHandle& responsePacket    /**< Packet received from robot */
                 );
 
         /**
@@ -150,8 +604,65 @@ class RedBot
 
         /**
          * Indicates the current status of the robot
+         *
+         * This is written by the I/O thread while it runs.
+         */
+        std::atomic<Status> myStatus;
+
+        /**
+         * Number of requests that may be outstanding at once
+         */
+        size_t myPipelineWindow;
+
+        /**
+         * Indicates if component packets are batched into frames
+         */
+        bool myIsFrameBatching;
+
+        /**
+         * Number of request bytes that may be sent in each cycle
+         */
+        size_t myLinkBudget;
+
+        /**
+         * Latest protocol version to negotiate with the robot
+         */
+        unsigned int myMaxProtocolVersion;
+
+        /**
+         * Protocol version currently in use
+         */
+        std::atomic<unsigned int> myProtocolVersion;
+
+        /**
+         * Indicates if the protocol version has been negotiated
+         */
+        bool myIsProtocolNegotiated;
+
+        /**
+         * Type of checksum to negotiate with the robot
+         */
+        Crc::Type myChecksumType;
+
+        /**
+         * Type of checksum currently in use
+         */
+        std::atomic<Crc::Type> myActiveChecksumType;
+
+        /**
+         * Number of times a corrupted exchange is retried
+         */
+        unsigned int myMaxRetries;
+
+        /**
+         * Number of requests sent again since construction
          */
-        Status myStatus;
+        std::atomic<unsigned long> myRetransmitCount;
+
+        /**
+         * Number of transfers carried out since construction
+         */
+        std::atomic<unsigned long> myTransferCount;
 
         /**
          * Indicates if this object is using externally provided IO buffers
@@ -166,11 +677,42 @@ class RedBot
          */
         FILE* myDevice;
 
+        /**
+         * Serial port opened by name for robot connection
+         */
+        SerialPort mySerialPort;
+
         /**
          * Components used in the program
          */
         Components myComponents;
 
+        /**
+         * Components indexed by the routing keys they process
+         */
+        std::unordered_map<RoutingKey, Component*> myRoutingTable;
+
+        /**
+         * Component polled under a link budget
+         */
+        struct ScheduleEntry
+        {
+            /**
+             * Component to poll
+             */
+            Component* component;
+
+            /**
+             * Number of cycles since the component was last polled
+             */
+            unsigned int deferredCycles;
+        };
+
+        /**
+         * Components in the order they were last polled under a link budget
+         */
+        std::vector<ScheduleEntry> mySchedule;
+
         /**
          * Buffer for incoming communication to robot
          */
@@ -183,18 +725,101 @@ class RedBot
 
         /**
          * Incoming packets from robot
+         *
+         * With the I/O thread running, only the thread uses this queue.
+         */
+        PacketQueue myIncomingPackets;
+
+        /**
+         * Requests collected for the current transfer when the I/O thread is
+         * not running
+         *
+         * This is kept from cycle to cycle so that its capacity is reused.
+         */
+        PacketQueue myOutgoingPackets;
+
+        /**
+         * Frames built by batchPackets(), kept so that their capacity is
+         * reused
+         */
+        PacketQueue myFramePackets;
+
+        /**
+         * Background thread carrying out transfers, if running
+         */
+        std::thread myIOThread;
+
+        /**
+         * Guards the state shared with the I/O thread
+         */
+        mutable std::mutex myIOMutex;
+
+        /**
+         * Signals the I/O thread that it has work to do
+         */
+        std::condition_variable myIOCondition;
+
+        /**
+         * Indicates that the I/O thread is asked to stop
+         */
+        bool myIsIOStopRequested;
+
+        /**
+         * Indicates that a transfer is asked of the I/O thread
+         */
+        bool myIsTransferRequested;
+
+        /**
+         * Indicates that a resync is asked of the I/O thread
+         */
+        bool myIsResyncRequested;
+
+        /**
+         * Indicates that a recovery is asked of the I/O thread
+         */
+        bool myIsRecoverRequested;
+
+        /**
+         * Requests queued for the next transfer of the I/O thread
+         */
+        PacketQueue myPendingPackets;
+
+        /**
+         * Requests taken by the I/O thread for its current transfer
+         */
+        PacketQueue myTransferPackets;
+
+        /**
+         * Packets received by the I/O thread, awaiting dispatch
+         */
+        PacketQueue myReceivedPackets;
+
+        /**
+         * Packets being collected from or dispatched to the components while
+         * the I/O thread runs
+         */
+        PacketQueue myCyclePackets;
+
+        /**
+         * Trace of the frames exchanged with the robot
+         */
+        TraceRing myTrace;
+
+        /**
+         * Number of the first trace record of the last transaction
          */
-        std::queue<Packet*> myIncomingPackets;
+        std::atomic<uint64_t> myTransactionStart;
 
         /**
-         * Binary data of packets sent in last transaction
+         * File the trace is written to when an exchange fails, or empty for
+         * none
          */
-        std::list<std::string> myLastTransactionSentData;
+        std::string myFaultTracePath;
 
         /**
-         * Binary data of packets received in last transaction
+         * Recorder of the packets read from the robot, or NULL
          */
-        std::list<std::string> myLastTransactionReceivedData;
+        SessionRecorder* myRecorder;
 
         /**
          * Packet generator used to generate packets from binary data stream
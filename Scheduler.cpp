@@ -1,6 +1,9 @@
 
 #include "Scheduler.h"
 #include "Subsystem.h"
+#include "Command.h"
+#include "Clock.h"
+#include <error.h>
 #include <stdlib.h>
 
 using namespace frc;
@@ -20,13 +23,17 @@ Scheduler::GetInstance()
   return ourInstance;
 }
 
+Scheduler*
+Scheduler::GetExistingInstance()
+{
+  return ourInstance;
+}
+
 void
 Scheduler::DestroyInstance()
 {
   delete ourInstance;
   ourInstance = NULL;
-
-  DefaultSubsystem::DestroyInstance();
 }
 
 Scheduler::Scheduler() :
@@ -37,25 +44,185 @@ Scheduler::Scheduler() :
 void
 Scheduler::Run()
 {
+  Clock& clock = Clock::GetInstance();
+  long long startTime = clock.getTime();
+
   if (!myAreSubsystemsInitialized)
     {
-      for (Subsystems::const_iterator sysIter = mySubsystems.begin(); sysIter != mySubsystems.end(); ++sysIter)
+      for (size_t sysIdx = 0; sysIdx < mySubsystems.size(); ++sysIdx)
 	{
-	  Subsystem* subsystem = *sysIter;
-	  subsystem->InitDefaultCommand();
+	  mySubsystems[sysIdx]->InitDefaultCommand();
 	}
       myAreSubsystemsInitialized = true;
     }
-      
-  for (Subsystems::const_iterator sysIter = mySubsystems.begin(); sysIter != mySubsystems.end(); ++sysIter)
+
+  // Commands started while others are initialized or interrupted are taken
+  // in the same run
+  for (size_t startedIdx = 0; startedIdx < myStartedCommands.size(); ++startedIdx)
     {
-      Subsystem* subsystem = *sysIter;
-      subsystem->ProcessCommands();
+      Command* cmd = myStartedCommands[startedIdx];
+      cmd->myIsStarted = false;
+      if (cmd->myIsRunning)
+	{
+	  continue;
+	}
+
+      Requirements conflicts = cmd->myRequirements & myHeldSubsystems;
+      if (conflicts.any())
+	{
+	  bool isInterruptible = true;
+	  for (size_t sysIdx = 0; sysIdx < mySubsystems.size(); ++sysIdx)
+	    {
+	      if (conflicts.test(sysIdx) && !(mySubsystemCommands[sysIdx]->IsInterruptible()))
+		{
+		  isInterruptible = false;
+		}
+	    }
+
+	  if (!isInterruptible)
+	    {
+	      continue;
+	    }
+
+	  for (size_t sysIdx = 0; sysIdx < mySubsystems.size(); ++sysIdx)
+	    {
+	      // Commands holding several subsystems are released from all at once
+	      Command* heldCmd = mySubsystemCommands[sysIdx];
+	      if (conflicts.test(sysIdx) && heldCmd)
+		{
+		  heldCmd->Interrupted();
+		  ReleaseCommand(heldCmd);
+		}
+	    }
+	}
+
+      InitializeCommand(cmd, cmd->myRequirements);
+    }
+  myStartedCommands.clear();
+
+  for (size_t sysIdx = 0; sysIdx < mySubsystems.size(); ++sysIdx)
+    {
+      Command* defaultCmd = mySubsystems[sysIdx]->myDefaultCommand;
+      if (!(myHeldSubsystems.test(sysIdx)) && defaultCmd && !(defaultCmd->myIsRunning))
+	{
+	  Requirements requirements = defaultCmd->myRequirements;
+	  requirements.set(sysIdx);
+
+	  if ((requirements & myHeldSubsystems).none())
+	    {
+	      InitializeCommand(defaultCmd, requirements);
+	    }
+	}
+    }
+
+  // Commands that are done are dropped from the list as it is walked
+  size_t runningCount = 0;
+  for (size_t cmdIdx = 0; cmdIdx < myCommands.size(); ++cmdIdx)
+    {
+      Command* cmd = myCommands[cmdIdx];
+      if (cmd->myIsRunning)
+	{
+	  long long executeTime = clock.getTime();
+	  cmd->SetEndCalled(false);
+	  cmd->Execute();
+
+	  long long isFinishedTime = clock.getTime();
+	  bool isFinished = cmd->IsFinished();
+
+	  long long endTime = clock.getTime();
+	  cmd->myExecuteTimes.add((double)(isFinishedTime - executeTime) / Clock::NSEC_PER_SEC);
+	  cmd->myIsFinishedTimes.add((double)(endTime - isFinishedTime) / Clock::NSEC_PER_SEC);
+
+	  if (isFinished)
+	    {
+	      cmd->End();
+	      cmd->SetEndCalled(true);
+	      ReleaseCommand(cmd);
+	    }
+	}
+
+      if (cmd->myIsRunning)
+	{
+	  myCommands[runningCount++] = cmd;
+	}
+      else
+	{
+	  cmd->myIsListed = false;
+	}
     }
+  myCommands.resize(runningCount);
+
+  myRunTimes.add((double)(clock.getTime() - startTime) / Clock::NSEC_PER_SEC);
 }
 
 void
 Scheduler::AddSubsystem(Subsystem* subsystem)
 {
+  if (mySubsystems.size() >= MAX_SUBSYSTEMS)
+    {
+      error(0, 0, "Too many subsystems, %s is not scheduled", subsystem->GetName().c_str());
+      return;
+    }
+
+  subsystem->myIndex = mySubsystems.size();
   mySubsystems.push_back(subsystem);
+  mySubsystemCommands.push_back(NULL);
+}
+
+void
+Scheduler::AddCommand(Command* command)
+{
+  if (!(command->myIsStarted))
+    {
+      command->myIsStarted = true;
+      myStartedCommands.push_back(command);
+    }
+}
+
+const LatencyHistogram&
+Scheduler::GetRunTimes() const
+{
+  return myRunTimes;
+}
+
+void
+Scheduler::InitializeCommand(Command* command, const Requirements& requirements)
+{
+  command->myHeldSubsystems = requirements;
+  command->myIsRunning = true;
+  myHeldSubsystems |= requirements;
+
+  for (size_t sysIdx = 0; requirements.any() && (sysIdx < mySubsystems.size()); ++sysIdx)
+    {
+      if (requirements.test(sysIdx))
+	{
+	  mySubsystemCommands[sysIdx] = command;
+	}
+    }
+
+  // A command interrupted and started again in the same run keeps its place
+  if (!(command->myIsListed))
+    {
+      command->myIsListed = true;
+      myCommands.push_back(command);
+    }
+
+  command->Initialize();
+}
+
+void
+Scheduler::ReleaseCommand(Command* command)
+{
+  const Requirements& requirements = command->myHeldSubsystems;
+  for (size_t sysIdx = 0; requirements.any() && (sysIdx < mySubsystems.size()); ++sysIdx)
+    {
+      if (requirements.test(sysIdx))
+	{
+	  mySubsystemCommands[sysIdx] = NULL;
+	}
+    }
+
+  myHeldSubsystems &= ~requirements;
+  command->myHeldSubsystems.reset();
+  command->myIsRunning = false;
 }
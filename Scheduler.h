@@ -1,35 +1,73 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
-#include <list>
+#include "LatencyHistogram.h"
+#include <bitset>
+#include <stddef.h>
+#include <vector>
 
 namespace frc
 {
+  class Command;
   class Subsystem;
 
   class Scheduler
   {
   public:
 
+    // Largest number of subsystems commands can require
+    static const size_t MAX_SUBSYSTEMS = 64;
+
+    // Subsystems required by a command, by index of subsystem
+    typedef std::bitset<MAX_SUBSYSTEMS> Requirements;
+
     static Scheduler* GetInstance();
 
+    // Existing instance, or NULL, without creating one
+    static Scheduler* GetExistingInstance();
+
     static void DestroyInstance();
 
     void Run();
 
     void AddSubsystem(Subsystem*);
 
+    void AddCommand(Command*);
+
+    // Time taken by each call to Run, whatever the commands run
+    const LatencyHistogram& GetRunTimes() const;
+
   private:
 
-    typedef std::list<Subsystem*> Subsystems;
+    typedef std::vector<Subsystem*> Subsystems;
+    typedef std::vector<Command*> Commands;
 
     static Scheduler* ourInstance;
 
     Scheduler();
 
+    void InitializeCommand(Command*, const Requirements&);
+
+    void ReleaseCommand(Command*);
+
+    // Subsystems, by index
     Subsystems mySubsystems;
 
+    // Command holding each subsystem, or NULL, by index of subsystem
+    Commands mySubsystemCommands;
+
+    // Subsystems held by a running command
+    Requirements myHeldSubsystems;
+
+    // Commands started since the last run, in the order they were started
+    Commands myStartedCommands;
+
+    // Running commands, in the order they were initialized
+    Commands myCommands;
+
     bool myAreSubsystemsInitialized;
+
+    LatencyHistogram myRunTimes;
   };
 }; /* namespace frc */
 
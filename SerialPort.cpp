@@ -0,0 +1,218 @@
+#include "SerialPort.h"
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <error.h>
+#include <errno.h>
+
+
+SerialPort::SerialPort() :
+    myFD(-1)
+{
+}
+
+SerialPort::~SerialPort()
+{
+    close();
+}
+
+bool
+SerialPort::open(
+        const char*     path,
+        int             accessMode,
+        unsigned long   baudRate,
+        unsigned int    latencyTimer
+        )
+{
+    close();
+
+    speed_t speed = GetSpeed(baudRate);
+    if (speed == B0)
+    {
+        error(0, 0, "Unsupported baud rate %lu", baudRate);
+        return false;
+    }
+
+    myFD = ::open(path, accessMode | O_NOCTTY);
+    if (myFD < 0)
+    {
+        error(0, errno, "Could not open %s", path);
+        return false;
+    }
+
+    // Leave devices that are not terminals as they are
+    if (isatty(myFD) == 0)
+    {
+        return true;
+    }
+
+    if (configure(speed) == false)
+    {
+        error(0, errno, "Could not configure %s", path);
+        close();
+        return false;
+    }
+
+    setLowLatency();
+    if (latencyTimer > 0)
+    {
+        setLatencyTimer(path, latencyTimer);
+    }
+
+    // Discard anything received before the port was configured
+    tcflush(myFD, TCIOFLUSH);
+
+    return true;
+}
+
+void
+SerialPort::close()
+{
+    if (myFD >= 0)
+    {
+        ::close(myFD);
+        myFD = -1;
+    }
+}
+
+bool
+SerialPort::isOpen() const
+{
+    return (myFD >= 0);
+}
+
+int
+SerialPort::getDescriptor() const
+{
+    return myFD;
+}
+
+bool
+SerialPort::IsSupportedBaudRate(
+        unsigned long baudRate
+        )
+{
+    return (GetSpeed(baudRate) != B0);
+}
+
+speed_t
+SerialPort::GetSpeed(
+        unsigned long baudRate
+        )
+{
+    switch (baudRate)
+    {
+        case 9600:      return B9600; break;
+        case 19200:     return B19200; break;
+        case 38400:     return B38400; break;
+        case 57600:     return B57600; break;
+        case 115200:    return B115200; break;
+        case 230400:    return B230400; break;
+        case 460800:    return B460800; break;
+        case 500000:    return B500000; break;
+        case 576000:    return B576000; break;
+        case 921600:    return B921600; break;
+        case 1000000:   return B1000000; break;
+        default: return B0; break;
+    };
+
+    return B0;
+}
+
+bool
+SerialPort::configure(
+        speed_t speed
+        )
+{
+    struct termios attributes;
+
+    if (tcgetattr(myFD, &attributes) != 0)
+    {
+        return false;
+    }
+
+    // No line editing, echo, signals or character translation
+    cfmakeraw(&attributes);
+
+    // Ignore modem control lines and enable the receiver
+    attributes.c_cflag |= (CLOCAL | CREAD);
+    attributes.c_cflag &= ~(CSTOPB | CRTSCTS);
+
+    // Reads return immediately with whatever is available
+    attributes.c_cc[VMIN] = 0;
+    attributes.c_cc[VTIME] = 0;
+
+    if(
+            (cfsetispeed(&attributes, speed) != 0) ||
+            (cfsetospeed(&attributes, speed) != 0)
+      )
+    {
+        return false;
+    }
+
+    return (tcsetattr(myFD, TCSANOW, &attributes) == 0);
+}
+
+void
+SerialPort::setLowLatency()
+{
+    struct serial_struct serialInfo;
+
+    // Not every driver supports this, so failures are ignored
+    if (ioctl(myFD, TIOCGSERIAL, &serialInfo) != 0)
+    {
+        return;
+    }
+
+    serialInfo.flags |= ASYNC_LOW_LATENCY;
+    ioctl(myFD, TIOCSSERIAL, &serialInfo);
+}
+
+void
+SerialPort::setLatencyTimer(
+        const char*     path,
+        unsigned int    latencyTimer
+        )
+{
+    char devicePath[PATH_MAX];
+
+    // The timer is exposed by the USB-serial device named after the tty
+    if (realpath(path, devicePath) == NULL)
+    {
+        return;
+    }
+
+    char timerPath[PATH_MAX];
+    snprintf(
+            timerPath,
+            sizeof(timerPath),
+            "/sys/bus/usb-serial/devices/%s/latency_timer",
+            basename(devicePath)
+            );
+
+    int timerFD = ::open(timerPath, O_WRONLY);
+    if (timerFD < 0)
+    {
+        // Not an FTDI adapter
+        if (errno != ENOENT)
+        {
+            error(0, errno, "Could not set latency timer in %s", timerPath);
+        }
+        return;
+    }
+
+    char timerValue[16];
+    int valueLength = snprintf(timerValue, sizeof(timerValue), "%u", latencyTimer);
+    if (write(timerFD, timerValue, valueLength) != valueLength)
+    {
+        error(0, errno, "Could not set latency timer in %s", timerPath);
+    }
+
+    ::close(timerFD);
+}
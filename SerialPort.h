@@ -0,0 +1,124 @@
+#ifndef SERIALPORT_H
+#define SERIALPORT_H
+
+#include <termios.h>
+
+/**
+ * Serial device connected to the robot
+ *
+ * Opening a port puts the terminal in raw mode at the requested baud rate, so
+ * that packet bytes pass through unaltered and reads return whatever has
+ * arrived without waiting for a line or a minimum byte count. The driver is
+ * also asked to hand received bytes over without delay: the kernel's
+ * low-latency flag is set, and the latency timer of FTDI USB-serial adapters
+ * is shortened from its 16 ms default. Adapters that do not support either
+ * are used as they are.
+ *
+ * Devices that are not terminals, such as the FIFOs of a simulated robot, are
+ * opened without configuration.
+ */
+class SerialPort
+{
+    public:
+
+        /**
+         * Baud rate the robot firmware starts with
+         */
+        static const unsigned long DEFAULT_BAUD_RATE = 9600;
+
+        /**
+         * USB-serial latency timer applied by default, in milliseconds
+         */
+        static const unsigned int DEFAULT_LATENCY_TIMER = 1;
+
+        /**
+         * Default constructor
+         */
+        SerialPort();
+
+        /**
+         * Destructor
+         *
+         * This closes the port if it is open.
+         */
+        ~SerialPort();
+
+        /**
+         * Opens and configures the serial device at the given path
+         *
+         * \return True if the device was opened and configured, false
+         * otherwise
+         */
+        bool open(
+                const char*     path,
+                int             accessMode,     /**< O_RDWR, O_RDONLY or O_WRONLY */
+                unsigned long   baudRate = DEFAULT_BAUD_RATE,
+                unsigned int    latencyTimer = DEFAULT_LATENCY_TIMER    /**< In milliseconds, or 0 to leave unchanged */
+                );
+
+        /**
+         * Closes the port
+         */
+        void close();
+
+        /**
+         * Indicates if the port is open
+         */
+        bool isOpen() const;
+
+        /**
+         * Provides the descriptor of the open port
+         *
+         * \return Descriptor, or -1 if the port is not open
+         */
+        int getDescriptor() const;
+
+        /**
+         * Indicates if the given baud rate is supported
+         */
+        static bool IsSupportedBaudRate(
+                unsigned long baudRate
+                );
+
+    private:
+
+        /**
+         * Provides the terminal speed for the given baud rate
+         *
+         * \return Terminal speed, or B0 if the baud rate is not supported
+         */
+        static speed_t GetSpeed(
+                unsigned long baudRate
+                );
+
+        /**
+         * Puts the terminal in raw mode at the given speed
+         *
+         * \return True if the terminal was configured, false otherwise
+         */
+        bool configure(
+                speed_t speed
+                );
+
+        /**
+         * Asks the driver to deliver received bytes without delay
+         */
+        void setLowLatency();
+
+        /**
+         * Sets the latency timer of the USB-serial adapter behind the device
+         *
+         * Only FTDI adapters expose this timer.
+         */
+        void setLatencyTimer(
+                const char*     path,
+                unsigned int    latencyTimer
+                );
+
+        /**
+         * Descriptor of the open port, or -1 if the port is not open
+         */
+        int myFD;
+};
+
+#endif /* ifndef SERIALPORT_H */
@@ -0,0 +1,583 @@
+
+#include "SessionLog.h"
+#include "Clock.h"
+#include <errno.h>
+#include <error.h>
+#include <string.h>
+
+
+const char SessionLog::MAGIC[8] = {'W', 'P', 'I', 'R', 'B', 'S', 'E', 'S'};
+
+std::atomic<SessionRecorder*> SessionRecorder::ourInstance(NULL);
+
+std::atomic<SessionPlayer*> SessionPlayer::ourInstance(NULL);
+
+
+size_t
+SessionLog::EncodeVarint(
+        uint64_t        value,
+        unsigned char*  buffer
+        )
+{
+    size_t byteIdx = 0;
+
+    while (value >= 0x80)
+    {
+        buffer[byteIdx++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    buffer[byteIdx++] = value;
+
+    return byteIdx;
+}
+
+size_t
+SessionLog::DecodeVarint(
+        const unsigned char*    buffer,
+        size_t                  bufferSize,
+        uint64_t&               value
+        )
+{
+    value = 0;
+
+    for(
+            size_t byteIdx = 0;
+            (byteIdx < bufferSize) && (byteIdx < MAX_VARINT_SIZE);
+            ++byteIdx
+       )
+    {
+        value |= (uint64_t)(buffer[byteIdx] & 0x7F) << (7 * byteIdx);
+
+        if ((buffer[byteIdx] & 0x80) == 0)
+        {
+            return byteIdx + 1;
+        }
+    }
+
+    return 0;
+}
+
+
+SessionRecorder::SessionRecorder() :
+    myMutex(),
+    myFile(NULL),
+    myLastTime(0)
+{
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    close();
+}
+
+bool
+SessionRecorder::open(
+        const char* path
+        )
+{
+    close();
+
+    std::lock_guard<std::mutex> lock(myMutex);
+
+    myFile = fopen(path, "wb");
+    if (myFile == NULL)
+    {
+        error(0, errno, "Could not open session log %s", path);
+        return false;
+    }
+
+    fwrite(SessionLog::MAGIC, 1, sizeof(SessionLog::MAGIC), myFile);
+    fputc(SessionLog::VERSION, myFile);
+    myLastTime = Clock::GetInstance().getTime();
+
+    return true;
+}
+
+void
+SessionRecorder::close()
+{
+    std::lock_guard<std::mutex> lock(myMutex);
+
+    if (myFile != NULL)
+    {
+        fclose(myFile);
+        myFile = NULL;
+    }
+}
+
+bool
+SessionRecorder::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(myMutex);
+
+    return (myFile != NULL);
+}
+
+void
+SessionRecorder::recordCycle()
+{
+    writeEvent(SessionLog::EVENT_CYCLE, NULL, 0);
+}
+
+void
+SessionRecorder::recordMode(
+        FieldControlSystem::Mode mode
+        )
+{
+    unsigned char values[1] = {(unsigned char)mode};
+
+    writeEvent(SessionLog::EVENT_MODE, values, sizeof(values));
+}
+
+void
+SessionRecorder::recordAxis(
+        int     port,
+        int     axis,
+        float   value
+        )
+{
+    unsigned char values[2 + sizeof(value)] = {(unsigned char)port, (unsigned char)axis};
+    memcpy(&values[2], &value, sizeof(value));
+
+    writeEvent(SessionLog::EVENT_AXIS, values, sizeof(values));
+}
+
+void
+SessionRecorder::recordButton(
+        int     port,
+        int     button,
+        bool    value
+        )
+{
+    unsigned char values[3] = {(unsigned char)port, (unsigned char)button, value};
+
+    writeEvent(SessionLog::EVENT_BUTTON, values, sizeof(values));
+}
+
+void
+SessionRecorder::recordPacket(
+        const unsigned char*    data,
+        size_t                  dataSize
+        )
+{
+    writeEvent(SessionLog::EVENT_PACKET, data, dataSize);
+}
+
+SessionRecorder*
+SessionRecorder::GetInstance()
+{
+    return ourInstance.load();
+}
+
+void
+SessionRecorder::SetInstance(
+        SessionRecorder* recorder
+        )
+{
+    ourInstance.store(recorder);
+}
+
+void
+SessionRecorder::writeEvent(
+        SessionLog::EventType   type,
+        const unsigned char*    values,
+        size_t                  valuesSize
+        )
+{
+    unsigned char header[1 + (2 * SessionLog::MAX_VARINT_SIZE)];
+    long long time = Clock::GetInstance().getTime();
+
+    std::lock_guard<std::mutex> lock(myMutex);
+
+    if (myFile == NULL)
+    {
+        return;
+    }
+
+    // Events from other threads may have been timed just before this one
+    uint64_t elapsedTime = (time > myLastTime) ? (time - myLastTime) : 0;
+    myLastTime += elapsedTime;
+
+    size_t headerSize = 0;
+    header[headerSize++] = type;
+    headerSize += SessionLog::EncodeVarint(elapsedTime, &header[headerSize]);
+
+    // Packets vary in size, so theirs comes first
+    if (type == SessionLog::EVENT_PACKET)
+    {
+        headerSize += SessionLog::EncodeVarint(valuesSize, &header[headerSize]);
+    }
+
+    fwrite(header, 1, headerSize, myFile);
+    if (valuesSize > 0)
+    {
+        fwrite(values, 1, valuesSize, myFile);
+    }
+}
+
+
+SessionPlayer::SessionPlayer() :
+    myCycles(),
+    myReadings(),
+    myReadingIdx(0),
+    myPacketData(),
+    myPacketOffsets(1, 0),
+    myPacketIdx(0),
+    myMismatchCount(0)
+{
+}
+
+bool
+SessionPlayer::load(
+        const char* path
+        )
+{
+    FILE* logFile = fopen(path, "rb");
+    if (logFile == NULL)
+    {
+        error(0, errno, "Could not open session log %s", path);
+        return false;
+    }
+
+    std::vector<unsigned char> logData;
+    unsigned char readData[4096];
+    size_t readSize;
+    while ((readSize = fread(readData, 1, sizeof(readData), logFile)) > 0)
+    {
+        logData.insert(logData.end(), readData, readData + readSize);
+    }
+    fclose(logFile);
+
+    myCycles.clear();
+    myReadings.clear();
+    myPacketData.clear();
+    myPacketOffsets.assign(1, 0);
+    rewind();
+
+    size_t logIdx = sizeof(SessionLog::MAGIC) + 1;
+    if(
+            (logData.size() < logIdx) ||
+            (memcmp(&logData[0], SessionLog::MAGIC, sizeof(SessionLog::MAGIC)) != 0) ||
+            (logData[sizeof(SessionLog::MAGIC)] != SessionLog::VERSION)
+      )
+    {
+        error(0, 0, "%s is not a session log", path);
+        return false;
+    }
+
+    long long time = 0;
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    while (logIdx < logData.size())
+    {
+        SessionLog::EventType type = (SessionLog::EventType)logData[logIdx++];
+
+        uint64_t elapsedTime = 0;
+        size_t varintSize = SessionLog::DecodeVarint(
+                &logData[0] + logIdx,
+                logData.size() - logIdx,
+                elapsedTime
+                );
+        if (varintSize == 0)
+        {
+            break;
+        }
+        logIdx += varintSize;
+        time += elapsedTime;
+
+        const unsigned char* values = &logData[0] + logIdx;
+        size_t remainingSize = logData.size() - logIdx;
+        size_t valuesSize = 0;
+
+        switch (type)
+        {
+            case SessionLog::EVENT_CYCLE:
+            {
+                Cycle cycle;
+                cycle.time = time;
+                cycle.mode = mode;
+                myCycles.push_back(cycle);
+            }
+            break;
+
+            case SessionLog::EVENT_MODE:
+                valuesSize = 1;
+                if (valuesSize <= remainingSize)
+                {
+                    mode = (FieldControlSystem::Mode)values[0];
+                }
+                break;
+
+            case SessionLog::EVENT_AXIS:
+            case SessionLog::EVENT_BUTTON:
+            {
+                valuesSize = (type == SessionLog::EVENT_AXIS) ? (2 + sizeof(float)) : 3;
+                if (valuesSize <= remainingSize)
+                {
+                    Reading reading;
+                    reading.type = type;
+                    reading.port = values[0];
+                    reading.index = values[1];
+                    if (type == SessionLog::EVENT_AXIS)
+                    {
+                        memcpy(&reading.value, &values[2], sizeof(reading.value));
+                    }
+                    else
+                    {
+                        reading.value = values[2];
+                    }
+                    myReadings.push_back(reading);
+                }
+            }
+            break;
+
+            case SessionLog::EVENT_PACKET:
+            {
+                uint64_t packetSize = 0;
+                varintSize = SessionLog::DecodeVarint(values, remainingSize, packetSize);
+                if(
+                        (varintSize == 0) ||
+                        (packetSize > (remainingSize - varintSize))
+                  )
+                {
+                    valuesSize = remainingSize + 1;
+                    break;
+                }
+
+                myPacketData.insert(
+                        myPacketData.end(),
+                        values + varintSize,
+                        values + varintSize + packetSize
+                        );
+                myPacketOffsets.push_back(myPacketData.size());
+                valuesSize = varintSize + packetSize;
+            }
+            break;
+
+            default:
+                error(0, 0, "Unknown event 0x%02x in session log %s", type, path);
+                return false;
+                break;
+        };
+
+        // A log cut short, as by a crash, holds everything up to its last
+        // complete event
+        if (valuesSize > remainingSize)
+        {
+            break;
+        }
+        logIdx += valuesSize;
+    }
+
+    return true;
+}
+
+const std::vector<SessionPlayer::Cycle>&
+SessionPlayer::getCycles() const
+{
+    return myCycles;
+}
+
+float
+SessionPlayer::replayAxis(
+        int port,
+        int axis
+        )
+{
+    const Reading* reading = takeReading(SessionLog::EVENT_AXIS, port, axis);
+
+    return (reading != NULL) ? reading->value : 0.0;
+}
+
+bool
+SessionPlayer::replayButton(
+        int port,
+        int button
+        )
+{
+    const Reading* reading = takeReading(SessionLog::EVENT_BUTTON, port, button);
+
+    return (
+            (reading != NULL) &&
+            (reading->value != 0.0)
+           );
+}
+
+bool
+SessionPlayer::replayPacket(
+        const unsigned char*&   data,
+        size_t&                 dataSize
+        )
+{
+    if (myPacketIdx >= getPacketCount())
+    {
+        ++myMismatchCount;
+        return false;
+    }
+
+    data = myPacketData.data() + myPacketOffsets[myPacketIdx];
+    dataSize = myPacketOffsets[myPacketIdx + 1] - myPacketOffsets[myPacketIdx];
+    ++myPacketIdx;
+
+    return true;
+}
+
+size_t
+SessionPlayer::getPacketCount() const
+{
+    return myPacketOffsets.size() - 1;
+}
+
+unsigned long
+SessionPlayer::getMismatchCount() const
+{
+    return myMismatchCount;
+}
+
+void
+SessionPlayer::rewind()
+{
+    myReadingIdx = 0;
+    myPacketIdx = 0;
+    myMismatchCount = 0;
+}
+
+SessionPlayer*
+SessionPlayer::GetInstance()
+{
+    return ourInstance.load();
+}
+
+void
+SessionPlayer::SetInstance(
+        SessionPlayer* player
+        )
+{
+    ourInstance.store(player);
+}
+
+const SessionPlayer::Reading*
+SessionPlayer::takeReading(
+        SessionLog::EventType   type,
+        int                     port,
+        int                     index
+        )
+{
+    // Readings are left in place on a mismatch, so that a program reading
+    // an extra input only loses that one reading
+    if(
+            (myReadingIdx >= myReadings.size()) ||
+            (myReadings[myReadingIdx].type != type) ||
+            (myReadings[myReadingIdx].port != port) ||
+            (myReadings[myReadingIdx].index != index)
+      )
+    {
+        ++myMismatchCount;
+        return NULL;
+    }
+
+    return &myReadings[myReadingIdx++];
+}
+
+
+InputReplayBuffer::InputReplayBuffer(
+        SessionPlayer& player
+        ) :
+    InputBuffer(),
+    myPlayer(player),
+    myPacketData(NULL),
+    myPacketSize(0),
+    myByteBuffer()
+{
+}
+
+InputReplayBuffer::~InputReplayBuffer()
+{
+}
+
+bool
+InputReplayBuffer::readPacket()
+{
+    if (myPlayer.replayPacket(myPacketData, myPacketSize) == false)
+    {
+        myPacketData = NULL;
+        myPacketSize = 0;
+    }
+
+    return (myPacketSize > 0);
+}
+
+std::istream&
+InputReplayBuffer::getInputStream()
+{
+    myByteBuffer.clear();
+    myByteBuffer.str(std::string((const char*)myPacketData, myPacketSize));
+
+    return myByteBuffer;
+}
+
+bool
+InputReplayBuffer::getPacketData(
+        const unsigned char*&   data,
+        size_t&                 dataSize
+        )
+{
+    // Timed out reads are provided as empty packets
+    static const unsigned char noData[1] = {0};
+
+    data = (myPacketData != NULL) ? myPacketData : noData;
+    dataSize = myPacketSize;
+
+    return true;
+}
+
+void
+InputReplayBuffer::clear()
+{
+    myPacketData = NULL;
+    myPacketSize = 0;
+}
+
+
+OutputReplayBuffer::OutputReplayBuffer() :
+    OutputBuffer(),
+    myByteBuffer()
+{
+}
+
+OutputReplayBuffer::~OutputReplayBuffer()
+{
+}
+
+bool
+OutputReplayBuffer::writePacket()
+{
+    myByteBuffer.str("");
+
+    return true;
+}
+
+bool
+OutputReplayBuffer::writeData(
+        const unsigned char*    data,
+        size_t                  dataSize
+        )
+{
+    return true;
+}
+
+std::ostream&
+OutputReplayBuffer::getOutputStream()
+{
+    return myByteBuffer;
+}
+
+void
+OutputReplayBuffer::clear()
+{
+    myByteBuffer.str("");
+}
+
+void
+OutputReplayBuffer::resync()
+{
+}
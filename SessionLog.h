@@ -0,0 +1,540 @@
+#ifndef SESSIONLOG_H
+#define SESSIONLOG_H
+
+#include "FieldControlSystem.h"
+#include "IOBuffer.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+/**
+ * Layout of session logs
+ *
+ * A log starts with an eight-byte identifier and a version byte, followed by
+ * events. Every event starts with its type byte and the time elapsed since
+ * the previous event, or since recording started, in nanoseconds of the
+ * process clock, followed by the event's values. Times and sizes are written
+ * as variable-length integers of seven bits per byte, least significant
+ * first, and floating-point values in host byte order.
+ */
+class SessionLog
+{
+    public:
+
+        /**
+         * File identifier at the start of every log
+         */
+        static const char MAGIC[8];
+
+        /**
+         * Version of the log layout
+         */
+        static const unsigned char VERSION = 1;
+
+        /**
+         * Largest number of bytes of a variable-length integer
+         */
+        static const size_t MAX_VARINT_SIZE = 10;
+
+        /**
+         * Enumeration of event types
+         */
+        enum EventType
+        {
+            EVENT_CYCLE = 0x01,     /**< Program cycle starts */
+            EVENT_MODE = 0x02,      /**< Mode changes, followed by the mode */
+            EVENT_AXIS = 0x03,      /**< Joystick axis is read, followed by
+                                         the port, axis and value */
+            EVENT_BUTTON = 0x04,    /**< Joystick button is read, followed by
+                                         the port, button and value */
+            EVENT_PACKET = 0x05     /**< Packet is read from the robot,
+                                         followed by its size and bytes */
+        };
+
+        /**
+         * Writes a variable-length integer to the given buffer of
+         * MAX_VARINT_SIZE bytes
+         *
+         * \return Number of bytes written
+         */
+        static size_t EncodeVarint(
+                uint64_t        value,
+                unsigned char*  buffer
+                );
+
+        /**
+         * Reads a variable-length integer from the given buffer
+         *
+         * \return Number of bytes read, or 0 if the buffer ends first
+         */
+        static size_t DecodeVarint(
+                const unsigned char*    buffer,
+                size_t                  bufferSize,
+                uint64_t&               value
+                );
+};
+
+/**
+ * Records everything a robot program consumes into a session log
+ *
+ * Mode changes, joystick readings and the packets read from the robot are
+ * recorded with the time they happened at, so that the run can be replayed
+ * offline by a SessionPlayer. Events may be recorded from several threads at
+ * once, such as the robot's I/O thread and the program's.
+ */
+class SessionRecorder
+{
+    public:
+
+        /**
+         * Default constructor
+         */
+        SessionRecorder();
+
+        /**
+         * Destructor
+         *
+         * This closes the log.
+         */
+        ~SessionRecorder();
+
+        /**
+         * Creates or truncates a log and starts recording to it
+         *
+         * \return True if the log was opened, false otherwise
+         */
+        bool open(
+                const char* path
+                );
+
+        /**
+         * Writes out the events recorded and closes the log
+         */
+        void close();
+
+        /**
+         * Indicates if a log is open
+         */
+        bool isOpen() const;
+
+        /**
+         * Records the start of a program cycle
+         */
+        void recordCycle();
+
+        /**
+         * Records a mode change
+         */
+        void recordMode(
+                FieldControlSystem::Mode mode
+                );
+
+        /**
+         * Records the reading of a joystick axis
+         */
+        void recordAxis(
+                int     port,
+                int     axis,
+                float   value
+                );
+
+        /**
+         * Records the reading of a joystick button
+         */
+        void recordButton(
+                int     port,
+                int     button,
+                bool    value
+                );
+
+        /**
+         * Records the bytes of a packet read from the robot
+         *
+         * Reads that timed out are recorded as empty packets.
+         */
+        void recordPacket(
+                const unsigned char*    data,
+                size_t                  dataSize
+                );
+
+        /**
+         * Provides the recorder of the process, or NULL if none is set
+         */
+        static SessionRecorder* GetInstance();
+
+        /**
+         * Sets the recorder of the process
+         *
+         * The recorder must outlive its use, and is unset by setting NULL.
+         */
+        static void SetInstance(
+                SessionRecorder* recorder
+                );
+
+    private:
+
+        /**
+         * Writes an event with the given values
+         */
+        void writeEvent(
+                SessionLog::EventType   type,
+                const unsigned char*    values,
+                size_t                  valuesSize
+                );
+
+        /**
+         * Recorder of the process
+         */
+        static std::atomic<SessionRecorder*> ourInstance;
+
+        /**
+         * Guards the log and the time of the last event
+         */
+        mutable std::mutex myMutex;
+
+        /**
+         * Log being recorded, or NULL
+         */
+        FILE* myFile;
+
+        /**
+         * Time of the last event recorded
+         */
+        long long myLastTime;
+
+        // Disabled copiers
+        SessionRecorder(const SessionRecorder&);
+        SessionRecorder& operator=(const SessionRecorder&);
+};
+
+/**
+ * Plays a recorded session back to a robot program
+ *
+ * The whole log is loaded up front. Cycles are replayed by the caller, while
+ * joystick readings and packets are handed out in the order they were
+ * recorded, as the program asks for them. A program that asks for something
+ * other than what comes next in the log has diverged from the recording;
+ * such requests are answered with neutral values and counted.
+ */
+class SessionPlayer
+{
+    public:
+
+        /**
+         * Recorded program cycle
+         */
+        struct Cycle
+        {
+            /**
+             * Time the cycle started at, in nanoseconds since recording
+             * started
+             */
+            long long time;
+
+            /**
+             * Mode the cycle ran in
+             */
+            FieldControlSystem::Mode mode;
+        };
+
+        /**
+         * Default constructor
+         */
+        SessionPlayer();
+
+        /**
+         * Loads a log, replacing any loaded before
+         *
+         * \return True if the log was loaded, false otherwise
+         */
+        bool load(
+                const char* path
+                );
+
+        /**
+         * Provides the recorded cycles, in order
+         */
+        const std::vector<Cycle>& getCycles() const;
+
+        /**
+         * Provides the next recorded reading of the given joystick axis
+         */
+        float replayAxis(
+                int port,
+                int axis
+                );
+
+        /**
+         * Provides the next recorded reading of the given joystick button
+         */
+        bool replayButton(
+                int port,
+                int button
+                );
+
+        /**
+         * Provides the bytes of the next recorded packet
+         *
+         * \return True if a packet was provided, false if all were
+         */
+        bool replayPacket(
+                const unsigned char*&   data,
+                size_t&                 dataSize
+                );
+
+        /**
+         * Provides the number of recorded packets
+         */
+        size_t getPacketCount() const;
+
+        /**
+         * Provides the number of requests that did not match the recording
+         */
+        unsigned long getMismatchCount() const;
+
+        /**
+         * Starts handing out readings and packets from the beginning again
+         */
+        void rewind();
+
+        /**
+         * Provides the player of the process, or NULL if none is set
+         */
+        static SessionPlayer* GetInstance();
+
+        /**
+         * Sets the player of the process
+         *
+         * While set, joysticks provide the readings of the player in place of
+         * those of the devices. The player must outlive its use, and is unset
+         * by setting NULL.
+         */
+        static void SetInstance(
+                SessionPlayer* player
+                );
+
+    private:
+
+        /**
+         * Recorded joystick reading
+         */
+        struct Reading
+        {
+            /**
+             * Type of the reading's event
+             */
+            SessionLog::EventType type;
+
+            /**
+             * Port of the joystick read
+             */
+            int port;
+
+            /**
+             * Axis or button read
+             */
+            int index;
+
+            /**
+             * Value read, 0 or 1 for buttons
+             */
+            float value;
+        };
+
+        /**
+         * Provides the next reading if it is of the given input
+         *
+         * \return Pointer to the reading, or NULL if the next one is not
+         */
+        const Reading* takeReading(
+                SessionLog::EventType   type,
+                int                     port,
+                int                     index
+                );
+
+        /**
+         * Player of the process
+         */
+        static std::atomic<SessionPlayer*> ourInstance;
+
+        /**
+         * Recorded cycles
+         */
+        std::vector<Cycle> myCycles;
+
+        /**
+         * Recorded joystick readings
+         */
+        std::vector<Reading> myReadings;
+
+        /**
+         * Index of the next reading to hand out
+         */
+        size_t myReadingIdx;
+
+        /**
+         * Bytes of all recorded packets, one after the other
+         *
+         * Packets are kept in a single block so that handing them out never
+         * allocates memory.
+         */
+        std::vector<unsigned char> myPacketData;
+
+        /**
+         * Offsets of the recorded packets in myPacketData, followed by the
+         * size of myPacketData
+         */
+        std::vector<size_t> myPacketOffsets;
+
+        /**
+         * Index of the next packet to hand out
+         */
+        size_t myPacketIdx;
+
+        /**
+         * Number of requests that did not match the recording
+         */
+        unsigned long myMismatchCount;
+
+        // Disabled copiers
+        SessionPlayer(const SessionPlayer&);
+        SessionPlayer& operator=(const SessionPlayer&);
+};
+
+/**
+ * Provides packets recorded in a session to a robot
+ *
+ * Each read takes the next recorded packet, so the robot reads the same
+ * packets in the same order as when the session was recorded. Reads that
+ * timed out then take no packet.
+ */
+class InputReplayBuffer : public InputBuffer
+{
+    public:
+
+        /**
+         * Constructor with player to take packets from
+         */
+        InputReplayBuffer(
+                SessionPlayer& player
+                );
+
+        /**
+         * Destructor
+         */
+        ~InputReplayBuffer();
+
+        /**
+         * Takes the next recorded packet
+         *
+         * \return True if a packet was taken, false if the read timed out
+         * when recorded or all packets were taken
+         */
+        bool readPacket();
+
+        /**
+         * Provides an input stream to read complete packets from
+         */
+        std::istream& getInputStream();
+
+        /**
+         * Provides the bytes of the packet taken without a stream
+         */
+        bool getPacketData(
+                const unsigned char*&   data,
+                size_t&                 dataSize
+                );
+
+        /**
+         * Clears the packet taken from this buffer
+         */
+        void clear();
+
+    private:
+
+        /**
+         * Player to take packets from
+         */
+        SessionPlayer& myPlayer;
+
+        /**
+         * Bytes of the packet taken, held by the player
+         */
+        const unsigned char* myPacketData;
+
+        /**
+         * Number of bytes in myPacketData
+         */
+        size_t myPacketSize;
+
+        /**
+         * Stream adapter over the packet's bytes
+         */
+        std::stringstream myByteBuffer;
+};
+
+/**
+ * Discards the packets written to a replayed robot
+ *
+ * The responses of a replayed robot were recorded, so its requests are not
+ * sent anywhere.
+ */
+class OutputReplayBuffer : public OutputBuffer
+{
+    public:
+
+        /**
+         * Default constructor
+         */
+        OutputReplayBuffer();
+
+        /**
+         * Destructor
+         */
+        ~OutputReplayBuffer();
+
+        /**
+         * Discards the buffered packet
+         *
+         * \return True, as nothing is left to write
+         */
+        bool writePacket();
+
+        /**
+         * Discards a single packet held in memory
+         *
+         * \return True, as nothing is left to write
+         */
+        bool writeData(
+                const unsigned char*    data,
+                size_t                  dataSize
+                );
+
+        /**
+         * Provides an output stream to write complete packets to
+         */
+        std::ostream& getOutputStream();
+
+        /**
+         * Clears the contents of this buffer
+         */
+        void clear();
+
+        /**
+         * Discards a resynchronization sequence
+         */
+        void resync();
+
+    private:
+
+        /**
+         * Buffer for packet bytes
+         */
+        std::stringstream myByteBuffer;
+};
+
+#endif /* ifndef SESSIONLOG_H */
@@ -1,8 +1,8 @@
 #ifndef SUBSYSTEM_H
 #define SUBSYSTEM_H
 
+#include <stddef.h>
 #include <string>
-#include <set>
 
 namespace frc
 {
@@ -12,58 +12,33 @@ namespace frc
   {
   public:
 
+    friend class Scheduler;
+    friend class Command;
+
     Subsystem(const std::string&);
 
     virtual ~Subsystem(){}
 
+    const std::string& GetName() const;
+
     void SetDefaultCommand(Command* command);
 
     virtual void InitDefaultCommand();
 
     virtual void Periodic();
 
-    virtual void ProcessCommands();
-
-    virtual void SetNextCommand(Command*);
-
   protected:
 
     Subsystem();
 
   private:
 
-    Command* myDefaultCommand;
-
-    Command* myCurrentCommand;
-
-    Command* myNextCommand;
-  };
-
-  class DefaultSubsystem : public Subsystem
-  {
-  public:
-
-    static DefaultSubsystem* GetInstance();
-
-    static void DestroyInstance();
-
-  private:
-
-    typedef std::set<Command*> Commands;
-
-    DefaultSubsystem();
+    std::string myName;
 
-    ~DefaultSubsystem();
+    // Index in the scheduler, or Scheduler::MAX_SUBSYSTEMS if not scheduled
+    size_t myIndex;
 
-    void ProcessCommands();
-
-    void SetNextCommand(Command*);
-
-    static DefaultSubsystem* ourInstance;
-
-    Commands myNextCommands;
-
-    Commands myCurrentCommands;
+    Command* myDefaultCommand;
   };
 }; /* namespace frc */
 
@@ -0,0 +1,369 @@
+
+#include "BaseStation.h"
+#include "RedBot.h"
+#include "RedBotPacket.h"
+#include "IterativeRobot.h"
+#include "IOBuffer.h"
+#include "CppUTest/TestHarness.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <thread>
+
+
+/**
+ * Robot firmware stand-in at the other end of a socket pair
+ *
+ * Every request packet is answered with an acknowledgement, as the firmware
+ * does for the connectivity pings of programs without components.
+ */
+class SimulatedLink
+{
+    public:
+
+        SimulatedLink(
+                bool isResponsive = true
+                ) :
+            myIsResponsive(isResponsive)
+        {
+            socketpair(AF_UNIX, SOCK_STREAM, 0, myDescriptors);
+            myThread = std::thread(&SimulatedLink::runFirmware, this);
+        }
+
+        ~SimulatedLink()
+        {
+            // The firmware stops once the robot's end is shut down
+            shutdown(myDescriptors[0], SHUT_RDWR);
+            myThread.join();
+
+            close(myDescriptors[0]);
+            close(myDescriptors[1]);
+        }
+
+        int getDescriptor() const
+        {
+            return myDescriptors[0];
+        }
+
+    private:
+
+        void runFirmware()
+        {
+            unsigned char readData[64];
+            size_t packetSize = 0;
+
+            ssize_t readSize;
+            while ((readSize = read(myDescriptors[1], readData, sizeof(readData))) > 0)
+            {
+                for(
+                        ssize_t byteIdx = 0;
+                        byteIdx < readSize;
+                        ++byteIdx
+                   )
+                {
+                    if (readData[byteIdx] != (unsigned char)Packet::BINARY_BOUND)
+                    {
+                        ++packetSize;
+                        continue;
+                    }
+
+                    if(
+                            (packetSize > 0) &&
+                            (myIsResponsive == true) &&
+                            (write(myDescriptors[1], "\xFF\x82\xFF", 3) != 3)
+                      )
+                    {
+                        return;
+                    }
+                    packetSize = 0;
+                }
+            }
+        }
+
+        bool myIsResponsive;
+
+        int myDescriptors[2];
+
+        std::thread myThread;
+};
+
+/**
+ * Program counting the calls made to it in autonomous and disabled modes
+ */
+class StationRobot : public frc::IterativeRobot
+{
+    public:
+
+        StationRobot() :
+            IterativeRobot(),
+            myDisabledInitCount(0),
+            myDisabledPeriodicCount(0),
+            myAutonomousInitCount(0),
+            myAutonomousPeriodicCount(0)
+        {
+        }
+
+        void DisabledInit()
+        {
+            ++myDisabledInitCount;
+        }
+
+        void DisabledPeriodic()
+        {
+            ++myDisabledPeriodicCount;
+        }
+
+        void AutonomousInit()
+        {
+            ++myAutonomousInitCount;
+        }
+
+        void AutonomousPeriodic()
+        {
+            ++myAutonomousPeriodicCount;
+        }
+
+        unsigned long myDisabledInitCount;
+
+        unsigned long myDisabledPeriodicCount;
+
+        unsigned long myAutonomousInitCount;
+
+        unsigned long myAutonomousPeriodicCount;
+};
+
+/**
+ * Robot driven by a base station under test, with its program and link
+ */
+struct StationEntry
+{
+    StationEntry(
+            bool isResponsive = true
+            ) :
+        link(isResponsive),
+        inputBuffer(link.getDescriptor(), getTimeout(isResponsive)),
+        outputBuffer(link.getDescriptor(), getTimeout(isResponsive)),
+        robot(
+                &program,
+                &inputBuffer,
+                &outputBuffer,
+                new RedBotPacketGenerator()
+             )
+    {
+    }
+
+    /**
+     * Provides the exchange timeout, short for robots that never reply
+     */
+    static unsigned long getTimeout(
+            bool isResponsive
+            )
+    {
+        return (isResponsive ? InputDescriptorBuffer::DEFAULT_TIMEOUT_USEC : 1000);
+    }
+
+    StationRobot program;
+    SimulatedLink link;
+    InputDescriptorBuffer inputBuffer;
+    OutputDescriptorBuffer outputBuffer;
+    RedBot robot;
+};
+
+TEST_GROUP(BaseStation)
+{
+    std::vector<StationEntry*> myEntries;
+
+    void teardown()
+    {
+        for(
+                std::vector<StationEntry*>::const_iterator entryIter = myEntries.begin();
+                entryIter != myEntries.end();
+                ++entryIter
+           )
+        {
+            delete (*entryIter);
+        }
+        myEntries.clear();
+    }
+
+    /**
+     * Adds robots to the given station
+     */
+    void addRobots(
+            BaseStation&    station,
+            size_t          robotCount,
+            bool            isResponsive = true,
+            double          period = 0.0
+            )
+    {
+        for(
+                size_t robotIdx = 0;
+                robotIdx < robotCount;
+                ++robotIdx
+           )
+        {
+            myEntries.push_back(new StationEntry(isResponsive));
+            station.addRobot(&myEntries.back()->robot, period);
+        }
+    }
+
+    /**
+     * Waits until every robot has completed the given number of cycles
+     */
+    void waitForCycles(
+            const BaseStation&  station,
+            unsigned long       cycleCount
+            )
+    {
+        for(
+                size_t robotIdx = 0;
+                robotIdx < station.getRobotCount();
+                ++robotIdx
+           )
+        {
+            while (station.getCycleCount(robotIdx) < cycleCount)
+            {
+                usleep(1000);
+            }
+        }
+    }
+};
+
+TEST(BaseStation, FairnessTest)
+{
+    BaseStation station(1);
+    addRobots(station, 16);
+
+    station.start();
+    waitForCycles(station, 20);
+    station.stop();
+
+    // Robots take turns, so none is ever a cycle ahead of another
+    unsigned long minCycleCount = station.getCycleCount(0);
+    unsigned long maxCycleCount = station.getCycleCount(0);
+    for(
+            size_t robotIdx = 1;
+            robotIdx < station.getRobotCount();
+            ++robotIdx
+       )
+    {
+        minCycleCount = std::min(minCycleCount, station.getCycleCount(robotIdx));
+        maxCycleCount = std::max(maxCycleCount, station.getCycleCount(robotIdx));
+    }
+
+    CHECK(maxCycleCount - minCycleCount <= 1);
+}
+
+TEST(BaseStation, WorkerPoolTest)
+{
+    BaseStation station;
+    addRobots(station, 16);
+
+    CHECK_FALSE(station.isRunning());
+
+    station.start();
+    CHECK_TRUE(station.isRunning());
+
+    waitForCycles(station, 50);
+    station.stop();
+
+    CHECK_FALSE(station.isRunning());
+    CHECK_EQUAL(16, station.getActiveRobotCount());
+    CHECK(station.getThroughput() > 0.0);
+
+    unsigned long totalCycleCount = 0;
+    for(
+            size_t robotIdx = 0;
+            robotIdx < station.getRobotCount();
+            ++robotIdx
+       )
+    {
+        unsigned long cycleCount = station.getCycleCount(robotIdx);
+        totalCycleCount += cycleCount;
+
+        CHECK_EQUAL(RedBot::STATUS_GOOD, myEntries[robotIdx]->robot.getStatus());
+        CHECK_EQUAL(cycleCount, myEntries[robotIdx]->program.myDisabledPeriodicCount);
+    }
+
+    CHECK_EQUAL(totalCycleCount, station.getTotalCycleCount());
+}
+
+TEST(BaseStation, ModeTest)
+{
+    BaseStation station(1);
+    addRobots(station, 2);
+
+    station.setMode(0, FieldControlSystem::MODE_AUTO);
+    CHECK_EQUAL(FieldControlSystem::MODE_AUTO, station.getMode(0));
+    CHECK_EQUAL(FieldControlSystem::MODE_DISABLED, station.getMode(1));
+
+    station.start();
+    waitForCycles(station, 3);
+    station.stop();
+
+    // Each robot is initialized once for its own mode
+    StationRobot& autoProgram = myEntries[0]->program;
+    CHECK_EQUAL(1, autoProgram.myAutonomousInitCount);
+    CHECK_EQUAL(station.getCycleCount(0), autoProgram.myAutonomousPeriodicCount);
+    CHECK_EQUAL(0, autoProgram.myDisabledPeriodicCount);
+
+    StationRobot& disabledProgram = myEntries[1]->program;
+    CHECK_EQUAL(1, disabledProgram.myDisabledInitCount);
+    CHECK_EQUAL(station.getCycleCount(1), disabledProgram.myDisabledPeriodicCount);
+    CHECK_EQUAL(0, disabledProgram.myAutonomousInitCount);
+
+    // Mode changes made while stopped apply once restarted
+    station.setMode(FieldControlSystem::MODE_AUTO);
+    station.start();
+    waitForCycles(station, station.getCycleCount(1) + 1);
+    station.stop();
+
+    CHECK_EQUAL(1, autoProgram.myAutonomousInitCount);
+    CHECK_EQUAL(1, disabledProgram.myAutonomousInitCount);
+    CHECK(disabledProgram.myAutonomousPeriodicCount > 0);
+}
+
+TEST(BaseStation, PeriodTest)
+{
+    BaseStation station;
+    addRobots(station, 2, true, 0.01);
+
+    station.start();
+    usleep(100000);
+    station.stop();
+
+    // Cycles start on deadlines 10 ms apart, the first one right away
+    for(
+            size_t robotIdx = 0;
+            robotIdx < station.getRobotCount();
+            ++robotIdx
+       )
+    {
+        CHECK(station.getCycleCount(robotIdx) >= 2);
+        CHECK(station.getCycleCount(robotIdx) <= 12);
+    }
+}
+
+TEST(BaseStation, RetireTest)
+{
+    BaseStation station(2);
+    addRobots(station, 1);
+    addRobots(station, 1, false);
+
+    station.start();
+    while (station.isRetired(1) == false)
+    {
+        usleep(1000);
+    }
+
+    // The responsive robot keeps running without the other
+    unsigned long cycleCount = station.getCycleCount(0);
+    while (station.getCycleCount(0) <= cycleCount)
+    {
+        usleep(1000);
+    }
+    station.stop();
+
+    CHECK_FALSE(station.isRetired(0));
+    CHECK_EQUAL(1, station.getActiveRobotCount());
+    CHECK_EQUAL(BaseStation::MAX_ERROR_COUNT, station.getCycleCount(1));
+}
@@ -0,0 +1,181 @@
+
+#include "DriverStation.h"
+#include "CppUTest/TestHarness.h"
+#include <stdio.h>
+#include <unistd.h>
+
+
+TEST_GROUP(DriverStation)
+{
+    /**
+     * Provides the port of the given server as a string
+     */
+    std::string getPortString(
+            const DriverStationServer& server
+            )
+    {
+        char portString[8];
+        snprintf(portString, sizeof(portString), "%hu", server.getPort());
+
+        return portString;
+    }
+
+    /**
+     * Waits until the client has received the given number of modes
+     */
+    void waitForUpdates(
+            const DriverStationClient&  client,
+            unsigned long               updateCount
+            )
+    {
+        while (client.getUpdateCount() < updateCount)
+        {
+            std::this_thread::yield();
+        }
+    }
+};
+
+TEST(DriverStation, MessageTest)
+{
+    unsigned char message[DriverStationMessage::SIZE];
+    DriverStationMessage::Type type;
+    unsigned char value = 0;
+
+    DriverStationMessage::Encode(DriverStationMessage::TYPE_MODE, 2, message);
+
+    CHECK_EQUAL(DriverStationMessage::MARKER, message[0]);
+    CHECK_TRUE(DriverStationMessage::Decode(message, type, value));
+    CHECK_EQUAL(DriverStationMessage::TYPE_MODE, type);
+    CHECK_EQUAL(2, value);
+
+    // Text requests of polling clients are not messages
+    CHECK_FALSE(DriverStationMessage::Decode((const unsigned char*)"req", type, value));
+
+    message[1] = 0x7F;
+    CHECK_FALSE(DriverStationMessage::Decode(message, type, value));
+}
+
+TEST(DriverStation, PushTest)
+{
+    DriverStationServer server;
+    DriverStationClient client;
+
+    CHECK_TRUE(server.listen());
+    CHECK(server.getPort() != 0);
+
+    server.setMode(FieldControlSystem::MODE_AUTO);
+
+    CHECK_FALSE(client.isConnected());
+    CHECK_EQUAL(FieldControlSystem::MODE_DISABLED, client.getMode());
+
+    CHECK_TRUE(client.connect("localhost", getPortString(server).c_str()));
+    CHECK_TRUE(client.isConnected());
+
+    // The current mode is given on subscription
+    waitForUpdates(client, 1);
+
+    CHECK_EQUAL(FieldControlSystem::MODE_AUTO, client.getMode());
+    CHECK_EQUAL(1, server.getClientCount());
+
+    // Later changes are pushed
+    server.setMode(FieldControlSystem::MODE_TELEOP);
+    waitForUpdates(client, 2);
+
+    CHECK_EQUAL(FieldControlSystem::MODE_TELEOP, client.getMode());
+
+    // A closed driver station is noticed, and the last mode is kept
+    server.close();
+    while (client.isConnected() == true)
+    {
+        std::this_thread::yield();
+    }
+
+    CHECK_EQUAL(FieldControlSystem::MODE_TELEOP, client.getMode());
+    CHECK_EQUAL(2, client.getUpdateCount());
+}
+
+TEST(DriverStation, DisconnectTest)
+{
+    DriverStationServer server;
+    DriverStationClient client;
+
+    CHECK_TRUE(server.listen());
+    CHECK_TRUE(client.connect("localhost", getPortString(server).c_str()));
+    waitForUpdates(client, 1);
+
+    client.disconnect();
+
+    CHECK_FALSE(client.isConnected());
+
+    // Clients that are gone are dropped once a mode is pushed to them
+    for (int attemptIdx = 0; attemptIdx < 100; attemptIdx++)
+    {
+        server.setMode(FieldControlSystem::MODE_TEST);
+        if (server.getClientCount() == 0)
+        {
+            break;
+        }
+
+        usleep(1000);
+    }
+
+    CHECK_EQUAL(0, server.getClientCount());
+
+    // Nothing listens on the port once the server is closed
+    std::string portString = getPortString(server);
+    server.close();
+
+    CHECK_FALSE(client.connect("localhost", portString.c_str()));
+    CHECK_FALSE(client.isConnected());
+}
+
+TEST(DriverStation, HeartbeatTest)
+{
+    DriverStationServer server;
+    DriverStationClient client;
+
+    server.setHeartbeatInterval(10);
+    client.setTimeout(200);
+
+    CHECK_TRUE(server.listen());
+    CHECK_TRUE(client.connect("localhost", getPortString(server).c_str()));
+
+    // An unchanged mode keeps being sent, so the connection stays up
+    waitForUpdates(client, 5);
+    usleep(300000);
+
+    CHECK_TRUE(client.isConnected());
+    CHECK_EQUAL(FieldControlSystem::MODE_DISABLED, client.getMode());
+
+    server.close();
+}
+
+TEST(DriverStation, SilentServerTest)
+{
+    DriverStationServer server;
+    DriverStationClient client;
+
+    CHECK_EQUAL(
+        3 * DriverStationMessage::HEARTBEAT_INTERVAL_MSEC,
+        client.getTimeout()
+        );
+
+    server.setHeartbeatInterval(0);
+    client.setTimeout(100);
+
+    CHECK_TRUE(server.listen());
+    server.setMode(FieldControlSystem::MODE_TELEOP);
+    CHECK_TRUE(client.connect("localhost", getPortString(server).c_str()));
+    waitForUpdates(client, 1);
+
+    // A driver station that goes silent without closing is taken as gone
+    while (client.isConnected() == true)
+    {
+        std::this_thread::yield();
+    }
+
+    CHECK_EQUAL(FieldControlSystem::MODE_TELEOP, client.getMode());
+    CHECK_EQUAL(1, server.getClientCount());
+
+    server.close();
+}
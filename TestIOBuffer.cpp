@@ -1,7 +1,17 @@
 
 #include "IOBuffer.h"
+#include "SerialPort.h"
 #include "RedBotPacket.h"
+#include "DigitalOutput.h"
+#include "RedBotEncoder.h"
+#include "Clock.h"
 #include "CppUTest/TestHarness.h"
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
 
 
 TEST_GROUP(IOBuffer)
@@ -24,7 +34,7 @@ TEST_GROUP(IOBuffer)
             std::istream& inputStream
             )
     {
-        return Packet::Read(inputStream, myPacketGen);
+        return Packet::Read(inputStream, myPacketGen).release();
     }
 };
 
@@ -236,3 +246,372 @@ TEST(IOBuffer, IOBufferPacketIntegrityTest)
 
     delete inputPacket;
 }
+
+
+TEST_GROUP(DescriptorBuffer)
+{
+    int myMasterFD;
+
+    int mySlaveFD;
+
+    RedBotPacketGenerator myPacketGen;
+
+    void setup()
+    {
+        // Pseudo-terminal pair standing in for a serial link
+        myMasterFD = posix_openpt(O_RDWR | O_NOCTTY);
+        CHECK(myMasterFD >= 0);
+        CHECK_EQUAL(0, grantpt(myMasterFD));
+        CHECK_EQUAL(0, unlockpt(myMasterFD));
+
+        mySlaveFD = open(ptsname(myMasterFD), O_RDWR | O_NOCTTY);
+        CHECK(mySlaveFD >= 0);
+
+        struct termios attributes;
+        tcgetattr(mySlaveFD, &attributes);
+        cfmakeraw(&attributes);
+        tcsetattr(mySlaveFD, TCSANOW, &attributes);
+    }
+
+    void teardown()
+    {
+        Clock::SetInstance(NULL);
+        close(mySlaveFD);
+        close(myMasterFD);
+    }
+
+    void writeMaster(
+            const char* data,
+            size_t      size
+            )
+    {
+        CHECK_EQUAL((ssize_t)size, write(myMasterFD, data, size));
+    }
+
+    Packet* readPacket(
+            std::istream& inputStream
+            )
+    {
+        return Packet::Read(inputStream, myPacketGen).release();
+    }
+
+    long getElapsedUsec(
+            const struct timespec& startTime
+            )
+    {
+        struct timespec endTime;
+        clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+        return
+            ((endTime.tv_sec - startTime.tv_sec) * 1000000) +
+            ((endTime.tv_nsec - startTime.tv_nsec) / 1000);
+    }
+};
+
+TEST(DescriptorBuffer, InputBufferReadTest)
+{
+    InputDescriptorBuffer iBuffer(mySlaveFD);
+
+    // Two packets in a single write, preceded by noise
+    writeMaster("\x05\xFF\x01\xFF\xFF\x82\xFF", 7);
+
+    CHECK(iBuffer.readPacket());
+
+    Packet* packet = readPacket(iBuffer.getInputStream());
+
+    CHECK(packet != NULL);
+    CHECK(NULL != dynamic_cast<PingPacket*>(packet));
+
+    delete packet;
+    iBuffer.clear();
+
+    CHECK(iBuffer.isPacketComplete() == false);
+    CHECK(iBuffer.readPacket());
+
+    packet = readPacket(iBuffer.getInputStream());
+
+    CHECK(packet != NULL);
+    CHECK(NULL != dynamic_cast<AcknowledgePacket*>(packet));
+
+    delete packet;
+}
+
+TEST(DescriptorBuffer, InputBufferCobsReadTest)
+{
+    InputDescriptorBuffer iBuffer(mySlaveFD);
+    iBuffer.setFraming(InputBuffer::FRAMING_COBS);
+
+    // Empty frames are skipped and bounds are ordinary data
+    writeMaster("\x00\x02\x01\x00\x03\x85\xFF\x01\x00", 9);
+
+    const unsigned char* packetData = NULL;
+    size_t packetSize = 0;
+
+    CHECK(iBuffer.readPacket());
+    CHECK(iBuffer.getPacketData(packetData, packetSize));
+
+    PacketHandle packet = Packet::DecodeCobs(packetData, packetSize, myPacketGen);
+
+    CHECK(NULL != dynamic_cast<PingPacket*>(packet.get()));
+
+    packet.reset();
+    iBuffer.clear();
+
+    CHECK(iBuffer.readPacket());
+    CHECK(iBuffer.getPacketData(packetData, packetSize));
+    CHECK_EQUAL(4, packetSize);
+    CHECK_EQUAL(0, memcmp("\x03\x85\xFF\x01", packetData, 4));
+}
+
+TEST(DescriptorBuffer, InputBufferTimeoutTest)
+{
+    InputDescriptorBuffer iBuffer(mySlaveFD, 20000);
+
+    CHECK_EQUAL(20000, iBuffer.getTimeout());
+
+    struct timespec startTime;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    CHECK_FALSE(iBuffer.readPacket());
+
+    long elapsedUsec = getElapsedUsec(startTime);
+    CHECK(elapsedUsec >= 20000);
+    CHECK(elapsedUsec < 500000);
+
+    // A packet split across the deadline completes on the next attempt
+    writeMaster("\xFF\x82", 2);
+
+    CHECK_FALSE(iBuffer.readPacket());
+
+    writeMaster("\xFF", 1);
+
+    CHECK(iBuffer.readPacket());
+
+    Packet* packet = readPacket(iBuffer.getInputStream());
+
+    CHECK(packet != NULL);
+    CHECK(NULL != dynamic_cast<AcknowledgePacket*>(packet));
+
+    delete packet;
+}
+
+TEST(DescriptorBuffer, InputBufferVirtualTimeoutTest)
+{
+    ManualClock clock(5 * Clock::NSEC_PER_SEC);
+    Clock::SetInstance(&clock);
+
+    InputDescriptorBuffer iBuffer(mySlaveFD);
+
+    struct timespec startTime;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    // A timeout on virtual time moves the clock on without waiting
+    CHECK_FALSE(iBuffer.readPacket());
+    CHECK(getElapsedUsec(startTime) < 500000);
+    CHECK_EQUAL(6 * Clock::NSEC_PER_SEC, clock.getTime());
+
+    // Bytes already waiting are taken without moving the clock on
+    writeMaster("\xFF\x82\xFF", 3);
+
+    struct pollfd readable;
+    readable.fd = mySlaveFD;
+    readable.events = POLLIN;
+    CHECK_EQUAL(1, poll(&readable, 1, 1000));
+
+    CHECK(iBuffer.readPacket());
+    CHECK_EQUAL(6 * Clock::NSEC_PER_SEC, clock.getTime());
+}
+
+TEST(DescriptorBuffer, InputBufferResyncTest)
+{
+    InputDescriptorBuffer iBuffer(mySlaveFD, 20000);
+
+    writeMaster("\xFF\xFF\xFF\xFF\xFF", 5);
+
+    CHECK_FALSE(iBuffer.readPacket());
+
+    writeMaster("\x82\xFF", 2);
+
+    CHECK(iBuffer.readPacket());
+
+    Packet* packet = readPacket(iBuffer.getInputStream());
+
+    CHECK(packet != NULL);
+    CHECK(NULL != dynamic_cast<AcknowledgePacket*>(packet));
+
+    delete packet;
+}
+
+TEST(DescriptorBuffer, OutputBufferWriteTest)
+{
+    OutputDescriptorBuffer oBuffer(mySlaveFD);
+    DigitalOutputPacket outputPacket(13, true);
+
+    outputPacket.write(oBuffer.getOutputStream());
+
+    CHECK(oBuffer.isPacketComplete() == false);
+    CHECK(oBuffer.writePacket());
+    CHECK(oBuffer.isPacketComplete());
+
+    oBuffer.clear();
+    oBuffer.resync();
+
+    char writtenData [16];
+    ssize_t writtenSize = 0;
+    while (writtenSize < 10)
+    {
+        ssize_t readCount = read(
+                myMasterFD,
+                writtenData + writtenSize,
+                sizeof(writtenData) - writtenSize
+                );
+        CHECK(readCount > 0);
+        writtenSize += readCount;
+    }
+
+    CHECK_EQUAL(10, writtenSize);
+    CHECK_EQUAL(0, memcmp("\xFF\x02\x0D\x02\xFF\xFF\xFF\xFF\xFF\xFF", writtenData, 10));
+}
+
+TEST(DescriptorBuffer, IOBufferPacketIntegrityTest)
+{
+    OutputDescriptorBuffer oBuffer(myMasterFD);
+    InputDescriptorBuffer iBuffer(mySlaveFD);
+    EncoderCountPacket outputPacket(true, -123456);
+
+    outputPacket.write(oBuffer.getOutputStream());
+    CHECK(oBuffer.writePacket());
+
+    CHECK(iBuffer.readPacket());
+    Packet* inputPacket = readPacket(iBuffer.getInputStream());
+
+    CHECK(inputPacket != NULL);
+    CHECK_EQUAL(outputPacket, *inputPacket);
+
+    delete inputPacket;
+}
+
+
+TEST_GROUP(SerialPort)
+{
+    int myMasterFD;
+
+    void setup()
+    {
+        // Pseudo-terminal standing in for a serial device
+        myMasterFD = posix_openpt(O_RDWR | O_NOCTTY);
+        CHECK(myMasterFD >= 0);
+        CHECK_EQUAL(0, grantpt(myMasterFD));
+        CHECK_EQUAL(0, unlockpt(myMasterFD));
+    }
+
+    void teardown()
+    {
+        close(myMasterFD);
+    }
+};
+
+TEST(SerialPort, RawModeTest)
+{
+    SerialPort port;
+    struct termios attributes;
+
+    CHECK(port.open(ptsname(myMasterFD), O_RDWR, 115200));
+    CHECK(port.isOpen());
+    CHECK_EQUAL(0, tcgetattr(port.getDescriptor(), &attributes));
+
+    CHECK_EQUAL(B115200, cfgetispeed(&attributes));
+    CHECK_EQUAL(B115200, cfgetospeed(&attributes));
+    CHECK_EQUAL(0, attributes.c_lflag & (ICANON | ECHO | ISIG));
+    CHECK_EQUAL(0, attributes.c_iflag & (ICRNL | IXON));
+    CHECK_EQUAL(0, attributes.c_oflag & OPOST);
+    CHECK_EQUAL(0, attributes.c_cc[VMIN]);
+    CHECK_EQUAL(0, attributes.c_cc[VTIME]);
+
+    // Bytes that a cooked terminal would translate pass through unaltered
+    const char data[] = { '\xFF', '\r', '\n', '\x03', '\xFF' };
+    char received[sizeof(data)];
+    CHECK_EQUAL((ssize_t)sizeof(data), write(myMasterFD, data, sizeof(data)));
+    CHECK_EQUAL(
+            (ssize_t)sizeof(data),
+            read(port.getDescriptor(), received, sizeof(received))
+            );
+    CHECK_EQUAL(0, memcmp(data, received, sizeof(data)));
+
+    port.close();
+    CHECK_FALSE(port.isOpen());
+    CHECK_EQUAL(-1, port.getDescriptor());
+}
+
+TEST(SerialPort, BaudRateTest)
+{
+    SerialPort port;
+
+    CHECK(SerialPort::IsSupportedBaudRate(SerialPort::DEFAULT_BAUD_RATE));
+    CHECK(SerialPort::IsSupportedBaudRate(1000000));
+    CHECK_FALSE(SerialPort::IsSupportedBaudRate(12345));
+
+    CHECK_FALSE(port.open(ptsname(myMasterFD), O_RDWR, 12345));
+    CHECK_FALSE(port.isOpen());
+}
+
+TEST(SerialPort, NonTerminalTest)
+{
+    SerialPort port;
+
+    // Devices that are not terminals are opened as they are
+    CHECK(port.open("/dev/null", O_WRONLY));
+    CHECK(port.isOpen());
+}
+
+
+TEST_GROUP(ByteRingBuffer)
+{
+};
+
+TEST(ByteRingBuffer, WrapTest)
+{
+    ByteRingBuffer ring;
+    int pipeFDs[2];
+    unsigned char byte;
+
+    CHECK_EQUAL(0, pipe(pipeFDs));
+
+    // Move the head near the end so that bulk transfers wrap around
+    for(
+            size_t byteIdx = 0;
+            byteIdx < (ByteRingBuffer::CAPACITY - 2);
+            ++byteIdx
+       )
+    {
+        CHECK(ring.push(0));
+        CHECK(ring.pop(byte));
+    }
+
+    CHECK_EQUAL(4, ::write(pipeFDs[1], "\x01\x02\x03\x04", 4));
+    CHECK_EQUAL(4, ring.fill(pipeFDs[0]));
+    CHECK_EQUAL(4, ring.size());
+
+    CHECK_EQUAL(4, ring.drain(pipeFDs[1]));
+    CHECK(ring.empty());
+
+    char readData [4];
+    CHECK_EQUAL(4, ::read(pipeFDs[0], readData, 4));
+    CHECK_EQUAL(0, memcmp("\x01\x02\x03\x04", readData, 4));
+
+    for(
+            size_t byteIdx = 0;
+            byteIdx < ByteRingBuffer::CAPACITY;
+            ++byteIdx
+       )
+    {
+        CHECK(ring.push(byteIdx));
+    }
+
+    CHECK_FALSE(ring.push(0));
+    CHECK(ring.pop(byte));
+    CHECK_EQUAL(0, byte);
+
+    close(pipeFDs[0]);
+    close(pipeFDs[1]);
+}
@@ -1,9 +1,14 @@
 
 #include "IterativeRobot.h"
+#include "TimedRobot.h"
 #include "RedBot.h"
 #include "RedBotPacket.h"
 #include "FieldControlSystem.h"
+#include "RobotContext.h"
+#include "Clock.h"
+#include "DigitalInput.h"
 #include "CppUTest/TestHarness.h"
+#include <thread>
 
 
 TEST_GROUP(IterativeRobot)
@@ -11,6 +16,7 @@ TEST_GROUP(IterativeRobot)
     void teardown()
     {
         FieldControlSystem::DestroyInstance();
+        Clock::SetInstance(NULL);
     }
 };
 
@@ -20,9 +26,12 @@ class CountRobot : public frc::IterativeRobot
 
         size_t myCounts[FieldControlSystem::NUM_MODES];
 
+        size_t myRobotPeriodicCount;
+
     public:
 
-        CountRobot()
+        CountRobot() :
+            myRobotPeriodicCount(0)
         {
             for(
                     size_t countIdx = 0;
@@ -39,6 +48,11 @@ class CountRobot : public frc::IterativeRobot
             return myCounts[mode];
         }
 
+        size_t getRobotPeriodicCount() const
+        {
+            return myRobotPeriodicCount;
+        }
+
         void DisabledPeriodic()
         {
             ++myCounts[FieldControlSystem::MODE_DISABLED];
@@ -53,6 +67,11 @@ class CountRobot : public frc::IterativeRobot
         {
             ++myCounts[FieldControlSystem::MODE_AUTO];
         }
+
+        void RobotPeriodic()
+        {
+            ++myRobotPeriodicCount;
+        }
 };
 
 class MockRedBot : public RedBot
@@ -76,6 +95,32 @@ class MockRedBot : public RedBot
         }
 };
 
+class SensorRobot : public frc::IterativeRobot
+{
+    public:
+
+        frc::DigitalInput leftInput;
+        frc::DigitalInput rightInput;
+
+        SensorRobot() :
+            IterativeRobot(),
+            leftInput(3),
+            rightInput(4)
+        {
+        }
+
+        bool hasOwnComponents()
+        {
+            const Components& components = GetRobotContext().getComponents();
+
+            return (
+                    (components.size() == 2) &&
+                    (components[0] == &leftInput) &&
+                    (components[1] == &rightInput)
+                   );
+        }
+};
+
 TEST(IterativeRobot, BasicTest)
 {
     CountRobot robot;
@@ -129,3 +174,158 @@ TEST(IterativeRobot, BasicFCSTest)
     CHECK_EQUAL(1, robot.getCount(FieldControlSystem::MODE_AUTO));
     CHECK_EQUAL(1, robot.getCount(FieldControlSystem::MODE_DISABLED));
 }
+
+TEST(IterativeRobot, MultiRobotFCSTest)
+{
+    CountRobot firstRobot;
+    MockRedBot firstRedBot(&firstRobot);
+    CountRobot secondRobot;
+    MockRedBot secondRedBot(&secondRobot);
+    FieldControlSystem* fcs = FieldControlSystem::GetInstance();
+    fcs->Register(&firstRedBot);
+    fcs->Register(&secondRedBot);
+    fcs->EnableAutonomous();
+    fcs->Step();
+
+    CHECK_EQUAL(1, firstRobot.getCount(FieldControlSystem::MODE_AUTO));
+    CHECK_EQUAL(1, secondRobot.getCount(FieldControlSystem::MODE_AUTO));
+
+    // Robots that are removed no longer follow the system
+    fcs->Unregister(&firstRedBot);
+    fcs->Step();
+
+    CHECK_EQUAL(1, firstRobot.getCount(FieldControlSystem::MODE_AUTO));
+    CHECK_EQUAL(2, secondRobot.getCount(FieldControlSystem::MODE_AUTO));
+}
+
+TEST(IterativeRobot, RobotPeriodicTest)
+{
+    CountRobot robot;
+    MockRedBot redBot(&robot);
+    FieldControlSystem* fcs = FieldControlSystem::GetInstance();
+    fcs->Register(&redBot);
+
+    fcs->Step();
+
+    CHECK_EQUAL(1, robot.getCount(FieldControlSystem::MODE_DISABLED));
+    CHECK_EQUAL(1, robot.getRobotPeriodicCount());
+
+    fcs->EnableAutonomous();
+    fcs->Step();
+
+    CHECK_EQUAL(1, robot.getCount(FieldControlSystem::MODE_AUTO));
+    CHECK_EQUAL(2, robot.getRobotPeriodicCount());
+}
+
+/**
+ * Builds a program on the calling thread
+ */
+static void
+BuildSensorRobot(
+        SensorRobot** robot
+        )
+{
+    *robot = new SensorRobot();
+}
+
+TEST(IterativeRobot, RobotContextTest)
+{
+    SensorRobot firstRobot;
+    SensorRobot secondRobot;
+
+    // Each program keeps the components built as its members
+    CHECK_TRUE(firstRobot.hasOwnComponents());
+    CHECK_TRUE(secondRobot.hasOwnComponents());
+    POINTERS_EQUAL(&secondRobot.GetRobotContext(), RobotContext::GetCurrent());
+
+    // Programs built at once on different threads are kept apart
+    SensorRobot* threadRobots[4];
+    std::thread threads[4];
+    for(
+            size_t threadIdx = 0;
+            threadIdx < 4;
+            ++threadIdx
+       )
+    {
+        threads[threadIdx] = std::thread(BuildSensorRobot, &threadRobots[threadIdx]);
+    }
+
+    for(
+            size_t threadIdx = 0;
+            threadIdx < 4;
+            ++threadIdx
+       )
+    {
+        threads[threadIdx].join();
+
+        CHECK_TRUE(threadRobots[threadIdx]->hasOwnComponents());
+        delete threadRobots[threadIdx];
+    }
+
+    CHECK_TRUE(secondRobot.hasOwnComponents());
+}
+
+TEST(IterativeRobot, UnregisteredComponentTest)
+{
+    {
+        SensorRobot robot;
+    }
+
+    // Components built outside of any program are not registered
+    POINTERS_EQUAL(NULL, RobotContext::GetCurrent());
+
+    frc::DigitalInput input(5);
+
+    POINTERS_EQUAL(NULL, RobotContext::GetCurrent());
+}
+
+TEST(IterativeRobot, TimedRobotTest)
+{
+    ManualClock clock(1 * Clock::NSEC_PER_SEC);
+    Clock::SetInstance(&clock);
+
+    frc::TimedRobot robot(0.02);
+
+    DOUBLES_EQUAL(0.02, robot.GetPeriod(), 1e-12);
+    DOUBLES_EQUAL(0.02, frc::TimedRobot().GetPeriod(), 1e-12);
+
+    // The first cycle starts right away
+    robot.WaitForNextCycle();
+
+    CHECK_EQUAL(1000000000LL, clock.getTime());
+
+    // Later cycles start on their deadline
+    clock.advance(0.005);
+    robot.WaitForNextCycle();
+
+    CHECK_EQUAL(1020000000LL, clock.getTime());
+    CHECK_EQUAL(0, robot.GetOverrunCount());
+
+    // An overrun starts the next cycle right away and skips missed deadlines
+    clock.advance(0.05);
+    robot.WaitForNextCycle();
+
+    CHECK_EQUAL(1070000000LL, clock.getTime());
+    CHECK_EQUAL(1, robot.GetOverrunCount());
+
+    clock.advance(0.001);
+    robot.WaitForNextCycle();
+
+    CHECK_EQUAL(1080000000LL, clock.getTime());
+    CHECK_EQUAL(1, robot.GetOverrunCount());
+    CHECK_EQUAL(4, robot.GetCycleCount());
+
+    CHECK_EQUAL(3, robot.GetExecutionTimes().getCount());
+    DOUBLES_EQUAL(0.001, robot.GetExecutionTimes().getMin(), 1e-9);
+    DOUBLES_EQUAL(0.05, robot.GetExecutionTimes().getMax(), 1e-9);
+
+    CHECK_EQUAL(4, robot.GetJitters().getCount());
+    DOUBLES_EQUAL(0.0, robot.GetJitters().getMin(), 1e-9);
+    DOUBLES_EQUAL(0.01, robot.GetJitters().getMax(), 1e-9);
+
+    robot.ResetStatistics();
+
+    CHECK_EQUAL(0, robot.GetCycleCount());
+    CHECK_EQUAL(0, robot.GetOverrunCount());
+    CHECK_EQUAL(0, robot.GetJitters().getCount());
+}
@@ -4,12 +4,18 @@
 #include "TestRedBot.h"
 #include "CppUTestExt/GMock.h"
 #include "RedBot.h"
+#include "PacketPool.h"
+#include "Crc.h"
 #include "SmartDashboard.h"
 #include "networktables/NetworkTableInstance.h"
 #include "Command.h"
 #include "CommandGroup.h"
 #include "Subsystem.h"
 #include "Scheduler.h"
+#include "SessionLog.h"
+#include "Diagnostics.h"
+#include <algorithm>
+#include <unistd.h>
 
 
 void
@@ -64,6 +70,18 @@ Exchange(
     }
 }
 
+void
+WaitForTransfers(
+        const RedBot&   robot,
+        unsigned long   transferCount
+        )
+{
+    while (robot.getTransferCount() < transferCount)
+    {
+        std::this_thread::yield();
+    }
+}
+
 TEST(RedBot, CommandTest)
 {
     DigitalOutputRobot program;
@@ -283,19 +301,731 @@ TEST(RedBot, DriveTest)
     myResponsePackets[2] = new AcknowledgePacket();
     myResponsePackets[3] = new AcknowledgePacket();
 
-    Exchange(
-            myRequestPackets,
-            myResponsePackets,
-            myPacketStrings,
-            robot,
-            mode,
-            1
-            );
+    Exchange(
+            myRequestPackets,
+            myResponsePackets,
+            myPacketStrings,
+            robot,
+            mode,
+            1
+            );
+
+    mock().checkExpectations();
+}
+
+TEST(RedBot, SuppressedDriveTest)
+{
+    CruiseRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_TELEOP;
+
+    // Unchanged motor commands are only sent in the first cycle
+    myRequestPackets.resize(6);
+    myRequestPackets[0] = new PingPacket();
+    myRequestPackets[1] = new MotorDrivePacket(
+            MotorDrivePacket::MOTOR_LEFT,
+            255,
+            MotorDrivePacket::DIR_FORWARD
+            );
+    myRequestPackets[2] = new MotorDrivePacket(
+            MotorDrivePacket::MOTOR_RIGHT,
+            255,
+            MotorDrivePacket::DIR_FORWARD
+            );
+    myRequestPackets[3] = new PingPacket();
+    myRequestPackets[4] = new PingPacket();
+    myRequestPackets[5] = new PingPacket();
+
+    myResponsePackets.resize(6);
+    for(
+            size_t packetIdx = 0;
+            packetIdx < myResponsePackets.size();
+            ++packetIdx
+       )
+    {
+        myResponsePackets[packetIdx] = new AcknowledgePacket();
+    }
+
+    Exchange(
+            myRequestPackets,
+            myResponsePackets,
+            myPacketStrings,
+            robot,
+            mode,
+            2
+            );
+
+    mock().checkExpectations();
+}
+
+TEST(RedBot, PipelinedDriveTest)
+{
+    DriveRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+    robot.setPipelineWindow(2);
+
+    CHECK_EQUAL(2, robot.getPipelineWindow());
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_TELEOP;
+
+    myRequestPackets.resize(4);
+    myRequestPackets[0] = new PingPacket();
+    myRequestPackets[1] = new MotorDrivePacket(
+            MotorDrivePacket::MOTOR_LEFT,
+            255,
+            MotorDrivePacket::DIR_FORWARD
+            );
+    myRequestPackets[2] = new MotorDrivePacket(
+            MotorDrivePacket::MOTOR_RIGHT,
+            255,
+            MotorDrivePacket::DIR_FORWARD
+            );
+    myRequestPackets[3] = new PingPacket();
+
+    myResponsePackets.resize(4);
+    myResponsePackets[0] = new AcknowledgePacket();
+    myResponsePackets[1] = new AcknowledgePacket();
+    myResponsePackets[2] = new AcknowledgePacket();
+    myResponsePackets[3] = new AcknowledgePacket();
+
+    Exchange(
+            myRequestPackets,
+            myResponsePackets,
+            myPacketStrings,
+            robot,
+            mode,
+            1
+            );
+
+    mock().checkExpectations();
+    CHECK_EQUAL(2, myMockInputOutputBuffer->getMaxOutstandingCount());
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+
+    robot.setPipelineWindow(0);
+    CHECK_EQUAL(1, robot.getPipelineWindow());
+}
+
+TEST(RedBot, FrameBatchingDriveTest)
+{
+    DriveRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+    robot.setFrameBatching(true);
+
+    CHECK_TRUE(robot.isFrameBatching());
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_TELEOP;
+
+    FramePacket* requestFrame = new FramePacket();
+    requestFrame->add(
+            new MotorDrivePacket(
+                MotorDrivePacket::MOTOR_LEFT,
+                255,
+                MotorDrivePacket::DIR_FORWARD
+                )
+            );
+    requestFrame->add(
+            new MotorDrivePacket(
+                MotorDrivePacket::MOTOR_RIGHT,
+                255,
+                MotorDrivePacket::DIR_FORWARD
+                )
+            );
+
+    FrameValuesPacket* responseFrame = new FrameValuesPacket();
+    responseFrame->add(new AcknowledgePacket());
+    responseFrame->add(new AcknowledgePacket());
+
+    myRequestPackets.resize(2);
+    myRequestPackets[0] = requestFrame;
+    myRequestPackets[1] = new FramePacket();    // Nothing left to send
+
+    myResponsePackets.resize(2);
+    myResponsePackets[0] = responseFrame;
+    myResponsePackets[1] = new FrameValuesPacket();
+
+    Exchange(
+            myRequestPackets,
+            myResponsePackets,
+            myPacketStrings,
+            robot,
+            mode,
+            2
+            );
+
+    mock().checkExpectations();
+    CHECK_EQUAL(1, myMockInputOutputBuffer->getMaxOutstandingCount());
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+}
+
+TEST(RedBot, SteadyStateAllocationTest)
+{
+    AcknowledgingInputOutputBuffer buffer;
+    CruiseRobot program;
+    RedBot robot(
+            &program,
+            &buffer,
+            &buffer,
+            new RedBotPacketGenerator()
+            );
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_TELEOP;
+
+    const size_t warmUpCycles = 2;
+    const size_t numCycles = 10;
+
+    // Send the unchanged motor commands every cycle
+    OutputCache::SetKeepAliveInterval(0);
+
+    robot.modeInit(mode);
+
+    for(
+            size_t cycleIdx = 0;
+            cycleIdx < warmUpCycles;
+            ++cycleIdx
+       )
+    {
+        robot.modePeriodic(mode);
+    }
+
+    size_t writeCount = buffer.getWriteCount();
+    size_t heapAllocationCount = PacketPool::GetHeapAllocationCount();
+    size_t outstandingCount = PacketPool::GetOutstandingCount();
+    size_t operatorNewCount = GetOperatorNewCount();
+
+    for(
+            size_t cycleIdx = warmUpCycles;
+            cycleIdx < numCycles;
+            ++cycleIdx
+       )
+    {
+        robot.modePeriodic(mode);
+    }
+
+    // Taken before the checks, which may allocate themselves
+    size_t cycleOperatorNewCount = GetOperatorNewCount() - operatorNewCount;
+
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+
+    // A ping, both motor commands and the closing ping each cycle
+    CHECK_EQUAL(
+            4 * (numCycles - warmUpCycles),
+            buffer.getWriteCount() - writeCount
+            );
+
+    // Packets come from the pool and are all returned to it each cycle, and
+    // the queues that carry them keep their capacity
+    CHECK_EQUAL(heapAllocationCount, PacketPool::GetHeapAllocationCount());
+    CHECK_EQUAL(outstandingCount, PacketPool::GetOutstandingCount());
+    CHECK_EQUAL(0, cycleOperatorNewCount);
+}
+
+TEST(RedBot, RoutingTest)
+{
+    RoutingRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x81\x06\x01\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x81\x07\x01\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.modePeriodic(mode);
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+
+    // The keyed packet skips the earlier component that would accept it
+    CHECK_EQUAL(1, program.keyed.myProcessedCount);
+    CHECK_EQUAL(1, program.greedy.myProcessedCount);
+}
+
+TEST(RedBot, StreamedSampleTest)
+{
+    RoutingRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    // Pushed samples answer pings in place of an acknowledgement, which also
+    // ends the cycle
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x86\x81\x06\x01\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x86\x81\x07\x01\xFF");
+    robot.modePeriodic(mode);
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+
+    CHECK_EQUAL(1, program.keyed.myProcessedCount);
+    CHECK_EQUAL(1, program.greedy.myProcessedCount);
+}
+
+TEST(RedBot, LinkBudgetTest)
+{
+    BudgetRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+
+    // Room for a single analog request per cycle
+    robot.setLinkBudget(4);
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    // The higher-priority sensor is polled until the other has waited long
+    // enough to overtake it
+    const char* requests[] = {
+        "\xFF\x04\x05\xFF",
+        "\xFF\x04\x05\xFF",
+        "\xFF\x04\x04\xFF",
+        "\xFF\x04\x05\xFF"
+    };
+    const char* responses[] = {
+        "\xFF\x83\x05\x01\x02\xFF",
+        "\xFF\x83\x05\x01\x03\xFF",
+        "\xFF\x83\x04\x01\x04\xFF",
+        "\xFF\x83\x05\x01\x05\xFF"
+    };
+
+    for(
+            size_t cycleIdx = 0;
+            cycleIdx < 4;
+            ++cycleIdx
+       )
+    {
+        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+        mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+        mock().expectOneCall("sendString").withParameter("outputString", requests[cycleIdx]);
+        mock().expectOneCall("receiveString").andReturnValue(responses[cycleIdx]);
+        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+        mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+        robot.modePeriodic(mode);
+
+        mock().checkExpectations();
+    }
+
+    // Responses are dispatched at the start of the following cycle
+    CHECK_EQUAL(3, program.lineSensor.GetValue());
+    CHECK_EQUAL(2, program.rangeSensor.GetValue());
+}
+
+TEST(RedBot, UnrecognizedPacketTest)
+{
+    frc::IterativeRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+    std::list<std::string> sentStrings;
+    std::list<std::string> receivedStrings;
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+
+    robot.getLastBinaryTransaction(
+            sentStrings,
+            receivedStrings
+            );
+
+    STRCMP_EQUAL("\xFF\x01\xFF", sentStrings.front().c_str());
+    STRCMP_EQUAL("\xFF\x82\xFF", receivedStrings.front().c_str());
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x8F\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(RedBot::STATUS_INCOHERENT, robot.getStatus());
+
+    robot.getLastBinaryTransaction(
+            sentStrings,
+            receivedStrings
+            );
+
+    STRCMP_EQUAL("\xFF\x01\xFF", sentStrings.front().c_str());
+    STRCMP_EQUAL("\xFF\x8F", receivedStrings.front().c_str());
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x81\x0A\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(RedBot::STATUS_INCOHERENT, robot.getStatus());
+
+    robot.getLastBinaryTransaction(
+            sentStrings,
+            receivedStrings
+            );
+
+    STRCMP_EQUAL("\xFF\x01\xFF", sentStrings.front().c_str());
+    BPACKET_EQUAL("\xFF\x81\x0A\xFF", receivedStrings.front().c_str());
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+
+    robot.getLastBinaryTransaction(
+            sentStrings,
+            receivedStrings
+            );
+
+    STRCMP_EQUAL("\xFF\x01\xFF", sentStrings.front().c_str());
+    STRCMP_EQUAL("\xFF\x82\xFF", receivedStrings.front().c_str());
+}
+
+TEST(RedBot, TraceTest)
+{
+    frc::IterativeRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+    const char* faultTracePath = "/tmp/TestRedBotFault.trace";
+    TraceRing::Record record;
+
+    unlink(faultTracePath);
+    robot.setFaultTraceFile(faultTracePath);
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    uint64_t recordCount = robot.getTrace().getRecordCount();
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(recordCount + 4, robot.getTrace().getRecordCount());
+
+    // Good exchanges leave no fault trace
+    CHECK(access(faultTracePath, F_OK) != 0);
+
+    CHECK_TRUE(robot.getTrace().getRecord(recordCount, record));
+    CHECK_EQUAL(TraceRing::DIRECTION_SENT, record.direction);
+    BPACKET_EQUAL("\xFF\x01\xFF", std::string((const char*)record.data, record.getDataSize()).c_str());
+
+    CHECK_TRUE(robot.getTrace().getRecord(recordCount + 1, record));
+    CHECK_EQUAL(TraceRing::DIRECTION_RECEIVED, record.direction);
+    CHECK_EQUAL(RedBot::STATUS_GOOD, record.status);
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x8F\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(RedBot::STATUS_INCOHERENT, robot.getStatus());
+
+    // The failed exchange is traced with the status it led to
+    CHECK_TRUE(robot.getTrace().getRecord(robot.getTrace().getRecordCount() - 1, record));
+    CHECK_EQUAL(TraceRing::DIRECTION_RECEIVED, record.direction);
+    CHECK_EQUAL(RedBot::STATUS_INCOHERENT, record.status);
+
+    CHECK_EQUAL(0, access(faultTracePath, F_OK));
+    unlink(faultTracePath);
+}
+
+TEST(RedBot, DiagnosticsLevelTest)
+{
+    frc::IterativeRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+    TraceRing::Record record;
+
+    Diagnostics::SetLevel(Diagnostics::LEVEL_ERRORS);
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    uint64_t recordCount = robot.getTrace().getRecordCount();
+
+    // Good exchanges are not traced with errors only
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(recordCount, robot.getTrace().getRecordCount());
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x8F\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(recordCount + 1, robot.getTrace().getRecordCount());
+    CHECK_TRUE(robot.getTrace().getRecord(recordCount, record));
+    CHECK_EQUAL(TraceRing::DIRECTION_RECEIVED, record.direction);
+    CHECK_EQUAL(RedBot::STATUS_INCOHERENT, record.status);
+
+    // Corrupt responses are still told from missing ones without diagnostics
+    Diagnostics::SetLevel(Diagnostics::LEVEL_OFF);
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x8F\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(RedBot::STATUS_INCOHERENT, robot.getStatus());
+}
+
+TEST(RedBot, SessionReplayTest)
+{
+    frc::IterativeRobot program;
+    const char* logPath = "/tmp/TestRedBotSession.log";
+    SessionRecorder recorder;
+    SessionPlayer player;
+
+    CHECK_TRUE(recorder.open(logPath));
+
+    // Packets are recorded whole whatever the diagnostics level
+    Diagnostics::SetLevel(Diagnostics::LEVEL_OFF);
+
+    {
+        RedBot robot(
+                &program,
+                myMockInputOutputBuffer,
+                myMockInputOutputBuffer,
+                new RedBotPacketGenerator()
+                );
+        robot.setSessionRecorder(&recorder);
+
+        FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+        robot.modeInit(mode);
+
+        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+        mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+        mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+        recorder.recordCycle();
+        robot.modePeriodic(mode);
+
+        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+        mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+        mock().expectOneCall("receiveString").andReturnValue("\xFF\x8F\xFF");
+        recorder.recordCycle();
+        robot.modePeriodic(mode);
+
+        mock().checkExpectations();
+        CHECK_EQUAL(RedBot::STATUS_INCOHERENT, robot.getStatus());
+    }
+
+    recorder.close();
+    CHECK_TRUE(player.load(logPath));
+    unlink(logPath);
+
+    CHECK_EQUAL(2, player.getCycles().size());
+    CHECK_EQUAL(4, player.getPacketCount());
+
+    // The replayed robot reads what the recorded one read, without a link
+    InputReplayBuffer inputBuffer(player);
+    OutputReplayBuffer outputBuffer;
+    RedBot robot(
+            &program,
+            &inputBuffer,
+            &outputBuffer,
+            new RedBotPacketGenerator()
+            );
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    robot.modePeriodic(mode);
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+
+    robot.modePeriodic(mode);
+    CHECK_EQUAL(RedBot::STATUS_INCOHERENT, robot.getStatus());
+    CHECK_EQUAL(0, player.getMismatchCount());
+}
+
+TEST(RedBot, UnresponsiveTest)
+{
+    frc::IterativeRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+
+    for (int i = 0; i < 5; i++)
+    {
+        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+        mock().expectOneCall("receiveString").andReturnValue("");
+    }
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(RedBot::STATUS_UNRESPONSIVE, robot.getStatus());
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+}
+
+TEST(RedBot, ResyncTest)
+{
+    frc::IterativeRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\xFF\xFF\xFF\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+
+    robot.resync();
+
+    mock().checkExpectations();
+}
+
+TEST(RedBot, ProtocolNegotiationTest)
+{
+    frc::IterativeRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+
+    robot.setMaxProtocolVersion(Packet::PROTOCOL_COBS);
+    CHECK_EQUAL(Packet::PROTOCOL_BOUNDED, robot.getProtocolVersion());
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    // Version is requested in the bounded protocol, then packets are COBS framed
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x0B\x02\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x87\x02\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\x02\x01");
+    mock().expectOneCall("receiveString").andReturnValue("\x02\x82");
+    mock().expectOneCall("sendString").withParameter("outputString", "\x02\x01");
+    mock().expectOneCall("receiveString").andReturnValue("\x02\x82");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(Packet::PROTOCOL_COBS, robot.getProtocolVersion());
+    CHECK_EQUAL(InputBuffer::FRAMING_COBS, myMockInputOutputBuffer->getFraming());
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+
+    // Resynchronizing falls back to the bounded protocol and negotiates again
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\xFF\xFF\xFF\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.resync();
+
+    mock().checkExpectations();
+    CHECK_EQUAL(Packet::PROTOCOL_BOUNDED, robot.getProtocolVersion());
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x0B\x02\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x87\x02\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\x02\x01");
+    mock().expectOneCall("receiveString").andReturnValue("\x02\x82");
+    mock().expectOneCall("sendString").withParameter("outputString", "\x02\x01");
+    mock().expectOneCall("receiveString").andReturnValue("\x02\x82");
+    robot.modePeriodic(mode);
 
     mock().checkExpectations();
+    CHECK_EQUAL(Packet::PROTOCOL_COBS, robot.getProtocolVersion());
 }
 
-TEST(RedBot, UnrecognizedPacketTest)
+TEST(RedBot, LegacyProtocolTest)
 {
     frc::IterativeRobot program;
     RedBot robot(
@@ -304,14 +1034,22 @@ TEST(RedBot, UnrecognizedPacketTest)
             myMockInputOutputBuffer,
             new RedBotPacketGenerator()
             );
-    std::list<std::string> sentStrings;
-    std::list<std::string> receivedStrings;
+
+    robot.setMaxProtocolVersion(Packet::PROTOCOL_COBS);
 
     FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
     robot.modeInit(mode);
 
-    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+    // Firmware without negotiation acknowledges the unknown request
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x0B\x02\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.modePeriodic(mode);
 
+    // Negotiation is not repeated
     mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
     mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
     mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
@@ -319,69 +1057,150 @@ TEST(RedBot, UnrecognizedPacketTest)
     robot.modePeriodic(mode);
 
     mock().checkExpectations();
-    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+    CHECK_EQUAL(Packet::PROTOCOL_BOUNDED, robot.getProtocolVersion());
+    CHECK_EQUAL(InputBuffer::FRAMING_BOUNDED, myMockInputOutputBuffer->getFraming());
+}
 
-    robot.getLastBinaryTransaction(
-            sentStrings,
-            receivedStrings
+TEST(RedBot, ThreadedIOTest)
+{
+    DigitalInputRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
             );
 
-    STRCMP_EQUAL("\xFF\x01\xFF", sentStrings.front().c_str());
-    STRCMP_EQUAL("\xFF\x82\xFF", receivedStrings.front().c_str());
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    robot.setThreadedIO(true);
+    CHECK_TRUE(robot.isThreadedIO());
 
+    // Pin configuration
     mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
     mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x05\x06\x02\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x84\x06\x02\xFF");
     mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
-    mock().expectOneCall("receiveString").andReturnValue("\xFF\x8F\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+
+    // Get pin value
+    for (int i = 0; i < 2; i++)
+    {
+        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+        mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x03\x06\xFF");
+        mock().expectOneCall("receiveString").andReturnValue("\xFF\x81\x06\x02\xFF");
+        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+        mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    }
+
     robot.modePeriodic(mode);
+    WaitForTransfers(robot, 1);
 
-    mock().checkExpectations();
-    CHECK_EQUAL(RedBot::STATUS_INCOHERENT, robot.getStatus());
+    CHECK_FALSE(program.getValue());
 
-    robot.getLastBinaryTransaction(
-            sentStrings,
-            receivedStrings
-            );
+    robot.modePeriodic(mode);
+    WaitForTransfers(robot, 2);
 
-    STRCMP_EQUAL("\xFF\x01\xFF", sentStrings.front().c_str());
-    STRCMP_EQUAL("\xFF\x8F", receivedStrings.front().c_str());
+    CHECK_FALSE(program.getValue());
 
-    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
-    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
-    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
-    mock().expectOneCall("receiveString").andReturnValue("\xFF\x81\x0A\xFF");
+    // The value received in the background is dispatched before user code
     robot.modePeriodic(mode);
 
+    CHECK_TRUE(program.getValue());
+
+    // Stopping waits for the transfer asked for
+    robot.setThreadedIO(false);
+    CHECK_FALSE(robot.isThreadedIO());
+    CHECK_EQUAL(3, robot.getTransferCount());
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+
     mock().checkExpectations();
-    CHECK_EQUAL(RedBot::STATUS_INCOHERENT, robot.getStatus());
+}
 
-    robot.getLastBinaryTransaction(
-            sentStrings,
-            receivedStrings
+TEST(RedBot, ThreadedBacklogTest)
+{
+    // Each transfer takes several milliseconds, far longer than a cycle
+    AcknowledgingInputOutputBuffer buffer(2000);
+    CruiseRobot program;
+    RedBot robot(
+            &program,
+            &buffer,
+            &buffer,
+            new RedBotPacketGenerator()
             );
 
-    STRCMP_EQUAL("\xFF\x01\xFF", sentStrings.front().c_str());
-    BPACKET_EQUAL("\xFF\x81\x0A\xFF", receivedStrings.front().c_str());
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_TELEOP;
+
+    // Send the unchanged motor commands every cycle
+    OutputCache::SetKeepAliveInterval(0);
+
+    robot.modeInit(mode);
+    robot.setThreadedIO(true);
+
+    // Cycles that outrun the link do not queue more than a cycle's requests
+    size_t maxPendingCount = 0;
+    for(
+            size_t cycleIdx = 0;
+            cycleIdx < 100;
+            ++cycleIdx
+       )
+    {
+        robot.modePeriodic(mode);
+        maxPendingCount = std::max(maxPendingCount, robot.getPendingPacketCount());
+    }
 
+    robot.setThreadedIO(false);
+
+    CHECK(robot.getTransferCount() < 100);
+    CHECK(maxPendingCount <= 2);
+    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+}
+
+TEST(RedBot, ThreadedRecoverTest)
+{
+    RoutingRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    robot.setThreadedIO(true);
+
+    // The resync is carried out by the thread, before the next transfer
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\xFF\xFF\xFF\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("");
     mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
-    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x81\x06\x01\xFF");
     mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
     mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.resync();
     robot.modePeriodic(mode);
 
+    // Packets received before the thread stopped are dispatched afterwards
+    robot.setThreadedIO(false);
+
     mock().checkExpectations();
-    CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+    CHECK_EQUAL(0, program.keyed.myProcessedCount);
 
-    robot.getLastBinaryTransaction(
-            sentStrings,
-            receivedStrings
-            );
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    robot.modePeriodic(mode);
 
-    STRCMP_EQUAL("\xFF\x01\xFF", sentStrings.front().c_str());
-    STRCMP_EQUAL("\xFF\x82\xFF", receivedStrings.front().c_str());
+    mock().checkExpectations();
+    CHECK_EQUAL(1, program.keyed.myProcessedCount);
 }
 
-TEST(RedBot, UnresponsiveTest)
+TEST(RedBot, ChecksumRetryTest)
 {
     frc::IterativeRobot program;
     RedBot robot(
@@ -391,34 +1210,113 @@ TEST(RedBot, UnresponsiveTest)
             new RedBotPacketGenerator()
             );
 
+    robot.setChecksumType(Crc::TYPE_CRC16);
+    CHECK_EQUAL(Crc::TYPE_NONE, robot.getActiveChecksumType());
+
     FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
     robot.modeInit(mode);
 
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x0C\x02\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x88\x02\xFF");
+
+    // A response that fails its checksum is asked for again
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3B\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
+
+    // So is a request that the robot reports corrupted
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x89\x03\x42\x51\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+    CHECK_EQUAL(Crc::TYPE_CRC16, robot.getActiveChecksumType());
     CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+    CHECK_EQUAL(2, robot.getRetransmitCount());
 
-    for (int i = 0; i < 5; i++)
+    // Retries are bounded
+    robot.setMaxRetries(1);
+
+    for (int i = 0; i < 2; i++)
     {
-        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
-        mock().expectOneCall("receiveString").andReturnValue("");
+        mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+        mock().expectOneCall("receiveString").andReturnValue("\xFF\x89\x03\x42\x51\xFF");
     }
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
     robot.modePeriodic(mode);
 
     mock().checkExpectations();
-    CHECK_EQUAL(RedBot::STATUS_UNRESPONSIVE, robot.getStatus());
+    CHECK_EQUAL(3, robot.getRetransmitCount());
+}
 
-    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
-    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
-    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\xFF");
-    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+TEST(RedBot, PipelinedRetryTest)
+{
+    DriveRobot program;
+    RedBot robot(
+            &program,
+            myMockInputOutputBuffer,
+            myMockInputOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+    robot.setPipelineWindow(2);
+    robot.setChecksumType(Crc::TYPE_CRC16);
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_TELEOP;
+    robot.modeInit(mode);
+
+    unsigned char buffer[Packet::MAX_BINARY_SIZE];
+
+    MotorDrivePacket leftPacket(
+            MotorDrivePacket::MOTOR_LEFT,
+            255,
+            MotorDrivePacket::DIR_FORWARD
+            );
+    std::string leftString(
+            (const char*)buffer,
+            leftPacket.encodeChecked(buffer, sizeof(buffer), Crc::TYPE_CRC16)
+            );
+
+    MotorDrivePacket rightPacket(
+            MotorDrivePacket::MOTOR_RIGHT,
+            255,
+            MotorDrivePacket::DIR_FORWARD
+            );
+    std::string rightString(
+            (const char*)buffer,
+            rightPacket.encodeChecked(buffer, sizeof(buffer), Crc::TYPE_CRC16)
+            );
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x0C\x02\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x88\x02\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
+
+    // The rejected left request is sent again behind the outstanding right one
+    mock().expectOneCall("sendString").withParameter("outputString", leftString.c_str());
+    mock().expectOneCall("sendString").withParameter("outputString", rightString.c_str());
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x89\x03\x42\x51\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", leftString.c_str());
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
     robot.modePeriodic(mode);
 
     mock().checkExpectations();
+    CHECK_EQUAL(1, robot.getRetransmitCount());
     CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
 }
 
-TEST(RedBot, ResyncTest)
+TEST(RedBot, RecoverTest)
 {
-    frc::IterativeRobot program;
+    RoutingRobot program;
     RedBot robot(
             &program,
             myMockInputOutputBuffer,
@@ -426,29 +1324,66 @@ TEST(RedBot, ResyncTest)
             new RedBotPacketGenerator()
             );
 
+    // Without a checksum, recovering resynchronizes
     mock().expectOneCall("sendString").withParameter("outputString", "\xFF\xFF\xFF\xFF\xFF");
-    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("");
+    robot.recover();
 
-    robot.resync();
+    mock().checkExpectations();
+
+    robot.setChecksumType(Crc::TYPE_CRC16);
+
+    FieldControlSystem::Mode mode = FieldControlSystem::MODE_DISABLED;
+    robot.modeInit(mode);
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x0C\x02\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x88\x02\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
+    robot.modePeriodic(mode);
+
+    mock().checkExpectations();
+
+    // With a checksum, corrupted data is skipped and intact packets are kept
+    // without resetting the robot
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x81\x06\x01\x01\x74\x72\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x81\x06\x01\x01\x74\x71\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x81\x07\x01\x01\x12\x40\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("");
+    robot.recover();
+
+    mock().checkExpectations();
+    CHECK_EQUAL(Crc::TYPE_CRC16, robot.getActiveChecksumType());
+
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
+    mock().expectOneCall("sendString").withParameter("outputString", "\xFF\x01\x03\x63\x51\xFF");
+    mock().expectOneCall("receiveString").andReturnValue("\xFF\x82\x01\x20\x3A\xFF");
+    robot.modePeriodic(mode);
 
     mock().checkExpectations();
+    // The greedy component also takes the acknowledgement to the first
+    // connectivity check
+    CHECK_EQUAL(1, program.keyed.myProcessedCount);
+    CHECK_EQUAL(2, program.greedy.myProcessedCount);
 }
 
 TEST(Timer, BasicTest)
 {
-    MockTimer timer(MockTimeAccessor);
-    MockTime.tv_sec = 0;
-    MockTime.tv_nsec = 0;
+    frc::Timer timer;
+    myClock.setTime(0);
 
     CHECK_EQUAL(0.0, timer.Get());
 
     timer.Start();
-    MockTime.tv_sec = 1;
+    myClock.setTime(1 * Clock::NSEC_PER_SEC);
 
     CHECK_EQUAL(1.0, timer.Get());
 
     timer.Stop();
-    MockTime.tv_sec = 2;
+    myClock.setTime(2 * Clock::NSEC_PER_SEC);
 
     CHECK_EQUAL(1.0, timer.Get());
 
@@ -457,7 +1392,7 @@ TEST(Timer, BasicTest)
     CHECK_EQUAL(1.0, timer.Get());
     CHECK_FALSE(timer.HasPeriodPassed(1.25));
 
-    MockTime.tv_nsec = 5e8;
+    myClock.advance(0.5);
 
     CHECK_EQUAL(1.5, timer.Get());
     CHECK_TRUE(timer.HasPeriodPassed(1.25));
@@ -471,6 +1406,27 @@ TEST(Timer, BasicTest)
     CHECK_EQUAL(0.0, timer.Get());
 }
 
+TEST(Timer, ClockTest)
+{
+    // Timestamps follow the clock in use, which sleeping moves straight on
+    DOUBLES_EQUAL(0.0, frc::Timer::GetFPGATimestamp(), 0.0);
+
+    myClock.sleepUntil(3 * Clock::NSEC_PER_SEC);
+
+    DOUBLES_EQUAL(3.0, frc::Timer::GetFPGATimestamp(), 0.0);
+
+    // Sleeping never moves the time back
+    myClock.sleepUntil(1 * Clock::NSEC_PER_SEC);
+
+    DOUBLES_EQUAL(3.0, frc::Timer::GetFPGATimestamp(), 0.0);
+
+    // The monotonic clock is back in use once the clock is removed
+    Clock::SetInstance(NULL);
+
+    CHECK_TRUE(Clock::GetInstance().isRealTime());
+    CHECK(frc::Timer::GetFPGATimestamp() > 0.0);
+}
+
 TEST_GROUP(SmartDashboard)
 {
   nt::NetworkTableInstance ntInst;
@@ -558,10 +1514,23 @@ TEST_GROUP(Commands)
   void teardown()
   {
     frc::Scheduler::DestroyInstance();
+    Clock::SetInstance(NULL);
     MemoryLeakWarningPlugin::turnOnNewDeleteOverloads();
   }
 };
 
+TEST(Commands, ExistingSchedulerTest)
+{
+  frc::Scheduler::DestroyInstance();
+
+  // Looking for the scheduler does not create it
+  POINTERS_EQUAL(NULL, frc::Scheduler::GetExistingInstance());
+  POINTERS_EQUAL(NULL, frc::Scheduler::GetExistingInstance());
+
+  frc::Scheduler* scheduler = frc::Scheduler::GetInstance();
+  POINTERS_EQUAL(scheduler, frc::Scheduler::GetExistingInstance());
+}
+
 class MockSubsystem : public frc::Subsystem
 {
 public:
@@ -918,3 +1887,97 @@ TEST(Commands, StartOnceNoSubsystem)
   mockCommand.Start();
   frc::Scheduler::GetInstance()->Run();
 }
+
+TEST(Commands, MultipleRequirements)
+{
+  MockSubsystem mockSubsystem1;
+  MockSubsystem mockSubsystem2;
+  MockCommand mockCommand1(&mockSubsystem1);
+  MockCommand mockCommand2(&mockSubsystem2);
+  MockCommand mockCommand3(&mockSubsystem1);
+
+  mockCommand3.Requires(&mockSubsystem2);
+
+  EXPECT_CALL(mockSubsystem1, InitDefaultCommand());
+  EXPECT_CALL(mockSubsystem2, InitDefaultCommand());
+
+  {
+    ::testing::InSequence s;
+
+    EXPECT_CALL(mockCommand1, Initialize());
+    EXPECT_CALL(mockCommand2, Initialize());
+    EXPECT_CALL(mockCommand1, Execute());
+    EXPECT_CALL(mockCommand1, IsFinished())
+      .WillOnce(Return(false));
+    EXPECT_CALL(mockCommand2, Execute());
+    EXPECT_CALL(mockCommand2, IsFinished())
+      .WillOnce(Return(false));
+
+    EXPECT_CALL(mockCommand1, Interrupted());
+    EXPECT_CALL(mockCommand2, Interrupted());
+    EXPECT_CALL(mockCommand3, Initialize());
+    EXPECT_CALL(mockCommand3, Execute());
+    EXPECT_CALL(mockCommand3, IsFinished())
+      .WillOnce(Return(true));
+    EXPECT_CALL(mockCommand3, End());
+  }
+
+  mockCommand1.Start();
+  mockCommand2.Start();
+  frc::Scheduler::GetInstance()->Run();
+  mockCommand3.Start();
+  frc::Scheduler::GetInstance()->Run();
+
+  CHECK_FALSE(mockCommand1.IsRunning());
+  CHECK_FALSE(mockCommand3.IsRunning());
+}
+
+class TimedCommand : public frc::Command
+{
+public:
+
+  TimedCommand(ManualClock& clock) :
+    myClock(clock)
+  {
+  }
+
+protected:
+
+  void Execute()
+  {
+    myClock.advance(0.002);
+  }
+
+  bool IsFinished()
+  {
+    myClock.advance(0.001);
+    return false;
+  }
+
+private:
+
+  ManualClock& myClock;
+};
+
+TEST(Commands, Timing)
+{
+  ManualClock clock;
+  TimedCommand command1(clock);
+  TimedCommand command2(clock);
+
+  Clock::SetInstance(&clock);
+
+  command1.Start();
+  command2.Start();
+  frc::Scheduler::GetInstance()->Run();
+  frc::Scheduler::GetInstance()->Run();
+
+  CHECK_EQUAL(2, command1.GetExecuteTimes().getCount());
+  DOUBLES_EQUAL(0.002, command1.GetExecuteTimes().getMax(), 1e-9);
+  CHECK_EQUAL(2, command2.GetIsFinishedTimes().getCount());
+  DOUBLES_EQUAL(0.001, command2.GetIsFinishedTimes().getMean(), 1e-9);
+
+  const LatencyHistogram& runTimes = frc::Scheduler::GetInstance()->GetRunTimes();
+  CHECK_EQUAL(2, runTimes.getCount());
+  DOUBLES_EQUAL(0.006, runTimes.getMax(), 1e-9);
+}
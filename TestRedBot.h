@@ -4,14 +4,18 @@
 #include "IterativeRobot.h"
 #include "DigitalOutput.h"
 #include "DigitalInput.h"
+#include "AnalogInput.h"
 #include "RobotDrive.h"
 #include "RedBotSpeedController.h"
 #include "Timer.h"
+#include "Clock.h"
 #include "IOBuffer.h"
 #include "FieldControlSystem.h"
+#include "Diagnostics.h"
 #include "TestUtils.h"
 #include "CppUTestExt/MockSupport.h"
 #include <stdio.h>
+#include <unistd.h>
 #include <vector>
 #include <list>
 
@@ -23,7 +27,9 @@ class MockInputOutputBuffer : public InputBuffer, public OutputBuffer
 
         MockInputOutputBuffer() :
             InputBuffer(),
-            OutputBuffer()
+            OutputBuffer(),
+            myOutstandingCount(0),
+            myMaxOutstandingCount(0)
         {
         }
 
@@ -46,15 +52,28 @@ class MockInputOutputBuffer : public InputBuffer, public OutputBuffer
         bool readPacket()
         {
             myStream.str(receiveString());
+            if (myOutstandingCount > 0)
+            {
+                --myOutstandingCount;
+            }
             return false;
         }
 
         bool writePacket()
         {
             sendString(myStream.str().c_str());
+            if (++myOutstandingCount > myMaxOutstandingCount)
+            {
+                myMaxOutstandingCount = myOutstandingCount;
+            }
             return false;
         }
 
+        size_t getMaxOutstandingCount() const
+        {
+            return myMaxOutstandingCount;
+        }
+
         bool isPacketComplete() const
         {
             return true;
@@ -92,6 +111,106 @@ class MockInputOutputBuffer : public InputBuffer, public OutputBuffer
     private:
 
         std::stringstream myStream;
+
+        size_t myOutstandingCount;
+
+        size_t myMaxOutstandingCount;
+};
+
+/**
+ * Buffer that answers every request with an acknowledgement
+ *
+ * The acknowledgement is provided from memory and requests are only counted,
+ * so exchanges through this buffer allocate nothing of their own. Reads may
+ * be delayed to stand for a slow link.
+ */
+class AcknowledgingInputOutputBuffer : public InputBuffer, public OutputBuffer
+{
+    public:
+
+        AcknowledgingInputOutputBuffer(
+                unsigned int readDelay = 0  /**< Microseconds each read takes */
+                ) :
+            InputBuffer(),
+            OutputBuffer(),
+            myAcknowledgeSize(0),
+            myReadDelay(readDelay),
+            myWriteCount(0)
+        {
+            myAcknowledgeSize = AcknowledgePacket().encode(
+                    myAcknowledgeData,
+                    sizeof(myAcknowledgeData)
+                    );
+        }
+
+        bool readPacket()
+        {
+            if (myReadDelay > 0)
+            {
+                usleep(myReadDelay);
+            }
+            return true;
+        }
+
+        bool getPacketData(
+                const unsigned char*&   data,
+                size_t&                 dataSize
+                )
+        {
+            data = myAcknowledgeData;
+            dataSize = myAcknowledgeSize;
+            return true;
+        }
+
+        bool writePacket()
+        {
+            ++myWriteCount;
+            return true;
+        }
+
+        bool writeData(
+                const unsigned char*    data,
+                size_t                  dataSize
+                )
+        {
+            ++myWriteCount;
+            return true;
+        }
+
+        size_t getWriteCount() const
+        {
+            return myWriteCount;
+        }
+
+        void clear()
+        {
+        }
+
+        void resync()
+        {
+        }
+
+        std::istream& getInputStream()
+        {
+            return myStream;
+        }
+
+        std::ostream& getOutputStream()
+        {
+            return myStream;
+        }
+
+    private:
+
+        std::stringstream myStream;
+
+        unsigned char myAcknowledgeData[Packet::MAX_BINARY_SIZE];
+
+        size_t myAcknowledgeSize;
+
+        unsigned int myReadDelay;
+
+        size_t myWriteCount;
 };
 
 TEST_GROUP(RedBot)
@@ -111,6 +230,11 @@ TEST_GROUP(RedBot)
 
     void teardown()
     {
+        OutputCache::SetKeepAliveInterval(
+                OutputCache::DEFAULT_KEEP_ALIVE_INTERVAL
+                );
+        Diagnostics::SetLevel(Diagnostics::DEFAULT_LEVEL);
+
         for(
                 std::vector<Packet*>::const_iterator packetIter = myRequestPackets.begin();
                 packetIter != myRequestPackets.end();
@@ -147,6 +271,85 @@ Exchange(
         size_t                      numCycles
         );
 
+/**
+ * Waits until the robot's I/O thread has carried out the given number of
+ * transfers
+ */
+void
+WaitForTransfers(
+        const RedBot&   robot,
+        unsigned long   transferCount
+        );
+
+/**
+ * Component that accepts every packet offered to it
+ */
+class GreedyComponent : public Component
+{
+    public:
+
+        GreedyComponent() :
+            myProcessedCount(0)
+        {
+            Component::RegisterComponent(this);
+        }
+
+        PacketHandle getNextPacket()
+        {
+            return PacketHandle();
+        }
+
+        bool processPacket(
+                const Packet& packet
+                )
+        {
+            ++myProcessedCount;
+            return true;
+        }
+
+        size_t myProcessedCount;
+};
+
+/**
+ * Component that claims digital values from a single pin
+ */
+class KeyedComponent : public GreedyComponent
+{
+    public:
+
+        KeyedComponent(
+                unsigned int pin
+                ) :
+            myPin(pin)
+        {
+        }
+
+        void getRoutingKeys(
+                std::vector<RoutingKey>& keys
+                ) const
+        {
+            keys.push_back(
+                    Packet::MakeRoutingKey(RedBotPacket::BID_DVALUE, myPin)
+                    );
+        }
+
+        unsigned int myPin;
+};
+
+class RoutingRobot : public frc::IterativeRobot
+{
+    public:
+
+        GreedyComponent greedy;
+        KeyedComponent keyed;
+
+        RoutingRobot() :
+            IterativeRobot(),
+            keyed(6)
+        {
+        }
+};
+
 class DigitalOutputRobot : public frc::IterativeRobot
 {
     private:
@@ -195,6 +398,23 @@ class DigitalInputRobot : public frc::IterativeRobot
         }
 };
 
+class BudgetRobot : public frc::IterativeRobot
+{
+    public:
+
+        frc::AnalogInput lineSensor;
+        frc::AnalogInput rangeSensor;
+
+        BudgetRobot() :
+            IterativeRobot(),
+            lineSensor(3),
+            rangeSensor(4)
+        {
+            lineSensor.SetPriority(0);
+            rangeSensor.SetPriority(1);
+        }
+};
+
 class DriveRobot : public frc::IterativeRobot
 {
     private:
@@ -223,34 +443,43 @@ class DriveRobot : public frc::IterativeRobot
         }
 };
 
-TEST_GROUP(Timer)
+class CruiseRobot : public frc::IterativeRobot
 {
-};
-
-struct timespec MockTime;
+    private:
 
-int
-MockTimeAccessor(
-        clockid_t           clock,
-        struct timespec*    time
-        )
-{
-    time->tv_sec = MockTime.tv_sec;
-    time->tv_nsec = MockTime.tv_nsec;
-    return 0;
-}
+        RedBotSpeedController lMotor;
+        RedBotSpeedController rMotor;
+        frc::DifferentialDrive drive;
 
-class MockTimer : public frc::Timer
-{
     public:
 
-        MockTimer(
-                TimeAccessor accessor
-                ) :
-            Timer()
+        CruiseRobot() :
+            IterativeRobot(),
+	    lMotor(0),
+	    rMotor(1),
+	    drive(lMotor, rMotor)
         {
-            Timer::getTime = accessor;
         }
+
+        void TeleopPeriodic()
+        {
+            drive.ArcadeDrive(1.0, 0);
+        }
+};
+
+TEST_GROUP(Timer)
+{
+    ManualClock myClock;
+
+    void setup()
+    {
+        Clock::SetInstance(&myClock);
+    }
+
+    void teardown()
+    {
+        Clock::SetInstance(NULL);
+    }
 };
 
 #endif /* ifndef TESTREDBOT_H */
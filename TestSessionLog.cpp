@@ -0,0 +1,173 @@
+#include "SessionLog.h"
+#include "Clock.h"
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+#include <unistd.h>
+
+
+TEST_GROUP(SessionLog)
+{
+    ManualClock myClock;
+
+    void setup()
+    {
+        myClock.setTime(0);
+        Clock::SetInstance(&myClock);
+    }
+
+    void teardown()
+    {
+        Clock::SetInstance(NULL);
+        unlink(getLogPath());
+    }
+
+    /**
+     * Provides the path of the log recorded by tests
+     */
+    const char* getLogPath() const
+    {
+        return "/tmp/TestSessionLog.log";
+    }
+};
+
+TEST(SessionLog, VarintTest)
+{
+    unsigned char buffer[SessionLog::MAX_VARINT_SIZE];
+    uint64_t value = 0;
+
+    CHECK_EQUAL(1, SessionLog::EncodeVarint(0x7F, buffer));
+    CHECK_EQUAL(1, SessionLog::DecodeVarint(buffer, sizeof(buffer), value));
+    CHECK_EQUAL(0x7F, value);
+
+    CHECK_EQUAL(2, SessionLog::EncodeVarint(0x80, buffer));
+    CHECK_EQUAL(0x80, buffer[0]);
+    CHECK_EQUAL(0x01, buffer[1]);
+    CHECK_EQUAL(2, SessionLog::DecodeVarint(buffer, sizeof(buffer), value));
+    CHECK_EQUAL(0x80, value);
+
+    CHECK_EQUAL(SessionLog::MAX_VARINT_SIZE, SessionLog::EncodeVarint(UINT64_MAX, buffer));
+    CHECK_EQUAL(SessionLog::MAX_VARINT_SIZE, SessionLog::DecodeVarint(buffer, sizeof(buffer), value));
+    CHECK(value == UINT64_MAX);
+
+    // Integers cut short are not read
+    CHECK_EQUAL(0, SessionLog::DecodeVarint(buffer, 3, value));
+}
+
+TEST(SessionLog, RecordReplayTest)
+{
+    SessionRecorder recorder;
+    SessionPlayer player;
+    const unsigned char* packetData = NULL;
+    size_t packetSize = 0;
+
+    CHECK_TRUE(recorder.open(getLogPath()));
+    CHECK_TRUE(recorder.isOpen());
+
+    recorder.recordMode(FieldControlSystem::MODE_DISABLED);
+    myClock.setTime(20000000);
+    recorder.recordCycle();
+    recorder.recordPacket((const unsigned char*)"\xFF\x82\xFF", 3);
+    recorder.recordMode(FieldControlSystem::MODE_TELEOP);
+    myClock.setTime(40000000);
+    recorder.recordCycle();
+    recorder.recordAxis(0, 1, -0.5);
+    recorder.recordButton(0, 3, true);
+    recorder.recordPacket(NULL, 0);
+    recorder.close();
+
+    CHECK_FALSE(recorder.isOpen());
+
+    CHECK_TRUE(player.load(getLogPath()));
+
+    const std::vector<SessionPlayer::Cycle>& cycles = player.getCycles();
+    CHECK_EQUAL(2, cycles.size());
+    CHECK_EQUAL(20000000, cycles[0].time);
+    CHECK_EQUAL(FieldControlSystem::MODE_DISABLED, cycles[0].mode);
+    CHECK_EQUAL(40000000, cycles[1].time);
+    CHECK_EQUAL(FieldControlSystem::MODE_TELEOP, cycles[1].mode);
+
+    // Readings not recorded next are neutral and counted
+    CHECK_FALSE(player.replayButton(0, 3));
+    CHECK_EQUAL(1, player.getMismatchCount());
+    DOUBLES_EQUAL(-0.5, player.replayAxis(0, 1), 0.0);
+    CHECK_TRUE(player.replayButton(0, 3));
+    DOUBLES_EQUAL(0.0, player.replayAxis(0, 1), 0.0);
+    CHECK_EQUAL(2, player.getMismatchCount());
+
+    CHECK_EQUAL(2, player.getPacketCount());
+    CHECK_TRUE(player.replayPacket(packetData, packetSize));
+    CHECK_EQUAL(3, packetSize);
+    CHECK_EQUAL(0, memcmp("\xFF\x82\xFF", packetData, packetSize));
+    CHECK_TRUE(player.replayPacket(packetData, packetSize));
+    CHECK_EQUAL(0, packetSize);
+    CHECK_FALSE(player.replayPacket(packetData, packetSize));
+    CHECK_EQUAL(3, player.getMismatchCount());
+
+    player.rewind();
+
+    CHECK_EQUAL(0, player.getMismatchCount());
+    DOUBLES_EQUAL(-0.5, player.replayAxis(0, 1), 0.0);
+}
+
+TEST(SessionLog, TruncatedLogTest)
+{
+    SessionRecorder recorder;
+    SessionPlayer player;
+
+    CHECK_TRUE(recorder.open(getLogPath()));
+    recorder.recordCycle();
+    recorder.recordPacket((const unsigned char*)"\xFF\x82\xFF", 3);
+    recorder.recordCycle();
+    recorder.recordPacket((const unsigned char*)"\xFF\x82\xFF", 3);
+    recorder.close();
+
+    // A log cut in its last event keeps the events before it
+    FILE* logFile = fopen(getLogPath(), "r+");
+    fseek(logFile, 0, SEEK_END);
+    CHECK_EQUAL(0, ftruncate(fileno(logFile), ftell(logFile) - 1));
+    fclose(logFile);
+
+    CHECK_TRUE(player.load(getLogPath()));
+    CHECK_EQUAL(2, player.getCycles().size());
+    CHECK_EQUAL(1, player.getPacketCount());
+
+    CHECK_FALSE(player.load("/nonexistent/TestSessionLog.log"));
+}
+
+TEST(SessionLog, ReplayBufferTest)
+{
+    SessionRecorder recorder;
+    SessionPlayer player;
+    const unsigned char* packetData = NULL;
+    size_t packetSize = 0;
+    std::string streamData;
+
+    CHECK_TRUE(recorder.open(getLogPath()));
+    recorder.recordPacket((const unsigned char*)"\xFF\x82\xFF", 3);
+    recorder.recordPacket(NULL, 0);
+    recorder.close();
+
+    CHECK_TRUE(player.load(getLogPath()));
+
+    InputReplayBuffer inputBuffer(player);
+    OutputReplayBuffer outputBuffer;
+
+    CHECK_TRUE(outputBuffer.writeData((const unsigned char*)"\xFF\x01\xFF", 3));
+
+    CHECK_TRUE(inputBuffer.readPacket());
+    CHECK_TRUE(inputBuffer.getPacketData(packetData, packetSize));
+    CHECK_EQUAL(3, packetSize);
+    CHECK_EQUAL(0, memcmp("\xFF\x82\xFF", packetData, packetSize));
+
+    std::getline(inputBuffer.getInputStream(), streamData);
+    STRCMP_EQUAL("\xFF\x82\xFF", streamData.c_str());
+
+    // Reads that timed out when recorded take no packet
+    inputBuffer.clear();
+    CHECK_FALSE(inputBuffer.readPacket());
+    CHECK_TRUE(inputBuffer.getPacketData(packetData, packetSize));
+    CHECK_EQUAL(0, packetSize);
+
+    CHECK_FALSE(inputBuffer.readPacket());
+    CHECK_EQUAL(1, player.getMismatchCount());
+}
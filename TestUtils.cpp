@@ -1,6 +1,9 @@
 
 #include "TestUtils.h"
+#include <atomic>
+#include <new>
 #include <sstream>
+#include <stdlib.h>
 
 
 /**
@@ -21,6 +24,42 @@ static void WritePacketString(
         );
 
 
+/**
+ * Number of calls made to the global operator new
+ */
+static std::atomic<size_t> ourOperatorNewCount(0);
+
+
+void*
+operator new(
+        size_t size
+        )
+{
+    ++ourOperatorNewCount;
+
+    void* memory = malloc((size == 0) ? 1 : size);
+    if (memory == NULL)
+    {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+void
+operator delete(
+        void* memory
+        ) noexcept
+{
+    free(memory);
+}
+
+size_t
+GetOperatorNewCount()
+{
+    return ourOperatorNewCount;
+}
+
 PacketDiffExplainer::PacketDiffExplainer(
         const char* expectedString, 
         const char* actualString
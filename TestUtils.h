@@ -3,6 +3,7 @@
 
 #include "CppUTest/TestHarness.h"
 #include <string.h>
+#include <stddef.h>
 
 
 /**
@@ -33,6 +34,14 @@ class PacketDiffExplainer
         std::string myMessage;
 };
 
+/**
+ * Provides the number of calls made to the global operator new so far
+ *
+ * Tests compare counts taken before and after the code under test to tell if
+ * it allocated.
+ */
+size_t GetOperatorNewCount();
+
 #define BPACKET_EQUAL(expectedString, actualString) \
     CHECK_TEXT( \
             (strcmp(expectedString, actualString) == 0), \
@@ -0,0 +1,94 @@
+
+#include "TimedRobot.h"
+#include "Clock.h"
+
+using namespace frc;
+
+
+constexpr double TimedRobot::DEFAULT_PERIOD;
+
+TimedRobot::TimedRobot(
+        double period
+        ) :
+    IterativeRobot(),
+    myPeriod((long long)(period * Clock::NSEC_PER_SEC + 0.5)),
+    myIsStarted(false),
+    myDeadline(0),
+    myCycleStart(0),
+    myCycleCount(0),
+    myOverrunCount(0)
+{
+}
+
+double
+TimedRobot::GetPeriod() const
+{
+    return (1e-9 * myPeriod);
+}
+
+void
+TimedRobot::WaitForNextCycle()
+{
+    Clock& clock = Clock::GetInstance();
+    long long currentTime = clock.getTime();
+
+    if (myIsStarted == false)
+    {
+        myIsStarted = true;
+        myDeadline = currentTime;
+    }
+    else
+    {
+        myExecutionTimes.add(1e-9 * (currentTime - myCycleStart));
+        myDeadline += myPeriod;
+
+        if (currentTime > myDeadline)
+        {
+            // Start right away, on the schedule of the last deadline missed
+            ++myOverrunCount;
+            myDeadline += ((currentTime - myDeadline) / myPeriod) * myPeriod;
+        }
+        else
+        {
+            clock.sleepUntil(myDeadline);
+            currentTime = clock.getTime();
+        }
+    }
+
+    myJitters.add(1e-9 * (currentTime - myDeadline));
+    myCycleStart = currentTime;
+    ++myCycleCount;
+}
+
+unsigned long
+TimedRobot::GetCycleCount() const
+{
+    return myCycleCount;
+}
+
+unsigned long
+TimedRobot::GetOverrunCount() const
+{
+    return myOverrunCount;
+}
+
+const LatencyHistogram&
+TimedRobot::GetExecutionTimes() const
+{
+    return myExecutionTimes;
+}
+
+const LatencyHistogram&
+TimedRobot::GetJitters() const
+{
+    return myJitters;
+}
+
+void
+TimedRobot::ResetStatistics()
+{
+    myCycleCount = 0;
+    myOverrunCount = 0;
+    myExecutionTimes.reset();
+    myJitters.reset();
+}
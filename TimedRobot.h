@@ -0,0 +1,124 @@
+#ifndef TIMEDROBOT_H
+#define TIMEDROBOT_H
+
+#include "IterativeRobot.h"
+#include "LatencyHistogram.h"
+
+namespace frc
+{
+
+/**
+ * Robot base class whose functions iterate at a fixed period
+ *
+ * Cycles start on absolute deadlines spaced one period apart, so the time
+ * spent in a cycle does not push the following ones back. A cycle that runs
+ * past the start of the next one is an overrun: the next cycle starts right
+ * away and the deadlines that were missed are skipped rather than made up
+ * for. The execution time of every cycle and how late it started are
+ * recorded so that the loop's timing can be reported.
+ *
+ * The schedule follows the clock in use by the process, so waiting for a
+ * cycle takes no real time when the program is simulated.
+ */
+class TimedRobot : public IterativeRobot
+{
+    public:
+
+        /**
+         * Default period between cycles in seconds
+         */
+        static constexpr double DEFAULT_PERIOD = 0.02;
+
+        /**
+         * Constructor
+         */
+        TimedRobot(
+                double period = DEFAULT_PERIOD  /**< Period in seconds, positive */
+                );
+
+        /**
+         * Provides the period between cycles in seconds
+         */
+        double GetPeriod() const;
+
+        /**
+         * Waits for the start of the next cycle
+         *
+         * The program's main loop calls this before every cycle. The first
+         * call starts the schedule and returns right away.
+         */
+        void WaitForNextCycle();
+
+        /**
+         * Provides the number of cycles started
+         */
+        unsigned long GetCycleCount() const;
+
+        /**
+         * Provides the number of cycles that ran past the start of the next
+         */
+        unsigned long GetOverrunCount() const;
+
+        /**
+         * Provides the execution times of completed cycles
+         */
+        const LatencyHistogram& GetExecutionTimes() const;
+
+        /**
+         * Provides how late each cycle started after its deadline
+         */
+        const LatencyHistogram& GetJitters() const;
+
+        /**
+         * Clears the recorded cycle counts and times
+         *
+         * The schedule itself is kept.
+         */
+        void ResetStatistics();
+
+    private:
+
+        /**
+         * Period between cycles in nanoseconds
+         */
+        long long myPeriod;
+
+        /**
+         * Indicates if the first cycle has started
+         */
+        bool myIsStarted;
+
+        /**
+         * Time the current cycle was due to start, in nanoseconds
+         */
+        long long myDeadline;
+
+        /**
+         * Time the current cycle started, in nanoseconds
+         */
+        long long myCycleStart;
+
+        /**
+         * Number of cycles started
+         */
+        unsigned long myCycleCount;
+
+        /**
+         * Number of cycles that ran past the start of the next
+         */
+        unsigned long myOverrunCount;
+
+        /**
+         * Execution times of completed cycles
+         */
+        LatencyHistogram myExecutionTimes;
+
+        /**
+         * Delays between the deadline and the start of each cycle
+         */
+        LatencyHistogram myJitters;
+};
+
+}; /* namespace frc */
+
+#endif /* ifndef TIMEDROBOT_H */
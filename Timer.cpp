@@ -5,7 +5,6 @@ using namespace frc;
 
 
 Timer::Timer() :
-    getTime(clock_gettime),
     myTime(0.0),
     myStartTime(0.0),
     myIsStopped(true)
@@ -21,25 +20,10 @@ Timer::Get()
     }
     else
     {
-        return (GetSystemTime() - myStartTime + myTime);
+        return (GetFPGATimestamp() - myStartTime + myTime);
     }
 }
 
-double
-Timer::GetSystemTime()
-{
-    struct timespec currentTimeSpec;
-
-    getTime(
-            OUR_CLOCK_ID,
-            &currentTimeSpec
-           );
-
-    double currentTime = currentTimeSpec.tv_sec + (1e-9 * currentTimeSpec.tv_nsec);
-
-    return currentTime;
-}
-
 void
 Timer::Reset()
 {
@@ -47,7 +31,7 @@ Timer::Reset()
 
     if (myIsStopped == false)
     {
-        myStartTime = GetSystemTime();
+        myStartTime = GetFPGATimestamp();
     }
 }
 
@@ -55,7 +39,7 @@ void
 Timer::Start()
 {
     myIsStopped = false;
-    myStartTime = GetSystemTime();
+    myStartTime = GetFPGATimestamp();
 }
 
 void
@@ -1,13 +1,16 @@
 #ifndef TIMER_H
 #define TIMER_H
 
-#include <time.h>
+#include "Clock.h"
 
 namespace frc
 {
 
 /**
  * Class used to keep track of time
+ *
+ * Timers follow the clock in use by the process, so they run on virtual time
+ * when the program is simulated.
  */
 class Timer
 {
@@ -49,32 +52,18 @@ class Timer
                 double period
                 );
 
-    protected:
-
-        /**
-         * System time accessor type
-         */
-        typedef int (*TimeAccessor)(clockid_t, struct timespec*);
-
         /**
-         * System time accessor
+         * Provides the current time of the clock used by timers
+         *
+         * This is defined here so that component libraries can timestamp
+         * samples without linking the rest of the framework.
+         *
+         * \return Number of seconds elapsed since an arbitrary fixed point
          */
-        TimeAccessor getTime;
+        static double GetFPGATimestamp();
 
     private:
 
-        /**
-         * ID of the system clock to use for time keeping
-         */
-        static const clockid_t OUR_CLOCK_ID = CLOCK_MONOTONIC;
-
-        /**
-         * Provides the system time
-         *
-         * \return Number of seconds elapsed
-         */
-        double GetSystemTime();
-
         /**
          * Number of seconds elapsed
          */
@@ -91,6 +80,12 @@ class Timer
         bool myIsStopped;
 };
 
+inline double
+Timer::GetFPGATimestamp()
+{
+    return (1e-9 * Clock::GetInstance().getTime());
+}
+
 }; /* namespace frc */
 
 #endif /* ifndef TIMER_H */
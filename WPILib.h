@@ -3,6 +3,7 @@
 
 // Framework
 #include "IterativeRobot.h"
+#include "TimedRobot.h"
 #include "Scheduler.h"
 
 // Components
@@ -26,4 +27,12 @@
         return WPIRBMain(argc, argv, program); \
     }
 
+#define START_ROBOT_STATION(RobotClass) \
+    static frc::IterativeRobot* CreateRobotProgram() { \
+        return new RobotClass(); \
+    } \
+    int main(int argc, char** argv) { \
+        return WPIRBStationMain(argc, argv, CreateRobotProgram); \
+    }
+
 #endif /* ifndef WPILIB_H */
@@ -73,3 +73,9 @@ analogRead(
 {
     return mock().actualCall("analogRead").withParameter("pin", pin).returnUnsignedIntValue();
 }
+
+unsigned long
+millis()
+{
+    return mock().actualCall("millis").returnUnsignedIntValue();
+}
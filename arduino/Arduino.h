@@ -66,4 +66,7 @@ analogRead(
         unsigned int pin
         );
 
+unsigned long
+millis();
+
 #endif /* ifndef ARDUINO_H */
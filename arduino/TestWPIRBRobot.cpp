@@ -79,6 +79,49 @@ SendPacket(
 }
 
 
+void
+SendBytes(
+        const std::string&  requestData,
+        const std::string&  responseData,
+        WPIRBRobot&         robot
+        )
+{
+    for(
+            size_t byteIdx = 0;
+            byteIdx < requestData.size();
+            ++byteIdx
+       )
+    {
+        mock().expectOneCall("available").onObject(&Serial).andReturnValue(1);
+        mock().expectOneCall("read").onObject(&Serial).andReturnValue(
+                (unsigned int)(unsigned char)requestData[byteIdx]
+                );
+    }
+
+    for(
+            size_t byteIdx = 0;
+            byteIdx < responseData.size();
+            ++byteIdx
+       )
+    {
+        mock().expectOneCall("write").onObject(&Serial).withParameter(
+                "data",
+                (unsigned int)(unsigned char)responseData[byteIdx]
+                );
+    }
+
+    mock().expectOneCall("flush").onObject(&Serial);
+
+    for(
+            size_t byteIdx = 0;
+            byteIdx < requestData.size();
+            ++byteIdx
+       )
+    {
+        robot.loop();
+    }
+}
+
 TEST(WPIRBRobot, BasicTest)
 {
     WPIRBRobot robot;
@@ -100,6 +143,15 @@ TEST(WPIRBRobot, BasicTest)
     mock().checkExpectations();
 }
 
+TEST(WPIRBRobot, BaudRateTest)
+{
+    WPIRBRobot robot;
+
+    mock().expectOneCall("begin").onObject(&Serial).withParameter("baud", 115200);
+    robot.setup(115200);
+    mock().checkExpectations();
+}
+
 TEST(WPIRBRobot, PingTest)
 {
     WPIRBRobot robot;
@@ -571,3 +623,339 @@ TEST(WPIRBRobot, PinConfigTest)
 
     mock().checkExpectations();
 }
+
+TEST(WPIRBRobot, FrameTest)
+{
+    WPIRBRobot robot;
+
+    mock().expectOneCall("begin").onObject(&Serial).withParameter("baud", 9600);
+    robot.setup();
+    mock().checkExpectations();
+
+    FramePacket requestFrame;
+    requestFrame.add(new DigitalOutputPacket(5, true));
+    requestFrame.add(new EncoderInputPacket(false));
+    requestFrame.add(new PingPacket());
+
+    FrameValuesPacket responseFrame;
+    responseFrame.add(new AcknowledgePacket());
+    responseFrame.add(new EncoderCountPacket(false, 40));
+    responseFrame.add(new AcknowledgePacket());
+
+    mock().expectOneCall("digitalWrite").withParameter("pin", 5).withParameter("value", HIGH);
+    mock().expectOneCall("encoderGetTicks").withParameter("motor", rb::LEFT).andReturnValue(40);
+    SendPacket(
+            requestFrame,
+            responseFrame,
+            robot
+            );
+
+    mock().checkExpectations();
+
+    // Frame packets may exceed the size limit of single packets
+    FramePacket largeFrame;
+    FrameValuesPacket largeResponseFrame;
+    for(
+            size_t packetIdx = 0;
+            packetIdx < 4;
+            ++packetIdx
+       )
+    {
+        largeFrame.add(new PinConfigPacket(8, PinConfigPacket::DIR_INPUT));
+        largeResponseFrame.add(new PinConfigInfoPacket(8, PinConfigInfoPacket::DIR_INPUT));
+
+        mock().expectOneCall("pinMode").withParameter("pin", 8).withParameter("mode", INPUT);
+    }
+
+    SendPacket(
+            largeFrame,
+            largeResponseFrame,
+            robot
+            );
+
+    mock().checkExpectations();
+
+    // Responses that overflow a frame are sent in another one, which frames
+    // built by the host never need
+    std::ostringstream requestStream;
+    FrameValuesPacket overflowResponseFrame1;
+    FrameValuesPacket overflowResponseFrame2;
+
+    requestStream << "\xFF\x09";
+    for(
+            size_t packetIdx = 0;
+            packetIdx < 16;
+            ++packetIdx
+       )
+    {
+        AnalogInputPacket(3).writeBody(requestStream);
+
+        FrameValuesPacket& responseFrame =
+            (packetIdx < 14) ? overflowResponseFrame1 : overflowResponseFrame2;
+        responseFrame.add(new AnalogValuePacket(3, 32));
+
+        mock().expectOneCall("analogRead").withParameter("pin", 3).andReturnValue(32);
+    }
+    requestStream << "\xFF";
+
+    std::ostringstream responseStream;
+    responseStream << overflowResponseFrame1 << overflowResponseFrame2;
+
+    mock().expectOneCall("flush").onObject(&Serial);
+    SendBytes(
+            requestStream.str(),
+            responseStream.str(),
+            robot
+            );
+
+    mock().checkExpectations();
+}
+
+TEST(WPIRBRobot, SubscribeTest)
+{
+    WPIRBRobot robot;
+
+    mock().expectOneCall("begin").onObject(&Serial).withParameter("baud", 9600);
+    robot.setup();
+    mock().checkExpectations();
+
+    // Pins and encoders are sampled at the next opportunity once subscribed
+    mock().expectOneCall("millis").andReturnValue(100u);
+    SendPacket(
+            SubscribePacket(DigitalInputPacket(3), 20),
+            AcknowledgePacket(),
+            robot
+            );
+    mock().expectOneCall("millis").andReturnValue(100u);
+    SendPacket(
+            SubscribePacket(EncoderInputPacket(true), 50),
+            AcknowledgePacket(),
+            robot
+            );
+    mock().checkExpectations();
+
+    FrameValuesPacket samplesFrame;
+    samplesFrame.add(new DigitalValuePacket(3, true));
+    samplesFrame.add(new EncoderCountPacket(true, 12));
+
+    mock().expectOneCall("millis").andReturnValue(100u);
+    mock().expectOneCall("digitalRead").withParameter("pin", 3).andReturnValue(HIGH);
+    mock().expectOneCall("encoderGetTicks").withParameter("motor", rb::RIGHT).andReturnValue(12);
+    SendPacket(
+            PingPacket(),
+            samplesFrame,
+            robot
+            );
+    mock().checkExpectations();
+
+    // Pings are acknowledged while no sample is due
+    mock().expectOneCall("millis").andReturnValue(110u);
+    SendPacket(
+            PingPacket(),
+            AcknowledgePacket(),
+            robot
+            );
+    mock().checkExpectations();
+
+    // Due samples follow the responses of a frame
+    FramePacket requestFrame;
+    requestFrame.add(new DigitalOutputPacket(5, true));
+
+    FrameValuesPacket responseFrame;
+    responseFrame.add(new AcknowledgePacket());
+    responseFrame.add(new DigitalValuePacket(3, false));
+
+    mock().expectOneCall("digitalWrite").withParameter("pin", 5).withParameter("value", HIGH);
+    mock().expectOneCall("millis").andReturnValue(120u);
+    mock().expectOneCall("digitalRead").withParameter("pin", 3).andReturnValue(LOW);
+    SendPacket(
+            requestFrame,
+            responseFrame,
+            robot
+            );
+    mock().checkExpectations();
+
+    // Cancelled subscriptions are no longer sampled
+    SendPacket(
+            SubscribePacket(DigitalInputPacket(3), 0),
+            AcknowledgePacket(),
+            robot
+            );
+    SendPacket(
+            SubscribePacket(EncoderInputPacket(true), 0),
+            AcknowledgePacket(),
+            robot
+            );
+    SendPacket(
+            PingPacket(),
+            AcknowledgePacket(),
+            robot
+            );
+    mock().checkExpectations();
+}
+
+TEST(WPIRBRobot, ProtocolVersionTest)
+{
+    WPIRBRobot robot;
+
+    mock().expectOneCall("begin").onObject(&Serial).withParameter("baud", 9600);
+    robot.setup();
+    mock().checkExpectations();
+
+    // Newer versions are clamped to the highest supported one
+    SendBytes(
+            std::string("\xFF\x0B\x05\xFF", 4),
+            std::string("\xFF\x87\x02\xFF", 4),
+            robot
+            );
+    mock().checkExpectations();
+
+    // Ping and acknowledge in COBS frames
+    SendBytes(
+            std::string("\x02\x01\x00", 3),
+            std::string("\x02\x82\x00", 3),
+            robot
+            );
+    mock().checkExpectations();
+
+    // Encoder counts are sent whole
+    mock().expectOneCall("encoderGetTicks").withParameter("motor", rb::LEFT).andReturnValue(-2);
+    SendBytes(
+            std::string("\x03\x07\x01\x00", 4),
+            std::string("\x07\x85\x02\xFF\xFF\xFF\xFE\x00", 8),
+            robot
+            );
+    mock().checkExpectations();
+
+    // A bounded frame returns to the bounded protocol
+    SendBytes(
+            std::string("\xFF\x01\xFF", 3),
+            std::string("\xFF\x82\xFF", 3),
+            robot
+            );
+    mock().checkExpectations();
+
+    SendPacket(
+            PingPacket(),
+            AcknowledgePacket(),
+            robot
+            );
+    mock().checkExpectations();
+}
+
+TEST(WPIRBRobot, CobsMotorDriveTest)
+{
+    WPIRBRobot robot;
+
+    mock().expectOneCall("begin").onObject(&Serial).withParameter("baud", 9600);
+    robot.setup();
+    mock().checkExpectations();
+
+    SendBytes(
+            std::string("\xFF\x0B\x02\xFF", 4),
+            std::string("\xFF\x87\x02\xFF", 4),
+            robot
+            );
+    mock().checkExpectations();
+
+    // Full speed needs no remapping in native contents
+    mock().expectOneCall("rightMotor").withParameter("speed", 255);
+    SendBytes(
+            std::string("\x05\x06\x01\x01\xFF\x00", 6),
+            std::string("\x02\x82\x00", 3),
+            robot
+            );
+    mock().checkExpectations();
+}
+
+TEST(WPIRBRobot, ChecksumTest)
+{
+    WPIRBRobot robot;
+
+    mock().expectOneCall("begin").onObject(&Serial).withParameter("baud", 9600);
+    robot.setup();
+    mock().checkExpectations();
+
+    // The selection is answered without the new checksum
+    SendBytes(
+            std::string("\xFF\x0C\x01\xFF", 4),
+            std::string("\xFF\x88\x01\xFF", 4),
+            robot
+            );
+    mock().checkExpectations();
+
+    // Ping and acknowledge with CRC-8
+    SendBytes(
+            std::string("\xFF\x01\x00\x07\xFF", 5),
+            std::string("\xFF\x82\x01\x07\xFF", 5),
+            robot
+            );
+    mock().checkExpectations();
+
+    // A corrupted request is refused
+    SendBytes(
+            std::string("\xFF\x01\x00\x08\xFF", 5),
+            std::string("\xFF\x89\x01\x36\xFF", 5),
+            robot
+            );
+    mock().checkExpectations();
+
+    // Resync turns checksums off
+    for (int i = 0; i < 5; i++)
+    {
+        mock().expectOneCall("available").onObject(&Serial).andReturnValue(1);
+        mock().expectOneCall("read").onObject(&Serial).andReturnValue(0xFF);
+    }
+
+    for (int i = 0; i < 5; i++)
+    {
+        robot.loop();
+    }
+
+    mock().checkExpectations();
+
+    SendPacket(
+            PingPacket(),
+            AcknowledgePacket(),
+            robot
+            );
+    mock().checkExpectations();
+}
+
+TEST(WPIRBRobot, CobsChecksumTest)
+{
+    WPIRBRobot robot;
+
+    mock().expectOneCall("begin").onObject(&Serial).withParameter("baud", 9600);
+    robot.setup();
+    mock().checkExpectations();
+
+    SendBytes(
+            std::string("\xFF\x0B\x02\xFF", 4),
+            std::string("\xFF\x87\x02\xFF", 4),
+            robot
+            );
+    mock().checkExpectations();
+
+    SendBytes(
+            std::string("\x03\x0C\x01\x00", 4),
+            std::string("\x03\x88\x01\x00", 4),
+            robot
+            );
+    mock().checkExpectations();
+
+    // The checksum is carried raw inside the COBS frame
+    SendBytes(
+            std::string("\x03\x01\x07\x00", 4),
+            std::string("\x03\x82\x87\x00", 4),
+            robot
+            );
+    mock().checkExpectations();
+
+    SendBytes(
+            std::string("\x03\x01\x08\x00", 4),
+            std::string("\x03\x89\xB6\x00", 4),
+            robot
+            );
+    mock().checkExpectations();
+}
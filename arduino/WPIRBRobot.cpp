@@ -5,74 +5,272 @@
 WPIRBRobot::WPIRBRobot() :
   myEncoders(A2, 10),
     myPacketSize(0),
-    myIsHeaderRead(false)
+    myIsHeaderRead(false),
+    myProtocolVersion(PROTOCOL_BOUNDED),
+    myChecksumType(CHECKSUM_NONE),
+    myResponseChecksum(0),
+    myBoundCount(0),
+    myCobsCode(0),
+    myCobsRemaining(0),
+    myIsFrameDropped(false),
+    myResponseSize(0),
+    myIsInFrame(false),
+    myFrameResponseSize(0),
+    mySubscriptionCount(0)
 {
 }
 
 void
-WPIRBRobot::setup()
+WPIRBRobot::setup(
+        unsigned long baudRate
+        )
 {
-    Serial.begin(9600);
+    Serial.begin(baudRate);
 }
 
 void
 WPIRBRobot::loop()
 {
+    // Bytes are consumed one at a time and every complete request is answered
+    // with exactly one response before the next is parsed. This lets the host
+    // keep a window of requests queued in the serial receive buffer and match
+    // their responses in order.
     if (Serial.available() > 0)
     {
         byte curByte = Serial.read();
 
-        if (curByte == PACKET_BOUND)
+        if (myProtocolVersion == PROTOCOL_COBS)
         {
-            if (myIsHeaderRead == false)
-            {
-                myPacketSize = 0;
-                myPacketBuffer[myPacketSize++] = PACKET_BOUND;
-                myIsHeaderRead = true;
-            }
-            else
+            readCobsByte(curByte);
+        }
+        else
+        {
+            readBoundedByte(curByte);
+        }
+    }
+}
+
+void
+WPIRBRobot::readBoundedByte(byte curByte)
+{
+    if (curByte != PACKET_BOUND)
+    {
+        myBoundCount = 0;
+    }
+    else if (myBoundCount < RESYNC_BOUND_COUNT && ++myBoundCount == RESYNC_BOUND_COUNT)
+    {
+        myChecksumType = CHECKSUM_NONE;
+    }
+
+    if (curByte == PACKET_BOUND)
+    {
+        if (myIsHeaderRead == false)
+        {
+            myPacketSize = 0;
+            myPacketBuffer[myPacketSize++] = PACKET_BOUND;
+            myIsHeaderRead = true;
+        }
+        else
+        {
+            if (myPacketSize < PACKET_BUFSIZE)
             {
-                if (myPacketSize < PACKET_BUFSIZE)
+                if (myPacketSize > 1)
                 {
-                    if (myPacketSize > 1)
-                    {
-                        // Valid complete packet
-                        myPacketBuffer[myPacketSize++] = PACKET_BOUND;
-                        parsePacket();
-                        myIsHeaderRead = false;
-                    }
-                    else
-                    {
-                        // Back-to-back packet bounds
-                        myPacketSize = 0;
-                        myPacketBuffer[myPacketSize++] = PACKET_BOUND;
-                        myIsHeaderRead = true;
-                    }
+                    // Valid complete packet
+                    myPacketBuffer[myPacketSize++] = PACKET_BOUND;
+                    parsePacket();
+                    myIsHeaderRead = false;
                 }
                 else
                 {
-                    // Packet too large
-                    myIsHeaderRead = false;
+                    // Back-to-back packet bounds
+                    myPacketSize = 0;
+                    myPacketBuffer[myPacketSize++] = PACKET_BOUND;
+                    myIsHeaderRead = true;
                 }
             }
+            else
+            {
+                // Packet too large
+                myIsHeaderRead = false;
+            }
         }
-        else
+    }
+    else
+    {
+        if (myIsHeaderRead == true)
         {
-            if (myIsHeaderRead == true)
+            if (myPacketSize < PACKET_BUFSIZE)
             {
-                if (myPacketSize < PACKET_BUFSIZE)
-                {
-                    myPacketBuffer[myPacketSize++] = curByte;
-                }
+                myPacketBuffer[myPacketSize++] = curByte;
             }
         }
     }
 }
 
+void
+WPIRBRobot::readCobsByte(byte curByte)
+{
+    if (curByte == PACKET_DELIMITER)
+    {
+        // A frame is complete once its last block is, and empty frames are
+        // skipped
+        if (myIsFrameDropped == false && myCobsCode != 0 && myCobsRemaining == 0 && myPacketSize > 1)
+        {
+            myPacketBuffer[myPacketSize++] = PACKET_BOUND;
+            parsePacket();
+        }
+
+        myPacketSize = 0;
+        myCobsCode = 0;
+        myIsFrameDropped = false;
+        return;
+    }
+
+    if (myIsFrameDropped == true)
+    {
+        return;
+    }
+
+    if (myCobsCode == 0)
+    {
+        // Frames are far shorter than a full block, so none starts with a
+        // bound. A bound starts a bounded packet instead, such as the resync
+        // sequence or a version request from a restarted host.
+        if (curByte == PACKET_BOUND)
+        {
+            setProtocolVersion(PROTOCOL_BOUNDED);
+            readBoundedByte(curByte);
+            return;
+        }
+
+        // The frame is held as a bounded packet so that it is parsed alike
+        myPacketSize = 0;
+        myPacketBuffer[myPacketSize++] = PACKET_BOUND;
+    }
+    else if (myCobsRemaining > 0)
+    {
+        storeCobsByte(curByte);
+        --myCobsRemaining;
+        return;
+    }
+    else if (myCobsCode != 0xFF)
+    {
+        // Every block but a full one stands for a zero byte after its data
+        if (storeCobsByte(0x00) == false)
+        {
+            return;
+        }
+    }
+
+    myCobsCode = curByte;
+    myCobsRemaining = curByte - 1;
+}
+
+boolean
+WPIRBRobot::storeCobsByte(byte curByte)
+{
+    // Leave room for the closing bound
+    if (myPacketSize >= (PACKET_BUFSIZE - 1))
+    {
+        myIsFrameDropped = true;
+        return false;
+    }
+
+    myPacketBuffer[myPacketSize++] = curByte;
+    return true;
+}
+
+void
+WPIRBRobot::setProtocolVersion(byte version)
+{
+    myProtocolVersion = version;
+
+    myIsHeaderRead = false;
+    myPacketSize = 0;
+    myCobsCode = 0;
+    myCobsRemaining = 0;
+    myIsFrameDropped = false;
+    myBoundCount = 0;
+}
+
+boolean
+WPIRBRobot::checkPacketChecksum()
+{
+    unsigned int checksumSize = getChecksumSize();
+    if (myPacketSize < (3 + checksumSize))
+    {
+        return false;
+    }
+
+    unsigned int contentEnd = myPacketSize - 1 - checksumSize;
+    unsigned int checksum = getInitialChecksum();
+    for (unsigned int byteIdx = 1; byteIdx < contentEnd; ++byteIdx)
+    {
+        checksum = updateChecksum(checksum, myPacketBuffer[byteIdx]);
+    }
+
+    byte bitsPerByte = (myProtocolVersion == PROTOCOL_COBS) ? 8 : 7;
+    for (unsigned int byteIdx = 0; byteIdx < checksumSize; ++byteIdx)
+    {
+        byte expected = byte((checksum >> (bitsPerByte * (checksumSize - byteIdx - 1))) & ((1 << bitsPerByte) - 1));
+        if (myPacketBuffer[contentEnd + byteIdx] != expected)
+        {
+            return false;
+        }
+    }
+
+    // The packet is parsed as if it had been sent without a checksum
+    myPacketBuffer[contentEnd] = PACKET_BOUND;
+    myPacketSize = contentEnd + 1;
+
+    return true;
+}
+
+unsigned int
+WPIRBRobot::updateChecksum(unsigned int checksum, byte value) const
+{
+    if (myChecksumType == CHECKSUM_CRC8)
+    {
+        checksum ^= value;
+        for (int bitIdx = 0; bitIdx < 8; ++bitIdx)
+        {
+            checksum = ((checksum & 0x80) ? ((checksum << 1) ^ 0x07) : (checksum << 1)) & 0xFF;
+        }
+    }
+    else if (myChecksumType == CHECKSUM_CRC16)
+    {
+        checksum ^= (unsigned int)value << 8;
+        for (int bitIdx = 0; bitIdx < 8; ++bitIdx)
+        {
+            checksum = ((checksum & 0x8000) ? ((checksum << 1) ^ 0x1021) : (checksum << 1)) & 0xFFFF;
+        }
+    }
+
+    return checksum;
+}
+
+unsigned int
+WPIRBRobot::getInitialChecksum() const
+{
+    return (myChecksumType == CHECKSUM_CRC16) ? 0xFFFF : 0x00;
+}
+
+unsigned int
+WPIRBRobot::getChecksumSize() const
+{
+    switch (myChecksumType)
+    {
+        case CHECKSUM_CRC8:     return (myProtocolVersion == PROTOCOL_COBS) ? 1 : 2;
+        case CHECKSUM_CRC16:    return (myProtocolVersion == PROTOCOL_COBS) ? 2 : 3;
+        default:                return 0;
+    };
+}
+
 void
 WPIRBRobot::parsePacket()
 {
-  if (myPacketSize == 0 || myPacketSize > 10)
+  if (myPacketSize == 0 || myPacketSize > PACKET_BUFSIZE)
   {
     myPacketSize = 0;
     return;
@@ -87,7 +285,26 @@ WPIRBRobot::parsePacket()
   {
     return;
   }
-  
+
+  if (myChecksumType != CHECKSUM_NONE && checkPacketChecksum() == false)
+  {
+    negativeAcknowledge();
+    return;
+  }
+
+  // Only frames may use the full buffer
+  if (myPacketBuffer[1] != PACKET_TYPE_FRAME && myPacketSize > PACKET_MAXSIZE)
+  {
+    myPacketSize = 0;
+    return;
+  }
+
+  dispatchPacket();
+}
+
+void
+WPIRBRobot::dispatchPacket()
+{
   switch (myPacketBuffer[1])
   {
     case PACKET_TYPE_PING:
@@ -122,15 +339,148 @@ WPIRBRobot::parsePacket()
     parseEncoderClearPacket();
     break;
 
+    case PACKET_TYPE_SUBSCRIBE:
+      parseSubscribePacket();
+      break;
+
+    case PACKET_TYPE_VERSION:
+      parseVersionPacket();
+      break;
+
+    case PACKET_TYPE_CHECKSUM:
+      parseChecksumPacket();
+      break;
+
+    case PACKET_TYPE_FRAME:
+      if (myIsInFrame == false)
+      {
+        parseFramePacket();
+      }
+      else
+      {
+        // Frames do not nest
+        acknowledge();
+      }
+      break;
+
     default:
       acknowledge();
       break;
   };
 }
 
+void
+WPIRBRobot::parseFramePacket()
+{
+    byte frameBuffer[PACKET_BUFSIZE];
+    unsigned int frameSize = myPacketSize;
+
+    for (unsigned int byteIdx = 0; byteIdx < frameSize; ++byteIdx)
+    {
+        frameBuffer[byteIdx] = myPacketBuffer[byteIdx];
+    }
+
+    // Each embedded packet is handled as if received on its own, with its
+    // response appended to a single response frame
+    beginFrameResponse();
+
+    unsigned int frameIdx = 2;
+    while (frameIdx < (frameSize - 1))
+    {
+        int contentSize = getContentSize(frameBuffer[frameIdx]);
+        if (contentSize < 0 || (frameIdx + 1 + contentSize) > (frameSize - 1))
+        {
+            break;
+        }
+
+        myPacketSize = 0;
+        myPacketBuffer[myPacketSize++] = PACKET_BOUND;
+        for (int byteIdx = 0; byteIdx <= contentSize; ++byteIdx)
+        {
+            myPacketBuffer[myPacketSize++] = frameBuffer[frameIdx + byteIdx];
+        }
+        myPacketBuffer[myPacketSize++] = PACKET_BOUND;
+
+        dispatchPacket();
+
+        frameIdx += 1 + contentSize;
+    }
+
+    if (mySubscriptionCount > 0)
+    {
+        sendDueSamples(millis());
+    }
+
+    endFrameResponse();
+}
+
+int
+WPIRBRobot::getContentSize(byte type) const
+{
+    switch (type)
+    {
+        case PACKET_TYPE_PING:      return 0;
+        case PACKET_TYPE_DOUTPUT:   return 2;
+        case PACKET_TYPE_DINPUT:    return 1;
+        case PACKET_TYPE_AINPUT:    return 1;
+        case PACKET_TYPE_PINCONFIG: return 2;
+        case PACKET_TYPE_MDRIVE:    return (myProtocolVersion == PROTOCOL_COBS) ? 3 : 4;
+        case PACKET_TYPE_ENCINPUT:  return 1;
+        case PACKET_TYPE_ENCCLEAR:  return 1;
+        case PACKET_TYPE_SUBSCRIBE: return 4;
+        case PACKET_TYPE_VERSION:   return 1;
+        case PACKET_TYPE_CHECKSUM:  return 1;
+        default:                    return -1;
+    };
+}
+
+int
+WPIRBRobot::getResponseContentSize(byte type) const
+{
+    switch (type)
+    {
+        case PACKET_TYPE_ACK:           return 0;
+        case PACKET_TYPE_DVALUE:        return 2;
+        case PACKET_TYPE_AVALUE:        return 3;
+        case PACKET_TYPE_PINCONFIGINFO: return 2;
+        case PACKET_TYPE_ENCCOUNT:      return (myProtocolVersion == PROTOCOL_COBS) ? 5 : 6;
+        case PACKET_TYPE_VERSIONINFO:   return 1;
+        case PACKET_TYPE_CHECKSUMINFO:  return 1;
+        case PACKET_TYPE_NAK:           return 0;
+        default:                        return 0;
+    };
+}
+
+int
+WPIRBRobot::getSampleSize(byte requestType) const
+{
+    // Only input requests can be subscribed to; their responses are at most
+    // this large, including the type byte
+    switch (requestType)
+    {
+        case PACKET_TYPE_DINPUT:    return 1 + getResponseContentSize(PACKET_TYPE_DVALUE);
+        case PACKET_TYPE_AINPUT:    return 1 + getResponseContentSize(PACKET_TYPE_AVALUE);
+        case PACKET_TYPE_ENCINPUT:  return 1 + getResponseContentSize(PACKET_TYPE_ENCCOUNT);
+        default:                    return 0;
+    };
+}
+
 void
 WPIRBRobot::parsePingPacket()
 {
+  if (myIsInFrame == false && mySubscriptionCount > 0)
+  {
+    unsigned long now = millis();
+
+    if (isSampleDue(now))
+    {
+      beginFrameResponse();
+      sendDueSamples(now);
+      endFrameResponse();
+      return;
+    }
+  }
+
   acknowledge();
 }
 
@@ -244,14 +594,17 @@ WPIRBRobot::parsePinConfigPacket()
 void
 WPIRBRobot::parseMotorDrivePacket()
 {
-    if (myPacketSize == 7)
+    if (int(myPacketSize) == (3 + getContentSize(PACKET_TYPE_MDRIVE)))
     {
         byte motor = myPacketBuffer[2];
         byte direction = myPacketBuffer[3];
-        byte speedHi = myPacketBuffer[4];
-        byte speedLo = myPacketBuffer[5];
+        unsigned int speed = myPacketBuffer[4];
 
-        unsigned int speed = ((speedHi - 1) << 4) | (speedLo - 1);
+        if (myProtocolVersion == PROTOCOL_BOUNDED)
+        {
+            // Speed is split into nibbles offset to avoid the bound
+            speed = ((myPacketBuffer[4] - 1) << 4) | (myPacketBuffer[5] - 1);
+        }
 
         // Do not attempt to drive at very low speeds
         if (speed <= MOTOR_SPEED_THRESHOLD)
@@ -335,59 +688,233 @@ WPIRBRobot::parseEncoderClearPacket()
   return;
 }
 
+void
+WPIRBRobot::parseSubscribePacket()
+{
+    if (myPacketSize == 7)
+    {
+        byte requestType = myPacketBuffer[2];
+        byte address = myPacketBuffer[3];
+        unsigned int period = (myPacketBuffer[4] << 8) | myPacketBuffer[5];
+
+        if (myProtocolVersion == PROTOCOL_BOUNDED)
+        {
+            period =
+                (((myPacketBuffer[4] - 1) & 0x7F) << 7) |
+                ((myPacketBuffer[5] - 1) & 0x7F);
+        }
+
+        if (getSampleSize(requestType) > 0)
+        {
+            subscribe(requestType, address, period);
+        }
+    }
+
+    acknowledge();
+    return;
+}
+
+void
+WPIRBRobot::parseVersionPacket()
+{
+    // The protocol cannot change in the middle of a frame
+    if (myPacketSize != 4 || myIsInFrame == true)
+    {
+        acknowledge();
+        return;
+    }
+
+    byte version = myPacketBuffer[2];
+    if (version > PROTOCOL_COBS)
+    {
+        version = PROTOCOL_COBS;
+    }
+    else if (version < PROTOCOL_BOUNDED)
+    {
+        version = PROTOCOL_BOUNDED;
+    }
+
+    // The reply is sent with the protocol the request came in
+    sendVersionInfo(version);
+    setProtocolVersion(version);
+}
+
+void
+WPIRBRobot::parseChecksumPacket()
+{
+    // The checksum cannot change in the middle of a frame
+    if (myPacketSize != 4 || myIsInFrame == true)
+    {
+        acknowledge();
+        return;
+    }
+
+    byte checksumType = myPacketBuffer[2];
+    if (checksumType > CHECKSUM_CRC16)
+    {
+        checksumType = CHECKSUM_NONE;
+    }
+
+    // The reply carries the checksum the request came in with
+    sendChecksumInfo(checksumType);
+    myChecksumType = checksumType;
+}
+
+void
+WPIRBRobot::subscribe(byte requestType, byte address, unsigned int period)
+{
+    unsigned int subIdx = 0;
+    while (subIdx < mySubscriptionCount)
+    {
+        if (mySubscriptions[subIdx].requestType == requestType &&
+            mySubscriptions[subIdx].address == address)
+        {
+            break;
+        }
+        ++subIdx;
+    }
+
+    if (period == 0)
+    {
+        // Cancel by moving the last subscription into this one's place
+        if (subIdx < mySubscriptionCount)
+        {
+            mySubscriptions[subIdx] = mySubscriptions[--mySubscriptionCount];
+        }
+        return;
+    }
+
+    if (subIdx < mySubscriptionCount)
+    {
+        mySubscriptions[subIdx].period = period;
+        return;
+    }
+
+    if (mySubscriptionCount >= MAX_SUBSCRIPTIONS)
+    {
+        return;
+    }
+
+    // New subscriptions are sampled at the next opportunity
+    Subscription& sub = mySubscriptions[mySubscriptionCount++];
+    sub.requestType = requestType;
+    sub.address = address;
+    sub.period = period;
+    sub.lastSampleTime = millis() - period;
+}
+
+boolean
+WPIRBRobot::isSampleDue(unsigned long now) const
+{
+    for (unsigned int subIdx = 0; subIdx < mySubscriptionCount; ++subIdx)
+    {
+        if ((now - mySubscriptions[subIdx].lastSampleTime) >= mySubscriptions[subIdx].period)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+WPIRBRobot::sendDueSamples(unsigned long now)
+{
+    for (unsigned int subIdx = 0; subIdx < mySubscriptionCount; ++subIdx)
+    {
+        Subscription& sub = mySubscriptions[subIdx];
+
+        if ((now - sub.lastSampleTime) < sub.period)
+        {
+            continue;
+        }
+
+        // Samples that do not fit are sent with the next response frame
+        if ((myFrameResponseSize + getSampleSize(sub.requestType)) > FRAME_CONTENT_MAXSIZE)
+        {
+            continue;
+        }
+
+        // Sample by handling the subscribed request as if it was received
+        myPacketSize = 0;
+        myPacketBuffer[myPacketSize++] = PACKET_BOUND;
+        myPacketBuffer[myPacketSize++] = sub.requestType;
+        myPacketBuffer[myPacketSize++] = sub.address;
+        myPacketBuffer[myPacketSize++] = PACKET_BOUND;
+
+        dispatchPacket();
+
+        sub.lastSampleTime = now;
+    }
+}
+
 void
 WPIRBRobot::acknowledge()
 {
-  Serial.write(PACKET_BOUND);
-  Serial.write(PACKET_TYPE_ACK);
-  Serial.write(PACKET_BOUND);
-  
-  Serial.flush();
+  beginResponse(PACKET_TYPE_ACK);
+  endResponse();
+}
+
+void
+WPIRBRobot::negativeAcknowledge()
+{
+  beginResponse(PACKET_TYPE_NAK);
+  endResponse();
 }
 
 void
 WPIRBRobot::sendDigitalValue(unsigned int pin, boolean value)
 {
-  Serial.write(PACKET_BOUND);
-  Serial.write(PACKET_TYPE_DVALUE);
-  Serial.write(byte(pin));
-  Serial.write((value == HIGH) ? 0x02 : 0x01);
-  Serial.write(PACKET_BOUND);
-  
-  Serial.flush();
+  beginResponse(PACKET_TYPE_DVALUE);
+  writeResponseByte(byte(pin));
+  writeResponseByte((value == HIGH) ? 0x02 : 0x01);
+  endResponse();
 }
 
 void
 WPIRBRobot::sendAnalogValue(unsigned int pin, unsigned int value)
 {
-    Serial.write(PACKET_BOUND);
-    Serial.write(PACKET_TYPE_AVALUE);
-    Serial.write(byte(pin + 1));
-    Serial.write(byte(((0x3E0 & value) >> 5) + 1));
-    Serial.write(byte((0x01F & value) + 1));
-    Serial.write(PACKET_BOUND);
-
-    Serial.flush();
+    beginResponse(PACKET_TYPE_AVALUE);
+    writeResponseByte(byte(pin + 1));
+    if (myProtocolVersion == PROTOCOL_COBS)
+    {
+        writeResponseByte(byte(value >> 8));
+        writeResponseByte(byte(value & 0xFF));
+    }
+    else
+    {
+        writeResponseByte(byte(((0x3E0 & value) >> 5) + 1));
+        writeResponseByte(byte((0x01F & value) + 1));
+    }
+    endResponse();
 }
 
 void
 WPIRBRobot::sendPinConfigInfo(unsigned int pin, bool isOutput)
 {
-    Serial.write(PACKET_BOUND);
-    Serial.write(PACKET_TYPE_PINCONFIGINFO);
-    Serial.write(byte(pin));
-    Serial.write(byte(isOutput ? 0x01 : 0x02));
-    Serial.write(PACKET_BOUND);
-
-    Serial.flush();
+    beginResponse(PACKET_TYPE_PINCONFIGINFO);
+    writeResponseByte(byte(pin));
+    writeResponseByte(byte(isOutput ? 0x01 : 0x02));
+    endResponse();
 }
 
 void
 WPIRBRobot::sendEncoderCount(bool isRight, long count)
 {
-  Serial.write(PACKET_BOUND);
-  Serial.write(PACKET_TYPE_ENCCOUNT);
-  Serial.write(byte(isRight ? 1 : 2));
+  beginResponse(PACKET_TYPE_ENCCOUNT);
+  writeResponseByte(byte(isRight ? 1 : 2));
+
+  if (myProtocolVersion == PROTOCOL_COBS)
+    {
+      // Count is sent whole, most significant byte first
+      for (int bitOffset = 24; bitOffset >= 0; bitOffset -= 8)
+	{
+	  writeResponseByte(byte(count >> bitOffset));
+	}
+
+      endResponse();
+      return;
+    }
 
   // Split count up into 7-bit chunks
   for (int bitOffset = 31; bitOffset >= 0; bitOffset -= 7)
@@ -399,10 +926,180 @@ WPIRBRobot::sendEncoderCount(bool isRight, long count)
 	}
       ++curByte;
 
-      Serial.write(byte(curByte));
+      writeResponseByte(byte(curByte));
     }
 
-  Serial.write(PACKET_BOUND);
+  endResponse();
+}
+
+void
+WPIRBRobot::sendVersionInfo(byte version)
+{
+    beginResponse(PACKET_TYPE_VERSIONINFO);
+    writeResponseByte(version);
+    endResponse();
+}
+
+void
+WPIRBRobot::sendChecksumInfo(byte checksumType)
+{
+    beginResponse(PACKET_TYPE_CHECKSUMINFO);
+    writeResponseByte(checksumType);
+    endResponse();
+}
+
+void
+WPIRBRobot::beginResponse(byte type)
+{
+    // Responses inside a frame share the frame's bounds
+    if (myIsInFrame == false)
+    {
+        if (myProtocolVersion == PROTOCOL_COBS)
+        {
+            myResponseSize = 0;
+        }
+        else
+        {
+            Serial.write(PACKET_BOUND);
+        }
+
+        myResponseChecksum = getInitialChecksum();
+    }
+    else
+    {
+        // Responses that would overflow the frame start a new one, rather
+        // than be cut short with the frame's checksum
+        if ((myFrameResponseSize + 1 + getResponseContentSize(type)) > FRAME_CONTENT_MAXSIZE)
+        {
+            endFrameResponse();
+            beginFrameResponse();
+        }
+
+        myFrameResponseSize += 1 + getResponseContentSize(type);
+    }
+
+    writeResponseByte(type);
+}
+
+void
+WPIRBRobot::endResponse()
+{
+    if (myIsInFrame == true)
+    {
+        return;
+    }
+
+    writeResponseChecksum();
+
+    if (myProtocolVersion == PROTOCOL_COBS)
+    {
+        sendCobsResponse();
+    }
+    else
+    {
+        Serial.write(PACKET_BOUND);
+    }
+
+    Serial.flush();
+}
+
+void
+WPIRBRobot::beginFrameResponse()
+{
+    if (myProtocolVersion == PROTOCOL_COBS)
+    {
+        myResponseSize = 0;
+    }
+    else
+    {
+        Serial.write(PACKET_BOUND);
+    }
+
+    myResponseChecksum = getInitialChecksum();
+    writeResponseByte(PACKET_TYPE_FRAMEVALUES);
+    myIsInFrame = true;
+    myFrameResponseSize = 0;
+}
+
+void
+WPIRBRobot::endFrameResponse()
+{
+    myIsInFrame = false;
+
+    writeResponseChecksum();
+
+    if (myProtocolVersion == PROTOCOL_COBS)
+    {
+        sendCobsResponse();
+    }
+    else
+    {
+        Serial.write(PACKET_BOUND);
+    }
+
+    Serial.flush();
+}
+
+void
+WPIRBRobot::writeResponseByte(byte value)
+{
+    myResponseChecksum = updateChecksum(myResponseChecksum, value);
+
+    if (myProtocolVersion == PROTOCOL_BOUNDED)
+    {
+        Serial.write(value);
+        return;
+    }
+
+    if (myResponseSize < PACKET_BUFSIZE)
+    {
+        myResponseBuffer[myResponseSize++] = value;
+    }
+}
+
+void
+WPIRBRobot::writeResponseChecksum()
+{
+    // Written most significant bits first, in 7-bit chunks between bounds
+    unsigned int checksum = myResponseChecksum;
+    unsigned int checksumSize = getChecksumSize();
+    byte bitsPerByte = (myProtocolVersion == PROTOCOL_COBS) ? 8 : 7;
+
+    for (unsigned int byteIdx = checksumSize; byteIdx > 0; --byteIdx)
+    {
+        writeResponseByte(byte((checksum >> (bitsPerByte * (byteIdx - 1))) & ((1 << bitsPerByte) - 1)));
+    }
+}
+
+void
+WPIRBRobot::sendCobsResponse()
+{
+    // Each block is its length code followed by its bytes, up to a zero byte
+    // that the next block's code stands for
+    unsigned int blockStart = 0;
+    while (true)
+    {
+        unsigned int blockEnd = blockStart;
+        while (blockEnd < myResponseSize && myResponseBuffer[blockEnd] != 0x00 && (blockEnd - blockStart) < 254)
+        {
+            ++blockEnd;
+        }
+
+        Serial.write(byte(blockEnd - blockStart + 1));
+        for (unsigned int byteIdx = blockStart; byteIdx < blockEnd; ++byteIdx)
+        {
+            Serial.write(myResponseBuffer[byteIdx]);
+        }
+
+        if (blockEnd >= myResponseSize)
+        {
+            break;
+        }
+
+        // A full block stands for no zero byte
+        blockStart = ((blockEnd - blockStart) == 254) ? blockEnd : (blockEnd + 1);
+    }
 
-  Serial.flush();
+    Serial.write(PACKET_DELIMITER);
+    myResponseSize = 0;
 }
@@ -12,15 +12,32 @@ class WPIRBRobot
 {
     public:
 
+        static const unsigned long DEFAULT_BAUD_RATE = 9600;
+
         WPIRBRobot();
 
-        void setup();
+        // The baud rate must match the one the base station opens its serial
+        // port with
+        void setup(
+                unsigned long baudRate = DEFAULT_BAUD_RATE
+                );
 
         void loop();
 
     private:
 
+        void readBoundedByte(byte curByte);
+        void readCobsByte(byte curByte);
+        boolean storeCobsByte(byte curByte);
+        void setProtocolVersion(byte version);
+        boolean checkPacketChecksum();
+        unsigned int updateChecksum(unsigned int checksum, byte value) const;
+        unsigned int getInitialChecksum() const;
+        unsigned int getChecksumSize() const;
+
         void parsePacket();
+        void dispatchPacket();
+        void parseFramePacket();
         void parsePingPacket();
         void parseDigitalOutputPacket();
         void parseDigitalInputPacket();
@@ -29,8 +46,20 @@ class WPIRBRobot
         void parseMotorDrivePacket();
 	void parseEncoderInputPacket();
 	void parseEncoderClearPacket();
+        void parseSubscribePacket();
+        void parseVersionPacket();
+        void parseChecksumPacket();
+
+        void subscribe(
+                byte            requestType,
+                byte            address,
+                unsigned int    period
+                );
+        boolean isSampleDue(unsigned long now) const;
+        void sendDueSamples(unsigned long now);
 
         void acknowledge();
+        void negativeAcknowledge();
         void sendDigitalValue(
                 unsigned int    pin,
                 boolean         value
@@ -44,9 +73,45 @@ class WPIRBRobot
                 bool            isOutput
                 );
 	void sendEncoderCount(bool isRight, long count);
+        void sendVersionInfo(byte version);
+        void sendChecksumInfo(byte checksumType);
+
+        void beginResponse(byte type);
+        void endResponse();
+        void beginFrameResponse();
+        void endFrameResponse();
+        void writeResponseByte(byte value);
+        void writeResponseChecksum();
+        void sendCobsResponse();
+
+        int getContentSize(byte type) const;
+        int getResponseContentSize(byte type) const;
+        int getSampleSize(byte requestType) const;
 
         const static byte PACKET_BOUND = 0xFF;
 
+        const static byte PACKET_DELIMITER = 0x00;
+
+        // Packets start out between bounds with their contents kept clear of
+        // the bound. Once the host negotiates COBS, packets are sent as COBS
+        // frames ended by a delimiter, with full 8-bit contents.
+        const static byte PROTOCOL_BOUNDED = 1;
+        const static byte PROTOCOL_COBS = 2;
+
+        // Once the host negotiates a checksum, every packet carries one of
+        // its contents before the closing bound or delimiter, in 7-bit chunks
+        // between bounds and whole in COBS frames. Requests that fail it are
+        // answered with a NAK so that the host sends them again.
+        const static byte CHECKSUM_NONE = 0;
+        const static byte CHECKSUM_CRC8 = 1;
+        const static byte CHECKSUM_CRC16 = 2;
+
+        const static unsigned int CHECKSUM_MAXSIZE = 3;
+
+        // No packet holds this many bounds in a row, so they can only be the
+        // resync sequence, which also turns checksums off
+        const static byte RESYNC_BOUND_COUNT = 3;
+
         const static byte PACKET_TYPE_PING =        0x01;
         const static byte PACKET_TYPE_DOUTPUT =     0x02;
         const static byte PACKET_TYPE_DINPUT =      0x03;
@@ -55,14 +120,32 @@ class WPIRBRobot
         const static byte PACKET_TYPE_MDRIVE =      0x06;
         const static byte PACKET_TYPE_ENCINPUT =    0x07;
         const static byte PACKET_TYPE_ENCCLEAR =    0x08;
+        const static byte PACKET_TYPE_FRAME =       0x09;
+        const static byte PACKET_TYPE_SUBSCRIBE =   0x0A;
+        const static byte PACKET_TYPE_VERSION =     0x0B;
+        const static byte PACKET_TYPE_CHECKSUM =    0x0C;
 
         const static byte PACKET_TYPE_ACK =             0x82;
         const static byte PACKET_TYPE_DVALUE =          0x81;
         const static byte PACKET_TYPE_AVALUE =          0x83;
         const static byte PACKET_TYPE_PINCONFIGINFO =   0x84;
         const static byte PACKET_TYPE_ENCCOUNT =        0x85;
+        const static byte PACKET_TYPE_FRAMEVALUES =     0x86;
+        const static byte PACKET_TYPE_VERSIONINFO =     0x87;
+        const static byte PACKET_TYPE_CHECKSUMINFO =    0x88;
+        const static byte PACKET_TYPE_NAK =             0x89;
+
+        // Large enough for a full frame; other packets are limited to
+        // PACKET_MAXSIZE bytes
+        const static unsigned int PACKET_BUFSIZE = 64;
+
+        const static unsigned int PACKET_MAXSIZE = 10;
+
+        // Room for responses between the bounds, type and checksum of a
+        // response frame
+        const static unsigned int FRAME_CONTENT_MAXSIZE = PACKET_BUFSIZE - 3 - CHECKSUM_MAXSIZE;
 
-        const static unsigned int PACKET_BUFSIZE = 10;
+        const static unsigned int MAX_SUBSCRIPTIONS = 8;
 
         const static unsigned int MOTOR_SPEED_THRESHOLD = 64;
 
@@ -75,6 +158,53 @@ class WPIRBRobot
         unsigned int myPacketSize;
 
         boolean myIsHeaderRead;
+
+        byte myProtocolVersion;
+
+        byte myChecksumType;
+
+        // Checksum of the response being written
+        unsigned int myResponseChecksum;
+
+        // Number of bounds read in a row
+        byte myBoundCount;
+
+        // COBS frames are decoded as they arrive. The code byte of the
+        // current block, or 0 before the first block of a frame, and the
+        // number of its data bytes still to come.
+        byte myCobsCode;
+
+        byte myCobsRemaining;
+
+        // Set while the rest of a malformed or overlong frame is skipped
+        boolean myIsFrameDropped;
+
+        // Responses are gathered here to be framed when using COBS
+        byte myResponseBuffer[PACKET_BUFSIZE];
+
+        unsigned int myResponseSize;
+
+        // Set while the packets of a frame are being handled, so that their
+        // responses are gathered into a single response frame
+        boolean myIsInFrame;
+
+        // Number of response bytes written to the current response frame
+        unsigned int myFrameResponseSize;
+
+        // Input requests that are answered periodically without being sent.
+        // Due samples are appended to response frames, and a ping is answered
+        // with a frame of them in place of an acknowledgement.
+        struct Subscription
+        {
+            byte requestType;
+            byte address;
+            unsigned int period;
+            unsigned long lastSampleTime;
+        };
+
+        Subscription mySubscriptions[MAX_SUBSCRIPTIONS];
+
+        unsigned int mySubscriptionCount;
 };
 
 #endif /* ifndef WPIRBROBOT_H */
@@ -0,0 +1,23 @@
+#include "BenchPackets.h"
+#include "benchmark/benchmark.h"
+
+
+int
+main(
+        int argc,
+        char** argv
+    )
+{
+    RegisterPacketBenchmarks();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv) == true)
+    {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
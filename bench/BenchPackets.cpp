@@ -0,0 +1,339 @@
+
+#include "BenchPackets.h"
+#include "RedBotPacket.h"
+#include "ConfigurableInterface.h"
+#include "DigitalInput.h"
+#include "DigitalOutput.h"
+#include "AnalogInput.h"
+#include "RedBotEncoder.h"
+#include "RedBotSpeedController.h"
+#include "XMLElement.h"
+#include "benchmark/benchmark.h"
+#include <sstream>
+#include <string>
+
+
+/**
+ * Generator used to decode packets and to read embedded packets of frames
+ */
+static RedBotPacketGenerator PacketGen;
+
+/**
+ * Names of the sample packets, one of each type, in the order created by
+ * CreateSamplePacket()
+ */
+static const char* const SamplePacketNames[] = {
+    "PingPacket",
+    "AcknowledgePacket",
+    "NegativeAcknowledgePacket",
+    "FramePacket",
+    "FrameValuesPacket",
+    "SubscribePacket",
+    "VersionPacket",
+    "VersionInfoPacket",
+    "ChecksumPacket",
+    "ChecksumInfoPacket",
+    "PinConfigPacket",
+    "PinConfigInfoPacket",
+    "DigitalInputPacket",
+    "DigitalValuePacket",
+    "DigitalOutputPacket",
+    "AnalogInputPacket",
+    "AnalogValuePacket",
+    "MotorDrivePacket",
+    "EncoderInputPacket",
+    "EncoderCountPacket",
+    "EncoderClearPacket"
+};
+
+/**
+ * Number of sample packets
+ */
+static const size_t NumSamplePackets = sizeof(SamplePacketNames) / sizeof(SamplePacketNames[0]);
+
+/**
+ * Number of data elements in the largest XML element list measured
+ */
+static const int MaxXMLElementCount = 64;
+
+/**
+ * Creates the sample packet of the given index
+ *
+ * Frames are filled with the packets a typical cycle of a small robot
+ * exchanges.
+ */
+static RedBotPacket*
+CreateSamplePacket(
+        size_t packetIdx
+        )
+{
+    switch (packetIdx)
+    {
+        case 0: return new PingPacket(); break;
+        case 1: return new AcknowledgePacket(); break;
+        case 2: return new NegativeAcknowledgePacket(); break;
+        case 3:
+        {
+            FramePacket* framePacket = new FramePacket(&PacketGen);
+            framePacket->add(new DigitalInputPacket(3));
+            framePacket->add(new AnalogInputPacket(2));
+            framePacket->add(new EncoderInputPacket(true));
+            framePacket->add(new EncoderInputPacket(false));
+            framePacket->add(new MotorDrivePacket(MotorDrivePacket::MOTOR_LEFT, 0.5));
+            framePacket->add(new MotorDrivePacket(MotorDrivePacket::MOTOR_RIGHT, -0.5));
+            return framePacket;
+        }
+        break;
+        case 4:
+        {
+            FrameValuesPacket* framePacket = new FrameValuesPacket(&PacketGen);
+            framePacket->add(new DigitalValuePacket(3, true));
+            framePacket->add(new AnalogValuePacket(2, 612));
+            framePacket->add(new EncoderCountPacket(true, 1234));
+            framePacket->add(new EncoderCountPacket(false, -1234));
+            framePacket->add(new AcknowledgePacket());
+            framePacket->add(new AcknowledgePacket());
+            return framePacket;
+        }
+        break;
+        case 5: return new SubscribePacket(AnalogInputPacket(1), 20); break;
+        case 6: return new VersionPacket(Packet::PROTOCOL_COBS); break;
+        case 7: return new VersionInfoPacket(Packet::PROTOCOL_COBS); break;
+        case 8: return new ChecksumPacket(Crc::TYPE_CRC16); break;
+        case 9: return new ChecksumInfoPacket(Crc::TYPE_CRC16); break;
+        case 10: return new PinConfigPacket(4, RedBotPacket::DIR_INPUT); break;
+        case 11: return new PinConfigInfoPacket(4, RedBotPacket::DIR_INPUT); break;
+        case 12: return new DigitalInputPacket(13); break;
+        case 13: return new DigitalValuePacket(13, true); break;
+        case 14: return new DigitalOutputPacket(7, true); break;
+        case 15: return new AnalogInputPacket(3); break;
+        case 16: return new AnalogValuePacket(3, 1023); break;
+        case 17: return new MotorDrivePacket(MotorDrivePacket::MOTOR_LEFT, 0.75); break;
+        case 18: return new EncoderInputPacket(true); break;
+        case 19: return new EncoderCountPacket(false, -30000); break;
+        case 20: return new EncoderClearPacket(true); break;
+        default: return NULL; break;
+    };
+
+    return NULL;
+}
+
+/**
+ * Measures encoding a packet between boundary bytes
+ */
+static void
+EncodePacket(
+        benchmark::State&   state,
+        size_t              packetIdx
+        )
+{
+    RedBotPacket* packet = CreateSamplePacket(packetIdx);
+    unsigned char packetData[Packet::MAX_BINARY_SIZE];
+    size_t packetSize = 0;
+
+    for (auto _ : state)
+    {
+        packetSize = packet->encode(packetData, sizeof(packetData));
+        benchmark::DoNotOptimize(packetData);
+    }
+
+    state.SetBytesProcessed(state.iterations() * packetSize);
+    delete packet;
+}
+
+/**
+ * Measures decoding a packet held in memory, from its type byte on
+ */
+static void
+DecodePacket(
+        benchmark::State&   state,
+        size_t              packetIdx
+        )
+{
+    RedBotPacket* packet = CreateSamplePacket(packetIdx);
+    unsigned char packetData[Packet::MAX_BINARY_SIZE];
+    size_t packetSize = packet->encode(packetData, sizeof(packetData));
+    delete packet;
+
+    for (auto _ : state)
+    {
+        PacketHandle decodedPacket = Packet::Decode(packetData, packetSize, PacketGen);
+        if (decodedPacket.isNull() == true)
+        {
+            state.SkipWithError("Packet failed to decode");
+            break;
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * packetSize);
+}
+
+/**
+ * Measures encoding a packet as a COBS frame
+ */
+static void
+EncodeCobsPacket(
+        benchmark::State&   state,
+        size_t              packetIdx
+        )
+{
+    RedBotPacket* packet = CreateSamplePacket(packetIdx);
+    unsigned char frameData[2 * Packet::MAX_BINARY_SIZE];
+    size_t frameSize = 0;
+
+    for (auto _ : state)
+    {
+        frameSize = packet->encodeCobs(frameData, sizeof(frameData), Crc::TYPE_CRC16);
+        benchmark::DoNotOptimize(frameData);
+    }
+
+    state.SetBytesProcessed(state.iterations() * frameSize);
+    delete packet;
+}
+
+/**
+ * Measures decoding a packet from a COBS frame
+ */
+static void
+DecodeCobsPacket(
+        benchmark::State&   state,
+        size_t              packetIdx
+        )
+{
+    RedBotPacket* packet = CreateSamplePacket(packetIdx);
+    unsigned char frameData[2 * Packet::MAX_BINARY_SIZE];
+    size_t frameSize = packet->encodeCobs(frameData, sizeof(frameData), Crc::TYPE_CRC16);
+    delete packet;
+
+    for (auto _ : state)
+    {
+        PacketHandle decodedPacket = Packet::DecodeCobs(
+                frameData,
+                frameSize,
+                PacketGen,
+                NULL,
+                Crc::TYPE_CRC16
+                );
+        if (decodedPacket.isNull() == true)
+        {
+            state.SkipWithError("Frame failed to decode");
+            break;
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * frameSize);
+}
+
+/**
+ * Measures reading a packet from a stream through the packet generator
+ */
+static void
+ReadPacket(
+        benchmark::State&   state,
+        size_t              packetIdx
+        )
+{
+    RedBotPacket* packet = CreateSamplePacket(packetIdx);
+    std::ostringstream packetStream;
+    packet->write(packetStream);
+    delete packet;
+
+    const std::string packetData = packetStream.str();
+    std::istringstream inputStream;
+
+    for (auto _ : state)
+    {
+        inputStream.clear();
+        inputStream.str(packetData);
+
+        PacketHandle readPacket = Packet::Read(inputStream, PacketGen);
+        if (readPacket.isNull() == true)
+        {
+            state.SkipWithError("Packet failed to read");
+            break;
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * packetData.size());
+}
+
+/**
+ * Measures generating the XML representation of a packet
+ */
+static void
+WritePacketXML(
+        benchmark::State&   state,
+        size_t              packetIdx
+        )
+{
+    RedBotPacket* packet = CreateSamplePacket(packetIdx);
+    std::ostringstream xmlStream;
+
+    for (auto _ : state)
+    {
+        xmlStream.str("");
+        packet->writeXML(xmlStream);
+    }
+
+    state.SetBytesProcessed(state.iterations() * xmlStream.str().size());
+    delete packet;
+}
+
+/**
+ * Measures building and serializing a list of XML data elements
+ */
+static void
+WriteXMLElements(
+        benchmark::State& state
+        )
+{
+    std::ostringstream xmlStream;
+
+    for (auto _ : state)
+    {
+        XMLElements elements;
+        for(
+                int elementIdx = 0;
+                elementIdx < state.range(0);
+                ++elementIdx
+           )
+        {
+            elements.add(new XMLDataElement<int>("value", elementIdx));
+        }
+
+        xmlStream.str("");
+        xmlStream << elements;
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(WriteXMLElements)->RangeMultiplier(4)->Range(1, MaxXMLElementCount);
+
+void
+RegisterPacketBenchmarks()
+{
+    for(
+            size_t packetIdx = 0;
+            packetIdx < NumSamplePackets;
+            ++packetIdx
+       )
+    {
+        const std::string packetName = SamplePacketNames[packetIdx];
+
+        benchmark::RegisterBenchmark(("EncodePacket/" + packetName).c_str(), EncodePacket, packetIdx);
+        benchmark::RegisterBenchmark(("DecodePacket/" + packetName).c_str(), DecodePacket, packetIdx);
+        benchmark::RegisterBenchmark(("ReadPacket/" + packetName).c_str(), ReadPacket, packetIdx);
+        benchmark::RegisterBenchmark(("WritePacketXML/" + packetName).c_str(), WritePacketXML, packetIdx);
+
+        RedBotPacket* packet = CreateSamplePacket(packetIdx);
+        unsigned char packetData[Packet::MAX_BINARY_SIZE];
+        bool isNative = (packet->encodeNative(packetData, sizeof(packetData)) > 0);
+        delete packet;
+
+        if (isNative == true)
+        {
+            benchmark::RegisterBenchmark(("EncodeCobsPacket/" + packetName).c_str(), EncodeCobsPacket, packetIdx);
+            benchmark::RegisterBenchmark(("DecodeCobsPacket/" + packetName).c_str(), DecodeCobsPacket, packetIdx);
+        }
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef BENCHPACKETS_H
+#define BENCHPACKETS_H
+
+/**
+ * Registers the measurements of a sample packet of each type, under the
+ * packet type's name
+ *
+ * Each packet is encoded, decoded, read from a stream and written as XML.
+ * Packets with a native encoding are also encoded and decoded as COBS frames.
+ */
+void
+RegisterPacketBenchmarks();
+
+#endif /* ifndef BENCHPACKETS_H */
@@ -0,0 +1,393 @@
+
+#include "RedBot.h"
+#include "RedBotPacket.h"
+#include "ConfigurableInterface.h"
+#include "DigitalInput.h"
+#include "DigitalOutput.h"
+#include "IterativeRobot.h"
+#include "IOBuffer.h"
+#include "benchmark/benchmark.h"
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * Number of components of the largest robot measured
+ */
+static const int MaxComponentCount = 16;
+
+/**
+ * Number of cycles run before measuring, for every pin to be configured
+ */
+static const size_t WarmUpCycleCount = 10;
+
+/**
+ * Answers each packet written to it with a response scripted beforehand
+ *
+ * Responses are kept encoded, keyed by the bytes of the request they answer,
+ * so that no packet is built on this side of the exchange. Requests without
+ * a scripted response are acknowledged.
+ */
+class ScriptedBuffer : public InputBuffer, public OutputBuffer
+{
+    public:
+
+        /**
+         * Default constructor
+         */
+        ScriptedBuffer() :
+            InputBuffer(),
+            OutputBuffer(),
+            myResponseData(NULL),
+            myRequestCount(0)
+        {
+            AcknowledgePacket ackPacket;
+            myAckData = Encode(ackPacket);
+        }
+
+        /**
+         * Scripts the response to the given request
+         */
+        void addResponse(
+                const Packet& request,
+                const Packet& response
+                )
+        {
+            myResponses[Encode(request)] = Encode(response);
+        }
+
+        /**
+         * Provides the number of requests written so far
+         */
+        unsigned long getRequestCount() const
+        {
+            return myRequestCount;
+        }
+
+        bool readPacket()
+        {
+            return (myResponseData != NULL);
+        }
+
+        bool getPacketData(
+                const unsigned char*&   data,
+                size_t&                 dataSize
+                )
+        {
+            if (myResponseData == NULL)
+            {
+                return false;
+            }
+
+            data = (const unsigned char*)myResponseData->data();
+            dataSize = myResponseData->size();
+
+            return true;
+        }
+
+        std::istream& getInputStream()
+        {
+            myInputStream.clear();
+            myInputStream.str(myResponseData != NULL ? *myResponseData : "");
+
+            return myInputStream;
+        }
+
+        bool writePacket()
+        {
+            std::string requestData = myOutputStream.str();
+            myOutputStream.str("");
+
+            return writeData(
+                    (const unsigned char*)requestData.data(),
+                    requestData.size()
+                    );
+        }
+
+        bool writeData(
+                const unsigned char*    data,
+                size_t                  dataSize
+                )
+        {
+            myRequestData.assign((const char*)data, dataSize);
+            ++myRequestCount;
+
+            std::unordered_map<std::string, std::string>::const_iterator responseIter =
+                myResponses.find(myRequestData);
+            if (responseIter != myResponses.end())
+            {
+                myResponseData = &responseIter->second;
+            }
+            else
+            {
+                myResponseData = &myAckData;
+            }
+
+            return true;
+        }
+
+        std::ostream& getOutputStream()
+        {
+            return myOutputStream;
+        }
+
+        void clear()
+        {
+            myOutputStream.str("");
+        }
+
+        void resync()
+        {
+            myResponseData = NULL;
+        }
+
+    private:
+
+        /**
+         * Encodes a packet between boundary bytes
+         */
+        static std::string Encode(
+                const Packet& packet
+                )
+        {
+            unsigned char packetData[Packet::MAX_BINARY_SIZE];
+            size_t packetSize = packet.encode(packetData, sizeof(packetData));
+
+            return std::string((const char*)packetData, packetSize);
+        }
+
+        /**
+         * Encoded responses keyed by the encoded requests they answer
+         */
+        std::unordered_map<std::string, std::string> myResponses;
+
+        /**
+         * Encoded acknowledgement for requests without a scripted response
+         */
+        std::string myAckData;
+
+        /**
+         * Bytes of the last request written
+         */
+        std::string myRequestData;
+
+        /**
+         * Response to the last request written, or NULL if there is none
+         */
+        const std::string* myResponseData;
+
+        /**
+         * Number of requests written so far
+         */
+        unsigned long myRequestCount;
+
+        /**
+         * Stream adapter for requests written through a stream
+         */
+        std::stringstream myOutputStream;
+
+        /**
+         * Stream adapter for responses read through a stream
+         */
+        std::stringstream myInputStream;
+};
+
+/**
+ * Program that reads half of its components and sets the other half
+ *
+ * Inputs are on even pins and outputs on odd pins. Outputs change every
+ * cycle, so that each one is written every cycle.
+ */
+class BenchmarkProgram : public frc::IterativeRobot
+{
+    public:
+
+        /**
+         * Constructor given the number of components
+         */
+        BenchmarkProgram(
+                int componentCount
+                ) :
+            IterativeRobot(),
+            myHighCount(0),
+            myIsSet(false)
+        {
+            for(
+                    int pin = 0;
+                    pin < componentCount;
+                    ++pin
+               )
+            {
+                if ((pin % 2) == 0)
+                {
+                    myInputs.push_back(new frc::DigitalInput(pin));
+                }
+                else
+                {
+                    myOutputs.push_back(new frc::DigitalOutput(pin));
+                }
+            }
+        }
+
+        /**
+         * Destructor
+         */
+        ~BenchmarkProgram()
+        {
+            for(
+                    std::vector<frc::DigitalInput*>::const_iterator inputIter = myInputs.begin();
+                    inputIter != myInputs.end();
+                    ++inputIter
+               )
+            {
+                delete (*inputIter);
+            }
+
+            for(
+                    std::vector<frc::DigitalOutput*>::const_iterator outputIter = myOutputs.begin();
+                    outputIter != myOutputs.end();
+                    ++outputIter
+               )
+            {
+                delete (*outputIter);
+            }
+        }
+
+        void TeleopPeriodic()
+        {
+            for(
+                    std::vector<frc::DigitalInput*>::const_iterator inputIter = myInputs.begin();
+                    inputIter != myInputs.end();
+                    ++inputIter
+               )
+            {
+                if ((*inputIter)->Get() == true)
+                {
+                    ++myHighCount;
+                }
+            }
+
+            myIsSet = !myIsSet;
+
+            for(
+                    std::vector<frc::DigitalOutput*>::const_iterator outputIter = myOutputs.begin();
+                    outputIter != myOutputs.end();
+                    ++outputIter
+               )
+            {
+                (*outputIter)->Set(myIsSet);
+            }
+        }
+
+        /**
+         * Provides the number of times inputs were read high
+         */
+        unsigned long getHighCount() const
+        {
+            return myHighCount;
+        }
+
+    private:
+
+        /**
+         * Inputs on even pins
+         */
+        std::vector<frc::DigitalInput*> myInputs;
+
+        /**
+         * Outputs on odd pins
+         */
+        std::vector<frc::DigitalOutput*> myOutputs;
+
+        /**
+         * Number of times inputs were read high
+         */
+        unsigned long myHighCount;
+
+        /**
+         * Value the outputs were last set to
+         */
+        bool myIsSet;
+};
+
+/**
+ * Measures a full cycle of a robot with the given number of components,
+ * from dispatching responses to user code and the exchange with the robot
+ */
+static void
+RunCycle(
+        benchmark::State& state
+        )
+{
+    int componentCount = state.range(0);
+
+    ScriptedBuffer buffer;
+    for(
+            int pin = 0;
+            pin < componentCount;
+            ++pin
+       )
+    {
+        if ((pin % 2) == 0)
+        {
+            buffer.addResponse(
+                    PinConfigPacket(pin, RedBotPacket::DIR_INPUT),
+                    PinConfigInfoPacket(pin, RedBotPacket::DIR_INPUT)
+                    );
+            buffer.addResponse(
+                    DigitalInputPacket(pin),
+                    DigitalValuePacket(pin, true)
+                    );
+        }
+        else
+        {
+            buffer.addResponse(
+                    PinConfigPacket(pin, RedBotPacket::DIR_OUTPUT),
+                    PinConfigInfoPacket(pin, RedBotPacket::DIR_OUTPUT)
+                    );
+        }
+    }
+
+    BenchmarkProgram program(componentCount);
+    RedBot robot(
+            &program,
+            &buffer,
+            &buffer,
+            new RedBotPacketGenerator()
+            );
+
+    robot.modeInit(FieldControlSystem::MODE_TELEOP);
+    for(
+            size_t cycleIdx = 0;
+            cycleIdx < WarmUpCycleCount;
+            ++cycleIdx
+       )
+    {
+        robot.modePeriodic(FieldControlSystem::MODE_TELEOP);
+    }
+
+    unsigned long requestCount = buffer.getRequestCount();
+
+    for (auto _ : state)
+    {
+        robot.modePeriodic(FieldControlSystem::MODE_TELEOP);
+    }
+
+    // Scripted values only reach the program through a working exchange
+    if(
+            (robot.getStatus() != RedBot::STATUS_GOOD) ||
+            (program.getHighCount() == 0)
+      )
+    {
+        state.SkipWithError("Robot lost its link");
+    }
+
+    state.SetItemsProcessed(state.iterations() * componentCount);
+    state.counters["requests"] = benchmark::Counter(
+            buffer.getRequestCount() - requestCount,
+            benchmark::Counter::kAvgIterations
+            );
+}
+BENCHMARK(RunCycle)->RangeMultiplier(2)->Range(1, MaxComponentCount);
@@ -0,0 +1,147 @@
+
+#include "Scheduler.h"
+#include "Subsystem.h"
+#include "Command.h"
+#include "benchmark/benchmark.h"
+#include <vector>
+
+
+/**
+ * Number of subsystems of the largest scheduler measured
+ */
+static const int MaxSubsystemCount = 64;
+
+/**
+ * Subsystem that runs its default command once initialized
+ */
+class BenchmarkSubsystem : public frc::Subsystem
+{
+    public:
+
+        /**
+         * Constructor given the default command to run
+         */
+        BenchmarkSubsystem(
+                frc::Command* defaultCommand
+                ) :
+            Subsystem("benchmark"),
+            myDefaultCommand(defaultCommand)
+        {
+        }
+
+        void InitDefaultCommand()
+        {
+            SetDefaultCommand(myDefaultCommand);
+        }
+
+    private:
+
+        /**
+         * Command run when no other command is
+         */
+        frc::Command* myDefaultCommand;
+};
+
+/**
+ * Command that counts its executions and never finishes
+ */
+class BenchmarkCommand : public frc::Command
+{
+    public:
+
+        /**
+         * Default constructor
+         */
+        BenchmarkCommand() :
+            Command(),
+            myExecuteCount(0)
+        {
+        }
+
+        /**
+         * Provides the number of executions so far
+         */
+        unsigned long getExecuteCount() const
+        {
+            return myExecuteCount;
+        }
+
+    protected:
+
+        void Execute()
+        {
+            ++myExecuteCount;
+        }
+
+        bool IsFinished()
+        {
+            return false;
+        }
+
+    private:
+
+        /**
+         * Number of executions so far
+         */
+        unsigned long myExecuteCount;
+};
+
+/**
+ * Measures a scheduler run with the given number of subsystems
+ *
+ * Each subsystem runs a default command, and as many commands without
+ * subsystems run alongside.
+ */
+static void
+RunScheduler(
+        benchmark::State& state
+        )
+{
+    int subsystemCount = state.range(0);
+
+    std::vector<BenchmarkCommand*> commands;
+    std::vector<BenchmarkSubsystem*> subsystems;
+    for(
+            int subsystemIdx = 0;
+            subsystemIdx < subsystemCount;
+            ++subsystemIdx
+       )
+    {
+        commands.push_back(new BenchmarkCommand());
+        subsystems.push_back(new BenchmarkSubsystem(commands.back()));
+
+        commands.push_back(new BenchmarkCommand());
+        commands.back()->Start();
+    }
+
+    frc::Scheduler* scheduler = frc::Scheduler::GetInstance();
+    for (auto _ : state)
+    {
+        scheduler->Run();
+    }
+
+    unsigned long executeCount = 0;
+    for(
+            std::vector<BenchmarkCommand*>::const_iterator commandIter = commands.begin();
+            commandIter != commands.end();
+            ++commandIter
+       )
+    {
+        executeCount += (*commandIter)->getExecuteCount();
+        delete (*commandIter);
+    }
+
+    for(
+            std::vector<BenchmarkSubsystem*>::const_iterator subsystemIter = subsystems.begin();
+            subsystemIter != subsystems.end();
+            ++subsystemIter
+       )
+    {
+        delete (*subsystemIter);
+    }
+
+    frc::Scheduler::DestroyInstance();
+
+    state.SetItemsProcessed(executeCount);
+}
+BENCHMARK(RunScheduler)->RangeMultiplier(4)->Range(1, MaxSubsystemCount);
@@ -0,0 +1,124 @@
+
+#include "Clock.h"
+#include <errno.h>
+#include <math.h>
+#include <stddef.h>
+#include <time.h>
+
+
+std::atomic<Clock*> Clock::ourInstance(NULL);
+
+
+Clock&
+Clock::GetInstance()
+{
+    Clock* clock = ourInstance.load(std::memory_order_acquire);
+    if (clock != NULL)
+    {
+        return *clock;
+    }
+
+    static MonotonicClock monotonicClock;
+    return monotonicClock;
+}
+
+void
+Clock::SetInstance(
+        Clock* clock
+        )
+{
+    ourInstance.store(clock, std::memory_order_release);
+}
+
+
+long long
+MonotonicClock::getTime()
+{
+    struct timespec currentTimeSpec;
+
+    clock_gettime(
+            CLOCK_MONOTONIC,
+            &currentTimeSpec
+            );
+
+    return (currentTimeSpec.tv_sec * NSEC_PER_SEC) + currentTimeSpec.tv_nsec;
+}
+
+void
+MonotonicClock::sleepUntil(
+        long long time
+        )
+{
+    struct timespec timeSpec;
+    timeSpec.tv_sec = time / NSEC_PER_SEC;
+    timeSpec.tv_nsec = time % NSEC_PER_SEC;
+
+    // Sleep again if interrupted by a signal
+    while(
+            clock_nanosleep(
+                CLOCK_MONOTONIC,
+                TIMER_ABSTIME,
+                &timeSpec,
+                NULL
+                ) == EINTR
+         )
+    {
+    }
+}
+
+bool
+MonotonicClock::isRealTime() const
+{
+    return true;
+}
+
+
+ManualClock::ManualClock(
+        long long time
+        ) :
+    myTime(time)
+{
+}
+
+long long
+ManualClock::getTime()
+{
+    return myTime.load();
+}
+
+void
+ManualClock::sleepUntil(
+        long long time
+        )
+{
+    // Sleepers on several threads only ever move the time on
+    long long currentTime = myTime.load();
+    while(
+            (currentTime < time) &&
+            (myTime.compare_exchange_weak(currentTime, time) == false)
+         )
+    {
+    }
+}
+
+bool
+ManualClock::isRealTime() const
+{
+    return false;
+}
+
+void
+ManualClock::setTime(
+        long long time
+        )
+{
+    myTime.store(time);
+}
+
+void
+ManualClock::advance(
+        double seconds
+        )
+{
+    myTime.fetch_add(llround(seconds * NSEC_PER_SEC));
+}
@@ -0,0 +1,160 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <atomic>
+
+/**
+ * Source of the time used throughout the framework
+ *
+ * Timers, the robot loop, sample timestamps and the timeouts of packet
+ * exchanges all read the time from and wait on the clock in use by the
+ * process. This is the system's monotonic clock unless another one is put in
+ * its place, such as a manual clock under test or a simulated one, which let
+ * programs run faster than real time with deterministic timing.
+ *
+ * Times are in nanoseconds since an arbitrary fixed point.
+ */
+class Clock
+{
+    public:
+
+        /**
+         * Number of nanoseconds in a second
+         */
+        static const long long NSEC_PER_SEC = 1000000000LL;
+
+        /**
+         * Destructor
+         */
+        virtual ~Clock(){};
+
+        /**
+         * Provides the current time
+         *
+         * \return Number of nanoseconds elapsed since an arbitrary fixed point
+         */
+        virtual long long getTime() = 0;
+
+        /**
+         * Waits until the given time
+         *
+         * Times already passed return right away.
+         */
+        virtual void sleepUntil(
+                long long time  /**< Time to wake at, in nanoseconds */
+                ) = 0;
+
+        /**
+         * Indicates if the clock follows real time
+         *
+         * Real-time clocks keep the time of the system's monotonic clock.
+         * Waits for events from outside the process, such as packets from a
+         * device, can only block until a deadline on a real-time clock. On
+         * other clocks, whatever is ready at the deadline is taken.
+         */
+        virtual bool isRealTime() const = 0;
+
+        /**
+         * Provides the clock in use by the process
+         */
+        static Clock& GetInstance();
+
+        /**
+         * Sets the clock in use by the process
+         *
+         * The clock is not owned, and must outlive its use.
+         */
+        static void SetInstance(
+                Clock* clock    /**< Clock, or NULL for the monotonic clock */
+                );
+
+    private:
+
+        /**
+         * Clock in use by the process, or NULL for the monotonic clock
+         */
+        static std::atomic<Clock*> ourInstance;
+};
+
+/**
+ * System's monotonic clock, following real time
+ */
+class MonotonicClock : public Clock
+{
+    public:
+
+        /**
+         * Provides the current time of the system's monotonic clock
+         */
+        long long getTime();
+
+        /**
+         * Sleeps until the given time of the system's monotonic clock
+         */
+        void sleepUntil(
+                long long time
+                );
+
+        /**
+         * Indicates that the clock follows real time
+         */
+        bool isRealTime() const;
+};
+
+/**
+ * Clock whose time only moves on when set
+ *
+ * Sleeping moves the time straight on to the time slept until, so that
+ * waits take no real time.
+ */
+class ManualClock : public Clock
+{
+    public:
+
+        /**
+         * Constructor given the time to start at, in nanoseconds
+         */
+        ManualClock(
+                long long time = 0
+                );
+
+        /**
+         * Provides the time last set
+         */
+        long long getTime();
+
+        /**
+         * Moves the time on to the given time, unless already past it
+         */
+        void sleepUntil(
+                long long time
+                );
+
+        /**
+         * Indicates that the clock does not follow real time
+         */
+        bool isRealTime() const;
+
+        /**
+         * Sets the time, in nanoseconds
+         */
+        void setTime(
+                long long time
+                );
+
+        /**
+         * Moves the time on by the given number of seconds
+         */
+        void advance(
+                double seconds
+                );
+
+    private:
+
+        /**
+         * Current time, in nanoseconds
+         */
+        std::atomic<long long> myTime;
+};
+
+#endif /* ifndef CLOCK_H */
@@ -0,0 +1,122 @@
+#include "Cobs.h"
+
+
+size_t
+Cobs::GetMaxEncodedSize(
+        size_t dataSize
+        )
+{
+    return dataSize + (dataSize / 254) + 1;
+}
+
+size_t
+Cobs::Encode(
+        const unsigned char*    data,
+        size_t                  dataSize,
+        unsigned char*          buffer,
+        size_t                  bufferSize
+        )
+{
+    if (bufferSize < GetMaxEncodedSize(dataSize))
+    {
+        return 0;
+    }
+
+    // Each code byte holds the distance to the next zero byte it replaces
+    size_t codeIdx = 0;
+    size_t encodedSize = 1;
+    unsigned char code = 1;
+
+    for(
+            size_t dataIdx = 0;
+            dataIdx < dataSize;
+            ++dataIdx
+       )
+    {
+        if (data[dataIdx] != DELIMITER)
+        {
+            buffer[encodedSize++] = data[dataIdx];
+            ++code;
+        }
+
+        if(
+                (data[dataIdx] == DELIMITER) ||
+                (code == 0xFF)
+          )
+        {
+            buffer[codeIdx] = code;
+            codeIdx = encodedSize++;
+            code = 1;
+
+            // A full block that ends the data needs no trailing code
+            if(
+                    (data[dataIdx] != DELIMITER) &&
+                    ((dataIdx + 1) == dataSize)
+              )
+            {
+                --encodedSize;
+                return encodedSize;
+            }
+        }
+    }
+
+    buffer[codeIdx] = code;
+
+    return encodedSize;
+}
+
+size_t
+Cobs::Decode(
+        const unsigned char*    data,
+        size_t                  dataSize,
+        unsigned char*          buffer,
+        size_t                  bufferSize
+        )
+{
+    size_t dataIdx = 0;
+    size_t decodedSize = 0;
+
+    while(
+            (dataIdx < dataSize) &&
+            (data[dataIdx] != DELIMITER)
+         )
+    {
+        unsigned char code = data[dataIdx++];
+
+        for(
+                unsigned char byteIdx = 1;
+                byteIdx < code;
+                ++byteIdx
+           )
+        {
+            if(
+                    (dataIdx >= dataSize) ||
+                    (data[dataIdx] == DELIMITER) ||
+                    (decodedSize >= bufferSize)
+              )
+            {
+                // Block runs past the frame or the buffer
+                return 0;
+            }
+
+            buffer[decodedSize++] = data[dataIdx++];
+        }
+
+        // Every block but a full one or the last stands for a zero byte
+        if(
+                (code != 0xFF) &&
+                (dataIdx < dataSize) &&
+                (data[dataIdx] != DELIMITER)
+          )
+        {
+            if (decodedSize >= bufferSize)
+            {
+                return 0;
+            }
+
+            buffer[decodedSize++] = 0x00;
+        }
+    }
+
+    return decodedSize;
+}
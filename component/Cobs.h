@@ -0,0 +1,62 @@
+#ifndef COBS_H
+#define COBS_H
+
+#include <stddef.h>
+
+/**
+ * Consistent overhead byte stuffing
+ *
+ * COBS removes every zero byte from a block of data at a cost of one byte per
+ * 254 bytes, so that a zero byte can delimit frames. Frames can then carry
+ * arbitrary 8-bit data, and a receiver that loses track of the stream
+ * recovers at the next delimiter.
+ */
+class Cobs
+{
+    public:
+
+        /**
+         * Byte that delimits encoded frames
+         */
+        static const unsigned char DELIMITER = 0x00;
+
+        /**
+         * Provides the largest encoded size of the given amount of data
+         *
+         * The size excludes the delimiter.
+         */
+        static size_t GetMaxEncodedSize(
+                size_t dataSize
+                );
+
+        /**
+         * Encodes data into the given buffer
+         *
+         * No delimiter is written.
+         *
+         * \return Number of bytes written, or 0 if the buffer is too small
+         */
+        static size_t Encode(
+                const unsigned char*    data,
+                size_t                  dataSize,
+                unsigned char*          buffer,
+                size_t                  bufferSize
+                );
+
+        /**
+         * Decodes an encoded frame into the given buffer
+         *
+         * Decoding stops at a delimiter or at the end of the data.
+         *
+         * \return Number of bytes written, or 0 if the frame is malformed,
+         * empty or does not fit in the buffer
+         */
+        static size_t Decode(
+                const unsigned char*    data,
+                size_t                  dataSize,
+                unsigned char*          buffer,
+                size_t                  bufferSize
+                );
+};
+
+#endif /* ifndef COBS_H */
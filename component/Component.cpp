@@ -1,8 +1,6 @@
 
 #include "Component.h"
-
-
-Components Component::ourCurrentComponents;
+#include "RobotContext.h"
 
 
 void
@@ -10,17 +8,9 @@ Component::RegisterComponent(
         Component* component
         )
 {
-    ourCurrentComponents.push_back(component);
-}
-
-const Components&
-Component::GetRegisteredComponents()
-{
-    return ourCurrentComponents;
-}
-
-void
-Component::ClearRegisteredComponents()
-{
-    ourCurrentComponents.clear();
+    RobotContext* context = RobotContext::GetCurrent();
+    if (context != NULL)
+    {
+        context->registerComponent(component);
+    }
 }
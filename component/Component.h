@@ -2,7 +2,8 @@
 #define COMPONENT_H
 
 #include "Packet.h"
-#include <list>
+#include "PacketHandle.h"
+#include <vector>
 
 // Forward declarations
 class Component;
@@ -10,7 +11,7 @@ class Component;
 /**
  * Component collection type
  */
-typedef std::list<Component*> Components;
+typedef std::vector<Component*> Components;
 
 /**
  * Interface for all robot components usable in programs
@@ -19,41 +20,63 @@ class Component
 {
     public:
 
+        /**
+         * Priority of components that do not set their own
+         */
+        static const unsigned int DEFAULT_PRIORITY = 10;
+
         /**
          * Registers a component used in a robot program
          *
          * This is done during program initialization so that packets can be
-         * exchanged between the robot and the different components.
+         * exchanged between the robot and the different components. The
+         * component registers with the robot context current on this thread.
+         * Components built outside of any robot program are not registered.
          */
         static void RegisterComponent(
                 Component* component
                 );
 
         /**
-         * Provides the list of all registered components
+         * Destructor
          */
-        static const Components& GetRegisteredComponents();
+        virtual ~Component(){};
 
         /**
-         * Clears the registered components awaiting ownership
+         * Provides the next packet to send to the robot
+         *
+         * Ownership of the packet passes to the caller through the returned
+         * handle.
+         *
+         * \return Handle to packet to send if available or an empty handle if
+         * none available
          */
-        static void ClearRegisteredComponents();
+        virtual PacketHandle getNextPacket() = 0;
 
         /**
-         * Destructor
+         * Provides the routing keys of the packets this component processes
+         *
+         * Packets carrying one of these keys are handed straight to this
+         * component. Packets without a known key are offered to every
+         * component in turn.
          */
-        virtual ~Component(){};
+        virtual void getRoutingKeys(
+                std::vector<RoutingKey>& keys
+                ) const
+        {
+        }
 
         /**
-         * Provides a pointer to the next packet to send to the robot
+         * Provides the priority of this component's packets
          *
-         * If the returned pointer is non-NULL, the caller is responsible for
-         * deleting packet that it points to.
-         *
-         * \return Pointer to packet to send if available or NULL if none
-         * available
+         * When the link budget of a cycle is limited, components are polled
+         * for packets from the highest priority down until the budget is
+         * spent.
          */
-        virtual Packet* getNextPacket() = 0;
+        virtual unsigned int getPriority() const
+        {
+            return DEFAULT_PRIORITY;
+        }
 
         /**
          * Examines a packet and processes it if desired
@@ -63,17 +86,6 @@ class Component
         virtual bool processPacket(
                 const Packet& packet
                 ) = 0;
-
-    private:
-
-        /**
-         * Components used in last-initialized robot program
-         *
-         * After the program has finished being constructed, the robot instance
-         * that owns the program should grab all of the components in this
-         * collection to use for packet communication and then clear it.
-         */
-        static Components ourCurrentComponents;
 };
 
 #endif /* ifndef COMPONENT_H */
@@ -0,0 +1,137 @@
+#include "Crc.h"
+
+
+size_t
+Crc::GetSize(
+        Type            type,
+        unsigned int    bitsPerByte
+        )
+{
+    size_t checksumBits = 0;
+    switch (type)
+    {
+        case TYPE_CRC8:     checksumBits = 8; break;
+        case TYPE_CRC16:    checksumBits = 16; break;
+        default:            break;
+    };
+
+    return (checksumBits + bitsPerByte - 1) / bitsPerByte;
+}
+
+unsigned int
+Crc::Compute(
+        Type                    type,
+        const unsigned char*    data,
+        size_t                  dataSize
+        )
+{
+    if (type == TYPE_CRC8)
+    {
+        unsigned char checksum = 0x00;
+        for(
+                size_t dataIdx = 0;
+                dataIdx < dataSize;
+                ++dataIdx
+           )
+        {
+            checksum ^= data[dataIdx];
+            for (int bitIdx = 0; bitIdx < 8; ++bitIdx)
+            {
+                checksum = (checksum & 0x80) ?
+                    (unsigned char)((checksum << 1) ^ 0x07) :
+                    (unsigned char)(checksum << 1);
+            }
+        }
+
+        return checksum;
+    }
+
+    if (type == TYPE_CRC16)
+    {
+        unsigned short checksum = 0xFFFF;
+        for(
+                size_t dataIdx = 0;
+                dataIdx < dataSize;
+                ++dataIdx
+           )
+        {
+            checksum ^= (unsigned short)(data[dataIdx] << 8);
+            for (int bitIdx = 0; bitIdx < 8; ++bitIdx)
+            {
+                checksum = (checksum & 0x8000) ?
+                    (unsigned short)((checksum << 1) ^ 0x1021) :
+                    (unsigned short)(checksum << 1);
+            }
+        }
+
+        return checksum;
+    }
+
+    return 0;
+}
+
+size_t
+Crc::Write(
+        Type                    type,
+        const unsigned char*    data,
+        size_t                  dataSize,
+        unsigned char*          buffer,
+        size_t                  bufferSize,
+        unsigned int            bitsPerByte
+        )
+{
+    size_t checksumSize = GetSize(type, bitsPerByte);
+    if (checksumSize > bufferSize)
+    {
+        return 0;
+    }
+
+    unsigned int checksum = Compute(type, data, dataSize);
+    unsigned int byteMask = (1 << bitsPerByte) - 1;
+
+    for(
+            size_t byteIdx = 0;
+            byteIdx < checksumSize;
+            ++byteIdx
+       )
+    {
+        size_t bitOffset = bitsPerByte * (checksumSize - byteIdx - 1);
+        buffer[byteIdx] = (unsigned char)((checksum >> bitOffset) & byteMask);
+    }
+
+    return checksumSize;
+}
+
+bool
+Crc::Check(
+        Type                    type,
+        const unsigned char*    data,
+        size_t                  dataSize,
+        unsigned int            bitsPerByte
+        )
+{
+    size_t checksumSize = GetSize(type, bitsPerByte);
+    if (checksumSize > dataSize)
+    {
+        return false;
+    }
+
+    unsigned char checksum[MAX_SIZE];
+    size_t contentSize = dataSize - checksumSize;
+
+    Write(type, data, contentSize, checksum, sizeof(checksum), bitsPerByte);
+
+    for(
+            size_t byteIdx = 0;
+            byteIdx < checksumSize;
+            ++byteIdx
+       )
+    {
+        if (checksum[byteIdx] != data[contentSize + byteIdx])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stddef.h>
+
+/**
+ * Cyclic redundancy checks for packet frames
+ *
+ * A checksum of a frame's contents is sent after them so that the receiver
+ * can tell a corrupted frame from a valid one. Checksums are written most
+ * significant bits first, either as whole bytes or split into 7-bit chunks
+ * that keep them clear of boundary bytes.
+ */
+class Crc
+{
+    public:
+
+        /**
+         * Checksum types
+         *
+         * The values are those sent when negotiating a checksum.
+         */
+        enum Type
+        {
+            TYPE_NONE = 0,  /**< No checksum */
+            TYPE_CRC8 = 1,  /**< CRC-8 with polynomial 0x07 and initial value 0x00 */
+            TYPE_CRC16 = 2  /**< CRC-16 with polynomial 0x1021 and initial value 0xFFFF */
+        };
+
+        /**
+         * Largest number of bytes any checksum is written as
+         */
+        static const size_t MAX_SIZE = 3;
+
+        /**
+         * Provides the number of bytes a checksum is written as
+         */
+        static size_t GetSize(
+                Type            type,
+                unsigned int    bitsPerByte = 8     /**< Checksum bits carried by each byte */
+                );
+
+        /**
+         * Computes the checksum of the given data
+         */
+        static unsigned int Compute(
+                Type                    type,
+                const unsigned char*    data,
+                size_t                  dataSize
+                );
+
+        /**
+         * Writes the checksum of the given data into the given buffer
+         *
+         * \return Number of bytes written, or 0 if the buffer is too small or
+         * there is no checksum
+         */
+        static size_t Write(
+                Type                    type,
+                const unsigned char*    data,
+                size_t                  dataSize,
+                unsigned char*          buffer,
+                size_t                  bufferSize,
+                unsigned int            bitsPerByte = 8     /**< Checksum bits carried by each byte */
+                );
+
+        /**
+         * Indicates if data ends with the checksum of the rest of it
+         */
+        static bool Check(
+                Type                    type,
+                const unsigned char*    data,
+                size_t                  dataSize,
+                unsigned int            bitsPerByte = 8     /**< Checksum bits carried by each byte */
+                );
+};
+
+#endif /* ifndef CRC_H */
@@ -0,0 +1,21 @@
+#include "Diagnostics.h"
+
+
+std::atomic<Diagnostics::Level> Diagnostics::ourLevel(DEFAULT_LEVEL);
+
+
+Diagnostics::Level
+Diagnostics::GetLevel()
+{
+    Level level = ourLevel.load(std::memory_order_relaxed);
+
+    return (level < WPIRB_MAX_DIAGNOSTICS_LEVEL) ? level : (Level)WPIRB_MAX_DIAGNOSTICS_LEVEL;
+}
+
+void
+Diagnostics::SetLevel(
+        Level level
+        )
+{
+    ourLevel.store(level, std::memory_order_relaxed);
+}
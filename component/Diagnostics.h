@@ -0,0 +1,80 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <atomic>
+
+/**
+ * Highest diagnostics level kept in the build
+ *
+ * Defining this as 0 at build time leaves all diagnostics out, and as 1
+ * leaves out everything but errors, whatever level is set at run time.
+ */
+#ifndef WPIRB_MAX_DIAGNOSTICS_LEVEL
+#define WPIRB_MAX_DIAGNOSTICS_LEVEL 2
+#endif
+
+/**
+ * Level of the diagnostics kept about packet exchanges
+ *
+ * Keeping the bytes of every exchange costs time and memory on every cycle,
+ * so the process-wide level can be lowered at run time. With diagnostics off,
+ * packets are exchanged without formatting or allocating anything for them.
+ */
+class Diagnostics
+{
+    public:
+
+        /**
+         * Enumeration of diagnostics levels
+         */
+        enum Level
+        {
+            LEVEL_OFF = 0,      /**< Nothing is kept */
+            LEVEL_ERRORS = 1,   /**< The bytes of failed exchanges are kept */
+            LEVEL_FULL = 2      /**< The bytes of every exchange are kept */
+        };
+
+        /**
+         * Level of the process until set otherwise
+         */
+        static const Level DEFAULT_LEVEL = LEVEL_FULL;
+
+        /**
+         * Provides the level of the process
+         *
+         * This is limited to the highest level kept in the build.
+         */
+        static Level GetLevel();
+
+        /**
+         * Sets the level of the process
+         */
+        static void SetLevel(
+                Level level
+                );
+
+        /**
+         * Indicates if diagnostics of the given level are kept
+         *
+         * Levels left out of the build are never kept, so checks for them
+         * compile away.
+         */
+        static bool IsEnabled(
+                Level level
+                )
+        {
+            return (
+                    (level <= WPIRB_MAX_DIAGNOSTICS_LEVEL) &&
+                    (level <= ourLevel.load(std::memory_order_relaxed))
+                   );
+        }
+
+    private:
+
+        /**
+         * Level of the process
+         */
+        static std::atomic<Level> ourLevel;
+};
+
+#endif /* ifndef DIAGNOSTICS_H */
@@ -0,0 +1,150 @@
+#include "LatencyHistogram.h"
+#include <math.h>
+
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void
+LatencyHistogram::add(
+        double latency
+        )
+{
+    if (latency < 0.0)
+    {
+        latency = 0.0;
+    }
+
+    size_t bucketIdx = 0;
+    while (latency >= GetBucketUpperBound(bucketIdx))
+    {
+        ++bucketIdx;
+    }
+
+    ++myBucketCounts[bucketIdx];
+
+    if (myCount == 0)
+    {
+        myMin = latency;
+        myMax = latency;
+    }
+    else
+    {
+        myMin = (latency < myMin) ? latency : myMin;
+        myMax = (latency > myMax) ? latency : myMax;
+    }
+
+    ++myCount;
+    mySum += latency;
+}
+
+void
+LatencyHistogram::reset()
+{
+    for(
+            size_t bucketIdx = 0;
+            bucketIdx < NUM_BUCKETS;
+            ++bucketIdx
+       )
+    {
+        myBucketCounts[bucketIdx] = 0;
+    }
+
+    myCount = 0;
+    mySum = 0.0;
+    myMin = 0.0;
+    myMax = 0.0;
+}
+
+size_t
+LatencyHistogram::getCount() const
+{
+    return myCount;
+}
+
+size_t
+LatencyHistogram::getBucketCount(
+        size_t bucketIdx
+        ) const
+{
+    if (bucketIdx >= NUM_BUCKETS)
+    {
+        return 0;
+    }
+
+    return myBucketCounts[bucketIdx];
+}
+
+double
+LatencyHistogram::getMin() const
+{
+    return myMin;
+}
+
+double
+LatencyHistogram::getMax() const
+{
+    return myMax;
+}
+
+double
+LatencyHistogram::getMean() const
+{
+    if (myCount == 0)
+    {
+        return 0.0;
+    }
+
+    return mySum / myCount;
+}
+
+double
+LatencyHistogram::getPercentile(
+        double percentile
+        ) const
+{
+    if (myCount == 0)
+    {
+        return 0.0;
+    }
+
+    // Rank of the latency holding the percentile, counting from 1
+    size_t rank = (size_t)ceil(myCount * (percentile / 100.0));
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    size_t countSoFar = 0;
+    for(
+            size_t bucketIdx = 0;
+            bucketIdx < NUM_BUCKETS;
+            ++bucketIdx
+       )
+    {
+        countSoFar += myBucketCounts[bucketIdx];
+        if (countSoFar >= rank)
+        {
+            double upperBound = GetBucketUpperBound(bucketIdx);
+            return (upperBound < myMax) ? upperBound : myMax;
+        }
+    }
+
+    return myMax;
+}
+
+double
+LatencyHistogram::GetBucketUpperBound(
+        size_t bucketIdx
+        )
+{
+    // The last bucket also holds everything beyond its range
+    if (bucketIdx >= (NUM_BUCKETS - 1))
+    {
+        return HUGE_VAL;
+    }
+
+    return ldexp(1e-6, (int)bucketIdx);
+}
@@ -0,0 +1,114 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <stddef.h>
+
+/**
+ * Histogram of latencies with logarithmic buckets
+ *
+ * Bucket 0 holds latencies below one microsecond, and every following bucket
+ * covers twice the range of the previous one. The last bucket also holds
+ * everything beyond its range. Recording a latency never allocates memory,
+ * so histograms can be kept per input and updated every cycle.
+ */
+class LatencyHistogram
+{
+    public:
+
+        /**
+         * Number of buckets
+         */
+        static const size_t NUM_BUCKETS = 24;
+
+        /**
+         * Default constructor
+         */
+        LatencyHistogram();
+
+        /**
+         * Records a latency
+         */
+        void add(
+                double latency  /**< Latency in seconds */
+                );
+
+        /**
+         * Clears all recorded latencies
+         */
+        void reset();
+
+        /**
+         * Provides the number of recorded latencies
+         */
+        size_t getCount() const;
+
+        /**
+         * Provides the number of recorded latencies in the given bucket
+         */
+        size_t getBucketCount(
+                size_t bucketIdx
+                ) const;
+
+        /**
+         * Provides the smallest recorded latency in seconds
+         */
+        double getMin() const;
+
+        /**
+         * Provides the largest recorded latency in seconds
+         */
+        double getMax() const;
+
+        /**
+         * Provides the mean recorded latency in seconds
+         */
+        double getMean() const;
+
+        /**
+         * Provides an upper bound of the given percentile in seconds
+         *
+         * This is the upper bound of the bucket holding the percentile, limited
+         * to the largest recorded latency.
+         */
+        double getPercentile(
+                double percentile   /**< Percentile from 0 to 100 */
+                ) const;
+
+        /**
+         * Provides the exclusive upper bound of the given bucket in seconds
+         *
+         * The bound of the last bucket is infinite.
+         */
+        static double GetBucketUpperBound(
+                size_t bucketIdx
+                );
+
+    private:
+
+        /**
+         * Number of recorded latencies per bucket
+         */
+        size_t myBucketCounts[NUM_BUCKETS];
+
+        /**
+         * Number of recorded latencies
+         */
+        size_t myCount;
+
+        /**
+         * Sum of recorded latencies in seconds
+         */
+        double mySum;
+
+        /**
+         * Smallest recorded latency in seconds
+         */
+        double myMin;
+
+        /**
+         * Largest recorded latency in seconds
+         */
+        double myMax;
+};
+
+#endif /* ifndef LATENCYHISTOGRAM_H */
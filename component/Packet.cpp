@@ -1,18 +1,50 @@
 
 #include "Packet.h"
+#include "PacketPool.h"
+#include "Cobs.h"
+#include "Diagnostics.h"
 #include <sstream>
+#include <string.h>
 
 
-Packet*
+RoutingKey
+Packet::MakeRoutingKey(
+        unsigned char   type,
+        unsigned int    address
+        )
+{
+    return ((RoutingKey)type << 24) | (address & 0x00FFFFFF);
+}
+
+void*
+Packet::operator new(
+        size_t size
+        )
+{
+    return PacketPool::Allocate(size);
+}
+
+void
+Packet::operator delete(
+        void*   memory,
+        size_t  size
+        )
+{
+    PacketPool::Free(memory, size);
+}
+
+PacketHandle
 Packet::Read(
         std::istream&       inputStream,
         PacketGenerator&    packetGen,
-        std::string*        readData
+        size_t*             readSize,
+        std::string*        readData,
+        Crc::Type           checksum
         )
 {
-    if (inputStream.good() == false)
+    if (readSize != NULL)
     {
-        return NULL;
+        *readSize = 0;
     }
 
     if (readData != NULL)
@@ -20,62 +52,334 @@ Packet::Read(
         readData->clear();
     }
 
-    std::string tmpDataBuf;
-
-    unsigned char header;
-    inputStream.get((char&)header);
     if (inputStream.good() == false)
     {
-        return NULL;
+        return PacketHandle();
     }
-    tmpDataBuf.push_back(header);
 
-    if (header == BINARY_BOUND)
+    // The packet is read up to its trailing bound, so that it is decoded,
+    // and its checksum checked, the same way as packets held in memory
+    unsigned char frameData[MAX_BINARY_SIZE];
+    size_t frameSize = 0;
+    char curByte;
+
+    while(
+            (frameSize < sizeof(frameData)) &&
+            (inputStream.get(curByte).good() == true)
+         )
     {
-        Packet* packet = NULL;
-        char packetType = '\0';
-        inputStream.get(packetType);
-        if (inputStream.good() == false)
+        frameData[frameSize++] = (unsigned char)curByte;
+
+        if(
+                (frameData[0] != BINARY_BOUND) ||
+                (
+                 (frameSize > 1) &&
+                 ((unsigned char)curByte == BINARY_BOUND)
+                )
+          )
         {
-            return NULL;
+            break;
         }
-        tmpDataBuf.push_back(packetType);
+    }
+
+    if (frameSize == 0)
+    {
+        return PacketHandle();
+    }
+
+    PacketHandle packet = Decode(frameData, frameSize, packetGen, NULL, readData, checksum);
+
+    // Everything taken from the stream counts as read, even past a header
+    // that no packet matched
+    if (readSize != NULL)
+    {
+        *readSize = frameSize;
+    }
+
+    return packet;
+}
+
+PacketHandle
+Packet::Decode(
+        const unsigned char*    data,
+        size_t                  dataSize,
+        PacketGenerator&        packetGen,
+        size_t*                 decodedSize,
+        std::string*            decodedData,
+        Crc::Type               checksum
+        )
+{
+    if(
+            (checksum != Crc::TYPE_NONE) &&
+            (dataSize > 0) &&
+            (data[0] == BINARY_BOUND)
+      )
+    {
+        return DecodeChecked(data, dataSize, packetGen, decodedSize, decodedData, checksum);
+    }
+
+    size_t headerSize = (dataSize < 2) ? dataSize : 2;
+    PacketHandle packet;
 
-        packet = packetGen.createPacket((unsigned char)packetType);
+    if(
+            (headerSize > 0) &&
+            (data[0] != BINARY_BOUND)
+      )
+    {
+        // Only the stray byte is consumed
+        headerSize = 1;
+    }
+    else if (headerSize == 2)
+    {
+        packet = packetGen.createPacket(data[1]);
+    }
 
-        if (packet != NULL)
+    if (packet.isNull() == true)
+    {
+        if (decodedSize != NULL)
         {
-            inputStream >> *packet;
-
-            if (readData != NULL)
-            {
-                // Dump read data for debugging
-                std::ostringstream outputStream;
-                outputStream << *packet;
-                *readData = outputStream.str();
-            }
-
-            if (packet->isValid() == true)
-            {
-                return packet;
-            }
-            else
-            {
-                // Delete invalid packet
-                delete packet;
-
-                return NULL;
-            }
+            *decodedSize = headerSize;
         }
+
+        // Dump decoded data for debugging
+        if (PrepareDump(decodedData, false) == true)
+        {
+            decodedData->assign((const char*)data, headerSize);
+        }
+
+        return PacketHandle();
     }
 
-    // Dump read data for debugging
-    if (readData != NULL)
+    size_t packetSize = headerSize + packet->decode(
+            data + headerSize,
+            dataSize - headerSize
+            );
+
+    if (decodedSize != NULL)
+    {
+        *decodedSize = packetSize;
+    }
+
+    bool isValid = packet->isValid();
+    if (PrepareDump(decodedData, isValid) == true)
+    {
+        // Dump decoded data for debugging
+        unsigned char packetData[MAX_BINARY_SIZE];
+        decodedData->assign(
+                (const char*)packetData,
+                packet->encode(packetData, MAX_BINARY_SIZE)
+                );
+    }
+
+    if (isValid == false)
+    {
+        // Invalid packet is deleted along with its handle
+        return PacketHandle();
+    }
+
+    return packet;
+}
+
+PacketHandle
+Packet::DecodeChecked(
+        const unsigned char*    data,
+        size_t                  dataSize,
+        PacketGenerator&        packetGen,
+        size_t*                 decodedSize,
+        std::string*            decodedData,
+        Crc::Type               checksum
+        )
+{
+    size_t frameSize = 1;
+    while(
+            (frameSize < dataSize) &&
+            (data[frameSize] != BINARY_BOUND)
+         )
+    {
+        ++frameSize;
+    }
+
+    bool isTerminated = (frameSize < dataSize);
+    if (isTerminated == true)
+    {
+        ++frameSize;
+    }
+
+    if (decodedSize != NULL)
+    {
+        *decodedSize = frameSize;
+    }
+
+    // Bytes between the bounds, checksum included
+    size_t contentSize = frameSize - ((isTerminated == true) ? 2 : 1);
+    PacketHandle packet;
+    if(
+            (isTerminated == true) &&
+            (frameSize <= MAX_BINARY_SIZE) &&
+            (Crc::Check(checksum, data + 1, contentSize, BOUNDED_CHECKSUM_BITS) == true)
+      )
+    {
+        // Decode the packet with its checksum taken out
+        unsigned char packetData[MAX_BINARY_SIZE];
+        size_t packetSize = 1 + contentSize - Crc::GetSize(checksum, BOUNDED_CHECKSUM_BITS);
+
+        memcpy(packetData, data, packetSize);
+        packetData[packetSize++] = BINARY_BOUND;
+
+        packet = Decode(packetData, packetSize, packetGen);
+    }
+
+    // Dump decoded data for debugging
+    if (PrepareDump(decodedData, (packet.isNull() == false)) == true)
+    {
+        decodedData->assign((const char*)data, frameSize);
+    }
+
+    return packet;
+}
+
+PacketHandle
+Packet::DecodeCobs(
+        const unsigned char*    data,
+        size_t                  dataSize,
+        PacketGenerator&        packetGen,
+        std::string*            decodedData,
+        Crc::Type               checksum
+        )
+{
+    PacketHandle packet;
+
+    unsigned char packetData[MAX_BINARY_SIZE];
+    size_t packetSize = Cobs::Decode(data, dataSize, packetData, sizeof(packetData));
+    size_t checksumSize = Crc::GetSize(checksum);
+    if(
+            (packetSize > checksumSize) &&
+            (Crc::Check(checksum, packetData, packetSize) == true)
+      )
+    {
+        packet = packetGen.createPacket(packetData[0]);
+    }
+
+    if (packet.isNull() == false)
+    {
+        packet->decodeNative(packetData + 1, packetSize - checksumSize - 1);
+        if (packet->isValid() == false)
+        {
+            // Delete invalid packet
+            packet.reset();
+        }
+    }
+
+    // Dump the frame for debugging
+    if (PrepareDump(decodedData, (packet.isNull() == false)) == true)
+    {
+        size_t frameSize = 0;
+        while(
+                (frameSize < dataSize) &&
+                (data[frameSize] != Cobs::DELIMITER)
+             )
+        {
+            ++frameSize;
+        }
+
+        decodedData->assign((const char*)data, frameSize);
+    }
+
+    return packet;
+}
+
+bool
+Packet::PrepareDump(
+        std::string*    dumpData,
+        bool            isValid
+        )
+{
+    if (dumpData == NULL)
+    {
+        return false;
+    }
+
+    if(
+            Diagnostics::IsEnabled(
+                (isValid == true) ? Diagnostics::LEVEL_FULL : Diagnostics::LEVEL_ERRORS
+                ) == false
+      )
+    {
+        dumpData->clear();
+        return false;
+    }
+
+    return true;
+}
+
+size_t
+Packet::encodeChecked(
+        unsigned char*  buffer,
+        size_t          bufferSize,
+        Crc::Type       checksum
+        ) const
+{
+    size_t checksumSize = Crc::GetSize(checksum, BOUNDED_CHECKSUM_BITS);
+    if (bufferSize < checksumSize)
     {
-        *readData = tmpDataBuf;
+        return 0;
     }
 
-    return NULL;
+    size_t packetSize = encode(buffer, bufferSize - checksumSize);
+    if (packetSize < 2)
+    {
+        return 0;
+    }
+
+    // Checksum goes in place of the trailing bound, which follows it
+    size_t contentSize = packetSize - 2;
+    Crc::Write(
+            checksum,
+            buffer + 1,
+            contentSize,
+            buffer + 1 + contentSize,
+            checksumSize,
+            BOUNDED_CHECKSUM_BITS
+            );
+    buffer[1 + contentSize + checksumSize] = BINARY_BOUND;
+
+    return packetSize + checksumSize;
+}
+
+size_t
+Packet::encodeCobs(
+        unsigned char*  buffer,
+        size_t          bufferSize,
+        Crc::Type       checksum
+        ) const
+{
+    unsigned char packetData[MAX_BINARY_SIZE + Crc::MAX_SIZE];
+    size_t packetSize = encodeNative(packetData, MAX_BINARY_SIZE);
+    if(
+            (packetSize == 0) ||
+            (bufferSize < 1)
+      )
+    {
+        return 0;
+    }
+
+    packetSize += Crc::Write(
+            checksum,
+            packetData,
+            packetSize,
+            packetData + packetSize,
+            Crc::MAX_SIZE
+            );
+
+    size_t frameSize = Cobs::Encode(packetData, packetSize, buffer, bufferSize - 1);
+    if (frameSize == 0)
+    {
+        return 0;
+    }
+
+    buffer[frameSize++] = Cobs::DELIMITER;
+
+    return frameSize;
 }
 
 
@@ -1,13 +1,26 @@
 #ifndef PACKET_H
 #define PACKET_H
 
+#include "Crc.h"
+#include "PacketHandle.h"
+#include "PacketQueue.h"
 #include <istream>
+#include <string>
+#include <stddef.h>
 #include <stdint.h>
 #include <vector>
 
 // Forward declarations
 class PacketGenerator;
 
+/**
+ * Key that addresses a received packet to the component that processes it
+ *
+ * A key combines a packet type byte with an address within that type, such as
+ * a pin number.
+ */
+typedef uint32_t RoutingKey;
+
 /**
  * Packet base class definition
  */
@@ -20,16 +33,100 @@ class Packet
          */
         const static unsigned char BINARY_BOUND = '\xFF';
 
+        /**
+         * Largest serialized size of any packet, boundary bytes and checksum
+         * included
+         */
+        const static size_t MAX_BINARY_SIZE = 64;
+
+        /**
+         * Checksum bits carried by each byte of a bounded packet
+         */
+        const static unsigned int BOUNDED_CHECKSUM_BITS = 7;
+
+        /**
+         * Wire protocol versions
+         *
+         * Both ends start with bounded packets. Later versions are used once
+         * they have been negotiated.
+         */
+        enum ProtocolVersion
+        {
+            PROTOCOL_BOUNDED = 1,   /**< Packets between boundary bytes, with contents kept clear of them */
+            PROTOCOL_COBS = 2       /**< COBS frames with full 8-bit contents, each ended by a zero byte */
+        };
+
         /**
          * Reads a packet from the given input stream
          *
-         * A new packet is allocated on the heap and a pointer to it is returned.
-         * Callers are responsible for freeing the consumed memory afterwards.
+         * A new packet is allocated from the packet pool and returned in a
+         * handle that owns it.
+         *
+         * The packet is read up to its trailing bound and decoded as by
+         * Decode(). The count of bytes read does not depend on the
+         * diagnostics level, while read data is only dumped at the level that
+         * keeps it, so that valid packets are not encoded again unless asked
+         * for.
          */
-        static Packet* Read(
+        static PacketHandle Read(
                 std::istream&       inputStream,
-                PacketGenerator&    packetGen,      /**< Packet generator to use to create new packets */
-                std::string*        readData = NULL /**< Optional buffer to dump read binary data to */
+                PacketGenerator&    packetGen,                  /**< Packet generator to use to create new packets */
+                size_t*             readSize = NULL,            /**< Optional count of bytes read */
+                std::string*        readData = NULL,            /**< Optional buffer to dump read binary data to */
+                Crc::Type           checksum = Crc::TYPE_NONE   /**< Checksum expected before the trailing bound */
+                );
+
+        /**
+         * Decodes a packet from the start of the given bytes
+         *
+         * This is the counterpart of Read() for callers that already hold
+         * the packet's bytes in memory. No stream is involved.
+         *
+         * A new packet is allocated from the packet pool and returned in a
+         * handle that owns it.
+         *
+         * With a checksum expected, the whole packet up to its trailing bound
+         * is consumed and it is only decoded if the checksum matches. Decoded
+         * data is dumped as by Read().
+         *
+         * \return Handle to the decoded packet, or an empty handle if the
+         * bytes do not hold a valid packet
+         */
+        static PacketHandle Decode(
+                const unsigned char*    data,
+                size_t                  dataSize,
+                PacketGenerator&        packetGen,                  /**< Packet generator to use to create new packets */
+                size_t*                 decodedSize = NULL,         /**< Optional count of bytes consumed */
+                std::string*            decodedData = NULL,         /**< Optional buffer to dump decoded binary data to */
+                Crc::Type               checksum = Crc::TYPE_NONE   /**< Checksum expected before the trailing bound */
+                );
+
+        /**
+         * Decodes a packet from a COBS frame
+         *
+         * The frame may or may not include its trailing delimiter. The frame's
+         * bytes are dumped as by Read().
+         *
+         * A new packet is allocated from the packet pool and returned in a
+         * handle that owns it.
+         *
+         * \return Handle to the decoded packet, or an empty handle if the
+         * frame does not hold a valid packet
+         */
+        static PacketHandle DecodeCobs(
+                const unsigned char*    data,
+                size_t                  dataSize,
+                PacketGenerator&        packetGen,                  /**< Packet generator to use to create new packets */
+                std::string*            decodedData = NULL,         /**< Optional buffer to dump the frame's bytes to */
+                Crc::Type               checksum = Crc::TYPE_NONE   /**< Checksum expected at the end of the frame */
+                );
+
+        /**
+         * Builds a routing key from a packet type byte and an address
+         */
+        static RoutingKey MakeRoutingKey(
+                unsigned char   type,
+                unsigned int    address
                 );
 
         /**
@@ -37,6 +134,21 @@ class Packet
          */
         virtual ~Packet(){};
 
+        /**
+         * Allocates memory for a packet from the packet pool
+         */
+        static void* operator new(
+                size_t size
+                );
+
+        /**
+         * Returns a packet's memory to the packet pool
+         */
+        static void operator delete(
+                void*   memory,
+                size_t  size
+                );
+
         /**
          * Writes serialized binary data to output stream
          *
@@ -62,6 +174,101 @@ class Packet
                 std::istream&
                 ) = 0;
 
+        /**
+         * Encodes serialized binary data into the given buffer
+         *
+         * \return Number of bytes written, or 0 if the buffer is too small
+         */
+        virtual size_t encode(
+                unsigned char*  buffer,
+                size_t          bufferSize
+                ) const = 0;
+
+        /**
+         * Decodes serialized binary data following the packet type byte
+         *
+         * The data is consumed up to and including the packet's trailing
+         * boundary byte. Whether the data held a valid packet is indicated by
+         * isValid() afterwards.
+         *
+         * \return Number of bytes consumed
+         */
+        virtual size_t decode(
+                const unsigned char*    data,
+                size_t                  dataSize
+                ) = 0;
+
+        /**
+         * Encodes serialized binary data with a checksum into the given buffer
+         *
+         * The checksum of the bytes between the bounds is inserted before the
+         * trailing bound, in 7-bit chunks that keep it clear of the bound.
+         *
+         * \return Number of bytes written, or 0 if the buffer is too small
+         */
+        size_t encodeChecked(
+                unsigned char*  buffer,
+                size_t          bufferSize,
+                Crc::Type       checksum
+                ) const;
+
+        /**
+         * Encodes this packet as a COBS frame into the given buffer
+         *
+         * The frame holds the native encoding, followed by its checksum if
+         * one is given, and ends with its delimiter.
+         *
+         * \return Number of bytes written, or 0 if the buffer is too small or
+         * this packet has no native encoding
+         */
+        size_t encodeCobs(
+                unsigned char*  buffer,
+                size_t          bufferSize,
+                Crc::Type       checksum = Crc::TYPE_NONE
+                ) const;
+
+        /**
+         * Encodes the packet type byte and contents with full 8-bit fields
+         *
+         * The native encoding carries no boundary bytes, so it has to be
+         * framed, such as by encodeCobs(), before it is sent.
+         *
+         * \return Number of bytes written, or 0 if the buffer is too small or
+         * this packet has no native encoding
+         */
+        virtual size_t encodeNative(
+                unsigned char*  buffer,
+                size_t          bufferSize
+                ) const
+        {
+            return 0;
+        }
+
+        /**
+         * Decodes native contents following the packet type byte
+         *
+         * All of the given data is taken as contents. Whether the data held a
+         * valid packet is indicated by isValid() afterwards.
+         */
+        virtual void decodeNative(
+                const unsigned char*    data,
+                size_t                  dataSize
+                )
+        {
+        }
+
+        /**
+         * Provides the key that addresses this packet to a component
+         *
+         * \return True if this packet carries a routing key, false otherwise
+         */
+        virtual bool getRoutingKey(
+                RoutingKey& key
+                ) const
+        {
+            return false;
+        }
+
         /**
          * Indicates if this packet is valid or not
          *
@@ -75,6 +282,16 @@ class Packet
          */
         virtual bool isAcknowledge() const = 0;
 
+        /**
+         * Indicates if this packet reports a corrupted request
+         *
+         * The request it answers should be sent again.
+         */
+        virtual bool isNegativeAcknowledge() const
+        {
+            return false;
+        }
+
         /**
          * Equality operator
          */
@@ -93,6 +310,37 @@ class Packet
          * String conversion operator
          */
         virtual operator std::string() const = 0;
+
+    private:
+
+        /**
+         * Prepares a buffer to dump the bytes of a packet to for debugging
+         *
+         * Bytes of valid packets are only dumped with full diagnostics, and
+         * those of invalid ones from errors up. The buffer is cleared if the
+         * bytes are not to be dumped.
+         *
+         * \return True if the bytes are to be dumped, false otherwise
+         */
+        static bool PrepareDump(
+                std::string*    dumpData,   /**< Buffer to dump to, or NULL */
+                bool            isValid     /**< Indicates if the packet is valid */
+                );
+
+        /**
+         * Decodes a packet with a checksum from the start of the given bytes
+         *
+         * The packet's bytes up to its trailing bound are consumed whether or
+         * not its checksum matches.
+         */
+        static PacketHandle DecodeChecked(
+                const unsigned char*    data,
+                size_t                  dataSize,
+                PacketGenerator&        packetGen,
+                size_t*                 decodedSize,
+                std::string*            decodedData,
+                Crc::Type               checksum
+                );
 };
 
 /**
@@ -131,16 +379,109 @@ class PacketGenerator
         /**
          * Creates a new blank packet given a packet type byte
          *
-         * \return Pointer to new packet if given type is valid, NULL otherwise
+         * \return Handle to new packet if given type is valid, an empty handle
+         * otherwise
          */
-        virtual Packet* createPacket(
+        virtual PacketHandle createPacket(
                 unsigned char type
                 ) = 0;
 
         /**
          * Creates a ping packet
          */
-        virtual Packet* createPingPacket() = 0;
+        virtual PacketHandle createPingPacket() = 0;
+
+        /**
+         * Moves packets from the front of the queue into a new frame packet
+         *
+         * A frame packet carries several packets in a single exchange. Packets
+         * that do not fit are left in the queue.
+         *
+         * An empty queue yields an empty frame, which serves as a ping.
+         *
+         * \return Handle to new frame packet, or an empty handle if framing
+         * is not supported or the leading packet cannot be carried in a frame
+         */
+        virtual PacketHandle createFramePacket(
+                PacketQueue& packets
+                )
+        {
+            return PacketHandle();
+        }
+
+        /**
+         * Creates a packet that asks for the given protocol version
+         *
+         * The receiver replies with the version it selects.
+         *
+         * \return Handle to new packet, or an empty handle if versions cannot
+         * be negotiated
+         */
+        virtual PacketHandle createVersionPacket(
+                unsigned int version
+                )
+        {
+            return PacketHandle();
+        }
+
+        /**
+         * Extracts the protocol version selected in a reply to a version
+         * packet
+         *
+         * \return True if the given packet carries a selected version, false
+         * otherwise
+         */
+        virtual bool getSelectedVersion(
+                const Packet&   packet,
+                unsigned int&   version
+                )
+        {
+            return false;
+        }
+
+        /**
+         * Creates a packet that asks for the given checksum type
+         *
+         * The receiver replies with the checksum type it selects.
+         *
+         * \return Handle to new packet, or an empty handle if checksums
+         * cannot be negotiated
+         */
+        virtual PacketHandle createChecksumPacket(
+                Crc::Type checksum
+                )
+        {
+            return PacketHandle();
+        }
+
+        /**
+         * Extracts the checksum type selected in a reply to a checksum packet
+         *
+         * \return True if the given packet carries a selected checksum type,
+         * false otherwise
+         */
+        virtual bool getSelectedChecksum(
+                const Packet&   packet,
+                Crc::Type&      checksum
+                )
+        {
+            return false;
+        }
+
+        /**
+         * Moves the packets contained in a received frame packet into a queue
+         *
+         * The queue takes ownership of the moved packets.
+         *
+         * \return True if the given packet was a frame packet, false otherwise
+         */
+        virtual bool unpackFramePacket(
+                Packet&         packet,
+                PacketQueue&    packets
+                )
+        {
+            return false;
+        }
 };
 
 #endif /* ifndef PACKET_H */
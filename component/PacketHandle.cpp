@@ -0,0 +1,86 @@
+#include "PacketHandle.h"
+#include "Packet.h"
+
+
+PacketHandle::PacketHandle() :
+    myPacket(NULL)
+{
+}
+
+PacketHandle::PacketHandle(
+        Packet* packet
+        ) :
+    myPacket(packet)
+{
+}
+
+PacketHandle::PacketHandle(
+        PacketHandle&& handle
+        ) :
+    myPacket(handle.release())
+{
+}
+
+PacketHandle::~PacketHandle()
+{
+    reset();
+}
+
+PacketHandle&
+PacketHandle::operator=(
+        PacketHandle&& handle
+        )
+{
+    if (this != &handle)
+    {
+        reset(handle.release());
+    }
+
+    return *this;
+}
+
+Packet*
+PacketHandle::get() const
+{
+    return myPacket;
+}
+
+Packet*
+PacketHandle::release()
+{
+    Packet* packet = myPacket;
+    myPacket = NULL;
+
+    return packet;
+}
+
+void
+PacketHandle::reset(
+        Packet* packet
+        )
+{
+    if (myPacket != NULL)
+    {
+        delete myPacket;
+    }
+
+    myPacket = packet;
+}
+
+bool
+PacketHandle::isNull() const
+{
+    return (myPacket == NULL);
+}
+
+Packet&
+PacketHandle::operator*() const
+{
+    return *myPacket;
+}
+
+Packet*
+PacketHandle::operator->() const
+{
+    return myPacket;
+}
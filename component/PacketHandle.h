@@ -0,0 +1,103 @@
+#ifndef PACKETHANDLE_H
+#define PACKETHANDLE_H
+
+#include <stddef.h>
+
+// Forward declarations
+class Packet;
+
+/**
+ * Owning handle to a packet
+ *
+ * A handle owns the packet it points to and deletes it, returning its memory
+ * to the packet pool, when the handle is destroyed or reset. Handles can be
+ * moved but not copied, so a packet always has exactly one owner.
+ */
+class PacketHandle
+{
+    public:
+
+        /**
+         * Constructor for an empty handle
+         */
+        PacketHandle();
+
+        /**
+         * Constructor taking ownership of the given packet
+         */
+        explicit PacketHandle(
+                Packet* packet
+                );
+
+        /**
+         * Move constructor
+         */
+        PacketHandle(
+                PacketHandle&& handle
+                );
+
+        /**
+         * Destructor
+         *
+         * This deletes the owned packet, if any.
+         */
+        ~PacketHandle();
+
+        /**
+         * Move assignment operator
+         */
+        PacketHandle& operator=(
+                PacketHandle&& handle
+                );
+
+        /**
+         * Provides the owned packet without giving up ownership
+         *
+         * \return Pointer to the owned packet, or NULL if the handle is empty
+         */
+        Packet* get() const;
+
+        /**
+         * Gives up ownership of the packet
+         *
+         * The caller becomes responsible for deleting the returned packet.
+         *
+         * \return Pointer to the previously owned packet, or NULL if the
+         * handle was empty
+         */
+        Packet* release();
+
+        /**
+         * Deletes the owned packet and takes ownership of another
+         */
+        void reset(
+                Packet* packet = NULL
+                );
+
+        /**
+         * Indicates if the handle owns no packet
+         */
+        bool isNull() const;
+
+        /**
+         * Dereference operator
+         */
+        Packet& operator*() const;
+
+        /**
+         * Member access operator
+         */
+        Packet* operator->() const;
+
+    private:
+
+        PacketHandle(const PacketHandle&) = delete;
+        PacketHandle& operator=(const PacketHandle&) = delete;
+
+        /**
+         * Owned packet
+         */
+        Packet* myPacket;
+};
+
+#endif /* ifndef PACKETHANDLE_H */
@@ -0,0 +1,129 @@
+#include "PacketPool.h"
+#include <new>
+
+
+alignas(max_align_t) unsigned char PacketPool::ourArena[PacketPool::ARENA_SIZE];
+size_t PacketPool::ourArenaUsed = 0;
+PacketPool::FreeSlot* PacketPool::ourFreeSlots[PacketPool::NUM_SLOT_SIZES] = {NULL};
+size_t PacketPool::ourHeapAllocationCount = 0;
+size_t PacketPool::ourOutstandingCount = 0;
+std::mutex PacketPool::ourMutex;
+
+
+void*
+PacketPool::Allocate(
+        size_t size
+        )
+{
+    size_t slotSizeIdx = GetSlotSizeIndex(size);
+
+    {
+        std::lock_guard<std::mutex> lock(ourMutex);
+
+        ++ourOutstandingCount;
+
+        if (slotSizeIdx < NUM_SLOT_SIZES)
+        {
+            // Reuse a freed slot if possible
+            FreeSlot* slot = ourFreeSlots[slotSizeIdx];
+            if (slot != NULL)
+            {
+                ourFreeSlots[slotSizeIdx] = slot->next;
+                return slot;
+            }
+
+            // Otherwise carve a new slot from the arena
+            size_t slotSize = (slotSizeIdx + 1) * SLOT_SIZE_STEP;
+            if ((ourArenaUsed + slotSize) <= ARENA_SIZE)
+            {
+                void* memory = ourArena + ourArenaUsed;
+                ourArenaUsed += slotSize;
+                return memory;
+            }
+        }
+
+        ++ourHeapAllocationCount;
+    }
+
+    return ::operator new(size);
+}
+
+void
+PacketPool::Free(
+        void*   memory,
+        size_t  size
+        )
+{
+    if (memory == NULL)
+    {
+        return;
+    }
+
+    if (IsInArena(memory) == false)
+    {
+        {
+            std::lock_guard<std::mutex> lock(ourMutex);
+            --ourOutstandingCount;
+        }
+
+        ::operator delete(memory);
+        return;
+    }
+
+    FreeSlot* slot = static_cast<FreeSlot*>(memory);
+    size_t slotSizeIdx = GetSlotSizeIndex(size);
+
+    std::lock_guard<std::mutex> lock(ourMutex);
+
+    --ourOutstandingCount;
+    slot->next = ourFreeSlots[slotSizeIdx];
+    ourFreeSlots[slotSizeIdx] = slot;
+}
+
+size_t
+PacketPool::GetHeapAllocationCount()
+{
+    std::lock_guard<std::mutex> lock(ourMutex);
+
+    return ourHeapAllocationCount;
+}
+
+size_t
+PacketPool::GetOutstandingCount()
+{
+    std::lock_guard<std::mutex> lock(ourMutex);
+
+    return ourOutstandingCount;
+}
+
+size_t
+PacketPool::GetSlotSizeIndex(
+        size_t size
+        )
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    size_t slotSizeIdx = (size - 1) / SLOT_SIZE_STEP;
+    if (slotSizeIdx > NUM_SLOT_SIZES)
+    {
+        slotSizeIdx = NUM_SLOT_SIZES;
+    }
+
+    return slotSizeIdx;
+}
+
+bool
+PacketPool::IsInArena(
+        const void* memory
+        )
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(memory);
+
+    return(
+            (bytes >= ourArena) &&
+            (bytes < (ourArena + ARENA_SIZE))
+          );
+}
@@ -0,0 +1,124 @@
+#ifndef PACKETPOOL_H
+#define PACKETPOOL_H
+
+#include <stddef.h>
+#include <mutex>
+
+/**
+ * Memory pool for packets
+ *
+ * Most packets live for a single cycle: they are created by a component or
+ * decoded from the robot's replies, exchanged or dispatched, and deleted.
+ * This pool serves packet memory from a statically allocated arena and keeps
+ * freed slots on free lists, one per slot size, so that steady-state packet
+ * traffic never reaches the heap.
+ *
+ * Requests larger than the largest slot, or made while the arena is
+ * exhausted, fall back to the heap. Such requests are counted so that tests
+ * can confirm that they do not happen.
+ */
+class PacketPool
+{
+    public:
+
+        /**
+         * Granularity of slot sizes, in bytes
+         */
+        static const size_t SLOT_SIZE_STEP = 64;
+
+        /**
+         * Number of distinct slot sizes
+         */
+        static const size_t NUM_SLOT_SIZES = 12;
+
+        /**
+         * Size of the statically allocated arena, in bytes
+         */
+        static const size_t ARENA_SIZE = 64 * 1024;
+
+        /**
+         * Allocates memory for a packet of the given size
+         *
+         * \return Pointer to the allocated memory
+         */
+        static void* Allocate(
+                size_t size
+                );
+
+        /**
+         * Returns memory obtained from Allocate() to the pool
+         */
+        static void Free(
+                void*   memory,
+                size_t  size    /**< Size the memory was allocated with */
+                );
+
+        /**
+         * Provides the number of allocations that fell back to the heap
+         */
+        static size_t GetHeapAllocationCount();
+
+        /**
+         * Provides the number of allocations not yet freed
+         */
+        static size_t GetOutstandingCount();
+
+    private:
+
+        /**
+         * Free slot, linked into a free list
+         */
+        struct FreeSlot
+        {
+            FreeSlot* next;
+        };
+
+        /**
+         * Provides the index of the slot size used for the given size
+         *
+         * \return Slot size index, or NUM_SLOT_SIZES if the size does not fit
+         * in any slot
+         */
+        static size_t GetSlotSizeIndex(
+                size_t size
+                );
+
+        /**
+         * Indicates if the given memory lies within the arena
+         */
+        static bool IsInArena(
+                const void* memory
+                );
+
+        /**
+         * Memory that slots are carved from
+         */
+        alignas(max_align_t) static unsigned char ourArena[ARENA_SIZE];
+
+        /**
+         * Number of arena bytes carved into slots so far
+         */
+        static size_t ourArenaUsed;
+
+        /**
+         * Freed slots for each slot size
+         */
+        static FreeSlot* ourFreeSlots[NUM_SLOT_SIZES];
+
+        /**
+         * Number of allocations that fell back to the heap
+         */
+        static size_t ourHeapAllocationCount;
+
+        /**
+         * Number of allocations not yet freed
+         */
+        static size_t ourOutstandingCount;
+
+        /**
+         * Guards the pool against concurrent use
+         */
+        static std::mutex ourMutex;
+};
+
+#endif /* ifndef PACKETPOOL_H */
@@ -0,0 +1,109 @@
+#include "PacketQueue.h"
+#include "Packet.h"
+#include <utility>
+
+
+PacketQueue::PacketQueue() :
+    mySlots(),
+    myFront(0),
+    mySize(0)
+{
+}
+
+bool
+PacketQueue::empty() const
+{
+    return (mySize == 0);
+}
+
+size_t
+PacketQueue::size() const
+{
+    return mySize;
+}
+
+size_t
+PacketQueue::getCapacity() const
+{
+    return mySlots.size();
+}
+
+void
+PacketQueue::reserve(
+        size_t capacity
+        )
+{
+    if (capacity <= mySlots.size())
+    {
+        return;
+    }
+
+    // Unwrap the ring into the new slots, front first
+    std::vector<PacketHandle> slots(capacity);
+    for(
+            size_t packetIdx = 0;
+            packetIdx < mySize;
+            ++packetIdx
+       )
+    {
+        slots[packetIdx] = std::move(mySlots[(myFront + packetIdx) % mySlots.size()]);
+    }
+
+    mySlots.swap(slots);
+    myFront = 0;
+}
+
+void
+PacketQueue::push(
+        PacketHandle&& packet
+        )
+{
+    if (mySize == mySlots.size())
+    {
+        reserve(
+                (mySlots.empty() == true) ?
+                    DEFAULT_CAPACITY : (2 * mySlots.size())
+                );
+    }
+
+    mySlots[(myFront + mySize) % mySlots.size()] = std::move(packet);
+    ++mySize;
+}
+
+PacketHandle&
+PacketQueue::front()
+{
+    return mySlots[myFront];
+}
+
+PacketHandle
+PacketQueue::pop()
+{
+    PacketHandle packet(std::move(mySlots[myFront]));
+
+    myFront = (myFront + 1) % mySlots.size();
+    --mySize;
+
+    return packet;
+}
+
+void
+PacketQueue::clear()
+{
+    while (mySize > 0)
+    {
+        pop();
+    }
+
+    myFront = 0;
+}
+
+void
+PacketQueue::swap(
+        PacketQueue& queue
+        )
+{
+    mySlots.swap(queue.mySlots);
+    std::swap(myFront, queue.myFront);
+    std::swap(mySize, queue.mySize);
+}
@@ -0,0 +1,111 @@
+#ifndef PACKETQUEUE_H
+#define PACKETQUEUE_H
+
+#include "PacketHandle.h"
+#include <stddef.h>
+#include <vector>
+
+/**
+ * First-in first-out queue of owned packets
+ *
+ * Packets are kept in a ring whose capacity grows as needed but is never
+ * given back, so that a queue reused from cycle to cycle stops allocating
+ * once it has held its largest load. Packets still queued when the queue is
+ * cleared or destroyed are deleted.
+ */
+class PacketQueue
+{
+    public:
+
+        /**
+         * Capacity of the ring when the first packet is pushed
+         */
+        static const size_t DEFAULT_CAPACITY = 16;
+
+        /**
+         * Constructor for an empty queue
+         *
+         * No memory is allocated until a packet is pushed.
+         */
+        PacketQueue();
+
+        /**
+         * Indicates if the queue holds no packet
+         */
+        bool empty() const;
+
+        /**
+         * Provides the number of queued packets
+         */
+        size_t size() const;
+
+        /**
+         * Provides the number of packets the queue can hold without growing
+         */
+        size_t getCapacity() const;
+
+        /**
+         * Grows the ring so that it holds at least the given number of packets
+         */
+        void reserve(
+                size_t capacity
+                );
+
+        /**
+         * Adds a packet at the back of the queue, taking ownership of it
+         */
+        void push(
+                PacketHandle&& packet
+                );
+
+        /**
+         * Provides the packet at the front of the queue
+         *
+         * The queue must not be empty.
+         */
+        PacketHandle& front();
+
+        /**
+         * Removes the packet at the front of the queue
+         *
+         * The queue must not be empty.
+         *
+         * \return Handle owning the removed packet
+         */
+        PacketHandle pop();
+
+        /**
+         * Deletes all queued packets, keeping the capacity
+         */
+        void clear();
+
+        /**
+         * Exchanges the packets and capacity of two queues
+         */
+        void swap(
+                PacketQueue& queue
+                );
+
+    private:
+
+        // Disabled copiers
+        PacketQueue(const PacketQueue&) = delete;
+        PacketQueue& operator=(const PacketQueue&) = delete;
+
+        /**
+         * Ring of packet slots, empty ones holding null handles
+         */
+        std::vector<PacketHandle> mySlots;
+
+        /**
+         * Index of the slot at the front of the queue
+         */
+        size_t myFront;
+
+        /**
+         * Number of queued packets
+         */
+        size_t mySize;
+};
+
+#endif /* ifndef PACKETQUEUE_H */
@@ -0,0 +1,48 @@
+
+#include "RobotContext.h"
+#include <stddef.h>
+
+
+thread_local RobotContext* RobotContext::ourCurrentContext = NULL;
+
+
+RobotContext::RobotContext() :
+    myComponents()
+{
+}
+
+RobotContext::~RobotContext()
+{
+    if (ourCurrentContext == this)
+    {
+        ourCurrentContext = NULL;
+    }
+}
+
+void
+RobotContext::registerComponent(
+        Component* component
+        )
+{
+    myComponents.push_back(component);
+}
+
+const Components&
+RobotContext::getComponents() const
+{
+    return myComponents;
+}
+
+RobotContext*
+RobotContext::GetCurrent()
+{
+    return ourCurrentContext;
+}
+
+void
+RobotContext::SetCurrent(
+        RobotContext* context
+        )
+{
+    ourCurrentContext = context;
+}
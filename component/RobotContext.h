@@ -0,0 +1,79 @@
+#ifndef ROBOTCONTEXT_H
+#define ROBOTCONTEXT_H
+
+#include "Component.h"
+
+/**
+ * Registry of the components used by a single robot program
+ *
+ * Every robot program owns a context, and the components built for the
+ * program register with it as they are constructed. The robot that runs the
+ * program then takes its components from the context.
+ *
+ * Components register with the context that is current on the thread
+ * constructing them. A program makes its context current as it starts being
+ * constructed, so the components among its members, or built during its
+ * initialization, register with it. Programs may thus be built concurrently
+ * on different threads without their components being mixed up.
+ */
+class RobotContext
+{
+    public:
+
+        /**
+         * Default constructor
+         */
+        RobotContext();
+
+        /**
+         * Destructor
+         *
+         * The context stops being current if it was.
+         */
+        ~RobotContext();
+
+        /**
+         * Registers a component with this context
+         */
+        void registerComponent(
+                Component* component
+                );
+
+        /**
+         * Provides the components registered, in order of registration
+         */
+        const Components& getComponents() const;
+
+        /**
+         * Provides the context that components built on this thread register
+         * with
+         *
+         * \return Current context, or NULL if there is none
+         */
+        static RobotContext* GetCurrent();
+
+        /**
+         * Sets the context that components built on this thread register with
+         */
+        static void SetCurrent(
+                RobotContext* context   /**< Context, or NULL for none */
+                );
+
+    private:
+
+        /**
+         * Components registered, in order of registration
+         */
+        Components myComponents;
+
+        /**
+         * Context that components built on this thread register with
+         */
+        static thread_local RobotContext* ourCurrentContext;
+
+        // Disabled copiers
+        RobotContext(const RobotContext&);
+        RobotContext& operator=(const RobotContext&);
+};
+
+#endif /* ifndef ROBOTCONTEXT_H */
@@ -0,0 +1,267 @@
+
+#include "TraceRing.h"
+#include "Clock.h"
+#include <error.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <new>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+const char TraceRing::OUR_MAGIC[8] = {'W', 'P', 'I', 'R', 'B', 'T', 'R', 'C'};
+
+
+size_t
+TraceRing::Record::getDataSize() const
+{
+    return (size < MAX_DATA_SIZE) ? size : MAX_DATA_SIZE;
+}
+
+
+TraceRing::TraceRing(
+        size_t capacity
+        ) :
+    myCapacity(1),
+    myHeader(NULL),
+    mySlots(NULL),
+    myIsMapped(false)
+{
+    while (myCapacity < capacity)
+    {
+        myCapacity *= 2;
+    }
+
+    initializeStorage(new unsigned char[GetStorageSize(myCapacity)]);
+}
+
+TraceRing::~TraceRing()
+{
+    releaseStorage(myHeader, myIsMapped);
+}
+
+size_t
+TraceRing::getCapacity() const
+{
+    return myCapacity;
+}
+
+void
+TraceRing::add(
+        Direction               direction,
+        uint8_t                 status,
+        const unsigned char*    data,
+        size_t                  dataSize
+        )
+{
+    uint64_t recordIdx = myHeader->recordCount.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = mySlots[recordIdx & (myCapacity - 1)];
+
+    // Readers that see the odd sequence, or a changed one once done, drop the
+    // record they copied
+    slot.sequence.store((2 * recordIdx) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Record& record = slot.record;
+    record.time = Clock::GetInstance().getTime();
+    record.size = (dataSize < UINT16_MAX) ? dataSize : UINT16_MAX;
+    record.direction = direction;
+    record.status = status;
+    if (dataSize > 0)
+    {
+        memcpy(record.data, data, record.getDataSize());
+    }
+
+    slot.sequence.store((2 * recordIdx) + 2, std::memory_order_release);
+}
+
+uint64_t
+TraceRing::getRecordCount() const
+{
+    return myHeader->recordCount.load(std::memory_order_acquire);
+}
+
+bool
+TraceRing::getRecord(
+        uint64_t    recordIdx,
+        Record&     record
+        ) const
+{
+    const Slot& slot = mySlots[recordIdx & (myCapacity - 1)];
+    uint64_t sequence = (2 * recordIdx) + 2;
+
+    if (slot.sequence.load(std::memory_order_acquire) != sequence)
+    {
+        return false;
+    }
+
+    memcpy(&record, &slot.record, sizeof(record));
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return (slot.sequence.load(std::memory_order_relaxed) == sequence);
+}
+
+bool
+TraceRing::mapFile(
+        const char* path
+        )
+{
+    void* storage = MapFile(path, GetStorageSize(myCapacity));
+    if (storage == NULL)
+    {
+        return false;
+    }
+
+    Header* previousHeader = myHeader;
+    Slot* previousSlots = mySlots;
+
+    initializeStorage(storage);
+    myHeader->recordCount.store(previousHeader->recordCount.load());
+    for(
+            size_t slotIdx = 0;
+            slotIdx < myCapacity;
+            ++slotIdx
+       )
+    {
+        mySlots[slotIdx].sequence.store(previousSlots[slotIdx].sequence.load());
+        mySlots[slotIdx].record = previousSlots[slotIdx].record;
+    }
+
+    releaseStorage(previousHeader, myIsMapped);
+    myIsMapped = true;
+
+    return true;
+}
+
+bool
+TraceRing::dump(
+        const char* path
+        ) const
+{
+    size_t storageSize = GetStorageSize(myCapacity);
+    void* storage = MapFile(path, storageSize);
+    if (storage == NULL)
+    {
+        return false;
+    }
+
+    Header* header = new (storage) Header;
+    memcpy(header->magic, OUR_MAGIC, sizeof(header->magic));
+    header->version = OUR_VERSION;
+    header->slotSize = sizeof(Slot);
+    header->capacity = myCapacity;
+
+    uint64_t recordCount = getRecordCount();
+    header->recordCount.store(recordCount);
+
+    // Slots whose record could not be copied whole are left unused
+    Slot* slots = (Slot*)(header + 1);
+    uint64_t firstRecordIdx = (recordCount > myCapacity) ? (recordCount - myCapacity) : 0;
+    for(
+            uint64_t recordIdx = firstRecordIdx;
+            recordIdx < recordCount;
+            ++recordIdx
+       )
+    {
+        Slot& slot = slots[recordIdx & (myCapacity - 1)];
+        if (getRecord(recordIdx, slot.record) == true)
+        {
+            slot.sequence.store((2 * recordIdx) + 2);
+        }
+    }
+
+    // Start writing back right away, in case the process does not last
+    msync(storage, storageSize, MS_ASYNC);
+    munmap(storage, storageSize);
+
+    return true;
+}
+
+size_t
+TraceRing::GetStorageSize(
+        size_t capacity
+        )
+{
+    return sizeof(Header) + (capacity * sizeof(Slot));
+}
+
+void*
+TraceRing::MapFile(
+        const char* path,
+        size_t      size
+        )
+{
+    int descriptor = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0)
+    {
+        error(0, errno, "Could not open trace file %s", path);
+        return NULL;
+    }
+
+    // A new file reads as zeros, so all of its slots are unused
+    if (ftruncate(descriptor, size) < 0)
+    {
+        error(0, errno, "Could not size trace file %s", path);
+        close(descriptor);
+        return NULL;
+    }
+
+    void* storage = mmap(
+            NULL,
+            size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            descriptor,
+            0
+            );
+    close(descriptor);
+
+    if (storage == MAP_FAILED)
+    {
+        error(0, errno, "Could not map trace file %s", path);
+        return NULL;
+    }
+
+    return storage;
+}
+
+void
+TraceRing::initializeStorage(
+        void* storage
+        )
+{
+    myHeader = new (storage) Header;
+    memcpy(myHeader->magic, OUR_MAGIC, sizeof(myHeader->magic));
+    myHeader->version = OUR_VERSION;
+    myHeader->slotSize = sizeof(Slot);
+    myHeader->capacity = myCapacity;
+    myHeader->recordCount.store(0);
+
+    mySlots = (Slot*)(myHeader + 1);
+    for(
+            size_t slotIdx = 0;
+            slotIdx < myCapacity;
+            ++slotIdx
+       )
+    {
+        new (&mySlots[slotIdx]) Slot;
+        mySlots[slotIdx].sequence.store(0);
+    }
+}
+
+void
+TraceRing::releaseStorage(
+        Header* header,
+        bool    isMapped
+        )
+{
+    if (isMapped == true)
+    {
+        munmap(header, GetStorageSize(myCapacity));
+    }
+    else
+    {
+        delete [] (unsigned char*)header;
+    }
+}
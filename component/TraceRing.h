@@ -0,0 +1,282 @@
+#ifndef TRACERING_H
+#define TRACERING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Fixed-size ring of timestamped records of the bytes exchanged on a link
+ *
+ * Adding a record never allocates memory or takes a lock, so every exchange
+ * can be traced. Once the ring is full, the oldest records are overwritten.
+ * Records can be added from several threads at once, and read from any
+ * thread while they are added. A record that was overwritten while being
+ * read is reported as lost rather than torn.
+ *
+ * The ring can be kept in a file mapped into memory, so that the last records
+ * survive the process, or dumped to a file when a fault occurs. Files start
+ * with a header, followed by the slots of the ring. Slot n holds record
+ * number n modulo the capacity, and its sequence is 2 * n + 2 once the record
+ * is complete, with all fields in host byte order.
+ */
+class TraceRing
+{
+    public:
+
+        /**
+         * Largest number of bytes of a frame kept in a record
+         *
+         * Longer frames are cut, but their full size is recorded.
+         */
+        static const size_t MAX_DATA_SIZE = 108;
+
+        /**
+         * Default number of records kept
+         *
+         * This holds several seconds of traffic on a busy link.
+         */
+        static const size_t DEFAULT_CAPACITY = 8192;
+
+        /**
+         * Directions in which frames travel
+         */
+        enum Direction
+        {
+            DIRECTION_SENT = 0,     /**< Frame sent to the device */
+            DIRECTION_RECEIVED = 1  /**< Frame received from the device */
+        };
+
+        /**
+         * Record of a single frame
+         */
+        struct Record
+        {
+            /**
+             * Time the frame was recorded at, in nanoseconds of the process
+             * clock
+             */
+            int64_t time;
+
+            /**
+             * Number of bytes in the frame
+             */
+            uint16_t size;
+
+            /**
+             * Direction the frame travelled in
+             */
+            uint8_t direction;
+
+            /**
+             * Status of the link once the frame was handled, as defined by
+             * the user of the ring
+             */
+            uint8_t status;
+
+            /**
+             * First bytes of the frame
+             */
+            unsigned char data[MAX_DATA_SIZE];
+
+            /**
+             * Provides the number of bytes of the frame kept in data
+             */
+            size_t getDataSize() const;
+        };
+
+        /**
+         * Constructor given the number of records to keep
+         *
+         * The capacity is rounded up to a power of two.
+         */
+        TraceRing(
+                size_t capacity = DEFAULT_CAPACITY
+                );
+
+        /**
+         * Destructor
+         *
+         * A mapped file is left with the records last added.
+         */
+        ~TraceRing();
+
+        /**
+         * Provides the number of records kept
+         */
+        size_t getCapacity() const;
+
+        /**
+         * Adds a record of a frame
+         */
+        void add(
+                Direction               direction,
+                uint8_t                 status,
+                const unsigned char*    data,
+                size_t                  dataSize
+                );
+
+        /**
+         * Provides the number of records added since construction
+         *
+         * This is one past the number of the last record added.
+         */
+        uint64_t getRecordCount() const;
+
+        /**
+         * Copies the record of the given number
+         *
+         * \return True if the record was copied, false if it has been
+         * overwritten or is still being added
+         */
+        bool getRecord(
+                uint64_t    recordIdx,
+                Record&     record
+                ) const;
+
+        /**
+         * Keeps the ring in the given file from now on
+         *
+         * The records added so far are copied to the file, which is created
+         * or truncated. Records added afterwards reach the file as they are
+         * added, without any system call. This must not be called while
+         * records are added or read.
+         *
+         * \return True if the file was mapped, false otherwise
+         */
+        bool mapFile(
+                const char* path
+                );
+
+        /**
+         * Writes the records currently kept to the given file
+         *
+         * The file is created or truncated, and holds the ring in the same
+         * layout as a mapped file. Records overwritten while being copied are
+         * left out.
+         *
+         * \return True if the file was written, false otherwise
+         */
+        bool dump(
+                const char* path
+                ) const;
+
+    private:
+
+        /**
+         * Header at the start of the ring's storage
+         */
+        struct Header
+        {
+            /**
+             * File identifier
+             */
+            char magic[8];
+
+            /**
+             * Layout version
+             */
+            uint32_t version;
+
+            /**
+             * Size of each slot in bytes
+             */
+            uint32_t slotSize;
+
+            /**
+             * Number of slots
+             */
+            uint64_t capacity;
+
+            /**
+             * Number of records added
+             */
+            std::atomic<uint64_t> recordCount;
+        };
+
+        /**
+         * Slot holding a record
+         */
+        struct Slot
+        {
+            /**
+             * Twice the record number plus one while the record is added,
+             * plus two once it is complete, or 0 if the slot is unused
+             */
+            std::atomic<uint64_t> sequence;
+
+            /**
+             * Record held
+             */
+            Record record;
+        };
+
+        /**
+         * File identifier at the start of the header
+         */
+        static const char OUR_MAGIC[8];
+
+        /**
+         * Layout version of the header and slots
+         */
+        static const uint32_t OUR_VERSION = 1;
+
+        /**
+         * Provides the size of storage for the given number of slots
+         */
+        static size_t GetStorageSize(
+                size_t capacity
+                );
+
+        /**
+         * Maps a file of the given size into memory, creating or truncating it
+         *
+         * \return Pointer to the mapping, or NULL if the file could not be
+         * mapped
+         */
+        static void* MapFile(
+                const char* path,
+                size_t      size
+                );
+
+        /**
+         * Sets up a header and empty slots in the given storage
+         */
+        void initializeStorage(
+                void* storage
+                );
+
+        /**
+         * Releases storage that starts with the given header
+         */
+        void releaseStorage(
+                Header* header,
+                bool    isMapped    /**< Indicates if the storage is a mapped file */
+                );
+
+        /**
+         * Number of slots, a power of two
+         */
+        size_t myCapacity;
+
+        /**
+         * Header of the current storage
+         */
+        Header* myHeader;
+
+        /**
+         * Slots of the current storage
+         */
+        Slot* mySlots;
+
+        /**
+         * Indicates if the storage is a mapped file
+         */
+        bool myIsMapped;
+
+        // Disabled copiers
+        TraceRing(const TraceRing&);
+        TraceRing& operator=(const TraceRing&);
+};
+
+#endif /* ifndef TRACERING_H */
@@ -2,9 +2,17 @@
 
 import Tkinter
 import SocketServer
+import socket
+import struct
 import threading
 
 
+# Binary messages are a marker byte, a message type and a value
+MESSAGE_MARKER =    0xD5
+MESSAGE_SUBSCRIBE = 0x01
+MESSAGE_MODE =      0x02
+
+
 class RobotMode:
 
     MODE_UNKNOWN =  -1
@@ -17,6 +25,7 @@ class RobotMode:
 
         self.currentValue = RobotMode.MODE_DISABLED
         self.lock = threading.Lock()
+        self.changed = threading.Condition(self.lock)
 
 
     def get(self):
@@ -34,12 +43,24 @@ class RobotMode:
 
         if (self.lock.acquire() == True):
             self.currentValue = newValue
+            self.changed.notifyAll()
             self.lock.release()
             return True
         else:
             return False
 
 
+    def waitForChange(self, lastValue, timeout):
+
+        self.lock.acquire()
+        if (self.currentValue == lastValue):
+            self.changed.wait(timeout)
+        value = self.currentValue
+        self.lock.release()
+
+        return value
+
+
 robotMode = RobotMode()
 
 
@@ -142,16 +163,38 @@ class ModeRequestHandler(SocketServer.BaseRequestHandler):
 
     def handle(self):
 
-        isConnected = True
+        request = self.request.recv(4096)
 
-        while (isConnected):
+        # Subscribers are pushed every mode change
+        if ((len(request) > 0) and (ord(request[0]) == MESSAGE_MARKER)):
+            self.pushModes()
+            return
 
+        # Other clients poll with text requests and are answered in text
+        while (len(request) > 0):
+            mode = robotMode.get()
+            self.request.sendall("%d" % mode)
             request = self.request.recv(4096)
-            if (len(request) == 0):
-                isConnected = False
-            else:
-                mode = robotMode.get()
-                self.request.sendall("%d" % mode)
+
+
+    def pushModes(self):
+
+        self.request.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+        mode = robotMode.get()
+        while (True):
+
+            try:
+                self.request.sendall(
+                        struct.pack("BBB", MESSAGE_MARKER, MESSAGE_MODE, mode)
+                        )
+            except socket.error:
+                return
+
+            # An unchanged mode is sent again when the wait times out, as a
+            # heartbeat. It lets the client tell a live link from a stale one
+            # and ends this thread once the client is gone.
+            mode = robotMode.waitForChange(mode, 1.0)
 
 
 def runGUI():
@@ -163,7 +206,9 @@ def runGUI():
 
 def runServer():
 
-    server = SocketServer.TCPServer(
+    SocketServer.ThreadingTCPServer.allow_reuse_address = True
+    SocketServer.ThreadingTCPServer.daemon_threads = True
+    server = SocketServer.ThreadingTCPServer(
             ("localhost", 9999),
             ModeRequestHandler
             )
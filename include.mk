@@ -11,6 +11,10 @@ CPPFLAGS += -std=c++14
 
 CXXFLAGS += -Wall -Werror
 
+# Diagnostics above this level are left out of the build: 0 for none, 1 for
+# errors only, 2 for all
+#CPPFLAGS += -DWPIRB_MAX_DIAGNOSTICS_LEVEL=0
+
 WPIUTIL_ROOT = /home/allen/Development/first/wpiutil
 CPPFLAGS += -I$(WPIUTIL_ROOT)/src/main/native/include
 LDFLAGS += -L$(WPIUTIL_ROOT)/build/libs/wpiutil/shared -lwpiutil
@@ -24,3 +28,6 @@ export LD_LIBRARY_PATH := $(NTCORE_ROOT)/build/libs/ntcore/shared:$(LD_LIBRARY_P
 GOOGLETEST_ROOT = /home/allen/Development/tdd/googletest-build
 CPPFLAGS += -I$(GOOGLETEST_ROOT)/include
 LDFLAGS += -L$(GOOGLETEST_ROOT)/lib -lgmock -lgtest -pthread
+
+# Only the benchmarks link against Google Benchmark
+GOOGLEBENCHMARK_ROOT = /home/allen/Development/tdd/benchmark-build
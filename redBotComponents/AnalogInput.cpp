@@ -20,11 +20,11 @@ AnalogInputPacket::AnalogInputPacket(
 }
 
 void
-AnalogInputPacket::writeContents(
-        std::ostream& outputStream
+AnalogInputPacket::encodeContents(
+        unsigned char* buffer
         ) const
 {
-    outputStream << (unsigned char)(myPin + 1);
+    buffer[0] = (unsigned char)(myPin + 1);
 }
 
 void
@@ -41,20 +41,18 @@ AnalogInputPacket::getXMLElements(
 }
 
 void
-AnalogInputPacket::read(
-        std::istream& inputStream
+AnalogInputPacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
         )
 {
-    int pin = -1;
-
-    pin = inputStream.get();
-    myPin = (unsigned int)(pin - 1);
-    if (inputStream.good() == false)
+    if (contentSize < 1)
     {
         return;
     }
 
-    inputStream.get();
+    myPin = (unsigned int)(contents[0] - 1);
 }
 
 bool
@@ -96,14 +94,39 @@ AnalogValuePacket::AnalogValuePacket(
 }
 
 void
-AnalogValuePacket::writeContents(
-        std::ostream&   outputStream
+AnalogValuePacket::encodeContents(
+        unsigned char* buffer
         ) const
 {
-    outputStream
-        << (unsigned char)(myPin + 1)
-        << (unsigned char)(((0x3E0 & myValue) >> 5) + 1)
-        << (unsigned char)((0x01F & myValue) + 1);
+    buffer[0] = (unsigned char)(myPin + 1);
+    buffer[1] = (unsigned char)(((0x3E0 & myValue) >> 5) + 1);
+    buffer[2] = (unsigned char)((0x01F & myValue) + 1);
+}
+
+void
+AnalogValuePacket::encodeNativeContents(
+        unsigned char* buffer
+        ) const
+{
+    // Pins are numbered from 1 on the wire in both encodings
+    buffer[0] = (unsigned char)(myPin + 1);
+    buffer[1] = (unsigned char)(myValue >> 8);
+    buffer[2] = (unsigned char)(myValue & 0xFF);
+}
+
+void
+AnalogValuePacket::decodeNativeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize
+        )
+{
+    if (contentSize < 3)
+    {
+        return;
+    }
+
+    myPin = (unsigned int)(contents[0] - 1);
+    myValue = (unsigned int)((contents[1] << 8) | contents[2]);
 }
 
 void
@@ -126,36 +149,26 @@ AnalogValuePacket::getXMLElements(
 }
 
 void
-AnalogValuePacket::read(
-        std::istream&   inputStream
+AnalogValuePacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
         )
 {
-    int pin = -1;
-    int valueHi = -1;
-    int valueLo = -1;
-
-    pin = inputStream.get();
-    if (inputStream.good() == false)
-    {
-        return;
-    }
-    myPin = (unsigned int)(pin - 1);
-
-    valueHi = inputStream.get();
-    if (inputStream.good() == false)
+    if (contentSize < 1)
     {
         return;
     }
+    myPin = (unsigned int)(contents[0] - 1);
 
-    valueLo = inputStream.get();
-    if (inputStream.good() == false)
+    if (contentSize < 3)
     {
         return;
     }
 
+    unsigned int valueHi = contents[1];
+    unsigned int valueLo = contents[2];
     myValue = (unsigned int)(((0x1F & (valueHi - 1)) << 5) | (0x1F & (valueLo - 1)));
-
-    inputStream.get();
 }
 
 bool
@@ -178,6 +191,16 @@ AnalogValuePacket::getPin() const
     return myPin;
 }
 
+bool
+AnalogValuePacket::getRoutingKey(
+        RoutingKey& key
+        ) const
+{
+    key = MakeRoutingKey(getBinaryID(), myPin);
+
+    return true;
+}
+
 unsigned int
 AnalogValuePacket::getValue() const
 {
@@ -202,10 +225,10 @@ AnalogInput::GetValue()
     return Get();
 }
 
-Packet*
+PacketHandle
 AnalogInput::getNextPacket()
 {
-    return (Packet*)getNextPacketIfTimedOut();
+    return getNextPacketIfTimedOut();
 }
 
 bool
@@ -215,3 +238,13 @@ AnalogInput::processPacket(
 {
     return processDataPacket(packet);
 }
+
+void
+AnalogInput::getRoutingKeys(
+        std::vector<RoutingKey>& keys
+        ) const
+{
+    keys.push_back(
+            Packet::MakeRoutingKey(RedBotPacket::BID_AVALUE, myChannel)
+            );
+}
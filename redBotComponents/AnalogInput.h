@@ -26,13 +26,6 @@ class AnalogInputPacket : public RedBotPacket
                 unsigned int    pin /**< Pin to read from */
                 );
 
-        /**
-         * Reads serialized binary data from input stream
-         */
-        void read(
-                std::istream&
-                );
-
         /**
          * Indicates if this packet is valid or not
          */
@@ -53,12 +46,21 @@ class AnalogInputPacket : public RedBotPacket
     private:
 
         /**
-         * Writes binary packet contents to output stream
+         * Encodes binary packet contents into the given buffer
          */
-        void writeContents(
-                std::ostream&
+        void encodeContents(
+                unsigned char* buffer
                 ) const;
 
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
         /**
          * Provides elements to include in the XML representation
          */
@@ -95,13 +97,6 @@ class AnalogValuePacket : public RedBotPacket
                 unsigned int    value   /**< Value detected on pin */
                 );
 
-        /**
-         * Reads serialized binary data from input stream
-         */
-        void read(
-                std::istream&
-                );
-
         /**
          * Indicates if this packet is valid or not
          */
@@ -119,6 +114,13 @@ class AnalogValuePacket : public RedBotPacket
          */
         unsigned int getPin() const;
 
+        /**
+         * Provides the key that addresses this packet to a component
+         */
+        bool getRoutingKey(
+                RoutingKey& key
+                ) const;
+
         /**
          * Provides the 10-bit value read from the pin
          */
@@ -127,12 +129,36 @@ class AnalogValuePacket : public RedBotPacket
     private:
 
         /**
-         * Writes binary packet contents to output stream
+         * Encodes binary packet contents into the given buffer
          */
-        void writeContents(
-                std::ostream&
+        void encodeContents(
+                unsigned char* buffer
                 ) const;
 
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
+        /**
+         * Encodes native packet contents into the given buffer
+         */
+        void encodeNativeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes native packet contents from the given bytes
+         */
+        void decodeNativeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize
+                );
+
         /**
          * Provides elements to include in the XML representation
          */
@@ -184,7 +210,7 @@ class AnalogInput : public PinInput<AnalogInputPacket, AnalogValuePacket, int>
         /**
          * Provides the next available packet to send
          */
-        Packet* getNextPacket();
+        PacketHandle getNextPacket();
 
         /**
          * Examines the given packet and processes it if appropriate
@@ -192,6 +218,13 @@ class AnalogInput : public PinInput<AnalogInputPacket, AnalogValuePacket, int>
         bool processPacket(
                 const Packet& packet
                 );
+
+        /**
+         * Provides the routing keys of the packets this component processes
+         */
+        void getRoutingKeys(
+                std::vector<RoutingKey>& keys
+                ) const;
 };
 
 }; /* namespace frc */
@@ -20,13 +20,12 @@ PinConfigPacket::PinConfigPacket(
 }
 
 void
-PinConfigPacket::writeContents(
-        std::ostream& outputStream
+PinConfigPacket::encodeContents(
+        unsigned char* buffer
         ) const
 {
-    outputStream
-        << (unsigned char)myPin
-        << (unsigned char)myDirection;
+    buffer[0] = (unsigned char)myPin;
+    buffer[1] = (unsigned char)myDirection;
 }
 
 void
@@ -49,17 +48,24 @@ PinConfigPacket::getXMLElements(
 }
 
 void
-PinConfigPacket::read(
-        std::istream& inputStream
+PinConfigPacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
         )
 {
-    myPin = inputStream.get();
-    if (inputStream.good() == false)
+    if (contentSize < 1)
     {
         return;
     }
+    myPin = contents[0];
 
-    switch (inputStream.get())
+    if (contentSize < 2)
+    {
+        return;
+    }
+
+    switch (contents[1])
     {
         case 1:
             myDirection = DIR_OUTPUT;
@@ -72,12 +78,6 @@ PinConfigPacket::read(
         default:
             break;
     };
-    if (inputStream.good() == false)
-    {
-        return;
-    }
-
-    inputStream.get();
 }
 
 bool
@@ -125,13 +125,12 @@ PinConfigInfoPacket::PinConfigInfoPacket(
 }
 
 void
-PinConfigInfoPacket::writeContents(
-        std::ostream& outputStream
+PinConfigInfoPacket::encodeContents(
+        unsigned char* buffer
         ) const
 {
-    outputStream
-        << (unsigned char)myPin
-        << (unsigned char)myDirection;
+    buffer[0] = (unsigned char)myPin;
+    buffer[1] = (unsigned char)myDirection;
 }
 
 void
@@ -154,28 +153,23 @@ PinConfigInfoPacket::getXMLElements(
 }
 
 void
-PinConfigInfoPacket::read(
-        std::istream& inputStream
+PinConfigInfoPacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
         )
 {
-    int pin;
-    int direction;
-
-    pin = inputStream.get();
-    if (inputStream.good() != true)
+    if (contentSize < 1)
     {
         return;
     }
-    myPin = (unsigned int)pin;
+    myPin = (unsigned int)contents[0];
 
-    direction = inputStream.get();
-    if (inputStream.good() != true)
+    if (contentSize < 2)
     {
         return;
     }
-    myDirection = ((direction == 1) ? DIR_OUTPUT : DIR_INPUT);
-
-    inputStream.get();
+    myDirection = ((contents[1] == 1) ? DIR_OUTPUT : DIR_INPUT);
 }
 
 bool
@@ -198,6 +192,16 @@ PinConfigInfoPacket::getPin() const
     return myPin;
 }
 
+bool
+PinConfigInfoPacket::getRoutingKey(
+        RoutingKey& key
+        ) const
+{
+    key = MakeRoutingKey(getBinaryID(), myPin);
+
+    return true;
+}
+
 RedBotPacket::PinDirection
 PinConfigInfoPacket::getDirection() const
 {
@@ -216,10 +220,10 @@ ConfigurableInterface::ConfigurableInterface(
 {
 }
 
-Packet*
+PacketHandle
 ConfigurableInterface::getNextConfigPacket()
 {
-    Packet* packet = NULL;
+    PacketHandle packet;
 
     // Only send one configuration packet per cycle
     if (myConfigPacket == NULL)
@@ -228,7 +232,7 @@ ConfigurableInterface::getNextConfigPacket()
                 myPin,
                 myDirection
                 );
-        packet = myConfigPacket;
+        packet.reset(myConfigPacket);
     }
     else
     {
@@ -262,6 +266,16 @@ ConfigurableInterface::processConfigInfoPacket(
     return true;
 }
 
+void
+ConfigurableInterface::getConfigRoutingKeys(
+        std::vector<RoutingKey>& keys
+        ) const
+{
+    keys.push_back(
+            Packet::MakeRoutingKey(RedBotPacket::BID_PINCONFIGINFO, myPin)
+            );
+}
+
 bool
 ConfigurableInterface::isConfigured() const
 {
@@ -2,6 +2,7 @@
 #define PINCONFIG_H
 
 #include "RedBotPacket.h"
+#include "PacketHandle.h"
 
 /**
  * This packet requests that a pin be configured a certain way
@@ -23,13 +24,6 @@ class PinConfigPacket : public RedBotPacket
                 PinDirection    dir     /**< Direction to set pin to */
                 );
 
-        /**
-         * Reads serialized binary data from input stream
-         */
-        void read(
-                std::istream&
-                );
-
         /**
          * Indicates if this packet is valid or not
          */
@@ -55,12 +49,21 @@ class PinConfigPacket : public RedBotPacket
     private:
 
         /**
-         * Writes binary packet contents to output stream
+         * Encodes binary packet contents into the given buffer
          */
-        void writeContents(
-                std::ostream&
+        void encodeContents(
+                unsigned char* buffer
                 ) const;
 
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
         /**
          * Provides elements to include in the XML representation
          */
@@ -102,13 +105,6 @@ class PinConfigInfoPacket : public RedBotPacket
                 PinDirection    dir     /**< Direction pin is set to */
                 );
 
-        /**
-         * Reads serialized binary data from input stream
-         */
-        void read(
-                std::istream&
-                );
-
         /**
          * Indicates if this packet is valid or not
          */
@@ -126,6 +122,13 @@ class PinConfigInfoPacket : public RedBotPacket
          */
         unsigned int getPin() const;
 
+        /**
+         * Provides the key that addresses this packet to a component
+         */
+        bool getRoutingKey(
+                RoutingKey& key
+                ) const;
+
         /**
          * Provides the direction this pin is configured for
          */
@@ -134,12 +137,21 @@ class PinConfigInfoPacket : public RedBotPacket
     private:
 
         /**
-         * Writes binary packet contents to output stream
+         * Encodes binary packet contents into the given buffer
          */
-        void writeContents(
-                std::ostream&
+        void encodeContents(
+                unsigned char* buffer
                 ) const;
 
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
         /**
          * Provides elements to include in the XML representation
          */
@@ -186,7 +198,7 @@ class ConfigurableInterface
         /**
          * Provides the next configuration packet if available
          */
-        Packet* getNextConfigPacket();
+        PacketHandle getNextConfigPacket();
 
         /**
          * Processes the given configuration packet if appropriate
@@ -202,6 +214,13 @@ class ConfigurableInterface
                 const Packet& packet
                 );
 
+        /**
+         * Provides the routing keys of the configuration packets to process
+         */
+        void getConfigRoutingKeys(
+                std::vector<RoutingKey>& keys
+                ) const;
+
         /**
          * Indicates if configuration is complete
          *
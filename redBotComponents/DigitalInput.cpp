@@ -1,6 +1,7 @@
 
 #include "DigitalInput.h"
 #include <stdlib.h>
+#include <string.h>
 
 using namespace frc;
 
@@ -20,11 +21,11 @@ DigitalInputPacket::DigitalInputPacket(
 }
 
 void
-DigitalInputPacket::writeContents(
-        std::ostream& outputStream
+DigitalInputPacket::encodeContents(
+        unsigned char* buffer
         ) const
 {
-    outputStream << (unsigned char)myPin;
+    buffer[0] = (unsigned char)myPin;
 }
 
 void
@@ -41,20 +42,18 @@ DigitalInputPacket::getXMLElements(
 }
 
 void
-DigitalInputPacket::read(
-        std::istream& inputStream
+DigitalInputPacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
         )
 {
-    int pin = -1;
-
-    pin = inputStream.get();
-    myPin = (unsigned int)pin;
-    if (inputStream.good() == false)
+    if (contentSize < 1)
     {
         return;
     }
 
-    inputStream.get();
+    myPin = contents[0];
 }
 
 bool
@@ -82,7 +81,8 @@ DigitalValuePacket::DigitalValuePacket() :
     RedBotPacket(TYPE_DVALUE, "DVALUE", BID_DVALUE),
     myPin(0),
     myValue(false),
-    myIsValid(false)
+    myIsValid(false),
+    myBinaryDataSize(0)
 {
 }
 
@@ -93,31 +93,25 @@ DigitalValuePacket::DigitalValuePacket(
     RedBotPacket(TYPE_DVALUE, "DVALUE", BID_DVALUE),
     myPin(pin),
     myValue(value),
-    myIsValid(true)
+    myIsValid(true),
+    myBinaryDataSize(0)
 {
 }
 
 void
-DigitalValuePacket::writeContents(
-        std::ostream& outputStream
+DigitalValuePacket::encodeContents(
+        unsigned char* buffer
         ) const
 {
     if (isValid() == true)
     {
-        outputStream << (unsigned char)myPin;
-        outputStream << ((myValue == true) ? '\x02' : '\x01');
+        buffer[0] = (unsigned char)myPin;
+        buffer[1] = (myValue == true) ? 0x02 : 0x01;
     }
     else
     {
-        // Dump raw data read from input stream
-        for(
-                size_t byteIdx = 0;
-                byteIdx < myBinaryData.size();
-                ++byteIdx
-           )
-        {
-            outputStream << (unsigned char)myBinaryData[byteIdx];
-        }
+        // Dump raw data decoded into this packet
+        memcpy(buffer, myBinaryData, myBinaryDataSize);
     }
 }
 
@@ -141,61 +135,43 @@ DigitalValuePacket::getXMLElements(
 }
 
 void
-DigitalValuePacket::read(
-        std::istream& inputStream
+DigitalValuePacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
         )
 {
-    int pin = -1;
-    int value = -1;
-    int trailer;
-
-    myBinaryData.clear();
+    myBinaryDataSize = 0;
     myIsValid = false;
 
-    for(
-            size_t byteIdx = 2;
-            byteIdx <= 4;
-            ++byteIdx
-       )
-    {
-        int curByte = inputStream.get();
-        if (inputStream.good() == false)
-        {
-            break;
-        }
-
-        if (curByte == BINARY_BOUND)
-        {
-            trailer = curByte;
-            break;
-        }
-
-        myBinaryData.push_back(curByte);
-
-        switch (byteIdx)
-        {
-            case 2: pin = curByte; break;
-            case 3: value = curByte; break;
-            default: break;
-        };
-    }
-
     if(
-            (pin == -1) ||
-            (value == -1) ||
-            (trailer != BINARY_BOUND)
+            (contentSize != 2) ||
+            (isTerminated == false)
       )
     {
+        // Keep raw data for debugging
+        myBinaryDataSize = (contentSize < MAX_BINARY_SIZE) ? contentSize : MAX_BINARY_SIZE;
+        memcpy(myBinaryData, contents, myBinaryDataSize);
         return;
     }
 
-    myPin = (unsigned int)pin;
-    myValue = (value == 0x02);
+    myPin = contents[0];
+    myValue = (contents[1] == 0x02);
 
-    myBinaryData.clear();
     myIsValid = true;
 }
 
+size_t
+DigitalValuePacket::getContentLength() const
+{
+    if (isValid() == false)
+    {
+        return myBinaryDataSize;
+    }
+
+    return RedBotPacket::getContentLength();
+}
+
 bool
 DigitalValuePacket::isValid() const
 {
@@ -216,6 +192,16 @@ DigitalValuePacket::getPin() const
     return myPin;
 }
 
+bool
+DigitalValuePacket::getRoutingKey(
+        RoutingKey& key
+        ) const
+{
+    key = MakeRoutingKey(getBinaryID(), myPin);
+
+    return true;
+}
+
 bool
 DigitalValuePacket::getValue() const
 {
@@ -235,10 +221,10 @@ DigitalInput::~DigitalInput()
 {
 }
 
-Packet*
+PacketHandle
 DigitalInput::getNextPacket()
 {
-    Packet* packet = NULL;
+    PacketHandle packet;
 
     if (isConfigured() == true)
     {
@@ -267,3 +253,14 @@ DigitalInput::processPacket(
     }
 }
 
+void
+DigitalInput::getRoutingKeys(
+        std::vector<RoutingKey>& keys
+        ) const
+{
+    getConfigRoutingKeys(keys);
+    keys.push_back(
+            Packet::MakeRoutingKey(RedBotPacket::BID_DVALUE, myChannel)
+            );
+}
+
@@ -30,13 +30,6 @@ class DigitalInputPacket : public RedBotPacket
                 unsigned int    pin     /**< Pin to read from */
                 );
 
-        /**
-         * Reads serialized binary data from input stream
-         */
-        void read(
-                std::istream&
-                );
-
         /**
          * Indicates if this packet is valid or not
          */
@@ -57,12 +50,21 @@ class DigitalInputPacket : public RedBotPacket
     private:
 
         /**
-         * Writes binary packet contents to output stream
+         * Encodes binary packet contents into the given buffer
          */
-        void writeContents(
-                std::ostream&
+        void encodeContents(
+                unsigned char* buffer
                 ) const;
 
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
         /**
          * Provides elements to include in the XML representation
          */
@@ -99,13 +101,6 @@ class DigitalValuePacket : public RedBotPacket
                 bool            value   /**< Value detected on pin */
                 );
 
-        /**
-         * Reads serialized binary data from input stream
-         */
-        void read(
-                std::istream&
-                );
-
         /**
          * Indicates if this packet is valid or not
          */
@@ -123,20 +118,43 @@ class DigitalValuePacket : public RedBotPacket
          */
         unsigned int getPin() const;
 
+        /**
+         * Provides the key that addresses this packet to a component
+         */
+        bool getRoutingKey(
+                RoutingKey& key
+                ) const;
+
         /**
          * Provides the value read from the pin
          */
         bool getValue() const;
 
+        /**
+         * Provides the number of content bytes this packet encodes to
+         *
+         * An invalid packet encodes the raw data it was decoded from.
+         */
+        size_t getContentLength() const;
+
     private:
 
         /**
-         * Writes binary packet contents to output stream
+         * Encodes binary packet contents into the given buffer
          */
-        void writeContents(
-                std::ostream&
+        void encodeContents(
+                unsigned char* buffer
                 ) const;
 
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
         /**
          * Provides elements to include in the XML representation
          */
@@ -160,9 +178,14 @@ class DigitalValuePacket : public RedBotPacket
         bool myIsValid;
 
         /**
-         * Raw binary data read from input stream
+         * Raw binary data decoded into an invalid packet
          */
-        std::vector<int> myBinaryData;
+        unsigned char myBinaryData[MAX_BINARY_SIZE];
+
+        /**
+         * Number of bytes in myBinaryData
+         */
+        size_t myBinaryDataSize;
 };
 
 namespace frc
@@ -192,7 +215,7 @@ class DigitalInput :
         /**
          * Provides the next available packet to send
          */
-        Packet* getNextPacket();
+        PacketHandle getNextPacket();
 
         /**
          * Examines the packet and processes it if appropriate
@@ -200,6 +223,13 @@ class DigitalInput :
         bool processPacket(
                 const Packet& packet
                 );
+
+        /**
+         * Provides the routing keys of the packets this component processes
+         */
+        void getRoutingKeys(
+                std::vector<RoutingKey>& keys
+                ) const;
 };
 
 }; /* namespace frc */
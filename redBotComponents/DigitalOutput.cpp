@@ -1,6 +1,7 @@
 
 #include "DigitalOutput.h"
 #include <stdlib.h>
+#include <utility>
 
 using namespace frc;
 
@@ -23,12 +24,12 @@ DigitalOutputPacket::DigitalOutputPacket(
 }
 
 void
-DigitalOutputPacket::writeContents(
-        std::ostream& outputStream
+DigitalOutputPacket::encodeContents(
+        unsigned char* buffer
         ) const
 {
-    outputStream << (unsigned char)myPin;
-    outputStream << (myValue ? '\x02' : '\x01');
+    buffer[0] = (unsigned char)myPin;
+    buffer[1] = myValue ? 0x02 : 0x01;
 }
 
 void
@@ -51,29 +52,25 @@ DigitalOutputPacket::getXMLElements(
 }
 
 void
-DigitalOutputPacket::read(
-        std::istream& inputStream
+DigitalOutputPacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
         )
 {
-    unsigned char pin;
-    unsigned char value;
-
-    inputStream >> pin;
-    myPin = (unsigned int)pin;
-    if (inputStream.good() == false)
+    if (contentSize < 1)
     {
         return;
     }
 
-    inputStream >> value;
-    if (value == '\x02')
-    {
-        myValue = true;
-    }
-    else
+    myPin = contents[0];
+
+    if (contentSize < 2)
     {
-        myValue = false;
+        return;
     }
+
+    myValue = (contents[1] == 0x02);
 }
 
 bool
@@ -128,7 +125,7 @@ DigitalOutput::DigitalOutput(
     RedBotComponent(),
     ConfigurableInterface(channel, RedBotPacket::DIR_OUTPUT),
     myChannel(channel),
-    myCurrentPacket(NULL)
+    myValue(0)
 {
 }
 
@@ -141,26 +138,38 @@ DigitalOutput::Set(
         uint32_t value
         )
 {
-    if (myCurrentPacket != NULL)
-    {
-        delete myCurrentPacket;
-    }
-
-    myCurrentPacket = new DigitalOutputPacket(
-            myChannel,
-            ((value == 0) ? false : true)
+    myValue = value;
+    myCurrentPacket.reset(
+            new DigitalOutputPacket(
+                myChannel,
+                ((value == 0) ? false : true)
+                )
             );
 }
 
-Packet*
+PacketHandle
 DigitalOutput::getNextPacket()
 {
-    Packet* packet = NULL;
+    PacketHandle packet;
 
     if (isConfigured() == true)
     {
-        packet = myCurrentPacket;
-        myCurrentPacket = NULL;
+        // Repeat the last value if nothing was set for a while
+        if(
+                (myCurrentPacket.isNull() == true) &&
+                (myOutputCache.isKeepAliveDue() == true)
+          )
+        {
+            Set(myValue);
+        }
+
+        // Drop values that would not change the output
+        if (myOutputCache.update(myCurrentPacket.get()) == false)
+        {
+            myCurrentPacket.reset();
+        }
+
+        packet = std::move(myCurrentPacket);
     }
     else
     {
@@ -185,3 +194,11 @@ DigitalOutput::processPacket(
     }
 }
 
+void
+DigitalOutput::getRoutingKeys(
+        std::vector<RoutingKey>& keys
+        ) const
+{
+    getConfigRoutingKeys(keys);
+}
+
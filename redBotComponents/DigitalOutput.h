@@ -5,6 +5,7 @@
 #include "RedBotComponent.h"
 #include "RedBotPacket.h"
 #include "ConfigurableInterface.h"
+#include "OutputCache.h"
 
 /**
  * Digital output command class
@@ -28,13 +29,6 @@ class DigitalOutputPacket : public RedBotPacket
                 bool            value   /**< Value to output */
                 );
 
-        /**
-         * Reads serialized binary data from input stream
-         */
-        void read(
-                std::istream&
-                );
-
         /**
          * Indicates if this packet is valid or not
          */
@@ -60,12 +54,21 @@ class DigitalOutputPacket : public RedBotPacket
     private:
 
         /**
-         * Writes binary packet contents to output stream
+         * Encodes binary packet contents into the given buffer
          */
-        void writeContents(
-                std::ostream&
+        void encodeContents(
+                unsigned char* buffer
                 ) const;
 
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
         /**
          * Provides elements to include in the XML representation
          */
@@ -118,7 +121,7 @@ class DigitalOutput :
         /**
          * Provides the next available packet to send
          */
-        Packet* getNextPacket();
+        PacketHandle getNextPacket();
 
         /**
          * Examines and processes a packet if needed
@@ -129,6 +132,13 @@ class DigitalOutput :
                 const Packet& packet
                 );
 
+        /**
+         * Provides the routing keys of the packets this component processes
+         */
+        void getRoutingKeys(
+                std::vector<RoutingKey>& keys
+                ) const;
+
     private:
 
         /**
@@ -136,10 +146,20 @@ class DigitalOutput :
          */
         uint32_t myChannel;
 
+        /**
+         * Last value the output was set to
+         */
+        uint32_t myValue;
+
         /**
          * Packet to send to robot
          */
-        Packet* myCurrentPacket;
+        PacketHandle myCurrentPacket;
+
+        /**
+         * Filter for repeated output values
+         */
+        OutputCache myOutputCache;
 };
 
 }; /* namespace frc */
@@ -2,17 +2,32 @@
 #define INPUT_H
 
 #include "RedBotComponent.h"
+#include "RedBotPacket.h"
+#include "LatencyHistogram.h"
+#include "Timer.h"
 #include <stdint.h>
 #include <stdlib.h>
+#include <limits>
+#include <utility>
 
 /**
  * Generic input class
  *
  * This class encapsulates an data input source on the robot. It sends RequestType
  * packets to request the latest value detected on the source which are returned
- * via ResponseType packets. If the last-sent request was dropped for whatever
- * reason, another request will be automatically sent after a number of cycles
- * have passed without any response.
+ * via ResponseType packets. By default a new request follows every response;
+ * a target sample rate spaces requests out instead. If the last-sent request
+ * was dropped for whatever reason, another request will be automatically sent
+ * after a number of cycles have passed without any response. That number
+ * adapts to how many cycles the robot takes to answer.
+ *
+ * Alternatively, the input can subscribe to samples pushed by the robot at a
+ * fixed period, in which case no requests are sent while samples keep
+ * arriving. The subscription is renewed if they stop.
+ *
+ * Each value is stamped with the monotonic time at which it was requested and
+ * received, and the round-trip latency of every answered request is recorded
+ * in a histogram.
  */
 template <class RequestType, class ResponseType, class ValueType>
 class Input : public RedBotComponent
@@ -31,6 +46,88 @@ class Input : public RedBotComponent
          */
         ValueType Get() const;
 
+        /**
+         * Gets the current value along with its age
+         *
+         * The age is infinite if no value has been received yet.
+         */
+        ValueType GetWithAge(
+                double& age /**< Seconds elapsed since the value was received */
+                ) const;
+
+        /**
+         * Provides the time at which the current value was received
+         *
+         * \return Monotonic time in seconds, or 0 if no value has been
+         * received yet
+         */
+        double GetTimestamp() const;
+
+        /**
+         * Provides the time at which the current value was requested
+         *
+         * Pushed samples are not requested, so their request time is the time
+         * they were received.
+         *
+         * \return Monotonic time in seconds, or 0 if no value has been
+         * received yet
+         */
+        double GetRequestTimestamp() const;
+
+        /**
+         * Provides the number of cycles since the current value was received
+         */
+        unsigned int GetStaleCycles() const;
+
+        /**
+         * Provides the round-trip latencies of the answered requests
+         */
+        const LatencyHistogram& GetLatencyHistogram() const;
+
+        /**
+         * Sets the rate at which values are requested
+         *
+         * A rate of 0 requests a new value as soon as the last one arrives.
+         */
+        void SetSampleRate(
+                double rate /**< Target number of samples per second */
+                );
+
+        /**
+         * Provides the rate at which values are requested
+         */
+        double GetSampleRate() const;
+
+        /**
+         * Sets the priority of this input's requests
+         *
+         * Higher-priority components are polled first when the robot's link
+         * budget is limited.
+         */
+        void SetPriority(
+                unsigned int priority
+                );
+
+        /**
+         * Provides the priority of this input's requests
+         */
+        unsigned int getPriority() const;
+
+        /**
+         * Sets the period at which the robot pushes samples of this input
+         *
+         * A period of 0 cancels the subscription and returns to requesting
+         * each value.
+         */
+        void SetStreamPeriod(
+                unsigned int period /**< Sampling period in milliseconds */
+                );
+
+        /**
+         * Provides the period at which the robot pushes samples of this input
+         */
+        unsigned int GetStreamPeriod() const;
+
     protected:
 
         /**
@@ -40,7 +137,7 @@ class Input : public RedBotComponent
          * from the robot was just received or if a number of cycles have
          * passed without any response since the last request.
          */
-        RequestType* getNextPacketIfTimedOut();
+        PacketHandle getNextPacketIfTimedOut();
 
         /**
          * Examines and processes a data packet if needed
@@ -59,9 +156,40 @@ class Input : public RedBotComponent
     private:
 
         /**
-         * Number of cycles to wait for reply packet before calling time-out
+         * Number of cycles to wait for the first reply packet before calling
+         * time-out
          */
-        const static unsigned int TIMEOUT_THRESH = 5;
+        const static unsigned int DEFAULT_RETRY_THRESH = 5;
+
+        /**
+         * Fewest cycles to wait for a reply packet before calling time-out
+         */
+        const static unsigned int MIN_RETRY_THRESH = 2;
+
+        /**
+         * Most cycles to wait for a reply packet before calling time-out
+         */
+        const static unsigned int MAX_RETRY_THRESH = 40;
+
+        /**
+         * Number of cycles to wait for a pushed sample before subscribing again
+         */
+        const static unsigned int STREAM_TIMEOUT_THRESH = 50;
+
+        /**
+         * Creates a request to subscribe to samples at the current period
+         */
+        PacketHandle createSubscribeRequest();
+
+        /**
+         * Indicates if a new value should be requested at the sample rate
+         */
+        bool isSampleDue() const;
+
+        /**
+         * Adapts the time-out to the cycles the last reply took
+         */
+        void updateRetryThreshold();
 
         /**
          * Last value read from pin
@@ -71,12 +199,74 @@ class Input : public RedBotComponent
         /**
          * Next packet to send to robot
          */
-        RequestType* myOutgoingPacket;
+        PacketHandle myOutgoingPacket;
 
         /**
          * Counter value used to detect time-outs for packet replies
          */
         unsigned int myTimeoutCounter;
+
+        /**
+         * Number of cycles to wait for a reply packet before calling time-out
+         */
+        unsigned int myRetryThresh;
+
+        /**
+         * Target number of samples per second, or 0 to request continuously
+         */
+        double mySampleRate;
+
+        /**
+         * Priority of this input's requests
+         */
+        unsigned int myPriority;
+
+        /**
+         * Indicates if a value has been received
+         *
+         * A value can be received at time 0, so the timestamp cannot tell.
+         */
+        bool myHasValue;
+
+        /**
+         * Time at which the current value was received
+         */
+        double myTimestamp;
+
+        /**
+         * Time at which the current value was requested
+         */
+        double myValueRequestTime;
+
+        /**
+         * Time at which the outstanding request was handed out for sending
+         */
+        double myRequestTime;
+
+        /**
+         * Indicates if a request was handed out and not answered yet
+         */
+        bool myIsRequestPending;
+
+        /**
+         * Number of cycles since the current value was received
+         */
+        unsigned int myStaleCycles;
+
+        /**
+         * Round-trip latencies of the answered requests
+         */
+        LatencyHistogram myLatencyHistogram;
+
+        /**
+         * Sampling period of the subscription, or 0 if values are requested
+         */
+        unsigned int myStreamPeriod;
+
+        /**
+         * Indicates if the stream period changed since it was last sent
+         */
+        bool myIsStreamChanged;
 };
 
 /**
@@ -116,18 +306,24 @@ template <class RequestType, class ResponseType, class ValueType>
 Input<RequestType, ResponseType, ValueType>::Input() :
     RedBotComponent(),
     myValue(0),
-    myOutgoingPacket(NULL),
-    myTimeoutCounter(TIMEOUT_THRESH+1)
+    myTimeoutCounter(0),
+    myRetryThresh(DEFAULT_RETRY_THRESH),
+    mySampleRate(0.0),
+    myPriority(DEFAULT_PRIORITY),
+    myHasValue(false),
+    myTimestamp(0.0),
+    myValueRequestTime(0.0),
+    myRequestTime(0.0),
+    myIsRequestPending(false),
+    myStaleCycles(0),
+    myStreamPeriod(0),
+    myIsStreamChanged(false)
 {
 }
 
 template <class RequestType, class ResponseType, class ValueType>
 Input<RequestType, ResponseType, ValueType>::~Input()
 {
-    if (myOutgoingPacket != NULL)
-    {
-        delete myOutgoingPacket;
-    }
 }
 
 template <class RequestType, class ResponseType, class ValueType>
@@ -138,16 +334,183 @@ Input<RequestType, ResponseType, ValueType>::Get() const
 }
 
 template <class RequestType, class ResponseType, class ValueType>
-RequestType*
+ValueType
+Input<RequestType, ResponseType, ValueType>::GetWithAge(
+        double& age
+        ) const
+{
+    if (myHasValue == false)
+    {
+        age = std::numeric_limits<double>::infinity();
+    }
+    else
+    {
+        age = frc::Timer::GetFPGATimestamp() - myTimestamp;
+    }
+
+    return myValue;
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+double
+Input<RequestType, ResponseType, ValueType>::GetTimestamp() const
+{
+    return myTimestamp;
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+double
+Input<RequestType, ResponseType, ValueType>::GetRequestTimestamp() const
+{
+    return myValueRequestTime;
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+unsigned int
+Input<RequestType, ResponseType, ValueType>::GetStaleCycles() const
+{
+    return myStaleCycles;
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+const LatencyHistogram&
+Input<RequestType, ResponseType, ValueType>::GetLatencyHistogram() const
+{
+    return myLatencyHistogram;
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+void
+Input<RequestType, ResponseType, ValueType>::SetStreamPeriod(
+        unsigned int period
+        )
+{
+    if (period > SubscribePacket::MAX_PERIOD)
+    {
+        period = SubscribePacket::MAX_PERIOD;
+    }
+
+    if (period != myStreamPeriod)
+    {
+        myStreamPeriod = period;
+        myIsStreamChanged = true;
+    }
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+unsigned int
+Input<RequestType, ResponseType, ValueType>::GetStreamPeriod() const
+{
+    return myStreamPeriod;
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+void
+Input<RequestType, ResponseType, ValueType>::SetSampleRate(
+        double rate
+        )
+{
+    mySampleRate = (rate > 0.0) ? rate : 0.0;
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+double
+Input<RequestType, ResponseType, ValueType>::GetSampleRate() const
+{
+    return mySampleRate;
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+void
+Input<RequestType, ResponseType, ValueType>::SetPriority(
+        unsigned int priority
+        )
+{
+    myPriority = priority;
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+unsigned int
+Input<RequestType, ResponseType, ValueType>::getPriority() const
+{
+    return myPriority;
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+bool
+Input<RequestType, ResponseType, ValueType>::isSampleDue() const
+{
+    if(
+            (mySampleRate == 0.0) ||
+            (myHasValue == false)
+      )
+    {
+        return true;
+    }
+
+    return ((frc::Timer::GetFPGATimestamp() - myRequestTime) >= (1.0 / mySampleRate));
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+void
+Input<RequestType, ResponseType, ValueType>::updateRetryThreshold()
+{
+    // Wait twice as long as the last reply took; rise at once but ease back
+    // down a cycle at a time so that a single quick reply does not cause
+    // needless retries
+    unsigned int retryThresh = (2 * myTimeoutCounter) + MIN_RETRY_THRESH;
+    if (retryThresh > MAX_RETRY_THRESH)
+    {
+        retryThresh = MAX_RETRY_THRESH;
+    }
+
+    if (retryThresh > myRetryThresh)
+    {
+        myRetryThresh = retryThresh;
+    }
+    else if (retryThresh < myRetryThresh)
+    {
+        --myRetryThresh;
+    }
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+PacketHandle
+Input<RequestType, ResponseType, ValueType>::createSubscribeRequest()
+{
+    RequestType* request = createRequest();
+    PacketHandle subscribePacket(new SubscribePacket(*request, myStreamPeriod));
+    delete request;
+
+    return subscribePacket;
+}
+
+template <class RequestType, class ResponseType, class ValueType>
+PacketHandle
 Input<RequestType, ResponseType, ValueType>::getNextPacketIfTimedOut()
 {
-    RequestType* packet = NULL;
+    // Anything handed out other than a subscription is a value request
+    bool isRequest = (
+            (myIsStreamChanged == false) &&
+            (myStreamPeriod == 0)
+            );
+
+    ++myStaleCycles;
 
-    if (myOutgoingPacket == NULL)
+    if (myIsStreamChanged == true)
     {
-        if (myTimeoutCounter > TIMEOUT_THRESH)
+        myIsStreamChanged = false;
+        myOutgoingPacket = createSubscribeRequest();
+
+        // Resume requesting values right away once unsubscribed
+        myTimeoutCounter = 0;
+        myIsRequestPending = false;
+    }
+    else if (myStreamPeriod > 0)
+    {
+        if (myTimeoutCounter > STREAM_TIMEOUT_THRESH)
         {
-	  myOutgoingPacket = createRequest();
+            myOutgoingPacket = createSubscribeRequest();
             myTimeoutCounter = 0;
         }
         else
@@ -155,11 +518,41 @@ Input<RequestType, ResponseType, ValueType>::getNextPacketIfTimedOut()
             ++myTimeoutCounter;
         }
     }
+    else if (myOutgoingPacket.isNull() == true)
+    {
+        if (myIsRequestPending == true)
+        {
+            if (myTimeoutCounter > myRetryThresh)
+            {
+                myOutgoingPacket.reset(createRequest());
+                myTimeoutCounter = 0;
+
+                // Back off while the robot is slow to answer
+                myRetryThresh = (2 * myRetryThresh > MAX_RETRY_THRESH) ?
+                    MAX_RETRY_THRESH : (2 * myRetryThresh);
+            }
+            else
+            {
+                ++myTimeoutCounter;
+            }
+        }
+        else if (isSampleDue() == true)
+        {
+            myOutgoingPacket.reset(createRequest());
+            myTimeoutCounter = 0;
+        }
+    }
 
-    packet = myOutgoingPacket;
-    myOutgoingPacket = NULL;
+    if(
+            (isRequest == true) &&
+            (myOutgoingPacket.isNull() == false)
+      )
+    {
+        myRequestTime = frc::Timer::GetFPGATimestamp();
+        myIsRequestPending = true;
+    }
 
-    return packet;
+    return std::move(myOutgoingPacket);
 }
 
 template <class RequestType, class ResponseType, class ValueType>
@@ -180,11 +573,33 @@ Input<RequestType, ResponseType, ValueType>::processDataPacket(
     }
 
     myValue = responsePacket->getValue();
+    myHasValue = true;
+    myStaleCycles = 0;
+
+    myTimestamp = frc::Timer::GetFPGATimestamp();
+    if (myIsRequestPending == true)
+    {
+        updateRetryThreshold();
+        myValueRequestTime = myRequestTime;
+        myLatencyHistogram.add(myTimestamp - myRequestTime);
+        myIsRequestPending = false;
+    }
+    else
+    {
+        myValueRequestTime = myTimestamp;
+    }
+
     myTimeoutCounter = 0;
 
-    if (myOutgoingPacket == NULL)
+    // Subscribed samples keep arriving without further requests, and
+    // rate-limited values are requested once due
+    if(
+            (myStreamPeriod == 0) &&
+            (mySampleRate == 0.0) &&
+            (myOutgoingPacket.isNull() == true)
+      )
     {
-      myOutgoingPacket = createRequest();
+      myOutgoingPacket.reset(createRequest());
     }
 
     return true;
@@ -0,0 +1,73 @@
+
+#include "OutputCache.h"
+#include <string.h>
+
+
+unsigned int OutputCache::ourKeepAliveInterval = OutputCache::DEFAULT_KEEP_ALIVE_INTERVAL;
+
+
+void
+OutputCache::SetKeepAliveInterval(
+        unsigned int cycleCount
+        )
+{
+    ourKeepAliveInterval = cycleCount;
+}
+
+unsigned int
+OutputCache::GetKeepAliveInterval()
+{
+    return ourKeepAliveInterval;
+}
+
+OutputCache::OutputCache() :
+    myLastPacketSize(0),
+    myCycleCount(0)
+{
+}
+
+bool
+OutputCache::isKeepAliveDue() const
+{
+    return(
+            (ourKeepAliveInterval > 0) &&
+            (myLastPacketSize > 0) &&
+            ((myCycleCount + 1) >= ourKeepAliveInterval)
+          );
+}
+
+bool
+OutputCache::update(
+        const Packet* packet
+        )
+{
+    if (myCycleCount < ourKeepAliveInterval)
+    {
+        ++myCycleCount;
+    }
+
+    if (packet == NULL)
+    {
+        return false;
+    }
+
+    unsigned char packetData[Packet::MAX_BINARY_SIZE];
+    size_t packetSize = packet->encode(packetData, sizeof(packetData));
+
+    if(
+            (ourKeepAliveInterval > 0) &&
+            (myCycleCount < ourKeepAliveInterval) &&
+            (packetSize == myLastPacketSize) &&
+            (memcmp(packetData, myLastPacketData, packetSize) == 0)
+      )
+    {
+        // Repeated command
+        return false;
+    }
+
+    memcpy(myLastPacketData, packetData, packetSize);
+    myLastPacketSize = packetSize;
+    myCycleCount = 0;
+
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef OUTPUTCACHE_H
+#define OUTPUTCACHE_H
+
+#include "Packet.h"
+
+/**
+ * Change filter for actuator commands
+ *
+ * Programs typically command their actuators every cycle, mostly with the
+ * same value. This cache remembers the last command sent for an actuator, as
+ * it appeared on the wire, and suppresses identical commands. The last
+ * command is still sent again once every keep-alive interval so that a lost
+ * packet is eventually made up for.
+ */
+class OutputCache
+{
+    public:
+
+        /**
+         * Default number of cycles between keep-alive commands
+         */
+        static const unsigned int DEFAULT_KEEP_ALIVE_INTERVAL = 25;
+
+        /**
+         * Sets the number of cycles between keep-alive commands
+         *
+         * An interval of 0 disables suppression, so every command is sent.
+         */
+        static void SetKeepAliveInterval(
+                unsigned int cycleCount
+                );
+
+        /**
+         * Provides the number of cycles between keep-alive commands
+         */
+        static unsigned int GetKeepAliveInterval();
+
+        /**
+         * Constructor
+         */
+        OutputCache();
+
+        /**
+         * Indicates if the last command is due to be sent again
+         *
+         * This holds when the coming call to update() falls on the end of the
+         * keep-alive interval.
+         */
+        bool isKeepAliveDue() const;
+
+        /**
+         * Decides if a command packet needs to be sent
+         *
+         * This is called once per cycle, with a NULL packet for cycles in
+         * which no command was given. Packets that are to be sent become the
+         * new last command.
+         *
+         * \return True if the packet should be sent, false if it is NULL or
+         * repeats the last command sent
+         */
+        bool update(
+                const Packet* packet
+                );
+
+    private:
+
+        /**
+         * Number of cycles between keep-alive commands
+         */
+        static unsigned int ourKeepAliveInterval;
+
+        /**
+         * Binary representation of the last command sent
+         */
+        unsigned char myLastPacketData[Packet::MAX_BINARY_SIZE];
+
+        /**
+         * Number of bytes in myLastPacketData, 0 if nothing was sent yet
+         */
+        size_t myLastPacketSize;
+
+        /**
+         * Number of cycles since the last command was sent
+         */
+        unsigned int myCycleCount;
+};
+
+#endif /* ifndef OUTPUTCACHE_H */
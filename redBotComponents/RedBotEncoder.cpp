@@ -21,9 +21,9 @@ EncoderInputPacket::isRight() const
 }
 
 void
-EncoderInputPacket::writeContents(std::ostream& outputStream) const
+EncoderInputPacket::encodeContents(unsigned char* buffer) const
 {
-  outputStream << (myIsRight ? '\x02' : '\x01');
+  buffer[0] = myIsRight ? 0x02 : 0x01;
 }
 
 void
@@ -33,18 +33,14 @@ EncoderInputPacket::getXMLElements(XMLElements& elements) const
 }
 
 void
-EncoderInputPacket::read(std::istream& inputStream)
+EncoderInputPacket::decodeContents(const unsigned char* contents, size_t contentSize, bool isTerminated)
 {
-  bool isRight = true;
-  isRight = (inputStream.get() == 2);
-  if (inputStream.good() == false)
+  if (contentSize < 1)
     {
       return;
     }
 
-  myIsRight = isRight;
-
-  inputStream.get();
+  myIsRight = (contents[0] == 2);
 }
 
 bool
@@ -80,6 +76,13 @@ EncoderCountPacket::isRight() const
   return myIsRight;
 }
 
+bool
+EncoderCountPacket::getRoutingKey(RoutingKey& key) const
+{
+  key = MakeRoutingKey(getBinaryID(), (myIsRight ? 1 : 0));
+  return true;
+}
+
 int32_t
 EncoderCountPacket::getCount() const
 {
@@ -93,25 +96,25 @@ EncoderCountPacket::getValue() const
 }
 
 void
-EncoderCountPacket::read(std::istream& inputStream)
+EncoderCountPacket::decodeContents(const unsigned char* contents, size_t contentSize, bool isTerminated)
 {
-  bool isRight = true;
-  isRight = (inputStream.get() == 1);
-  if (inputStream.good() == false)
+  if (contentSize < 1)
     {
       return;
     }
 
-  myIsRight = isRight;
+  myIsRight = (contents[0] == 1);
+
+  if (contentSize < 6)
+    {
+      return;
+    }
 
   int32_t count = 0;
+  size_t contentIdx = 1;
   for (ssize_t upperByteIdx = 32; upperByteIdx >= 0; upperByteIdx -= 7)
     {
-      char curByte = inputStream.get();
-      if (inputStream.good() == false)
-	{
-	  return;
-	}
+      char curByte = contents[contentIdx++];
 
       --curByte;
 
@@ -120,8 +123,6 @@ EncoderCountPacket::read(std::istream& inputStream)
     }
 
   myCount = count;
-
-  inputStream.get();
 }
 
 bool
@@ -137,11 +138,12 @@ EncoderCountPacket::operator==(const Packet& packet) const
 }
 
 void
-EncoderCountPacket::writeContents(std::ostream& outputStream) const
+EncoderCountPacket::encodeContents(unsigned char* buffer) const
 {
-  outputStream << (myIsRight ? "\x01" : "\x02");
+  buffer[0] = myIsRight ? 0x01 : 0x02;
 
   // Split count up into 7-bit chunks
+  size_t contentIdx = 1;
   for (ssize_t bitOffset = 31; bitOffset >= 0; bitOffset -= 7)
     {
       char curByte = 0;
@@ -151,10 +153,42 @@ EncoderCountPacket::writeContents(std::ostream& outputStream) const
 	}
       ++curByte;
 
-      outputStream << curByte;
+      buffer[contentIdx++] = curByte;
     }
 }
 
+void
+EncoderCountPacket::encodeNativeContents(unsigned char* buffer) const
+{
+  buffer[0] = myIsRight ? 0x01 : 0x02;
+
+  // Count is sent whole, most significant byte first
+  uint32_t count = (uint32_t)myCount;
+  for (size_t contentIdx = 1; contentIdx <= 4; ++contentIdx)
+    {
+      buffer[contentIdx] = (unsigned char)(count >> (8 * (4 - contentIdx)));
+    }
+}
+
+void
+EncoderCountPacket::decodeNativeContents(const unsigned char* contents, size_t contentSize)
+{
+  if (contentSize < 5)
+    {
+      return;
+    }
+
+  myIsRight = (contents[0] == 1);
+
+  uint32_t count = 0;
+  for (size_t contentIdx = 1; contentIdx <= 4; ++contentIdx)
+    {
+      count = (count << 8) | contents[contentIdx];
+    }
+
+  myCount = (int32_t)count;
+}
+
 void
 EncoderCountPacket::getXMLElements(XMLElements& elements) const
 {
@@ -182,18 +216,14 @@ EncoderClearPacket::isRight() const
 }
 
 void
-EncoderClearPacket::read(std::istream& inputStream)
+EncoderClearPacket::decodeContents(const unsigned char* contents, size_t contentSize, bool isTerminated)
 {
-  bool isRight = true;
-  isRight = (inputStream.get() == 1);
-  if (inputStream.good() == false)
+  if (contentSize < 1)
     {
       return;
     }
 
-  myIsRight = isRight;
-
-  inputStream.get();
+  myIsRight = (contents[0] == 1);
 }
 
 bool
@@ -209,9 +239,9 @@ EncoderClearPacket::operator==(const Packet& packet) const
 }
 
 void
-EncoderClearPacket::writeContents(std::ostream& outputStream) const
+EncoderClearPacket::encodeContents(unsigned char* buffer) const
 {
-  outputStream << (myIsRight ? '\x01' : '\x02');
+  buffer[0] = myIsRight ? 0x01 : 0x02;
 }
 
 void
@@ -239,13 +269,13 @@ RedBotEncoder::Reset()
   myIsReset = true;
 }
 
-Packet*
+PacketHandle
 RedBotEncoder::getNextPacket()
 {
   if (myIsReset == true)
     {
       myIsReset = false;
-      return new EncoderClearPacket(myIsRight);
+      return PacketHandle(new EncoderClearPacket(myIsRight));
     }
   else
     {
@@ -259,6 +289,12 @@ RedBotEncoder::processPacket(const Packet& packet)
   return processDataPacket(packet);
 }
 
+void
+RedBotEncoder::getRoutingKeys(std::vector<RoutingKey>& keys) const
+{
+  keys.push_back(Packet::MakeRoutingKey(RedBotPacket::BID_ENCCOUNT, (myIsRight ? 1 : 0)));
+}
+
 EncoderInputPacket*
 RedBotEncoder::createRequest()
 {
@@ -31,15 +31,15 @@ class EncoderInputPacket : public RedBotPacket
 
   bool isRight() const;
 
-  void read(std::istream& inputStream);
-
   bool isValid() const;
 
   bool operator==(const Packet& packet) const;
 
  private:
 
-  void writeContents(std::ostream& outputStream) const;
+  void encodeContents(unsigned char* buffer) const;
+
+  void decodeContents(const unsigned char* contents, size_t contentSize, bool isTerminated);
 
   void getXMLElements(XMLElements& elements) const;
 
@@ -56,19 +56,25 @@ class EncoderCountPacket : public RedBotPacket
 
   bool isRight() const;
 
+  bool getRoutingKey(RoutingKey& key) const;
+
   int32_t getCount() const;
 
   int32_t getValue() const;
 
-  void read(std::istream& inputStream);
-
   bool isValid() const;
 
   bool operator==(const Packet& packet) const;
 
  private:
 
-  void writeContents(std::ostream& outputStream) const;
+  void encodeContents(unsigned char* buffer) const;
+
+  void decodeContents(const unsigned char* contents, size_t contentSize, bool isTerminated);
+
+  void encodeNativeContents(unsigned char* buffer) const;
+
+  void decodeNativeContents(const unsigned char* contents, size_t contentSize);
 
   void getXMLElements(XMLElements& elements) const;
 
@@ -87,15 +93,15 @@ class EncoderClearPacket : public RedBotPacket
 
   bool isRight() const;
 
-  void read(std::istream& inputStream);
-
   bool isValid() const;
 
   bool operator==(const Packet& packet) const;
 
  private:
 
-  void writeContents(std::ostream& outputStream) const;
+  void encodeContents(unsigned char* buffer) const;
+
+  void decodeContents(const unsigned char* contents, size_t contentSize, bool isTerminated);
 
   void getXMLElements(XMLElements& elements) const;
 
@@ -114,10 +120,12 @@ class RedBotEncoder :
 
   void Reset();
 
-  Packet* getNextPacket();
+  PacketHandle getNextPacket();
 
   bool processPacket(const Packet&);
 
+  void getRoutingKeys(std::vector<RoutingKey>& keys) const;
+
  private:
 
   const bool myIsRight;
@@ -8,6 +8,7 @@
 #include <sstream>
 #include <vector>
 #include <math.h>
+#include <string.h>
 
 
 RedBotPacket::RedBotPacket(
@@ -26,13 +27,171 @@ RedBotPacket::write(
         std::ostream& outputStream
         ) const
 {
-    outputStream
-        << BINARY_BOUND
-        << (unsigned char)myBinaryID;
+    unsigned char packetData[MAX_BINARY_SIZE];
+
+    outputStream.write(
+            (const char*)packetData,
+            encode(packetData, MAX_BINARY_SIZE)
+            );
+}
+
+void
+RedBotPacket::writeBody(
+        std::ostream& outputStream
+        ) const
+{
+    unsigned char packetData[MAX_BINARY_SIZE];
+
+    outputStream.write(
+            (const char*)packetData,
+            encodeBody(packetData, MAX_BINARY_SIZE)
+            );
+}
+
+void
+RedBotPacket::read(
+        std::istream& inputStream
+        )
+{
+    unsigned char packetData[MAX_BINARY_SIZE];
+    size_t packetSize = 0;
+
+    // Gather bytes up to the trailing boundary byte
+    while (packetSize < MAX_BINARY_SIZE)
+    {
+        int curByte = inputStream.get();
+        if (inputStream.good() == false)
+        {
+            break;
+        }
+
+        packetData[packetSize++] = (unsigned char)curByte;
+        if (curByte == BINARY_BOUND)
+        {
+            break;
+        }
+    }
+
+    decode(packetData, packetSize);
+}
+
+size_t
+RedBotPacket::encode(
+        unsigned char*  buffer,
+        size_t          bufferSize
+        ) const
+{
+    if (bufferSize < 1)
+    {
+        return 0;
+    }
+
+    size_t bodySize = encodeBody(buffer + 1, bufferSize - 1);
+    if(
+            (bodySize == 0) ||
+            ((bodySize + 2) > bufferSize)
+      )
+    {
+        return 0;
+    }
+
+    buffer[0] = BINARY_BOUND;
+    buffer[bodySize + 1] = BINARY_BOUND;
+
+    return bodySize + 2;
+}
+
+size_t
+RedBotPacket::encodeBody(
+        unsigned char*  buffer,
+        size_t          bufferSize
+        ) const
+{
+    size_t bodySize = 1 + getContentLength();
+    if (bodySize > bufferSize)
+    {
+        return 0;
+    }
+
+    buffer[0] = (unsigned char)myBinaryID;
+    encodeContents(buffer + 1);
+
+    return bodySize;
+}
+
+size_t
+RedBotPacket::decode(
+        const unsigned char*    data,
+        size_t                  dataSize
+        )
+{
+    size_t contentSize = 0;
+    while(
+            (contentSize < dataSize) &&
+            (data[contentSize] != BINARY_BOUND)
+         )
+    {
+        ++contentSize;
+    }
+
+    bool isTerminated = (contentSize < dataSize);
+
+    decodeContents(data, contentSize, isTerminated);
+
+    return (isTerminated == true) ? (contentSize + 1) : contentSize;
+}
+
+size_t
+RedBotPacket::encodeNative(
+        unsigned char*  buffer,
+        size_t          bufferSize
+        ) const
+{
+    size_t bodySize = 1 + getNativeContentLength();
+    if (bodySize > bufferSize)
+    {
+        return 0;
+    }
+
+    buffer[0] = (unsigned char)myBinaryID;
+    encodeNativeContents(buffer + 1);
+
+    return bodySize;
+}
+
+void
+RedBotPacket::decodeNative(
+        const unsigned char*    data,
+        size_t                  dataSize
+        )
+{
+    decodeNativeContents(data, dataSize);
+}
+
+void
+RedBotPacket::encodeNativeContents(
+        unsigned char* buffer
+        ) const
+{
+    encodeContents(buffer);
+}
+
+void
+RedBotPacket::decodeNativeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize
+        )
+{
+    // Native contents are delimited by their frame
+    decodeContents(contents, contentSize, true);
+}
 
-    writeContents(outputStream);
+size_t
+RedBotPacket::getContentLength() const
+{
+    int contentLength = GetContentLength(myBinaryID);
 
-    outputStream << BINARY_BOUND;
+    return (contentLength < 0) ? 0 : contentLength;
 }
 
 void
@@ -50,18 +209,116 @@ RedBotPacket::writeXML(
         << "</packet>";
 }
 
+size_t
+RedBotPacket::getNativeContentLength() const
+{
+    int nativeLength = GetNativeContentLength(myBinaryID);
+
+    // Contents that are the same in both encodings have the same length
+    if (nativeLength == GetContentLength(myBinaryID))
+    {
+        return getContentLength();
+    }
+
+    return (nativeLength < 0) ? 0 : nativeLength;
+}
+
 RedBotPacket::Type
 RedBotPacket::getType() const
 {
     return myType;
 }
 
+RedBotPacket::BinaryID
+RedBotPacket::getBinaryID() const
+{
+    return myBinaryID;
+}
+
+int
+RedBotPacket::GetContentLength(
+        unsigned char binID
+        )
+{
+    switch (binID)
+    {
+        case BID_PING:          return 0; break;
+        case BID_DOUTPUT:       return 2; break;
+        case BID_DINPUT:        return 1; break;
+        case BID_AINPUT:        return 1; break;
+        case BID_PINCONFIG:     return 2; break;
+        case BID_MDRIVE:        return 4; break;
+        case BID_ENCINPUT:      return 1; break;
+        case BID_ENCCLEAR:      return 1; break;
+        case BID_SUBSCRIBE:     return 4; break;
+        case BID_VERSION:       return 1; break;
+        case BID_CHECKSUM:      return 1; break;
+        case BID_ACK:           return 0; break;
+        case BID_DVALUE:        return 2; break;
+        case BID_AVALUE:        return 3; break;
+        case BID_PINCONFIGINFO: return 2; break;
+        case BID_ENCCOUNT:      return 6; break;
+        case BID_VERSIONINFO:   return 1; break;
+        case BID_CHECKSUMINFO:  return 1; break;
+        case BID_NAK:           return 0; break;
+        default: return -1; break;
+    };
+
+    return -1;
+}
+
+int
+RedBotPacket::GetResponseContentLength(
+        unsigned char binID
+        )
+{
+    // Input requests that fail are acknowledged instead
+    switch (binID)
+    {
+        case BID_PING:          return GetContentLength(BID_ACK); break;
+        case BID_DOUTPUT:       return GetContentLength(BID_ACK); break;
+        case BID_DINPUT:        return GetContentLength(BID_DVALUE); break;
+        case BID_AINPUT:        return GetContentLength(BID_AVALUE); break;
+        case BID_PINCONFIG:     return GetContentLength(BID_PINCONFIGINFO); break;
+        case BID_MDRIVE:        return GetContentLength(BID_ACK); break;
+        case BID_ENCINPUT:      return GetContentLength(BID_ENCCOUNT); break;
+        case BID_ENCCLEAR:      return GetContentLength(BID_ACK); break;
+        case BID_SUBSCRIBE:     return GetContentLength(BID_ACK); break;
+        case BID_VERSION:       return GetContentLength(BID_VERSIONINFO); break;
+        case BID_CHECKSUM:      return GetContentLength(BID_CHECKSUMINFO); break;
+        default: break;
+    };
+
+    return (GetContentLength(binID) < 0) ? -1 : 0;
+}
+
+int
+RedBotPacket::GetNativeContentLength(
+        unsigned char binID
+        )
+{
+    switch (binID)
+    {
+        case BID_MDRIVE:        return 3; break;
+        case BID_ENCCOUNT:      return 5; break;
+        default: return GetContentLength(binID); break;
+    };
+
+    return -1;
+}
+
 bool
 RedBotPacket::isAcknowledge() const
 {
     return (getType() == TYPE_ACK);
 }
 
+bool
+RedBotPacket::isNegativeAcknowledge() const
+{
+    return (getType() == TYPE_NAK);
+}
+
 bool
 RedBotPacket::operator!=(
         const Packet&   packet
@@ -72,12 +329,15 @@ RedBotPacket::operator!=(
 
 RedBotPacket::operator std::string() const
 {
-    std::ostringstream stringStream;
-    write(stringStream);
-    return stringStream.str();
+    unsigned char packetData[MAX_BINARY_SIZE];
+
+    return std::string(
+            (const char*)packetData,
+            encode(packetData, MAX_BINARY_SIZE)
+            );
 }
 
-Packet*
+PacketHandle
 RedBotPacketGenerator::createPacket(
         unsigned char type
         )
@@ -85,28 +345,138 @@ RedBotPacketGenerator::createPacket(
     switch (type)
     {
         case RedBotPacket::BID_PING:          return createPingPacket(); break;
-        case RedBotPacket::BID_PINCONFIG:     return new PinConfigPacket(); break;
-        case RedBotPacket::BID_PINCONFIGINFO: return new PinConfigInfoPacket(); break;
-        case RedBotPacket::BID_DINPUT:        return new DigitalInputPacket(); break;
-        case RedBotPacket::BID_DOUTPUT:       return new DigitalOutputPacket(); break;
-        case RedBotPacket::BID_DVALUE:        return new DigitalValuePacket(); break;
-        case RedBotPacket::BID_AINPUT:        return new AnalogInputPacket(); break;
-        case RedBotPacket::BID_AVALUE:        return new AnalogValuePacket(); break;
-        case RedBotPacket::BID_MDRIVE:        return new MotorDrivePacket(); break;
-        case RedBotPacket::BID_ENCINPUT:      return new EncoderInputPacket(); break;
-        case RedBotPacket::BID_ENCCOUNT:      return new EncoderCountPacket(); break;
-        case RedBotPacket::BID_ENCCLEAR:      return new EncoderClearPacket(); break;
-        case RedBotPacket::BID_ACK:           return new AcknowledgePacket(); break;
-        default: return NULL; break;
+        case RedBotPacket::BID_PINCONFIG:     return PacketHandle(new PinConfigPacket()); break;
+        case RedBotPacket::BID_PINCONFIGINFO: return PacketHandle(new PinConfigInfoPacket()); break;
+        case RedBotPacket::BID_DINPUT:        return PacketHandle(new DigitalInputPacket()); break;
+        case RedBotPacket::BID_DOUTPUT:       return PacketHandle(new DigitalOutputPacket()); break;
+        case RedBotPacket::BID_DVALUE:        return PacketHandle(new DigitalValuePacket()); break;
+        case RedBotPacket::BID_AINPUT:        return PacketHandle(new AnalogInputPacket()); break;
+        case RedBotPacket::BID_AVALUE:        return PacketHandle(new AnalogValuePacket()); break;
+        case RedBotPacket::BID_MDRIVE:        return PacketHandle(new MotorDrivePacket()); break;
+        case RedBotPacket::BID_ENCINPUT:      return PacketHandle(new EncoderInputPacket()); break;
+        case RedBotPacket::BID_ENCCOUNT:      return PacketHandle(new EncoderCountPacket()); break;
+        case RedBotPacket::BID_ENCCLEAR:      return PacketHandle(new EncoderClearPacket()); break;
+        case RedBotPacket::BID_ACK:           return PacketHandle(new AcknowledgePacket()); break;
+        case RedBotPacket::BID_FRAME:         return PacketHandle(new FramePacket(this)); break;
+        case RedBotPacket::BID_FRAMEVALUES:   return PacketHandle(new FrameValuesPacket(this)); break;
+        case RedBotPacket::BID_SUBSCRIBE:     return PacketHandle(new SubscribePacket()); break;
+        case RedBotPacket::BID_VERSION:       return PacketHandle(new VersionPacket()); break;
+        case RedBotPacket::BID_VERSIONINFO:   return PacketHandle(new VersionInfoPacket()); break;
+        case RedBotPacket::BID_CHECKSUM:      return PacketHandle(new ChecksumPacket()); break;
+        case RedBotPacket::BID_CHECKSUMINFO:  return PacketHandle(new ChecksumInfoPacket()); break;
+        case RedBotPacket::BID_NAK:           return PacketHandle(new NegativeAcknowledgePacket()); break;
+        default: return PacketHandle(); break;
     };
 
-    return NULL;
+    return PacketHandle();
 }
 
-Packet*
+PacketHandle
 RedBotPacketGenerator::createPingPacket()
 {
-    return new PingPacket();
+    return PacketHandle(new PingPacket());
+}
+
+PacketHandle
+RedBotPacketGenerator::createFramePacket(
+        PacketQueue& packets
+        )
+{
+    FramePacket* framePacket = new FramePacket(this);
+    PacketHandle frameHandle(framePacket);
+
+    while (packets.empty() == false)
+    {
+        RedBotPacket* packet = dynamic_cast<RedBotPacket*>(packets.front().get());
+        if(
+                (packet == NULL) ||
+                (framePacket->add(packet) == false)
+          )
+        {
+            break;
+        }
+
+        // The frame owns the packet now
+        packets.pop().release();
+    }
+
+    // Leading packet cannot be carried in a frame
+    if(
+            (framePacket->getPacketCount() == 0) &&
+            (packets.empty() == false)
+      )
+    {
+        return PacketHandle();
+    }
+
+    return frameHandle;
+}
+
+bool
+RedBotPacketGenerator::unpackFramePacket(
+        Packet&         packet,
+        PacketQueue&    packets
+        )
+{
+    FramePacket* framePacket = dynamic_cast<FramePacket*>(&packet);
+    if (framePacket == NULL)
+    {
+        return false;
+    }
+
+    framePacket->releasePackets(packets);
+
+    return true;
+}
+
+PacketHandle
+RedBotPacketGenerator::createVersionPacket(
+        unsigned int version
+        )
+{
+    return PacketHandle(new VersionPacket(version));
+}
+
+bool
+RedBotPacketGenerator::getSelectedVersion(
+        const Packet&   packet,
+        unsigned int&   version
+        )
+{
+    const VersionInfoPacket* infoPacket = dynamic_cast<const VersionInfoPacket*>(&packet);
+    if (infoPacket == NULL)
+    {
+        return false;
+    }
+
+    version = infoPacket->getVersion();
+
+    return true;
+}
+
+PacketHandle
+RedBotPacketGenerator::createChecksumPacket(
+        Crc::Type checksum
+        )
+{
+    return PacketHandle(new ChecksumPacket(checksum));
+}
+
+bool
+RedBotPacketGenerator::getSelectedChecksum(
+        const Packet&   packet,
+        Crc::Type&      checksum
+        )
+{
+    const ChecksumInfoPacket* infoPacket = dynamic_cast<const ChecksumInfoPacket*>(&packet);
+    if (infoPacket == NULL)
+    {
+        return false;
+    }
+
+    checksum = infoPacket->getChecksum();
+
+    return true;
 }
 
 
@@ -117,8 +487,8 @@ PingPacket::PingPacket() :
 }
 
 void
-PingPacket::writeContents(
-        std::ostream& outputStream
+PingPacket::encodeContents(
+        unsigned char* buffer
         ) const
 {
 }
@@ -131,21 +501,16 @@ PingPacket::getXMLElements(
 }
 
 void
-PingPacket::read(
-        std::istream& inputStream
+PingPacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
         )
 {
-    unsigned char trailer;
-
-    inputStream >> trailer;
-    if (trailer == 0xFF)
-    {
-        myIsValid = true;
-    }
-    else
-    {
-        myIsValid = false;
-    }
+    myIsValid = (
+            (contentSize == 0) &&
+            (isTerminated == true)
+            );
 }
 
 bool
@@ -177,8 +542,8 @@ AcknowledgePacket::AcknowledgePacket() :
 }
 
 void
-AcknowledgePacket::writeContents(
-        std::ostream& outputStream
+AcknowledgePacket::encodeContents(
+        unsigned char* buffer
         ) const
 {
 }
@@ -191,21 +556,16 @@ AcknowledgePacket::getXMLElements(
 }
 
 void
-AcknowledgePacket::read(
-        std::istream& inputStream
+AcknowledgePacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
         )
 {
-    unsigned char trailer;
-
-    inputStream >> trailer;
-    if (trailer == 0xFF)
-    {
-        myIsValid = true;
-    }
-    else
-    {
-        myIsValid = false;
-    }
+    myIsValid = (
+            (contentSize == 0) &&
+            (isTerminated == true)
+            );
 }
 
 bool
@@ -229,3 +589,970 @@ AcknowledgePacket::operator==(
     }
 }
 
+
+
+// A full frame fits in the packet buffer with the largest checksum, both
+// between boundary bytes and as a COBS frame with its code byte and delimiter
+static_assert(
+        (2 + 1 + FramePacket::MAX_CONTENT_LENGTH + Crc::MAX_SIZE) <= Packet::MAX_BINARY_SIZE,
+        "Bounded frames must fit in the packet buffer"
+        );
+static_assert(
+        (1 + 1 + FramePacket::MAX_CONTENT_LENGTH + Crc::MAX_SIZE + 1) <= Packet::MAX_BINARY_SIZE,
+        "COBS frames must fit in the packet buffer"
+        );
+
+FramePacket::FramePacket(
+        PacketGenerator* packetGen
+        ) :
+    RedBotPacket(TYPE_FRAME, "FRAME", BID_FRAME),
+    myPacketCount(0),
+    myContentLength(0),
+    myResponseLength(0),
+    myPacketGenerator(packetGen),
+    myIsValid(true),
+    myInvalidContentLength(0)
+{
+}
+
+FramePacket::FramePacket(
+        Type                type,
+        const char*         typeName,
+        BinaryID            binID,
+        PacketGenerator*    packetGen
+        ) :
+    RedBotPacket(type, typeName, binID),
+    myPacketCount(0),
+    myContentLength(0),
+    myResponseLength(0),
+    myPacketGenerator(packetGen),
+    myIsValid(true),
+    myInvalidContentLength(0)
+{
+}
+
+FramePacket::~FramePacket()
+{
+    clearPackets();
+}
+
+bool
+FramePacket::add(
+        RedBotPacket* packet
+        )
+{
+    int contentLength = GetContentLength(packet->getBinaryID());
+    int responseLength = GetResponseContentLength(packet->getBinaryID());
+    if(
+            (contentLength < 0) ||
+            (responseLength < 0)
+      )
+    {
+        return false;
+    }
+
+    if(
+            ((myContentLength + 1 + contentLength) > MAX_CONTENT_LENGTH) ||
+            ((myResponseLength + 1 + responseLength) > MAX_CONTENT_LENGTH)
+      )
+    {
+        return false;
+    }
+
+    myPackets[myPacketCount++] = packet;
+    myContentLength += 1 + contentLength;
+    myResponseLength += 1 + responseLength;
+
+    return true;
+}
+
+size_t
+FramePacket::getPacketCount() const
+{
+    return myPacketCount;
+}
+
+const RedBotPacket*
+FramePacket::getPacket(
+        size_t packetIdx
+        ) const
+{
+    if (packetIdx >= myPacketCount)
+    {
+        return NULL;
+    }
+
+    return myPackets[packetIdx];
+}
+
+void
+FramePacket::releasePackets(
+        PacketQueue& packets
+        )
+{
+    for(
+            size_t packetIdx = 0;
+            packetIdx < myPacketCount;
+            ++packetIdx
+       )
+    {
+        packets.push(PacketHandle(myPackets[packetIdx]));
+    }
+
+    myPacketCount = 0;
+    myContentLength = 0;
+    myResponseLength = 0;
+}
+
+size_t
+FramePacket::getContentLength() const
+{
+    if (myIsValid == false)
+    {
+        return myInvalidContentLength;
+    }
+
+    return myContentLength;
+}
+
+void
+FramePacket::encodeContents(
+        unsigned char* buffer
+        ) const
+{
+    if (myIsValid == false)
+    {
+        memcpy(buffer, myInvalidContents, myInvalidContentLength);
+        return;
+    }
+
+    size_t contentIdx = 0;
+    for(
+            size_t packetIdx = 0;
+            packetIdx < myPacketCount;
+            ++packetIdx
+       )
+    {
+        contentIdx += myPackets[packetIdx]->encodeBody(
+                buffer + contentIdx,
+                myContentLength - contentIdx
+                );
+    }
+}
+
+void
+FramePacket::getXMLElements(
+        XMLElements& elements
+        ) const
+{
+    std::ostringstream packetsStream;
+
+    for(
+            size_t packetIdx = 0;
+            packetIdx < myPacketCount;
+            ++packetIdx
+       )
+    {
+        myPackets[packetIdx]->writeXML(packetsStream);
+    }
+
+    elements.add(
+            new XMLDataElement<std::string>(
+                "packets",
+                packetsStream.str()
+                )
+            );
+}
+
+void
+FramePacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
+        )
+{
+    keepInvalidContents(contents, contentSize);
+
+    if(
+            (isTerminated == false) ||
+            (myPacketGenerator == NULL)
+      )
+    {
+        return;
+    }
+
+    // Split contents into embedded packets according to their type lengths
+    size_t contentIdx = 0;
+    while (contentIdx < contentSize)
+    {
+        unsigned char binID = contents[contentIdx];
+        int contentLength = GetContentLength(binID);
+        if(
+                (contentLength < 0) ||
+                ((contentIdx + 1 + contentLength) > contentSize) ||
+                (myPacketCount >= MAX_CONTENT_LENGTH)
+          )
+        {
+            clearPackets();
+            return;
+        }
+
+        PacketHandle packet = myPacketGenerator->createPacket(binID);
+        RedBotPacket* redBotPacket = dynamic_cast<RedBotPacket*>(packet.get());
+        if (redBotPacket == NULL)
+        {
+            clearPackets();
+            return;
+        }
+
+        // Embedded packets carry no trailer of their own
+        unsigned char packetData[MAX_BINARY_SIZE];
+        memcpy(packetData, contents + contentIdx + 1, contentLength);
+        packetData[contentLength] = BINARY_BOUND;
+
+        redBotPacket->decode(packetData, contentLength + 1);
+        if (redBotPacket->isValid() == false)
+        {
+            clearPackets();
+            return;
+        }
+
+        // The frame owns the packet now
+        packet.release();
+        myPackets[myPacketCount++] = redBotPacket;
+        myContentLength += 1 + contentLength;
+        contentIdx += 1 + contentLength;
+    }
+
+    myInvalidContentLength = 0;
+    myIsValid = true;
+}
+
+size_t
+FramePacket::getNativeContentLength() const
+{
+    if (myIsValid == false)
+    {
+        return myInvalidContentLength;
+    }
+
+    size_t contentLength = 0;
+    for(
+            size_t packetIdx = 0;
+            packetIdx < myPacketCount;
+            ++packetIdx
+       )
+    {
+        contentLength += 1 + myPackets[packetIdx]->getNativeContentLength();
+    }
+
+    return contentLength;
+}
+
+void
+FramePacket::encodeNativeContents(
+        unsigned char* buffer
+        ) const
+{
+    if (myIsValid == false)
+    {
+        memcpy(buffer, myInvalidContents, myInvalidContentLength);
+        return;
+    }
+
+    size_t contentIdx = 0;
+    for(
+            size_t packetIdx = 0;
+            packetIdx < myPacketCount;
+            ++packetIdx
+       )
+    {
+        contentIdx += myPackets[packetIdx]->encodeNative(
+                buffer + contentIdx,
+                MAX_BINARY_SIZE - contentIdx
+                );
+    }
+}
+
+void
+FramePacket::decodeNativeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize
+        )
+{
+    keepInvalidContents(contents, contentSize);
+
+    if (myPacketGenerator == NULL)
+    {
+        return;
+    }
+
+    // Split contents into embedded packets according to their native lengths
+    size_t contentIdx = 0;
+    while (contentIdx < contentSize)
+    {
+        unsigned char binID = contents[contentIdx];
+        int contentLength = GetNativeContentLength(binID);
+        if(
+                (contentLength < 0) ||
+                ((contentIdx + 1 + contentLength) > contentSize) ||
+                (myPacketCount >= MAX_CONTENT_LENGTH)
+          )
+        {
+            clearPackets();
+            return;
+        }
+
+        PacketHandle packet = myPacketGenerator->createPacket(binID);
+        RedBotPacket* redBotPacket = dynamic_cast<RedBotPacket*>(packet.get());
+        if (redBotPacket == NULL)
+        {
+            clearPackets();
+            return;
+        }
+
+        redBotPacket->decodeNative(contents + contentIdx + 1, contentLength);
+        if (redBotPacket->isValid() == false)
+        {
+            clearPackets();
+            return;
+        }
+
+        // The frame owns the packet now
+        packet.release();
+        myPackets[myPacketCount++] = redBotPacket;
+        myContentLength += 1 + redBotPacket->getContentLength();
+        contentIdx += 1 + contentLength;
+    }
+
+    myInvalidContentLength = 0;
+    myIsValid = true;
+}
+
+void
+FramePacket::keepInvalidContents(
+        const unsigned char*    contents,
+        size_t                  contentSize
+        )
+{
+    clearPackets();
+    myIsValid = false;
+
+    // Contents are kept until they are known to be valid
+    myInvalidContentLength = (contentSize < MAX_BINARY_SIZE) ? contentSize : MAX_BINARY_SIZE;
+    memcpy(myInvalidContents, contents, myInvalidContentLength);
+}
+
+bool
+FramePacket::isValid() const
+{
+    return myIsValid;
+}
+
+bool
+FramePacket::operator==(
+        const Packet& packet
+        ) const
+{
+    const FramePacket* framePacket = dynamic_cast<const FramePacket*>(&packet);
+    if (framePacket == NULL)
+    {
+        return false;
+    }
+
+    if(
+            (framePacket->getBinaryID() != getBinaryID()) ||
+            (framePacket->getPacketCount() != myPacketCount)
+      )
+    {
+        return false;
+    }
+
+    for(
+            size_t packetIdx = 0;
+            packetIdx < myPacketCount;
+            ++packetIdx
+       )
+    {
+        if (*(myPackets[packetIdx]) != *(framePacket->getPacket(packetIdx)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+FramePacket::clearPackets()
+{
+    for(
+            size_t packetIdx = 0;
+            packetIdx < myPacketCount;
+            ++packetIdx
+       )
+    {
+        delete myPackets[packetIdx];
+    }
+
+    myPacketCount = 0;
+    myContentLength = 0;
+    myResponseLength = 0;
+}
+
+
+FrameValuesPacket::FrameValuesPacket(
+        PacketGenerator* packetGen
+        ) :
+    FramePacket(TYPE_FRAMEVALUES, "FRAMEVALUES", BID_FRAMEVALUES, packetGen)
+{
+}
+
+
+SubscribePacket::SubscribePacket() :
+    RedBotPacket(TYPE_SUBSCRIBE, "SUBSCRIBE", BID_SUBSCRIBE),
+    myRequestID(0),
+    myRequestAddress(0),
+    myPeriod(0),
+    myIsValid(false)
+{
+}
+
+SubscribePacket::SubscribePacket(
+        const RedBotPacket& request,
+        unsigned int        period
+        ) :
+    RedBotPacket(TYPE_SUBSCRIBE, "SUBSCRIBE", BID_SUBSCRIBE),
+    myRequestID(0),
+    myRequestAddress(0),
+    myPeriod((period > MAX_PERIOD) ? MAX_PERIOD : period),
+    myIsValid(false)
+{
+    unsigned char requestData[3];
+
+    // The request is carried as its binary ID and single content byte
+    if (request.encodeBody(requestData, sizeof(requestData)) == 2)
+    {
+        myRequestID = requestData[0];
+        myRequestAddress = requestData[1];
+        myIsValid = true;
+    }
+}
+
+void
+SubscribePacket::encodeContents(
+        unsigned char* buffer
+        ) const
+{
+    buffer[0] = myRequestID;
+    buffer[1] = myRequestAddress;
+
+    // Split period into 7-bit chunks offset to avoid the boundary byte
+    buffer[2] = (unsigned char)(((myPeriod >> 7) & 0x7F) + 1);
+    buffer[3] = (unsigned char)((myPeriod & 0x7F) + 1);
+}
+
+void
+SubscribePacket::encodeNativeContents(
+        unsigned char* buffer
+        ) const
+{
+    buffer[0] = myRequestID;
+    buffer[1] = myRequestAddress;
+    buffer[2] = (unsigned char)(myPeriod >> 8);
+    buffer[3] = (unsigned char)(myPeriod & 0xFF);
+}
+
+void
+SubscribePacket::decodeNativeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize
+        )
+{
+    myIsValid = (contentSize == 4);
+    if (myIsValid == false)
+    {
+        return;
+    }
+
+    myRequestID = contents[0];
+    myRequestAddress = contents[1];
+    myPeriod = (contents[2] << 8) | contents[3];
+}
+
+void
+SubscribePacket::getXMLElements(
+        XMLElements& elements
+        ) const
+{
+    elements.add(
+            new XMLDataElement<unsigned int>(
+                "request",
+                myRequestID
+                )
+            );
+    elements.add(
+            new XMLDataElement<unsigned int>(
+                "address",
+                myRequestAddress
+                )
+            );
+    elements.add(
+            new XMLDataElement<unsigned int>(
+                "period",
+                myPeriod
+                )
+            );
+}
+
+void
+SubscribePacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
+        )
+{
+    myIsValid = (
+            (contentSize == 4) &&
+            (isTerminated == true) &&
+            (contents[2] >= 1) &&
+            (contents[3] >= 1)
+            );
+    if (myIsValid == false)
+    {
+        return;
+    }
+
+    myRequestID = contents[0];
+    myRequestAddress = contents[1];
+    myPeriod = (((contents[2] - 1) & 0x7F) << 7) | ((contents[3] - 1) & 0x7F);
+}
+
+bool
+SubscribePacket::isValid() const
+{
+    return myIsValid;
+}
+
+bool
+SubscribePacket::operator==(
+        const Packet& packet
+        ) const
+{
+    const SubscribePacket* subscribePacket = dynamic_cast<const SubscribePacket*>(&packet);
+    if (subscribePacket == NULL)
+    {
+        return false;
+    }
+
+    return(
+            (myRequestID == subscribePacket->myRequestID) &&
+            (myRequestAddress == subscribePacket->myRequestAddress) &&
+            (myPeriod == subscribePacket->myPeriod)
+          );
+}
+
+unsigned char
+SubscribePacket::getRequestID() const
+{
+    return myRequestID;
+}
+
+unsigned char
+SubscribePacket::getRequestAddress() const
+{
+    return myRequestAddress;
+}
+
+unsigned int
+SubscribePacket::getPeriod() const
+{
+    return myPeriod;
+}
+
+
+VersionPacket::VersionPacket() :
+    RedBotPacket(TYPE_VERSION, "VERSION", BID_VERSION),
+    myVersion(0),
+    myIsValid(false)
+{
+}
+
+VersionPacket::VersionPacket(
+        unsigned int version
+        ) :
+    RedBotPacket(TYPE_VERSION, "VERSION", BID_VERSION),
+    myVersion((unsigned char)version),
+    myIsValid(
+            (version > 0) &&
+            (version < BINARY_BOUND)
+            )
+{
+}
+
+void
+VersionPacket::encodeContents(
+        unsigned char* buffer
+        ) const
+{
+    buffer[0] = myVersion;
+}
+
+void
+VersionPacket::getXMLElements(
+        XMLElements& elements
+        ) const
+{
+    elements.add(
+            new XMLDataElement<unsigned int>(
+                "version",
+                myVersion
+                )
+            );
+}
+
+void
+VersionPacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
+        )
+{
+    myIsValid = (
+            (contentSize == 1) &&
+            (isTerminated == true) &&
+            (contents[0] > 0)
+            );
+    if (myIsValid == false)
+    {
+        return;
+    }
+
+    myVersion = contents[0];
+}
+
+bool
+VersionPacket::isValid() const
+{
+    return myIsValid;
+}
+
+bool
+VersionPacket::operator==(
+        const Packet& packet
+        ) const
+{
+    const VersionPacket* versionPacket = dynamic_cast<const VersionPacket*>(&packet);
+    if (versionPacket == NULL)
+    {
+        return false;
+    }
+
+    return (myVersion == versionPacket->myVersion);
+}
+
+unsigned int
+VersionPacket::getVersion() const
+{
+    return myVersion;
+}
+
+VersionInfoPacket::VersionInfoPacket() :
+    RedBotPacket(TYPE_VERSIONINFO, "VERSIONINFO", BID_VERSIONINFO),
+    myVersion(0),
+    myIsValid(false)
+{
+}
+
+VersionInfoPacket::VersionInfoPacket(
+        unsigned int version
+        ) :
+    RedBotPacket(TYPE_VERSIONINFO, "VERSIONINFO", BID_VERSIONINFO),
+    myVersion((unsigned char)version),
+    myIsValid(
+            (version > 0) &&
+            (version < BINARY_BOUND)
+            )
+{
+}
+
+void
+VersionInfoPacket::encodeContents(
+        unsigned char* buffer
+        ) const
+{
+    buffer[0] = myVersion;
+}
+
+void
+VersionInfoPacket::getXMLElements(
+        XMLElements& elements
+        ) const
+{
+    elements.add(
+            new XMLDataElement<unsigned int>(
+                "version",
+                myVersion
+                )
+            );
+}
+
+void
+VersionInfoPacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
+        )
+{
+    myIsValid = (
+            (contentSize == 1) &&
+            (isTerminated == true) &&
+            (contents[0] > 0)
+            );
+    if (myIsValid == false)
+    {
+        return;
+    }
+
+    myVersion = contents[0];
+}
+
+bool
+VersionInfoPacket::isValid() const
+{
+    return myIsValid;
+}
+
+bool
+VersionInfoPacket::operator==(
+        const Packet& packet
+        ) const
+{
+    const VersionInfoPacket* versionPacket = dynamic_cast<const VersionInfoPacket*>(&packet);
+    if (versionPacket == NULL)
+    {
+        return false;
+    }
+
+    return (myVersion == versionPacket->myVersion);
+}
+
+unsigned int
+VersionInfoPacket::getVersion() const
+{
+    return myVersion;
+}
+
+
+NegativeAcknowledgePacket::NegativeAcknowledgePacket() :
+    RedBotPacket(TYPE_NAK, "NAK", BID_NAK),
+    myIsValid(true)
+{
+}
+
+void
+NegativeAcknowledgePacket::encodeContents(
+        unsigned char* buffer
+        ) const
+{
+}
+
+void
+NegativeAcknowledgePacket::getXMLElements(
+        XMLElements& elements
+        ) const
+{
+}
+
+void
+NegativeAcknowledgePacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
+        )
+{
+    myIsValid = (
+            (contentSize == 0) &&
+            (isTerminated == true)
+            );
+}
+
+bool
+NegativeAcknowledgePacket::isValid() const
+{
+    return myIsValid;
+}
+
+bool
+NegativeAcknowledgePacket::operator==(
+        const Packet& packet
+        ) const
+{
+    return packet.isNegativeAcknowledge();
+}
+
+ChecksumPacket::ChecksumPacket() :
+    RedBotPacket(TYPE_CHECKSUM, "CHECKSUM", BID_CHECKSUM),
+    myChecksum(Crc::TYPE_NONE),
+    myIsValid(false)
+{
+}
+
+ChecksumPacket::ChecksumPacket(
+        Crc::Type checksum
+        ) :
+    RedBotPacket(TYPE_CHECKSUM, "CHECKSUM", BID_CHECKSUM),
+    myChecksum(checksum),
+    myIsValid(checksum <= Crc::TYPE_CRC16)
+{
+}
+
+void
+ChecksumPacket::encodeContents(
+        unsigned char* buffer
+        ) const
+{
+    buffer[0] = (unsigned char)myChecksum;
+}
+
+void
+ChecksumPacket::getXMLElements(
+        XMLElements& elements
+        ) const
+{
+    elements.add(
+            new XMLDataElement<unsigned int>(
+                "checksum",
+                myChecksum
+                )
+            );
+}
+
+void
+ChecksumPacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
+        )
+{
+    myIsValid = (
+            (contentSize == 1) &&
+            (isTerminated == true) &&
+            (contents[0] <= Crc::TYPE_CRC16)
+            );
+    if (myIsValid == false)
+    {
+        return;
+    }
+
+    myChecksum = (Crc::Type)contents[0];
+}
+
+bool
+ChecksumPacket::isValid() const
+{
+    return myIsValid;
+}
+
+bool
+ChecksumPacket::operator==(
+        const Packet& packet
+        ) const
+{
+    const ChecksumPacket* checksumPacket = dynamic_cast<const ChecksumPacket*>(&packet);
+    if (checksumPacket == NULL)
+    {
+        return false;
+    }
+
+    return (myChecksum == checksumPacket->myChecksum);
+}
+
+Crc::Type
+ChecksumPacket::getChecksum() const
+{
+    return myChecksum;
+}
+
+ChecksumInfoPacket::ChecksumInfoPacket() :
+    RedBotPacket(TYPE_CHECKSUMINFO, "CHECKSUMINFO", BID_CHECKSUMINFO),
+    myChecksum(Crc::TYPE_NONE),
+    myIsValid(false)
+{
+}
+
+ChecksumInfoPacket::ChecksumInfoPacket(
+        Crc::Type checksum
+        ) :
+    RedBotPacket(TYPE_CHECKSUMINFO, "CHECKSUMINFO", BID_CHECKSUMINFO),
+    myChecksum(checksum),
+    myIsValid(checksum <= Crc::TYPE_CRC16)
+{
+}
+
+void
+ChecksumInfoPacket::encodeContents(
+        unsigned char* buffer
+        ) const
+{
+    buffer[0] = (unsigned char)myChecksum;
+}
+
+void
+ChecksumInfoPacket::getXMLElements(
+        XMLElements& elements
+        ) const
+{
+    elements.add(
+            new XMLDataElement<unsigned int>(
+                "checksum",
+                myChecksum
+                )
+            );
+}
+
+void
+ChecksumInfoPacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
+        )
+{
+    myIsValid = (
+            (contentSize == 1) &&
+            (isTerminated == true) &&
+            (contents[0] <= Crc::TYPE_CRC16)
+            );
+    if (myIsValid == false)
+    {
+        return;
+    }
+
+    myChecksum = (Crc::Type)contents[0];
+}
+
+bool
+ChecksumInfoPacket::isValid() const
+{
+    return myIsValid;
+}
+
+bool
+ChecksumInfoPacket::operator==(
+        const Packet& packet
+        ) const
+{
+    const ChecksumInfoPacket* checksumPacket = dynamic_cast<const ChecksumInfoPacket*>(&packet);
+    if (checksumPacket == NULL)
+    {
+        return false;
+    }
+
+    return (myChecksum == checksumPacket->myChecksum);
+}
+
+Crc::Type
+ChecksumInfoPacket::getChecksum() const
+{
+    return myChecksum;
+}
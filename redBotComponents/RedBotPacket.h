@@ -27,13 +27,21 @@ class RedBotPacket : public Packet
             TYPE_MDRIVE,    /**< Motor drive packet */
             TYPE_ENCINPUT,  /**< Encoder input packet */
             TYPE_ENCCLEAR,  /**< Encoder clear packet */
+            TYPE_FRAME,     /**< Batched request frame packet */
+            TYPE_SUBSCRIBE, /**< Sample subscription packet */
+            TYPE_VERSION,   /**< Protocol version request packet */
+            TYPE_CHECKSUM,  /**< Checksum type request packet */
 
             // Response packets
             TYPE_ACK,           /**< Acknowledgement packet */
             TYPE_DVALUE,        /**< Digital value response packet */
             TYPE_AVALUE,        /**< Analog value response packet */
             TYPE_PINCONFIGINFO, /**< Pin configuration info response packet */
-            TYPE_ENCCOUNT       /**< Encoder count packet */
+            TYPE_ENCCOUNT,      /**< Encoder count packet */
+            TYPE_FRAMEVALUES,   /**< Batched response frame packet */
+            TYPE_VERSIONINFO,   /**< Selected protocol version response packet */
+            TYPE_CHECKSUMINFO,  /**< Selected checksum type response packet */
+            TYPE_NAK            /**< Corrupted request response packet */
         };
 
         /**
@@ -52,13 +60,21 @@ class RedBotPacket : public Packet
             BID_MDRIVE =    0x06,
             BID_ENCINPUT =  0x07,
             BID_ENCCLEAR =  0x08,
+            BID_FRAME =     0x09,
+            BID_SUBSCRIBE = 0x0A,
+            BID_VERSION =   0x0B,
+            BID_CHECKSUM =  0x0C,
 
             // Response packets
             BID_ACK =           0x82,
             BID_DVALUE =        0x81,
             BID_AVALUE =        0x83,
             BID_PINCONFIGINFO = 0x84,
-            BID_ENCCOUNT =      0x85
+            BID_ENCCOUNT =      0x85,
+            BID_FRAMEVALUES =   0x86,
+            BID_VERSIONINFO =   0x87,
+            BID_CHECKSUMINFO =  0x88,
+            BID_NAK =           0x89
         };
 
         /**
@@ -87,13 +103,105 @@ class RedBotPacket : public Packet
         /**
          * Writes serialized binary data to output stream
          *
-         * This writes the boundary and type bytes before deferring to the
-         * subclass's writing method.
+         * This is a stream adapter for encode().
          */
         void write(
                 std::ostream& outputStream
                 ) const;
 
+        /**
+         * Writes the binary ID and contents to output stream
+         *
+         * This is a stream adapter for encodeBody().
+         */
+        void writeBody(
+                std::ostream& outputStream
+                ) const;
+
+        /**
+         * Reads serialized binary data from input stream
+         *
+         * Bytes are taken from the stream up to and including the trailing
+         * boundary byte and handed to decode().
+         */
+        void read(
+                std::istream& inputStream
+                );
+
+        /**
+         * Encodes serialized binary data into the given buffer
+         *
+         * This writes the boundary and type bytes before deferring to the
+         * subclass's encoding method.
+         *
+         * \return Number of bytes written, or 0 if the buffer is too small
+         */
+        size_t encode(
+                unsigned char*  buffer,
+                size_t          bufferSize
+                ) const;
+
+        /**
+         * Encodes the binary ID and contents into the given buffer
+         *
+         * This omits the boundary bytes so that the packet can be embedded in
+         * a frame packet.
+         *
+         * \return Number of bytes written, or 0 if the buffer is too small
+         */
+        size_t encodeBody(
+                unsigned char*  buffer,
+                size_t          bufferSize
+                ) const;
+
+        /**
+         * Decodes serialized binary data following the packet type byte
+         *
+         * The contents up to the trailing boundary byte are handed to the
+         * subclass's decoding method.
+         *
+         * \return Number of bytes consumed
+         */
+        size_t decode(
+                const unsigned char*    data,
+                size_t                  dataSize
+                );
+
+        /**
+         * Encodes the binary ID and native contents into the given buffer
+         *
+         * This defers to the subclass's native encoding method.
+         *
+         * \return Number of bytes written, or 0 if the buffer is too small
+         */
+        size_t encodeNative(
+                unsigned char*  buffer,
+                size_t          bufferSize
+                ) const;
+
+        /**
+         * Decodes native contents following the binary ID
+         */
+        void decodeNative(
+                const unsigned char*    data,
+                size_t                  dataSize
+                );
+
+        /**
+         * Provides the number of content bytes this packet encodes to
+         *
+         * Contents exclude the boundary and binary ID bytes.
+         */
+        virtual size_t getContentLength() const;
+
+        /**
+         * Provides the number of content bytes of this packet's native
+         * encoding
+         *
+         * Contents exclude the binary ID byte.
+         */
+        virtual size_t getNativeContentLength() const;
+
         /**
          * Generates an XML representation of this packet
          */
@@ -106,11 +214,60 @@ class RedBotPacket : public Packet
          */
         Type getType() const;
 
+        /**
+         * Provides the binary ID of this packet
+         */
+        BinaryID getBinaryID() const;
+
+        /**
+         * Provides the number of content bytes for the given packet type
+         *
+         * Contents exclude the boundary and binary ID bytes.
+         *
+         * \return Number of content bytes, or -1 if the type is unknown or
+         * its packets have no fixed size
+         */
+        static int GetContentLength(
+                unsigned char binID
+                );
+
+        /**
+         * Provides the number of native content bytes for the given packet
+         * type
+         *
+         * Native contents use full 8-bit fields, so values that are split or
+         * offset to keep clear of the boundary byte take fewer bytes.
+         *
+         * \return Number of content bytes, or -1 if the type is unknown or
+         * its packets have no fixed size
+         */
+        static int GetNativeContentLength(
+                unsigned char binID
+                );
+
+        /**
+         * Provides the largest number of content bytes of a response to the
+         * given packet type
+         *
+         * Responses themselves are not answered, so they take none.
+         *
+         * \return Number of content bytes, or -1 if the type is unknown or
+         * its packets have no fixed size
+         */
+        static int GetResponseContentLength(
+                unsigned char binID
+                );
+
         /**
          * Indicates if this packet is an acknowledgement packet
          */
         bool isAcknowledge() const;
 
+        /**
+         * Indicates if this packet is a negative acknowledgement packet
+         */
+        bool isNegativeAcknowledge() const;
+
         /**
          * Inequality operator
          */
@@ -126,14 +283,46 @@ class RedBotPacket : public Packet
     protected:
 
         /**
-         * Writes the binary contents to the output stream
+         * Encodes the binary contents into the given buffer
          *
-         * This does not write the boundary or type bytes.
+         * Exactly getContentLength() bytes are written. This does not write
+         * the boundary or type bytes.
          */
-        virtual void writeContents(
-                std::ostream& outputStream
+        virtual void encodeContents(
+                unsigned char* buffer
                 ) const = 0;
 
+        /**
+         * Decodes the binary contents from the given bytes
+         *
+         * The contents exclude the type and boundary bytes.
+         */
+        virtual void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated    /**< Indicates if the trailing boundary byte was found */
+                ) = 0;
+
+        /**
+         * Encodes the native contents into the given buffer
+         *
+         * Exactly getNativeContentLength() bytes are written. By default the
+         * contents are the same as in the bounded encoding.
+         */
+        virtual void encodeNativeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes the native contents from the given bytes
+         *
+         * By default the contents are decoded as in the bounded encoding.
+         */
+        virtual void decodeNativeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize
+                );
+
         /**
          * Provides a list of elements to include in the XML representation
          */
@@ -151,7 +340,7 @@ class RedBotPacket : public Packet
         /**
          * String representation of the type of this packet
          */
-        const std::string myTypeName;
+        const char* const myTypeName;
 
         /**
          * The binary ID for this packet
@@ -172,14 +361,62 @@ class RedBotPacketGenerator : public PacketGenerator
         /**
          * Creates a new blank packet given a packet type byte
          */
-        Packet* createPacket(
+        PacketHandle createPacket(
                 unsigned char type
                 );
 
         /**
          * Creates a ping packet
          */
-        Packet* createPingPacket();
+        PacketHandle createPingPacket();
+
+        /**
+         * Moves packets from the front of the queue into a new frame packet
+         *
+         * Packets are added until the frame is full or the queue is empty.
+         * An empty handle is returned if the leading packet cannot be framed.
+         */
+        PacketHandle createFramePacket(
+                PacketQueue& packets
+                );
+
+        /**
+         * Moves the packets contained in a response frame into the queue
+         */
+        bool unpackFramePacket(
+                Packet&         packet,
+                PacketQueue&    packets
+                );
+
+        /**
+         * Creates a packet that asks for the given protocol version
+         */
+        PacketHandle createVersionPacket(
+                unsigned int version
+                );
+
+        /**
+         * Extracts the protocol version selected in a version info packet
+         */
+        bool getSelectedVersion(
+                const Packet&   packet,
+                unsigned int&   version
+                );
+
+        /**
+         * Creates a packet that asks for the given checksum type
+         */
+        PacketHandle createChecksumPacket(
+                Crc::Type checksum
+                );
+
+        /**
+         * Extracts the checksum type selected in a checksum info packet
+         */
+        bool getSelectedChecksum(
+                const Packet&   packet,
+                Crc::Type&      checksum
+                );
 };
 
 /**
@@ -194,13 +431,6 @@ class PingPacket : public RedBotPacket
          */
         PingPacket();
 
-        /**
-         * Reads serialized binary data from input stream
-         */
-        void read(
-                std::istream&
-                );
-
         /**
          * Indicates if this packet is valid or not
          */
@@ -216,12 +446,21 @@ class PingPacket : public RedBotPacket
     private:
 
         /**
-         * Writes binary packet contents to output stream
+         * Encodes binary packet contents into the given buffer
          */
-        void writeContents(
-                std::ostream&
+        void encodeContents(
+                unsigned char* buffer
                 ) const;
 
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
         /**
          * Provides elements to include in the XML representation
          */
@@ -248,12 +487,134 @@ class AcknowledgePacket : public RedBotPacket
         AcknowledgePacket();
 
         /**
-         * Reads serialized binary data from input stream
+         * Indicates if this packet is valid or not
          */
-        void read(
-                std::istream&
+        bool isValid() const;
+
+        /**
+         * Equality operator
+         */
+        bool operator==(
+                const Packet&
+                ) const;
+
+    private:
+
+        /**
+         * Encodes binary packet contents into the given buffer
+         */
+        void encodeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
+        /**
+         * Provides elements to include in the XML representation
+         */
+        void getXMLElements(
+                XMLElements& elements
+                ) const;
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool myIsValid;
+};
+
+/**
+ * Batched request frame class
+ *
+ * This packet carries several request packets between a single pair of
+ * boundary bytes. Each embedded packet is written as its binary ID followed
+ * by its contents. The robot answers with a FrameValuesPacket holding one
+ * response for each embedded request in the same order.
+ */
+class FramePacket : public RedBotPacket
+{
+    public:
+
+        /**
+         * Largest number of content bytes a frame may carry
+         *
+         * This keeps a whole frame within the robot's packet buffer, with room
+         * for the largest checksum.
+         */
+        static const size_t MAX_CONTENT_LENGTH = 58;
+
+        /**
+         * Constructor given packet generator
+         *
+         * The generator is used to create embedded packets when reading a
+         * frame from an input stream.
+         */
+        FramePacket(
+                PacketGenerator* packetGen = NULL
+                );
+
+        /**
+         * Destructor
+         *
+         * This deletes all of the embedded packets.
+         */
+        ~FramePacket();
+
+        /**
+         * Adds a packet to this frame
+         *
+         * This frame takes ownership of the packet. Responses can be longer
+         * than their requests, so the packet is only added if the responses
+         * to all of the frame's packets also fit in a single frame.
+         *
+         * \return True if the packet was added, false if it does not fit or
+         * cannot be embedded
+         */
+        bool add(
+                RedBotPacket* packet
+                );
+
+        /**
+         * Provides the number of embedded packets
+         */
+        size_t getPacketCount() const;
+
+        /**
+         * Provides an embedded packet given its index
+         *
+         * \return Pointer to the embedded packet, or NULL if the index is out
+         * of range
+         */
+        const RedBotPacket* getPacket(
+                size_t packetIdx
+                ) const;
+
+        /**
+         * Moves the embedded packets into the given queue
+         *
+         * The queue takes ownership of the moved packets.
+         */
+        void releasePackets(
+                PacketQueue& packets
                 );
 
+        /**
+         * Provides the number of content bytes in this frame
+         */
+        size_t getContentLength() const;
+
+        /**
+         * Provides the number of content bytes in this frame's native
+         * encoding
+         */
+        size_t getNativeContentLength() const;
+
         /**
          * Indicates if this packet is valid or not
          */
@@ -266,15 +627,51 @@ class AcknowledgePacket : public RedBotPacket
                 const Packet&
                 ) const;
 
+    protected:
+
+        /**
+         * Constructor given type information for subclasses
+         */
+        FramePacket(
+                Type                type,
+                const char*         typeName,
+                BinaryID            binID,
+                PacketGenerator*    packetGen
+                );
+
     private:
 
         /**
-         * Writes binary packet contents to output stream
+         * Encodes binary packet contents into the given buffer
          */
-        void writeContents(
-                std::ostream&
+        void encodeContents(
+                unsigned char* buffer
                 ) const;
 
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
+        /**
+         * Encodes the native bodies of the embedded packets
+         */
+        void encodeNativeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes embedded packets from their native bodies
+         */
+        void decodeNativeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize
+                );
+
         /**
          * Provides elements to include in the XML representation
          */
@@ -282,6 +679,555 @@ class AcknowledgePacket : public RedBotPacket
                 XMLElements& elements
                 ) const;
 
+        /**
+         * Keeps the contents of a frame that failed to decode for debugging
+         */
+        void keepInvalidContents(
+                const unsigned char*    contents,
+                size_t                  contentSize
+                );
+
+        /**
+         * Deletes all of the embedded packets
+         */
+        void clearPackets();
+
+        /**
+         * Packets embedded in this frame
+         *
+         * Every embedded packet takes at least one content byte, so the
+         * content limit bounds the number of packets.
+         */
+        RedBotPacket* myPackets[MAX_CONTENT_LENGTH];
+
+        /**
+         * Number of packets in myPackets
+         */
+        size_t myPacketCount;
+
+        /**
+         * Number of content bytes in this frame
+         */
+        size_t myContentLength;
+
+        /**
+         * Largest number of content bytes in the frame answering this one
+         */
+        size_t myResponseLength;
+
+        /**
+         * Generator used to create embedded packets while reading
+         */
+        PacketGenerator* myPacketGenerator;
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool myIsValid;
+
+        /**
+         * Contents of an invalid frame as read, kept for debugging
+         */
+        unsigned char myInvalidContents[MAX_BINARY_SIZE];
+
+        /**
+         * Number of bytes in myInvalidContents
+         */
+        size_t myInvalidContentLength;
+};
+
+/**
+ * Batched response frame class
+ *
+ * This packet carries the responses to the requests of a FramePacket, in the
+ * same order. Samples of subscribed inputs that are due may follow them, and
+ * a ping may be answered with a frame of such samples in place of an
+ * acknowledgement.
+ */
+class FrameValuesPacket : public FramePacket
+{
+    public:
+
+        /**
+         * Constructor given packet generator
+         */
+        FrameValuesPacket(
+                PacketGenerator* packetGen = NULL
+                );
+};
+
+/**
+ * Sample subscription request class
+ *
+ * This packet asks the robot to answer an input request on its own at a fixed
+ * period. The robot appends the responses to its replies to pings and frames
+ * whenever they are due, so the request does not need to be sent every cycle.
+ * The robot acknowledges the subscription. A period of 0 cancels it.
+ */
+class SubscribePacket : public RedBotPacket
+{
+    public:
+
+        /**
+         * Largest supported sampling period in milliseconds
+         */
+        const static unsigned int MAX_PERIOD = 0x3FFF;
+
+        /**
+         * Default constructor
+         */
+        SubscribePacket();
+
+        /**
+         * Constructor given the request to subscribe to
+         *
+         * Only requests with a single content byte can be subscribed to.
+         */
+        SubscribePacket(
+                const RedBotPacket& request,    /**< Input request to answer periodically */
+                unsigned int        period      /**< Sampling period in milliseconds */
+                );
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool isValid() const;
+
+        /**
+         * Equality operator
+         */
+        bool operator==(
+                const Packet&
+                ) const;
+
+        /**
+         * Provides the binary ID of the subscribed request
+         */
+        unsigned char getRequestID() const;
+
+        /**
+         * Provides the content byte of the subscribed request
+         */
+        unsigned char getRequestAddress() const;
+
+        /**
+         * Provides the sampling period in milliseconds
+         */
+        unsigned int getPeriod() const;
+
+    private:
+
+        /**
+         * Encodes binary packet contents into the given buffer
+         */
+        void encodeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
+        /**
+         * Encodes native packet contents into the given buffer
+         */
+        void encodeNativeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes native packet contents from the given bytes
+         */
+        void decodeNativeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize
+                );
+
+        /**
+         * Provides elements to include in the XML representation
+         */
+        void getXMLElements(
+                XMLElements& elements
+                ) const;
+
+        /**
+         * Binary ID of the subscribed request
+         */
+        unsigned char myRequestID;
+
+        /**
+         * Content byte of the subscribed request
+         */
+        unsigned char myRequestAddress;
+
+        /**
+         * Sampling period in milliseconds
+         */
+        unsigned int myPeriod;
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool myIsValid;
+};
+
+/**
+ * Protocol version request class
+ *
+ * This packet asks the robot to switch to the given protocol version, or to
+ * the latest version it supports below it. The robot replies with a
+ * VersionInfoPacket in the current protocol and switches afterwards. Robots
+ * that predate version negotiation acknowledge the request instead and keep
+ * using bounded packets.
+ */
+class VersionPacket : public RedBotPacket
+{
+    public:
+
+        /**
+         * Default constructor
+         */
+        VersionPacket();
+
+        /**
+         * Constructor given the requested version
+         */
+        VersionPacket(
+                unsigned int version
+                );
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool isValid() const;
+
+        /**
+         * Equality operator
+         */
+        bool operator==(
+                const Packet&
+                ) const;
+
+        /**
+         * Provides the requested version
+         */
+        unsigned int getVersion() const;
+
+    private:
+
+        /**
+         * Encodes binary packet contents into the given buffer
+         */
+        void encodeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
+        /**
+         * Provides elements to include in the XML representation
+         */
+        void getXMLElements(
+                XMLElements& elements
+                ) const;
+
+        /**
+         * Requested version
+         */
+        unsigned char myVersion;
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool myIsValid;
+};
+
+/**
+ * Selected protocol version response class
+ */
+class VersionInfoPacket : public RedBotPacket
+{
+    public:
+
+        /**
+         * Default constructor
+         */
+        VersionInfoPacket();
+
+        /**
+         * Constructor given the selected version
+         */
+        VersionInfoPacket(
+                unsigned int version
+                );
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool isValid() const;
+
+        /**
+         * Equality operator
+         */
+        bool operator==(
+                const Packet&
+                ) const;
+
+        /**
+         * Provides the selected version
+         */
+        unsigned int getVersion() const;
+
+    private:
+
+        /**
+         * Encodes binary packet contents into the given buffer
+         */
+        void encodeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
+        /**
+         * Provides elements to include in the XML representation
+         */
+        void getXMLElements(
+                XMLElements& elements
+                ) const;
+
+        /**
+         * Selected version
+         */
+        unsigned char myVersion;
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool myIsValid;
+};
+
+/**
+ * Negative acknowledgement response class
+ *
+ * The robot sends this in place of a response when a request's checksum does
+ * not match, so that the request can be sent again.
+ */
+class NegativeAcknowledgePacket : public RedBotPacket
+{
+    public:
+
+        /**
+         * Default constructor
+         */
+        NegativeAcknowledgePacket();
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool isValid() const;
+
+        /**
+         * Equality operator
+         */
+        bool operator==(
+                const Packet&
+                ) const;
+
+    private:
+
+        /**
+         * Encodes binary packet contents into the given buffer
+         */
+        void encodeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
+        /**
+         * Provides elements to include in the XML representation
+         */
+        void getXMLElements(
+                XMLElements& elements
+                ) const;
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool myIsValid;
+};
+
+/**
+ * Checksum type request class
+ *
+ * This packet asks the robot to check and append checksums of the given type
+ * on every packet, or to stop with Crc::TYPE_NONE. The robot replies with a
+ * ChecksumInfoPacket using the checksum type the request came in with and
+ * switches afterwards. Robots without checksums acknowledge the request
+ * instead.
+ */
+class ChecksumPacket : public RedBotPacket
+{
+    public:
+
+        /**
+         * Default constructor
+         */
+        ChecksumPacket();
+
+        /**
+         * Constructor given the requested checksum type
+         */
+        ChecksumPacket(
+                Crc::Type checksum
+                );
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool isValid() const;
+
+        /**
+         * Equality operator
+         */
+        bool operator==(
+                const Packet&
+                ) const;
+
+        /**
+         * Provides the requested checksum type
+         */
+        Crc::Type getChecksum() const;
+
+    private:
+
+        /**
+         * Encodes binary packet contents into the given buffer
+         */
+        void encodeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
+        /**
+         * Provides elements to include in the XML representation
+         */
+        void getXMLElements(
+                XMLElements& elements
+                ) const;
+
+        /**
+         * Requested checksum type
+         */
+        Crc::Type myChecksum;
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool myIsValid;
+};
+
+/**
+ * Selected checksum type response class
+ */
+class ChecksumInfoPacket : public RedBotPacket
+{
+    public:
+
+        /**
+         * Default constructor
+         */
+        ChecksumInfoPacket();
+
+        /**
+         * Constructor given the selected checksum type
+         */
+        ChecksumInfoPacket(
+                Crc::Type checksum
+                );
+
+        /**
+         * Indicates if this packet is valid or not
+         */
+        bool isValid() const;
+
+        /**
+         * Equality operator
+         */
+        bool operator==(
+                const Packet&
+                ) const;
+
+        /**
+         * Provides the selected checksum type
+         */
+        Crc::Type getChecksum() const;
+
+    private:
+
+        /**
+         * Encodes binary packet contents into the given buffer
+         */
+        void encodeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
+        /**
+         * Provides elements to include in the XML representation
+         */
+        void getXMLElements(
+                XMLElements& elements
+                ) const;
+
+        /**
+         * Selected checksum type
+         */
+        Crc::Type myChecksum;
+
         /**
          * Indicates if this packet is valid or not
          */
@@ -1,6 +1,7 @@
 
 #include "RedBotSpeedController.h"
 #include <math.h>
+#include <utility>
 
 
 MotorDrivePacket::MotorDrivePacket() :
@@ -56,14 +57,40 @@ MotorDrivePacket::MotorDrivePacket(
 }
 
 void
-MotorDrivePacket::writeContents(
-        std::ostream& outputStream
+MotorDrivePacket::encodeContents(
+        unsigned char* buffer
         ) const
 {
-    outputStream << ((myMotor == MOTOR_LEFT) ? '\x02' : '\x01');
-    outputStream << ((myDirection == DIR_FORWARD) ? '\x01' : '\x02');
-    outputStream << (unsigned char)(((mySpeed & 0xF0) >> 4) + 1);
-    outputStream << (unsigned char)((mySpeed & 0x0F) + 1);
+    buffer[0] = (myMotor == MOTOR_LEFT) ? 0x02 : 0x01;
+    buffer[1] = (myDirection == DIR_FORWARD) ? 0x01 : 0x02;
+    buffer[2] = (unsigned char)(((mySpeed & 0xF0) >> 4) + 1);
+    buffer[3] = (unsigned char)((mySpeed & 0x0F) + 1);
+}
+
+void
+MotorDrivePacket::encodeNativeContents(
+        unsigned char* buffer
+        ) const
+{
+    buffer[0] = (myMotor == MOTOR_LEFT) ? 0x02 : 0x01;
+    buffer[1] = (myDirection == DIR_FORWARD) ? 0x01 : 0x02;
+    buffer[2] = mySpeed;
+}
+
+void
+MotorDrivePacket::decodeNativeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize
+        )
+{
+    if (contentSize < 3)
+    {
+        return;
+    }
+
+    myMotor = ((contents[0] == 0x01) ? MOTOR_RIGHT : MOTOR_LEFT);
+    mySpeed = contents[2];
+    myDirection = ((contents[1] == 0x01) ? DIR_FORWARD : DIR_BACKWARD);
 }
 
 void
@@ -92,34 +119,20 @@ MotorDrivePacket::getXMLElements(
 }
 
 void
-MotorDrivePacket::read(
-        std::istream& inputStream
+MotorDrivePacket::decodeContents(
+        const unsigned char*    contents,
+        size_t                  contentSize,
+        bool                    isTerminated
         )
 {
-    std::vector<unsigned char> byteBuf(4);
-
-    for (int i = 0; i < 4; i++)
+    if (contentSize < 4)
     {
-        unsigned char curByte;
-        inputStream >> curByte;
-
-        if(
-                (curByte == '\xFF') ||
-                (inputStream.good() == false)
-          )
-        {
-            return;
-        }
-
-        byteBuf[i] = curByte;
+        return;
     }
 
-    myMotor = ((byteBuf[0] == '\x01') ? MOTOR_RIGHT : MOTOR_LEFT);
-    mySpeed = ((byteBuf[2] - 1) << 4) | (byteBuf[3] - 1);
-    myDirection = ((byteBuf[1] == '\x01') ? DIR_FORWARD : DIR_BACKWARD);
-
-    unsigned char trailer;
-    inputStream >> trailer;
+    myMotor = ((contents[0] == 0x01) ? MOTOR_RIGHT : MOTOR_LEFT);
+    mySpeed = ((contents[2] - 1) << 4) | (contents[3] - 1);
+    myDirection = ((contents[1] == 0x01) ? DIR_FORWARD : DIR_BACKWARD);
 }
 
 bool
@@ -175,34 +188,33 @@ MotorDrivePacket::getDirection() const
 
 RedBotSpeedController::RedBotSpeedController(size_t channel) :
   myChannel(channel),
-  myCurrentMotorPacket(NULL)
+  mySpeed(0.0)
 {
 }
 
 void
 RedBotSpeedController::Set(double speed)
 {
-  if (myCurrentMotorPacket != NULL)
-    {
-      delete myCurrentMotorPacket;
-    }
-
-  myCurrentMotorPacket = new MotorDrivePacket(((myChannel == 0) ? MotorDrivePacket::MOTOR_LEFT : MotorDrivePacket::MOTOR_RIGHT), speed);
+  mySpeed = speed;
+  myCurrentMotorPacket.reset(new MotorDrivePacket(((myChannel == 0) ? MotorDrivePacket::MOTOR_LEFT : MotorDrivePacket::MOTOR_RIGHT), speed));
 }
 
-Packet*
+PacketHandle
 RedBotSpeedController::getNextPacket()
 {
-  if (myCurrentMotorPacket != NULL)
+  // Repeat the last speed if nothing was commanded for a while
+  if ((myCurrentMotorPacket.isNull() == true) && (myOutputCache.isKeepAliveDue() == true))
     {
-      Packet* motorPacket = myCurrentMotorPacket;
-      myCurrentMotorPacket = NULL;
-      return motorPacket;
+      Set(mySpeed);
     }
-  else
+
+  // Drop commands that would not change the motor's speed
+  if (myOutputCache.update(myCurrentMotorPacket.get()) == false)
     {
-      return NULL;
+      myCurrentMotorPacket.reset();
     }
+
+  return std::move(myCurrentMotorPacket);
 }
 
 bool
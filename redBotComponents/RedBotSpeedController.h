@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include "RedBotComponent.h"
 #include "RedBotPacket.h"
+#include "OutputCache.h"
 
 /**
  * Motor drive command class
@@ -61,13 +62,6 @@ class MotorDrivePacket : public RedBotPacket
          */
         ~MotorDrivePacket();
 
-        /**
-         * Reads serialized binary data from input stream
-         */
-        void read(
-                std::istream&
-                );
-
         /**
          * Indicates if this packet is valid or not
          *
@@ -101,12 +95,36 @@ class MotorDrivePacket : public RedBotPacket
     private:
 
         /**
-         * Writes binary packet contents to output stream
+         * Encodes binary packet contents into the given buffer
+         */
+        void encodeContents(
+                unsigned char* buffer
+                ) const;
+
+        /**
+         * Decodes binary packet contents from the given bytes
+         */
+        void decodeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize,
+                bool                    isTerminated
+                );
+
+        /**
+         * Encodes native packet contents into the given buffer
          */
-        void writeContents(
-                std::ostream&
+        void encodeNativeContents(
+                unsigned char* buffer
                 ) const;
 
+        /**
+         * Decodes native packet contents from the given bytes
+         */
+        void decodeNativeContents(
+                const unsigned char*    contents,
+                size_t                  contentSize
+                );
+
         /**
          * Provides elements to include in the XML representation
          */
@@ -159,7 +177,7 @@ class RedBotSpeedController : public frc::PWMSpeedController, public RedBotCompo
 
   void Set(double speed);
 
-  Packet* getNextPacket();
+  PacketHandle getNextPacket();
 
   bool processPacket(const Packet& packet);
 
@@ -167,7 +185,11 @@ class RedBotSpeedController : public frc::PWMSpeedController, public RedBotCompo
 
   const size_t myChannel;
 
-  MotorDrivePacket* myCurrentMotorPacket;
+  double mySpeed;
+
+  PacketHandle myCurrentMotorPacket;
+
+  OutputCache myOutputCache;
 };
 
 #endif /* ifndef SPEEDCONTROLLER_H */
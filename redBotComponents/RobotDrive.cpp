@@ -50,10 +50,10 @@ DifferentialDrive::ArcadeDrive(
     myRightController.Set(magnitude - curve);
 }
 
-Packet*
+PacketHandle
 DifferentialDrive::getNextPacket()
 {
-  return NULL;
+  return PacketHandle();
 }
 
 bool
@@ -48,7 +48,7 @@ class DifferentialDrive : public RedBotComponent
         /**
          * Provides the next packet to send to the robot
          */
-        Packet* getNextPacket();
+        PacketHandle getNextPacket();
 
         /**
          * Processes a packet received from the robot
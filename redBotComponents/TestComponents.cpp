@@ -6,6 +6,8 @@
 #include "RobotDrive.h"
 #include "RedBotSpeedController.h"
 #include "RedBotEncoder.h"
+#include "LatencyHistogram.h"
+#include "Timer.h"
 
 
 static void CheckDrive(
@@ -26,6 +28,45 @@ template <class RequestType> static void CheckConfiguration(
         );
 
 
+TEST_GROUP(LatencyHistogram)
+{
+};
+
+TEST(LatencyHistogram, BucketTest)
+{
+    LatencyHistogram histogram;
+
+    CHECK_EQUAL(0, histogram.getCount());
+    DOUBLES_EQUAL(0.0, histogram.getPercentile(50.0), 0.0);
+
+    histogram.add(0.5e-6);
+    histogram.add(3e-6);
+    histogram.add(3.5e-6);
+    histogram.add(1e-3);
+    histogram.add(100.0);
+
+    CHECK_EQUAL(5, histogram.getCount());
+    CHECK_EQUAL(1, histogram.getBucketCount(0));
+    CHECK_EQUAL(2, histogram.getBucketCount(2));
+    CHECK_EQUAL(1, histogram.getBucketCount(10));
+    CHECK_EQUAL(1, histogram.getBucketCount(LatencyHistogram::NUM_BUCKETS - 1));
+
+    DOUBLES_EQUAL(0.5e-6, histogram.getMin(), 1e-12);
+    DOUBLES_EQUAL(100.0, histogram.getMax(), 1e-12);
+    DOUBLES_EQUAL(20.0002014, histogram.getMean(), 1e-6);
+
+    // Percentiles are bounded by their bucket
+    DOUBLES_EQUAL(4e-6, histogram.getPercentile(50.0), 1e-12);
+    DOUBLES_EQUAL(1.024e-3, histogram.getPercentile(80.0), 1e-12);
+    DOUBLES_EQUAL(100.0, histogram.getPercentile(100.0), 1e-12);
+
+    histogram.reset();
+
+    CHECK_EQUAL(0, histogram.getCount());
+    CHECK_EQUAL(0, histogram.getBucketCount(2));
+}
+
+
 TEST(Components, DigitalOutputConfigTest)
 {
     frc::DigitalOutput dOut(9);
@@ -43,7 +84,7 @@ TEST(Components, DigitalOutputTest)
 {
     frc::DigitalOutput dOut(5);
     dOut.Set(1);
-    Packet* packet0 = dOut.getNextPacket();
+    Packet* packet0 = dOut.getNextPacket().release();
     myPackets.push_back(packet0);
 
     CHECK(packet0 != NULL);
@@ -56,7 +97,7 @@ TEST(Components, DigitalOutputTest)
 
     dOut.processPacket(PinConfigInfoPacket(5, PinConfigInfoPacket::DIR_OUTPUT));
 
-    Packet* packet1 = dOut.getNextPacket();
+    Packet* packet1 = dOut.getNextPacket().release();
     myPackets.push_back(packet1);
 
     CHECK(packet1 != NULL);
@@ -66,11 +107,16 @@ TEST(Components, DigitalOutputTest)
 
     CHECK_EQUAL(5, dOutPacket1->getPin());
     CHECK_EQUAL(true, dOutPacket1->getValue());
-    POINTERS_EQUAL(NULL, dOut.getNextPacket());
+    POINTERS_EQUAL(NULL, dOut.getNextPacket().get());
 
+    // Setting the value that was last sent changes nothing
     dOut.Set(0);
     dOut.Set(1);
-    Packet* packet2 = dOut.getNextPacket();
+    POINTERS_EQUAL(NULL, dOut.getNextPacket().get());
+
+    dOut.Set(1);
+    dOut.Set(0);
+    Packet* packet2 = dOut.getNextPacket().release();
     myPackets.push_back(packet2);
 
     CHECK(packet2 != NULL);
@@ -79,7 +125,32 @@ TEST(Components, DigitalOutputTest)
     DigitalOutputPacket* dOutPacket2 = static_cast<DigitalOutputPacket*>(packet2);
 
     CHECK_EQUAL(5, dOutPacket2->getPin());
-    CHECK_EQUAL(true, dOutPacket2->getValue());
+    CHECK_EQUAL(false, dOutPacket2->getValue());
+}
+
+TEST(Components, DigitalOutputKeepAliveTest)
+{
+    OutputCache::SetKeepAliveInterval(3);
+
+    frc::DigitalOutput dOut(5);
+    myPackets.push_back(dOut.getNextPacket().release());
+    dOut.processPacket(PinConfigInfoPacket(5, PinConfigInfoPacket::DIR_OUTPUT));
+
+    dOut.Set(1);
+    myPackets.push_back(dOut.getNextPacket().release());
+
+    CHECK(NULL != dynamic_cast<DigitalOutputPacket*>(myPackets.back()));
+
+    dOut.Set(1);
+    POINTERS_EQUAL(NULL, dOut.getNextPacket().get());
+    POINTERS_EQUAL(NULL, dOut.getNextPacket().get());
+
+    // The last value is sent again once per interval
+    myPackets.push_back(dOut.getNextPacket().release());
+
+    CHECK(NULL != dynamic_cast<DigitalOutputPacket*>(myPackets.back()));
+    CHECK_TRUE(static_cast<DigitalOutputPacket*>(myPackets.back())->getValue());
+    POINTERS_EQUAL(NULL, dOut.getNextPacket().get());
 }
 
 TEST(Components, DigitalInputConfigTest)
@@ -98,7 +169,7 @@ TEST(Components, DigitalInputTest)
 {
     frc::DigitalInput dIn(4);
 
-    Packet* packet0 = dIn.getNextPacket();
+    Packet* packet0 = dIn.getNextPacket().release();
     myPackets.push_back(packet0);
 
     CHECK(packet0 != NULL);
@@ -111,7 +182,7 @@ TEST(Components, DigitalInputTest)
 
     dIn.processPacket(PinConfigInfoPacket(4, PinConfigInfoPacket::DIR_INPUT));
 
-    Packet* packet1 = dIn.getNextPacket();
+    Packet* packet1 = dIn.getNextPacket().release();
     myPackets.push_back(packet1);
 
     CHECK(packet1 != NULL);
@@ -141,7 +212,7 @@ TEST(Components, AnalogInputTest)
 {
     frc::AnalogInput aIn(3);
 
-    Packet* packet1 = aIn.getNextPacket();
+    Packet* packet1 = aIn.getNextPacket().release();
     myPackets.push_back(packet1);
 
     CHECK(packet1 != NULL);
@@ -156,12 +227,308 @@ TEST(Components, AnalogInputTest)
     CHECK_EQUAL(-19, aIn.GetValue());
 }
 
+TEST(Components, InputStreamTest)
+{
+    frc::DigitalInput dIn(4);
+
+    myPackets.push_back(dIn.getNextPacket().release());
+    dIn.processPacket(PinConfigInfoPacket(4, PinConfigInfoPacket::DIR_INPUT));
+
+    dIn.SetStreamPeriod(20);
+
+    CHECK_EQUAL(20, dIn.GetStreamPeriod());
+
+    Packet* packet1 = dIn.getNextPacket().release();
+    myPackets.push_back(packet1);
+
+    CHECK(NULL != dynamic_cast<SubscribePacket*>(packet1));
+    CHECK(*packet1 == SubscribePacket(DigitalInputPacket(4), 20));
+
+    // Pushed samples do not trigger further requests
+    CHECK(dIn.processPacket(DigitalValuePacket(4, true)));
+    CHECK_TRUE(dIn.Get());
+
+    for(
+            size_t cycleIdx = 0;
+            cycleIdx < 10;
+            ++cycleIdx
+       )
+    {
+        CHECK(dIn.getNextPacket().isNull());
+    }
+
+    // The subscription is renewed once samples stop arriving
+    Packet* packet2 = NULL;
+    size_t cycleCount = 0;
+    while(
+            (packet2 == NULL) &&
+            (cycleCount < 100)
+         )
+    {
+        packet2 = dIn.getNextPacket().release();
+        ++cycleCount;
+    }
+    myPackets.push_back(packet2);
+
+    CHECK(NULL != dynamic_cast<SubscribePacket*>(packet2));
+    CHECK(*packet2 == SubscribePacket(DigitalInputPacket(4), 20));
+
+    // Cancelling the subscription returns to requesting values
+    dIn.SetStreamPeriod(0);
+
+    Packet* packet3 = dIn.getNextPacket().release();
+    myPackets.push_back(packet3);
+
+    CHECK(*packet3 == SubscribePacket(DigitalInputPacket(4), 0));
+
+    Packet* packet4 = dIn.getNextPacket().release();
+    myPackets.push_back(packet4);
+
+    CHECK(NULL != dynamic_cast<DigitalInputPacket*>(packet4));
+}
+
+TEST(Components, InputTimestampTest)
+{
+    frc::AnalogInput aIn(3);
+    double age = 0.0;
+
+    DOUBLES_EQUAL(0.0, aIn.GetTimestamp(), 0.0);
+    aIn.GetWithAge(age);
+    CHECK(age > 1e300);
+
+    double startTime = frc::Timer::GetFPGATimestamp();
+
+    Packet* packet1 = aIn.getNextPacket().release();
+    myPackets.push_back(packet1);
+
+    CHECK(NULL != dynamic_cast<AnalogInputPacket*>(packet1));
+
+    CHECK(aIn.processPacket(AnalogValuePacket(3, 5)));
+
+    double endTime = frc::Timer::GetFPGATimestamp();
+
+    // The value carries the times it was requested and received
+    CHECK(aIn.GetRequestTimestamp() >= startTime);
+    CHECK(aIn.GetTimestamp() >= aIn.GetRequestTimestamp());
+    CHECK(aIn.GetTimestamp() <= endTime);
+    CHECK_EQUAL(5, aIn.GetWithAge(age));
+    CHECK(age >= 0.0);
+    CHECK(age < 1.0);
+    CHECK_EQUAL(1, aIn.GetLatencyHistogram().getCount());
+    CHECK_EQUAL(0, aIn.GetStaleCycles());
+
+    // Values age by a cycle every time the input is polled
+    myPackets.push_back(aIn.getNextPacket().release());
+    myPackets.push_back(aIn.getNextPacket().release());
+
+    CHECK_EQUAL(2, aIn.GetStaleCycles());
+
+    CHECK(aIn.processPacket(AnalogValuePacket(3, 6)));
+
+    CHECK_EQUAL(0, aIn.GetStaleCycles());
+    CHECK_EQUAL(2, aIn.GetLatencyHistogram().getCount());
+
+    // Pushed samples are not counted as round trips
+    CHECK(aIn.processPacket(AnalogValuePacket(3, 7)));
+
+    CHECK_EQUAL(2, aIn.GetLatencyHistogram().getCount());
+    DOUBLES_EQUAL(aIn.GetTimestamp(), aIn.GetRequestTimestamp(), 0.0);
+}
+
+TEST(Components, InputClockTest)
+{
+    ManualClock clock(10 * Clock::NSEC_PER_SEC);
+    Clock::SetInstance(&clock);
+
+    frc::AnalogInput aIn(3);
+    double age = 0.0;
+
+    // Timestamps and latencies are exact on a manual clock
+    myPackets.push_back(aIn.getNextPacket().release());
+    clock.advance(0.25);
+
+    CHECK(aIn.processPacket(AnalogValuePacket(3, 5)));
+    DOUBLES_EQUAL(10.0, aIn.GetRequestTimestamp(), 0.0);
+    DOUBLES_EQUAL(10.25, aIn.GetTimestamp(), 0.0);
+    DOUBLES_EQUAL(0.25, aIn.GetLatencyHistogram().getMax(), 1e-9);
+
+    clock.advance(0.5);
+
+    CHECK_EQUAL(5, aIn.GetWithAge(age));
+    DOUBLES_EQUAL(0.5, age, 0.0);
+}
+
+TEST(Components, InputZeroTimestampTest)
+{
+    ManualClock clock(0);
+    Clock::SetInstance(&clock);
+
+    frc::AnalogInput aIn(3);
+    double age = 0.0;
+
+    aIn.SetSampleRate(0.001);
+
+    // A value received at time 0 is still a value
+    myPackets.push_back(aIn.getNextPacket().release());
+
+    CHECK(aIn.processPacket(AnalogValuePacket(3, 5)));
+    DOUBLES_EQUAL(0.0, aIn.GetTimestamp(), 0.0);
+
+    CHECK_EQUAL(5, aIn.GetWithAge(age));
+    DOUBLES_EQUAL(0.0, age, 0.0);
+    CHECK(aIn.getNextPacket().isNull());
+}
+
+TEST(Components, InputSampleRateTest)
+{
+    frc::AnalogInput aIn(3);
+
+    CHECK_EQUAL(Component::DEFAULT_PRIORITY, aIn.getPriority());
+
+    aIn.SetPriority(3);
+
+    CHECK_EQUAL(3, aIn.getPriority());
+
+    // A sample every 1000 s is never due again during this test
+    aIn.SetSampleRate(0.001);
+
+    Packet* packet1 = aIn.getNextPacket().release();
+    myPackets.push_back(packet1);
+
+    CHECK(NULL != dynamic_cast<AnalogInputPacket*>(packet1));
+    CHECK(aIn.processPacket(AnalogValuePacket(3, 5)));
+
+    for(
+            size_t cycleIdx = 0;
+            cycleIdx < 20;
+            ++cycleIdx
+       )
+    {
+        CHECK(aIn.getNextPacket().isNull());
+    }
+
+    // Without a rate the next value is requested as soon as one arrives
+    aIn.SetSampleRate(0.0);
+
+    Packet* packet2 = aIn.getNextPacket().release();
+    myPackets.push_back(packet2);
+
+    CHECK(NULL != dynamic_cast<AnalogInputPacket*>(packet2));
+}
+
+TEST(Components, InputRetryTest)
+{
+    frc::AnalogInput aIn(3);
+    size_t idleCycles = 0;
+
+    myPackets.push_back(aIn.getNextPacket().release());
+
+    // Unanswered requests are retried, waiting longer each time
+    for(
+            size_t retryIdx = 0;
+            retryIdx < 2;
+            ++retryIdx
+       )
+    {
+        Packet* packet = NULL;
+        idleCycles = 0;
+        while(
+                ((packet = aIn.getNextPacket().release()) == NULL) &&
+                (idleCycles < 100)
+             )
+        {
+            ++idleCycles;
+        }
+        myPackets.push_back(packet);
+
+        CHECK(NULL != dynamic_cast<AnalogInputPacket*>(packet));
+        CHECK_EQUAL((retryIdx == 0) ? 6 : 11, idleCycles);
+    }
+
+    // Prompt answers shorten the wait again
+    for(
+            size_t answerIdx = 0;
+            answerIdx < 30;
+            ++answerIdx
+       )
+    {
+        CHECK(aIn.processPacket(AnalogValuePacket(3, answerIdx)));
+        myPackets.push_back(aIn.getNextPacket().release());
+    }
+
+    idleCycles = 0;
+    while(
+            (aIn.getNextPacket().isNull() == true) &&
+            (idleCycles < 100)
+         )
+    {
+        ++idleCycles;
+    }
+
+    CHECK_EQUAL(3, idleCycles);
+}
+
+TEST(Components, RoutingKeyTest)
+{
+    frc::DigitalInput dIn(4);
+    frc::DigitalOutput dOut(5);
+    frc::AnalogInput aIn(4);
+    RedBotEncoder rightEncoder(true);
+
+    std::vector<RoutingKey> keys;
+    RoutingKey key;
+
+    dIn.getRoutingKeys(keys);
+
+    CHECK_EQUAL(2, keys.size());
+    CHECK_TRUE(
+            PinConfigInfoPacket(4, PinConfigInfoPacket::DIR_INPUT).getRoutingKey(key)
+            );
+    CHECK_EQUAL(key, keys[0]);
+    CHECK_TRUE(DigitalValuePacket(4, true).getRoutingKey(key));
+    CHECK_EQUAL(key, keys[1]);
+
+    // Other pins and packet types have other keys
+    CHECK_TRUE(DigitalValuePacket(5, true).getRoutingKey(key));
+    CHECK(key != keys[1]);
+    CHECK_TRUE(AnalogValuePacket(4, 7).getRoutingKey(key));
+    CHECK(key != keys[1]);
+
+    keys.clear();
+    dOut.getRoutingKeys(keys);
+
+    CHECK_EQUAL(1, keys.size());
+    CHECK_TRUE(
+            PinConfigInfoPacket(5, PinConfigInfoPacket::DIR_OUTPUT).getRoutingKey(key)
+            );
+    CHECK_EQUAL(key, keys[0]);
+
+    keys.clear();
+    aIn.getRoutingKeys(keys);
+
+    CHECK_EQUAL(1, keys.size());
+    CHECK_TRUE(AnalogValuePacket(4, 7).getRoutingKey(key));
+    CHECK_EQUAL(key, keys[0]);
+
+    keys.clear();
+    rightEncoder.getRoutingKeys(keys);
+
+    CHECK_EQUAL(1, keys.size());
+    CHECK_TRUE(EncoderCountPacket(true, 12).getRoutingKey(key));
+    CHECK_EQUAL(key, keys[0]);
+    CHECK_TRUE(EncoderCountPacket(false, 12).getRoutingKey(key));
+    CHECK(key != keys[0]);
+
+    // Requests are not routed
+    CHECK_FALSE(DigitalInputPacket(4).getRoutingKey(key));
+}
+
 TEST(Components, EncoderTest)
 {
   RedBotEncoder leftEncoder(false);
   RedBotEncoder rightEncoder(true);
 
-  Packet* packet0 = leftEncoder.getNextPacket();
+  Packet* packet0 = leftEncoder.getNextPacket().release();
   myPackets.push_back(packet0);
 
   CHECK(packet0 != NULL);
@@ -171,12 +538,12 @@ TEST(Components, EncoderTest)
 
   CHECK_FALSE(leftInputPacket->isRight());
 
-  Packet* packet1 = leftEncoder.getNextPacket();
+  Packet* packet1 = leftEncoder.getNextPacket().release();
   myPackets.push_back(packet1);
 
   CHECK_EQUAL((Packet*)NULL, packet1);
 
-  Packet* packet2 = rightEncoder.getNextPacket();
+  Packet* packet2 = rightEncoder.getNextPacket().release();
   myPackets.push_back(packet2);
 
   CHECK(packet2 != NULL);
@@ -204,7 +571,7 @@ TEST(Components, EncoderTest)
 
   leftEncoder.Reset();
 
-  Packet* packet3 = leftEncoder.getNextPacket();
+  Packet* packet3 = leftEncoder.getNextPacket().release();
   myPackets.push_back(packet3);
 
   CHECK(packet3 != NULL);
@@ -214,7 +581,7 @@ TEST(Components, EncoderTest)
 
   CHECK_FALSE(leftClearPacket->isRight());
 
-  Packet* packet4 = leftEncoder.getNextPacket();
+  Packet* packet4 = leftEncoder.getNextPacket().release();
   myPackets.push_back(packet4);
 
   CHECK(packet4 != NULL);
@@ -222,7 +589,7 @@ TEST(Components, EncoderTest)
 
   rightEncoder.Reset();
 
-  Packet* packet5 = rightEncoder.getNextPacket();
+  Packet* packet5 = rightEncoder.getNextPacket().release();
   myPackets.push_back(packet5);
 
   CHECK(packet5 != NULL);
@@ -237,12 +604,12 @@ TEST(Components, SpeedControllerTest)
 {
   RedBotSpeedController lMotor(0);
 
-  myPackets.push_back(lMotor.getNextPacket());
+  myPackets.push_back(lMotor.getNextPacket().release());
 
   CHECK_EQUAL((Packet*)NULL, myPackets.back());
 
   lMotor.Set(1.0);
-  myPackets.push_back(lMotor.getNextPacket());
+  myPackets.push_back(lMotor.getNextPacket().release());
 
   CHECK(NULL != myPackets.back());
   CHECK(NULL != dynamic_cast<MotorDrivePacket*>(myPackets.back()));
@@ -255,12 +622,12 @@ TEST(Components, SpeedControllerTest)
 
   RedBotSpeedController rMotor(1);
 
-  myPackets.push_back(rMotor.getNextPacket());
+  myPackets.push_back(rMotor.getNextPacket().release());
 
   CHECK_EQUAL((Packet*)NULL, myPackets.back());
 
   rMotor.Set(-0.5);
-  myPackets.push_back(rMotor.getNextPacket());
+  myPackets.push_back(rMotor.getNextPacket().release());
 
   CHECK(NULL != myPackets.back());
   CHECK(NULL != dynamic_cast<MotorDrivePacket*>(myPackets.back()));
@@ -272,17 +639,56 @@ TEST(Components, SpeedControllerTest)
   CHECK_EQUAL(MotorDrivePacket::MOTOR_RIGHT, mDrivePacket2->getMotor());
 }
 
+TEST(Components, SpeedControllerSuppressionTest)
+{
+  OutputCache::SetKeepAliveInterval(4);
+
+  RedBotSpeedController lMotor(0);
+
+  lMotor.Set(1.0);
+  myPackets.push_back(lMotor.getNextPacket().release());
+
+  CHECK(NULL != dynamic_cast<MotorDrivePacket*>(myPackets.back()));
+
+  // Speeds that produce the same command are not sent again
+  lMotor.Set(1.0);
+  POINTERS_EQUAL(NULL, lMotor.getNextPacket().get());
+  lMotor.Set(1.2);
+  POINTERS_EQUAL(NULL, lMotor.getNextPacket().get());
+  POINTERS_EQUAL(NULL, lMotor.getNextPacket().get());
+
+  // Keep-alive
+  lMotor.Set(1.0);
+  myPackets.push_back(lMotor.getNextPacket().release());
+
+  CHECK(NULL != dynamic_cast<MotorDrivePacket*>(myPackets.back()));
+
+  lMotor.Set(-1.0);
+  myPackets.push_back(lMotor.getNextPacket().release());
+
+  CHECK(NULL != dynamic_cast<MotorDrivePacket*>(myPackets.back()));
+  CHECK_EQUAL(MotorDrivePacket::DIR_BACKWARD, static_cast<MotorDrivePacket*>(myPackets.back())->getDirection());
+
+  // Disabling suppression sends every command
+  OutputCache::SetKeepAliveInterval(0);
+
+  lMotor.Set(-1.0);
+  myPackets.push_back(lMotor.getNextPacket().release());
+
+  CHECK(NULL != dynamic_cast<MotorDrivePacket*>(myPackets.back()));
+}
+
 TEST(Components, RobotDriveSimpleTest)
 {
     RedBotSpeedController lMotor(0);
     RedBotSpeedController rMotor(1);
     frc::DifferentialDrive drive(lMotor, rMotor);
-    myPackets.push_back(lMotor.getNextPacket());
+    myPackets.push_back(lMotor.getNextPacket().release());
 
     CHECK_EQUAL((Packet*)NULL, myPackets.back());
 
     drive.ArcadeDrive(0.0, 0.0);
-    myPackets.push_back(lMotor.getNextPacket());
+    myPackets.push_back(lMotor.getNextPacket().release());
 
     CHECK(NULL != myPackets.back());
     CHECK(NULL != dynamic_cast<MotorDrivePacket*>(myPackets.back()));
@@ -292,7 +698,7 @@ TEST(Components, RobotDriveSimpleTest)
     CHECK_EQUAL(0, mDrivePacket1->getSpeed());
     CHECK_EQUAL(MotorDrivePacket::DIR_FORWARD, mDrivePacket1->getDirection());
 
-    myPackets.push_back(rMotor.getNextPacket());
+    myPackets.push_back(rMotor.getNextPacket().release());
 
     CHECK(NULL != myPackets.back());
     CHECK(NULL != dynamic_cast<MotorDrivePacket*>(myPackets.back()));
@@ -311,7 +717,7 @@ TEST(Components, RobotDriveSimpleTest)
         CHECK_EQUAL(MotorDrivePacket::MOTOR_RIGHT, mDrivePacket2->getMotor())
     }
 
-    myPackets.push_back(lMotor.getNextPacket());
+    myPackets.push_back(lMotor.getNextPacket().release());
 
     CHECK_EQUAL((Packet*)NULL, myPackets.back());
 }
@@ -326,9 +732,9 @@ TEST(Components, RobotDriveStraightTest)
 
     drive.ArcadeDrive(1.0, 0.0);
 
-    myPackets.push_back(lMotor.getNextPacket());
+    myPackets.push_back(lMotor.getNextPacket().release());
     mDrivePacket1 = dynamic_cast<MotorDrivePacket*>(myPackets.back());
-    myPackets.push_back(rMotor.getNextPacket());
+    myPackets.push_back(rMotor.getNextPacket().release());
     mDrivePacket2 = dynamic_cast<MotorDrivePacket*>(myPackets.back());
 
     CHECK(NULL != mDrivePacket1);
@@ -340,9 +746,9 @@ TEST(Components, RobotDriveStraightTest)
 
     drive.ArcadeDrive(-1.0, 0.0);
 
-    myPackets.push_back(lMotor.getNextPacket());
+    myPackets.push_back(lMotor.getNextPacket().release());
     mDrivePacket1 = dynamic_cast<MotorDrivePacket*>(myPackets.back());
-    myPackets.push_back(rMotor.getNextPacket());
+    myPackets.push_back(rMotor.getNextPacket().release());
     mDrivePacket2 = dynamic_cast<MotorDrivePacket*>(myPackets.back());
 
     CHECK(NULL != mDrivePacket1);
@@ -354,9 +760,9 @@ TEST(Components, RobotDriveStraightTest)
 
     drive.ArcadeDrive(0.5, 0.0);
 
-    myPackets.push_back(lMotor.getNextPacket());
+    myPackets.push_back(lMotor.getNextPacket().release());
     mDrivePacket1 = dynamic_cast<MotorDrivePacket*>(myPackets.back());
-    myPackets.push_back(rMotor.getNextPacket());
+    myPackets.push_back(rMotor.getNextPacket().release());
     mDrivePacket2 = dynamic_cast<MotorDrivePacket*>(myPackets.back());
 
     CHECK(NULL != mDrivePacket1);
@@ -368,9 +774,9 @@ TEST(Components, RobotDriveStraightTest)
 
     drive.ArcadeDrive(1.5, 0.0);
 
-    myPackets.push_back(lMotor.getNextPacket());
+    myPackets.push_back(lMotor.getNextPacket().release());
     mDrivePacket1 = dynamic_cast<MotorDrivePacket*>(myPackets.back());
-    myPackets.push_back(rMotor.getNextPacket());
+    myPackets.push_back(rMotor.getNextPacket().release());
     mDrivePacket2 = dynamic_cast<MotorDrivePacket*>(myPackets.back());
 
     CHECK_EQUAL((MotorDrivePacket*)NULL, mDrivePacket1);
@@ -747,8 +1153,8 @@ CheckDrive(
     RedBotSpeedController& leftController = dynamic_cast<RedBotSpeedController&>(drive.getLeftController());
     RedBotSpeedController& rightController = dynamic_cast<RedBotSpeedController&>(drive.getRightController());
 
-    packets.push_back(leftController.getNextPacket());
-    packets.push_back(rightController.getNextPacket());
+    packets.push_back(leftController.getNextPacket().release());
+    packets.push_back(rightController.getNextPacket().release());
 
     std::list<Packet*>::const_reverse_iterator packetIter = packets.rbegin();
 
@@ -796,26 +1202,26 @@ CheckConfiguration(
 
     // cycle 1: no response
 
-    requestPacket = component.getNextPacket();
+    requestPacket = component.getNextPacket().release();
     packets.push_back(requestPacket);
 
     CHECK(NULL != requestPacket);
     CHECK(NULL != dynamic_cast<PinConfigPacket*>(requestPacket));
 
-    requestPacket = component.getNextPacket();
+    requestPacket = component.getNextPacket().release();
     packets.push_back(requestPacket);
 
     POINTERS_EQUAL(NULL, requestPacket);
 
     // cycle 2: no response
 
-    requestPacket = component.getNextPacket();
+    requestPacket = component.getNextPacket().release();
     packets.push_back(requestPacket);
 
     CHECK(NULL != requestPacket);
     CHECK(NULL != dynamic_cast<PinConfigPacket*>(requestPacket));
 
-    requestPacket = component.getNextPacket();
+    requestPacket = component.getNextPacket().release();
     packets.push_back(requestPacket);
 
     POINTERS_EQUAL(NULL, requestPacket);
@@ -830,13 +1236,13 @@ CheckConfiguration(
 
     CHECK(component.processPacket(configInfoPacket2));
 
-    requestPacket = component.getNextPacket();
+    requestPacket = component.getNextPacket().release();
     packets.push_back(requestPacket);
 
     CHECK(NULL != requestPacket);
     CHECK(NULL != dynamic_cast<PinConfigPacket*>(requestPacket));
 
-    requestPacket = component.getNextPacket();
+    requestPacket = component.getNextPacket().release();
     packets.push_back(requestPacket);
 
     POINTERS_EQUAL(NULL, requestPacket);
@@ -847,13 +1253,13 @@ CheckConfiguration(
 
     CHECK(component.processPacket(configInfoPacket3));
 
-    requestPacket = component.getNextPacket();
+    requestPacket = component.getNextPacket().release();
     packets.push_back(requestPacket);
 
     CHECK(NULL != requestPacket);
     CHECK(NULL != dynamic_cast<RequestType*>(requestPacket));
 
-    requestPacket = component.getNextPacket();
+    requestPacket = component.getNextPacket().release();
     packets.push_back(requestPacket);
 
     POINTERS_EQUAL(NULL, requestPacket);
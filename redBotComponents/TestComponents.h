@@ -3,6 +3,8 @@
 
 #include "Component.h"
 #include "Packet.h"
+#include "OutputCache.h"
+#include "Clock.h"
 #include "CppUTest/TestHarness.h"
 #include <list>
 
@@ -12,7 +14,10 @@ TEST_GROUP(Components)
 
     void teardown()
     {
-        Component::ClearRegisteredComponents();
+        Clock::SetInstance(NULL);
+        OutputCache::SetKeepAliveInterval(
+                OutputCache::DEFAULT_KEEP_ALIVE_INTERVAL
+                );
 
         for(
                 std::list<Packet*>::iterator packetIter = myPackets.begin();
@@ -1,14 +1,24 @@
 
 #include "RedBotPacket.h"
+#include "PacketPool.h"
+#include "PacketHandle.h"
+#include "PacketQueue.h"
 #include "ConfigurableInterface.h"
 #include "DigitalInput.h"
 #include "DigitalOutput.h"
 #include "AnalogInput.h"
 #include "RedBotSpeedController.h"
 #include "RedBotEncoder.h"
+#include "Cobs.h"
+#include "Crc.h"
+#include "TraceRing.h"
+#include "Diagnostics.h"
 #include "TestUtils.h"
 #include <sstream>
 #include <list>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
 TEST_GROUP(Packets)
@@ -29,13 +39,16 @@ TEST_GROUP(Packets)
         }
 
         myPackets.clear();
+
+        Diagnostics::SetLevel(Diagnostics::DEFAULT_LEVEL);
     }
 
     Packet* readPacket(
             std::istream& inputStream
             )
     {
-        return Packet::Read(inputStream, myPacketGen);
+        // The packet is deleted with the others at teardown
+        return Packet::Read(inputStream, myPacketGen).release();
     }
 };
 
@@ -528,6 +541,52 @@ TEST(Packets, AcknowledgePacket)
     delete packet2;
 }
 
+TEST(Packets, SubscribePacket)
+{
+    SubscribePacket subPacket1(DigitalInputPacket(3), 20);
+    std::stringstream packetStream;
+
+    CHECK(subPacket1.isValid());
+    CHECK_EQUAL(RedBotPacket::BID_DINPUT, subPacket1.getRequestID());
+    CHECK_EQUAL(3, subPacket1.getRequestAddress());
+    CHECK_EQUAL(20, subPacket1.getPeriod());
+
+    packetStream << subPacket1;
+
+    BPACKET_EQUAL("\xFF\x0A\x03\x03\x01\x15\xFF", packetStream.str().c_str());
+
+    // Periods are clamped to what the two 7-bit chunks can carry
+    SubscribePacket subPacket2(EncoderInputPacket(true), 20000);
+
+    CHECK_EQUAL(SubscribePacket::MAX_PERIOD, subPacket2.getPeriod());
+
+    packetStream.str("");
+    packetStream << subPacket2;
+
+    BPACKET_EQUAL("\xFF\x0A\x07\x02\x80\x80\xFF", packetStream.str().c_str());
+
+    // Only requests with a single content byte can be subscribed to
+    SubscribePacket subPacket3(MotorDrivePacket(MotorDrivePacket::MOTOR_LEFT, 0.5), 20);
+
+    CHECK_FALSE(subPacket3.isValid());
+
+    packetStream.str("\xFF\x0A\x04\x02\x03\x05\xFF");
+    Packet* packet4 = readPacket(packetStream);
+
+    CHECK(NULL != packet4);
+    CHECK(NULL != dynamic_cast<SubscribePacket*>(packet4));
+
+    SubscribePacket* subPacket4 = static_cast<SubscribePacket*>(packet4);
+
+    CHECK(subPacket4->isValid());
+    CHECK_EQUAL(RedBotPacket::BID_AINPUT, subPacket4->getRequestID());
+    CHECK_EQUAL(2, subPacket4->getRequestAddress());
+    CHECK_EQUAL(260, subPacket4->getPeriod());
+    CHECK(*subPacket4 == SubscribePacket(AnalogInputPacket(1), 260));
+
+    delete packet4;
+}
+
 TEST(Packets, DigitalOutputPacketXML)
 {
     std::ostringstream packetStream;
@@ -857,6 +916,150 @@ TEST(Packets, EncoderCountPacketXML)
   CHECK_EQUAL(expectedOutput, packetStream.str());
 }
 
+TEST(Packets, FramePacket)
+{
+    FramePacket framePacket1(&myPacketGen);
+
+    CHECK_EQUAL(RedBotPacket::TYPE_FRAME, framePacket1.getType());
+    CHECK_TRUE(framePacket1.add(new DigitalOutputPacket(4, true)));
+    CHECK_TRUE(framePacket1.add(new DigitalInputPacket(6)));
+    CHECK_EQUAL(5, framePacket1.getContentLength());
+
+    std::ostringstream outputStream;
+    outputStream << framePacket1;
+
+    BPACKET_EQUAL("\xFF\x09\x02\x04\x02\x03\x06\xFF", outputStream.str().c_str());
+
+    std::istringstream inputStream;
+    inputStream.str("\xFF\x86\x82\x81\x06\x02\xFF");
+
+    Packet* packet2 = readPacket(inputStream);
+    myPackets.push_back(packet2);
+
+    CHECK(packet2 != NULL);
+    CHECK(NULL != dynamic_cast<FrameValuesPacket*>(packet2));
+
+    FrameValuesPacket* framePacket2 = static_cast<FrameValuesPacket*>(packet2);
+
+    CHECK_TRUE(framePacket2->isValid());
+    CHECK_EQUAL(2, framePacket2->getPacketCount());
+    CHECK_TRUE(framePacket2->getPacket(0)->isAcknowledge());
+    CHECK(*(framePacket2->getPacket(1)) == DigitalValuePacket(6, true));
+
+    PacketQueue packets;
+    CHECK_TRUE(myPacketGen.unpackFramePacket(*framePacket2, packets));
+    CHECK_EQUAL(2, packets.size());
+    CHECK_EQUAL(0, framePacket2->getPacketCount());
+
+    while (packets.empty() == false)
+    {
+        myPackets.push_back(packets.pop().release());
+    }
+
+    // Truncated embedded packet
+    inputStream.clear();
+    inputStream.str("\xFF\x86\x81\x06\xFF");
+
+    Packet* packet3 = readPacket(inputStream);
+    myPackets.push_back(packet3);
+
+    CHECK_EQUAL((Packet*)NULL, packet3);
+}
+
+TEST(Packets, FramePacketCapacity)
+{
+    PacketQueue packets;
+
+    for(
+            size_t packetIdx = 0;
+            packetIdx < 15;
+            ++packetIdx
+       )
+    {
+        packets.push(
+                PacketHandle(
+                    new MotorDrivePacket(
+                        MotorDrivePacket::MOTOR_LEFT,
+                        100,
+                        MotorDrivePacket::DIR_FORWARD
+                        )
+                    )
+                );
+    }
+
+    Packet* packet1 = myPacketGen.createFramePacket(packets).release();
+    myPackets.push_back(packet1);
+
+    FramePacket* framePacket1 = dynamic_cast<FramePacket*>(packet1);
+    CHECK(framePacket1 != NULL);
+    CHECK_EQUAL(11, framePacket1->getPacketCount());
+    CHECK_EQUAL(55, framePacket1->getContentLength());
+    CHECK_EQUAL(4, packets.size());
+
+    Packet* packet2 = myPacketGen.createFramePacket(packets).release();
+    myPackets.push_back(packet2);
+
+    CHECK(packet2 != NULL);
+    CHECK_EQUAL(0, packets.size());
+
+    // Frames leave room for the responses to their packets
+    for(
+            size_t packetIdx = 0;
+            packetIdx < 20;
+            ++packetIdx
+       )
+    {
+        packets.push(PacketHandle(new AnalogInputPacket(3)));
+    }
+
+    Packet* packet4 = myPacketGen.createFramePacket(packets).release();
+    myPackets.push_back(packet4);
+
+    FramePacket* framePacket4 = dynamic_cast<FramePacket*>(packet4);
+    CHECK(framePacket4 != NULL);
+    CHECK_EQUAL(14, framePacket4->getPacketCount());
+    CHECK_EQUAL(6, packets.size());
+
+    while (packets.empty() == false)
+    {
+        myPackets.push_back(packets.pop().release());
+    }
+
+    // An empty queue makes an empty frame
+    Packet* packet3 = myPacketGen.createFramePacket(packets).release();
+    myPackets.push_back(packet3);
+
+    std::ostringstream outputStream;
+    outputStream << *packet3;
+
+    BPACKET_EQUAL("\xFF\x09\xFF", outputStream.str().c_str());
+
+    // Frames cannot be nested
+    packets.push(PacketHandle(new FramePacket()));
+
+    CHECK_TRUE(myPacketGen.createFramePacket(packets).isNull());
+    CHECK_EQUAL(1, packets.size());
+
+    myPackets.push_back(packets.pop().release());
+}
+
+TEST(Packets, FramePacketOverflow)
+{
+    // A frame of more zero-length packets than a frame may hold
+    unsigned char frameData[Packet::MAX_BINARY_SIZE];
+    size_t decodedSize = 0;
+
+    memset(frameData, RedBotPacket::BID_PING, sizeof(frameData));
+    frameData[0] = Packet::BINARY_BOUND;
+    frameData[1] = RedBotPacket::BID_FRAME;
+    frameData[sizeof(frameData) - 1] = Packet::BINARY_BOUND;
+
+    CHECK_TRUE(
+            Packet::Decode(frameData, sizeof(frameData), myPacketGen, &decodedSize).isNull()
+            );
+    CHECK_EQUAL(sizeof(frameData), decodedSize);
+}
+
 TEST(Packets, InvalidReadPacket)
 {
     std::istringstream inputStream;
@@ -880,6 +1083,782 @@ TEST(Packets, InvalidReadPacket)
     BPACKET_EQUAL("\xFF\x81\x0A\xFF", dValPacketData.c_str());
 }
 
+TEST(Packets, EncodePacket)
+{
+    unsigned char packetData[Packet::MAX_BINARY_SIZE];
+
+    MotorDrivePacket mDrivePacket(
+            MotorDrivePacket::MOTOR_RIGHT,
+            255,
+            MotorDrivePacket::DIR_FORWARD
+            );
+    size_t packetSize = mDrivePacket.encode(packetData, sizeof(packetData));
+
+    CHECK_EQUAL(7, packetSize);
+    CHECK_EQUAL(0, memcmp("\xFF\x06\x01\x01\x10\x10\xFF", packetData, 7));
+
+    // Too small a buffer writes nothing
+    CHECK_EQUAL(0, mDrivePacket.encode(packetData, 6));
+
+    EncoderCountPacket eCountPacket(false, -2);
+    packetSize = eCountPacket.encode(packetData, sizeof(packetData));
+
+    std::ostringstream outputStream;
+    outputStream << eCountPacket;
+
+    CHECK_EQUAL(outputStream.str().size(), packetSize);
+    CHECK_EQUAL(
+            0,
+            memcmp(outputStream.str().data(), packetData, packetSize)
+            );
+}
+
+TEST(Packets, DecodePacket)
+{
+    const unsigned char packetData[] =
+        "\x00\xFF\x06\x02\x02\x09\x01\xFF\xFF\x81\x0A\x00\xFF";
+    size_t decodedSize = 0;
+    std::string decodedData;
+
+    // Noise before a packet is consumed one byte at a time
+    Packet* packet1 = Packet::Decode(
+            packetData,
+            sizeof(packetData) - 1,
+            myPacketGen,
+            &decodedSize,
+            &decodedData
+            ).release();
+
+    CHECK_EQUAL((Packet*)NULL, packet1);
+    CHECK_EQUAL(1, decodedSize);
+
+    Packet* packet2 = Packet::Decode(
+            packetData + 1,
+            sizeof(packetData) - 2,
+            myPacketGen,
+            &decodedSize,
+            &decodedData
+            ).release();
+    myPackets.push_back(packet2);
+
+    CHECK(NULL != dynamic_cast<MotorDrivePacket*>(packet2));
+    CHECK_EQUAL(7, decodedSize);
+    BPACKET_EQUAL("\xFF\x06\x02\x02\x09\x01\xFF", decodedData.c_str());
+
+    MotorDrivePacket* mDrivePacket = static_cast<MotorDrivePacket*>(packet2);
+
+    CHECK_EQUAL(MotorDrivePacket::MOTOR_LEFT, mDrivePacket->getMotor());
+    CHECK_EQUAL(128, mDrivePacket->getSpeed());
+    CHECK_EQUAL(MotorDrivePacket::DIR_BACKWARD, mDrivePacket->getDirection());
+
+    // The next packet starts right after the consumed bytes
+    Packet* packet3 = Packet::Decode(
+            packetData + 8,
+            sizeof(packetData) - 9,
+            myPacketGen,
+            &decodedSize
+            ).release();
+    myPackets.push_back(packet3);
+
+    CHECK(NULL != dynamic_cast<DigitalValuePacket*>(packet3));
+    CHECK_EQUAL(5, decodedSize);
+    CHECK_EQUAL(0x0A, static_cast<DigitalValuePacket*>(packet3)->getPin());
+
+    // Truncated packets are invalid
+    CHECK_TRUE(
+            Packet::Decode(packetData + 8, 4, myPacketGen, &decodedSize).isNull()
+            );
+    CHECK_EQUAL(4, decodedSize);
+}
+
+TEST(Packets, DiagnosticsLevelTest)
+{
+    const unsigned char packetData[] = "\xFF\x06\x02\x02\x09\x01\xFF";
+    const unsigned char noiseData[] = "\x00\xFF";
+    size_t decodedSize = 0;
+    std::string decodedData("stale");
+
+    // Without diagnostics, nothing is dumped
+    Diagnostics::SetLevel(Diagnostics::LEVEL_OFF);
+    Packet* packet1 = Packet::Decode(
+            packetData,
+            sizeof(packetData) - 1,
+            myPacketGen,
+            &decodedSize,
+            &decodedData
+            ).release();
+    myPackets.push_back(packet1);
+
+    CHECK(NULL != packet1);
+    CHECK_TRUE(decodedData.empty());
+    CHECK_TRUE(
+            Packet::Decode(noiseData, 1, myPacketGen, &decodedSize, &decodedData).isNull()
+            );
+    CHECK_TRUE(decodedData.empty());
+
+    // Read sizes are still given, for valid and corrupt packets alike
+    size_t readSize = 0;
+    std::istringstream inputStream(std::string((const char*)packetData, 7));
+    Packet* packet3 = Packet::Read(
+            inputStream,
+            myPacketGen,
+            &readSize,
+            &decodedData
+            ).release();
+    myPackets.push_back(packet3);
+
+    CHECK(NULL != packet3);
+    CHECK_EQUAL(7, readSize);
+    CHECK_TRUE(decodedData.empty());
+
+    std::istringstream corruptStream(std::string("\xFF\x81\x06\x01\x00\x10\xFF", 7));
+    CHECK_TRUE(
+            Packet::Read(
+                corruptStream,
+                myPacketGen,
+                &readSize,
+                &decodedData,
+                Crc::TYPE_CRC8
+                ).isNull()
+            );
+    CHECK_EQUAL(7, readSize);
+    CHECK_TRUE(decodedData.empty());
+
+    // Only invalid packets are dumped with errors
+    Diagnostics::SetLevel(Diagnostics::LEVEL_ERRORS);
+    Packet* packet2 = Packet::Decode(
+            packetData,
+            sizeof(packetData) - 1,
+            myPacketGen,
+            &decodedSize,
+            &decodedData
+            ).release();
+    myPackets.push_back(packet2);
+
+    CHECK(NULL != packet2);
+    CHECK_TRUE(decodedData.empty());
+    CHECK_TRUE(
+            Packet::Decode(noiseData, 1, myPacketGen, &decodedSize, &decodedData).isNull()
+            );
+    CHECK_EQUAL(1, decodedData.size());
+}
+
+TEST(Packets, EncodeCobsPacket)
+{
+    unsigned char packetData[Packet::MAX_BINARY_SIZE];
+
+    // Native contents use full 8-bit fields
+    MotorDrivePacket mDrivePacket(
+            MotorDrivePacket::MOTOR_RIGHT,
+            255,
+            MotorDrivePacket::DIR_FORWARD
+            );
+    size_t packetSize = mDrivePacket.encodeCobs(packetData, sizeof(packetData));
+
+    CHECK_EQUAL(6, packetSize);
+    CHECK_EQUAL(0, memcmp("\x05\x06\x01\x01\xFF\x00", packetData, 6));
+
+    // Zero bytes are replaced by block codes
+    EncoderCountPacket eCountPacket(false, 256);
+    packetSize = eCountPacket.encodeCobs(packetData, sizeof(packetData));
+
+    CHECK_EQUAL(8, packetSize);
+    CHECK_EQUAL(0, memcmp("\x03\x85\x02\x01\x02\x01\x01\x00", packetData, 8));
+
+    AnalogValuePacket aValuePacket(2, 1023);
+    packetSize = aValuePacket.encodeCobs(packetData, sizeof(packetData));
+
+    CHECK_EQUAL(6, packetSize);
+    CHECK_EQUAL(0, memcmp("\x05\x83\x03\x03\xFF\x00", packetData, 6));
+
+    // Too small a buffer writes nothing
+    CHECK_EQUAL(0, mDrivePacket.encodeCobs(packetData, 5));
+}
+
+TEST(Packets, DecodeCobsPacket)
+{
+    std::string decodedData;
+
+    const unsigned char countData[] = "\x07\x85\x01\xFF\xFF\xFF\xFE\x00";
+    Packet* packet1 = Packet::DecodeCobs(
+            countData,
+            sizeof(countData) - 1,
+            myPacketGen,
+            &decodedData
+            ).release();
+    myPackets.push_back(packet1);
+
+    CHECK(NULL != dynamic_cast<EncoderCountPacket*>(packet1));
+    BPACKET_EQUAL("\x07\x85\x01\xFF\xFF\xFF\xFE", decodedData.c_str());
+
+    EncoderCountPacket* eCountPacket = static_cast<EncoderCountPacket*>(packet1);
+
+    CHECK(eCountPacket->isRight());
+    CHECK_EQUAL(-2, eCountPacket->getCount());
+
+    // Periods are carried whole
+    const unsigned char subscribeData[] = "\x04\x0A\x04\x02\x02\x04";
+    Packet* packet2 = Packet::DecodeCobs(
+            subscribeData,
+            sizeof(subscribeData) - 1,
+            myPacketGen
+            ).release();
+    myPackets.push_back(packet2);
+
+    CHECK(NULL != dynamic_cast<SubscribePacket*>(packet2));
+    CHECK_EQUAL(2, static_cast<SubscribePacket*>(packet2)->getRequestAddress());
+    CHECK_EQUAL(4, static_cast<SubscribePacket*>(packet2)->getPeriod());
+
+    // Frames split their contents by native lengths
+    const unsigned char frameData[] = "\x07\x86\x82\x83\x04\x01\xF4\x00";
+    Packet* packet3 = Packet::DecodeCobs(
+            frameData,
+            sizeof(frameData) - 1,
+            myPacketGen
+            ).release();
+    myPackets.push_back(packet3);
+
+    CHECK(NULL != dynamic_cast<FrameValuesPacket*>(packet3));
+
+    FramePacket* framePacket = static_cast<FramePacket*>(packet3);
+
+    CHECK_EQUAL(2, framePacket->getPacketCount());
+    CHECK(framePacket->getPacket(0)->isAcknowledge());
+    CHECK_EQUAL(
+            500,
+            static_cast<const AnalogValuePacket*>(framePacket->getPacket(1))->getValue()
+            );
+
+    unsigned char packetData[Packet::MAX_BINARY_SIZE];
+    CHECK_EQUAL(
+            sizeof(frameData) - 1,
+            framePacket->encodeCobs(packetData, sizeof(packetData))
+            );
+    CHECK_EQUAL(0, memcmp(frameData, packetData, sizeof(frameData) - 1));
+
+    // Blocks that run past the frame are malformed
+    const unsigned char truncatedData[] = "\x05\x06\x01\x00";
+    CHECK_TRUE(
+            Packet::DecodeCobs(truncatedData, sizeof(truncatedData) - 1, myPacketGen).isNull()
+            );
+
+    // Unknown binary IDs are dropped
+    const unsigned char unknownData[] = "\x02\x7F";
+    CHECK_TRUE(
+            Packet::DecodeCobs(unknownData, sizeof(unknownData) - 1, myPacketGen).isNull()
+            );
+}
+
+TEST(Packets, VersionPacket)
+{
+    std::stringstream packetStream;
+
+    VersionPacket versionPacket(Packet::PROTOCOL_COBS);
+
+    CHECK(versionPacket.isValid());
+    CHECK_EQUAL(Packet::PROTOCOL_COBS, versionPacket.getVersion());
+
+    packetStream << versionPacket;
+
+    BPACKET_EQUAL("\xFF\x0B\x02\xFF", packetStream.str().c_str());
+
+    packetStream.str("\xFF\x87\x01\xFF");
+    Packet* packet = readPacket(packetStream);
+    myPackets.push_back(packet);
+
+    CHECK(NULL != dynamic_cast<VersionInfoPacket*>(packet));
+
+    unsigned int version = 0;
+    CHECK(myPacketGen.getSelectedVersion(*packet, version));
+    CHECK_EQUAL(Packet::PROTOCOL_BOUNDED, version);
+
+    // Only version info carries a selected version
+    CHECK_FALSE(myPacketGen.getSelectedVersion(AcknowledgePacket(), version));
+
+    CHECK_FALSE(VersionPacket(0).isValid());
+}
+
+
+TEST(Packets, ChecksumPacket)
+{
+    unsigned char packetData[Packet::MAX_BINARY_SIZE];
+    DigitalOutputPacket dOutPacket(4, true);
+
+    // Checksums between bounds are split into 7-bit chunks
+    size_t packetSize = dOutPacket.encodeChecked(packetData, sizeof(packetData), Crc::TYPE_CRC16);
+
+    CHECK_EQUAL(8, packetSize);
+    CHECK_EQUAL(0, memcmp("\xFF\x02\x04\x02\x01\x1C\x7A\xFF", packetData, 8));
+
+    packetSize = dOutPacket.encodeCobs(packetData, sizeof(packetData), Crc::TYPE_CRC16);
+
+    CHECK_EQUAL(7, packetSize);
+    CHECK_EQUAL(0, memcmp("\x06\x02\x04\x02\x4E\x7A\x00", packetData, 7));
+
+    // Packets are decoded once their checksum matches
+    std::string decodedData;
+    size_t decodedSize = 0;
+    const unsigned char valueData[] = "\xFF\x81\x06\x02\x00\x10\xFF\xFF\x82";
+    Packet* packet1 = Packet::Decode(
+            valueData,
+            sizeof(valueData) - 1,
+            myPacketGen,
+            &decodedSize,
+            &decodedData,
+            Crc::TYPE_CRC8
+            ).release();
+    myPackets.push_back(packet1);
+
+    CHECK(packet1 != NULL);
+    CHECK(*packet1 == DigitalValuePacket(6, true));
+    CHECK_EQUAL(7, decodedSize);
+    BPACKET_EQUAL("\xFF\x81\x06\x02\x00\x10\xFF", decodedData.c_str());
+
+    // Corrupted packets are consumed whole
+    const unsigned char corruptData[] = "\xFF\x81\x06\x01\x00\x10\xFF\xFF\x82";
+    CHECK_TRUE(
+            Packet::Decode(
+                corruptData,
+                sizeof(corruptData) - 1,
+                myPacketGen,
+                &decodedSize,
+                NULL,
+                Crc::TYPE_CRC8
+                ).isNull()
+            );
+    CHECK_EQUAL(7, decodedSize);
+
+    std::istringstream inputStream(std::string("\xFF\x89\x03\x42\x51\xFF", 6));
+    Packet* packet2 = Packet::Read(inputStream, myPacketGen, NULL, NULL, Crc::TYPE_CRC16).release();
+    myPackets.push_back(packet2);
+
+    CHECK(packet2 != NULL);
+    CHECK(packet2->isNegativeAcknowledge());
+    CHECK_FALSE(packet2->isAcknowledge());
+
+    const unsigned char frameData[] = "\x05\x81\x06\x02\x10\x00";
+    Packet* packet3 = Packet::DecodeCobs(
+            frameData,
+            sizeof(frameData) - 1,
+            myPacketGen,
+            NULL,
+            Crc::TYPE_CRC8
+            ).release();
+    myPackets.push_back(packet3);
+
+    CHECK(packet3 != NULL);
+    CHECK(*packet3 == DigitalValuePacket(6, true));
+
+    // A frame without its checksum is corrupted
+    CHECK_TRUE(
+            Packet::DecodeCobs(frameData, sizeof(frameData) - 1, myPacketGen, NULL, Crc::TYPE_CRC16).isNull()
+            );
+
+    ChecksumPacket checksumPacket(Crc::TYPE_CRC8);
+    std::ostringstream outputStream;
+    outputStream << checksumPacket;
+
+    BPACKET_EQUAL("\xFF\x0C\x01\xFF", outputStream.str().c_str());
+
+    Crc::Type checksum = Crc::TYPE_NONE;
+    CHECK(myPacketGen.getSelectedChecksum(ChecksumInfoPacket(Crc::TYPE_CRC16), checksum));
+    CHECK_EQUAL(Crc::TYPE_CRC16, checksum);
+    CHECK_FALSE(myPacketGen.getSelectedChecksum(AcknowledgePacket(), checksum));
+}
+
+
+TEST_GROUP(Crc)
+{
+};
+
+TEST(Crc, ComputeTest)
+{
+    const unsigned char* data = (const unsigned char*)"123456789";
+
+    CHECK_EQUAL(0xF4, Crc::Compute(Crc::TYPE_CRC8, data, 9));
+    CHECK_EQUAL(0x29B1, Crc::Compute(Crc::TYPE_CRC16, data, 9));
+
+    CHECK_EQUAL(0, Crc::GetSize(Crc::TYPE_NONE));
+    CHECK_EQUAL(1, Crc::GetSize(Crc::TYPE_CRC8));
+    CHECK_EQUAL(2, Crc::GetSize(Crc::TYPE_CRC8, 7));
+    CHECK_EQUAL(3, Crc::GetSize(Crc::TYPE_CRC16, 7));
+}
+
+TEST(Crc, WriteTest)
+{
+    const unsigned char* data = (const unsigned char*)"123456789";
+    unsigned char checked[12];
+
+    memcpy(checked, data, 9);
+
+    CHECK_EQUAL(2, Crc::Write(Crc::TYPE_CRC16, data, 9, checked + 9, 3));
+    CHECK_EQUAL(0, memcmp("\x29\xB1", checked + 9, 2));
+    CHECK(Crc::Check(Crc::TYPE_CRC16, checked, 11));
+
+    CHECK_EQUAL(3, Crc::Write(Crc::TYPE_CRC16, data, 9, checked + 9, 3, 7));
+    CHECK_EQUAL(0, memcmp("\x00\x53\x31", checked + 9, 3));
+    CHECK(Crc::Check(Crc::TYPE_CRC16, checked, 12, 7));
+
+    // Any flipped bit is caught
+    checked[4] ^= 0x10;
+    CHECK_FALSE(Crc::Check(Crc::TYPE_CRC16, checked, 12, 7));
+
+    CHECK_EQUAL(0, Crc::Write(Crc::TYPE_CRC16, data, 9, checked, 1));
+}
+
+TEST_GROUP(Cobs)
+{
+    void checkRoundTrip(
+            const unsigned char*    data,
+            size_t                  dataSize,
+            const unsigned char*    expectedData,
+            size_t                  expectedSize
+            )
+    {
+        unsigned char encodedData[300];
+        unsigned char decodedData[300];
+
+        size_t encodedSize = Cobs::Encode(data, dataSize, encodedData, sizeof(encodedData));
+
+        CHECK_EQUAL(expectedSize, encodedSize);
+        CHECK(encodedSize <= Cobs::GetMaxEncodedSize(dataSize));
+        CHECK_EQUAL(0, memcmp(expectedData, encodedData, expectedSize));
+        CHECK(memchr(encodedData, Cobs::DELIMITER, encodedSize) == NULL);
+
+        CHECK_EQUAL(
+                dataSize,
+                Cobs::Decode(encodedData, encodedSize, decodedData, sizeof(decodedData))
+                );
+        CHECK_EQUAL(0, memcmp(data, decodedData, dataSize));
+    }
+};
+
+TEST(Cobs, EncodeTest)
+{
+    checkRoundTrip(
+            (const unsigned char*)"\x11\x22\x00\x33",
+            4,
+            (const unsigned char*)"\x03\x11\x22\x02\x33",
+            5
+            );
+    checkRoundTrip(
+            (const unsigned char*)"\x00\x00",
+            2,
+            (const unsigned char*)"\x01\x01\x01",
+            3
+            );
+    checkRoundTrip(
+            (const unsigned char*)"\x11\x00",
+            2,
+            (const unsigned char*)"\x02\x11\x01",
+            3
+            );
+
+    // Runs of 254 non-zero bytes fill a block without standing for a zero
+    unsigned char data[300];
+    unsigned char expectedData[300];
+    for (size_t dataIdx = 0; dataIdx < 255; ++dataIdx)
+    {
+        data[dataIdx] = (unsigned char)(dataIdx + 1);
+    }
+
+    expectedData[0] = 0xFF;
+    memcpy(expectedData + 1, data, 254);
+    checkRoundTrip(data, 254, expectedData, 255);
+
+    expectedData[255] = 0x02;
+    expectedData[256] = data[254];
+    checkRoundTrip(data, 255, expectedData, 257);
+}
+
+TEST(Cobs, DecodeTest)
+{
+    unsigned char decodedData[8];
+
+    // Decoding stops at the delimiter
+    CHECK_EQUAL(
+            2,
+            Cobs::Decode(
+                (const unsigned char*)"\x03\x11\x22\x00\x02\x33",
+                6,
+                decodedData,
+                sizeof(decodedData)
+                )
+            );
+
+    // Blocks must not run past the frame or the buffer
+    CHECK_EQUAL(
+            0,
+            Cobs::Decode(
+                (const unsigned char*)"\x04\x11\x22\x00",
+                4,
+                decodedData,
+                sizeof(decodedData)
+                )
+            );
+    CHECK_EQUAL(
+            0,
+            Cobs::Decode(
+                (const unsigned char*)"\x03\x11\x22",
+                3,
+                decodedData,
+                1
+                )
+            );
+}
+
+
+TEST_GROUP(PacketPool)
+{
+};
+
+TEST(PacketPool, ReuseTest)
+{
+    size_t heapAllocationCount = PacketPool::GetHeapAllocationCount();
+    size_t outstandingCount = PacketPool::GetOutstandingCount();
+
+    Packet* packet1 = new DigitalOutputPacket(3, true);
+    void* packetMemory1 = packet1;
+
+    CHECK_EQUAL(outstandingCount + 1, PacketPool::GetOutstandingCount());
+
+    delete packet1;
+
+    CHECK_EQUAL(outstandingCount, PacketPool::GetOutstandingCount());
+
+    // A freed slot is handed out again for a packet of the same size
+    Packet* packet2 = new DigitalOutputPacket(4, false);
+
+    POINTERS_EQUAL(packetMemory1, packet2);
+
+    delete packet2;
+
+    // Frames are pooled as well
+    FramePacket* framePacket = new FramePacket();
+    framePacket->add(new PingPacket());
+    framePacket->add(new DigitalInputPacket(5));
+    delete framePacket;
+
+    CHECK_EQUAL(outstandingCount, PacketPool::GetOutstandingCount());
+    CHECK_EQUAL(heapAllocationCount, PacketPool::GetHeapAllocationCount());
+}
+
+TEST(PacketPool, HeapFallbackTest)
+{
+    size_t heapAllocationCount = PacketPool::GetHeapAllocationCount();
+    size_t outstandingCount = PacketPool::GetOutstandingCount();
+    size_t largeSize = (PacketPool::NUM_SLOT_SIZES * PacketPool::SLOT_SIZE_STEP) + 1;
+
+    void* memory = PacketPool::Allocate(largeSize);
+
+    CHECK(memory != NULL);
+    CHECK_EQUAL(heapAllocationCount + 1, PacketPool::GetHeapAllocationCount());
+    CHECK_EQUAL(outstandingCount + 1, PacketPool::GetOutstandingCount());
+
+    PacketPool::Free(memory, largeSize);
+
+    CHECK_EQUAL(outstandingCount, PacketPool::GetOutstandingCount());
+}
+
+TEST_GROUP(PacketHandle)
+{
+};
+
+TEST(PacketHandle, OwnershipTest)
+{
+    size_t outstandingCount = PacketPool::GetOutstandingCount();
+
+    PacketHandle handle1;
+
+    CHECK_TRUE(handle1.isNull());
+
+    handle1.reset(new DigitalInputPacket(7));
+
+    CHECK_FALSE(handle1.isNull());
+    CHECK(NULL != dynamic_cast<DigitalInputPacket*>(handle1.get()));
+
+    // Moving passes ownership
+    PacketHandle handle2(std::move(handle1));
+
+    CHECK_TRUE(handle1.isNull());
+    CHECK_EQUAL(7, static_cast<DigitalInputPacket&>(*handle2).getPin());
+
+    handle1 = std::move(handle2);
+
+    CHECK_TRUE(handle2.isNull());
+    CHECK_EQUAL(outstandingCount + 1, PacketPool::GetOutstandingCount());
+
+    // Resetting deletes the owned packet
+    handle1.reset();
+
+    CHECK_EQUAL(outstandingCount, PacketPool::GetOutstandingCount());
+
+    Packet* packet = new PingPacket();
+    {
+        PacketHandle handle3(packet);
+
+        CHECK_EQUAL(packet, handle3.get());
+        CHECK_EQUAL(packet, handle3.release());
+        CHECK_TRUE(handle3.isNull());
+    }
+
+    CHECK_EQUAL(outstandingCount + 1, PacketPool::GetOutstandingCount());
+
+    delete packet;
+}
+
+TEST_GROUP(PacketQueue)
+{
+};
+
+TEST(PacketQueue, RingTest)
+{
+    size_t outstandingCount = PacketPool::GetOutstandingCount();
+
+    PacketQueue packets;
+
+    CHECK_TRUE(packets.empty());
+    CHECK_EQUAL(0, packets.getCapacity());
+
+    // Wrap around the ring before it grows
+    for(
+            unsigned int pin = 0;
+            pin < PacketQueue::DEFAULT_CAPACITY;
+            ++pin
+       )
+    {
+        packets.push(PacketHandle(new DigitalInputPacket(pin)));
+    }
+
+    packets.pop();
+    packets.pop();
+    packets.push(PacketHandle(new DigitalInputPacket(16)));
+    packets.push(PacketHandle(new DigitalInputPacket(17)));
+    packets.push(PacketHandle(new DigitalInputPacket(18)));
+
+    CHECK_EQUAL(17, packets.size());
+    CHECK_EQUAL(2 * PacketQueue::DEFAULT_CAPACITY, packets.getCapacity());
+
+    // Packets leave in the order they were pushed
+    for(
+            unsigned int pin = 2;
+            pin < 10;
+            ++pin
+       )
+    {
+        PacketHandle packet = packets.pop();
+
+        CHECK_EQUAL(pin, static_cast<DigitalInputPacket&>(*packet).getPin());
+    }
+
+    // Clearing deletes the queued packets and keeps the capacity
+    packets.clear();
+
+    CHECK_TRUE(packets.empty());
+    CHECK_EQUAL(2 * PacketQueue::DEFAULT_CAPACITY, packets.getCapacity());
+    CHECK_EQUAL(outstandingCount, PacketPool::GetOutstandingCount());
+}
+
+TEST_GROUP(TraceRing)
+{
+};
+
+TEST(TraceRing, AddTest)
+{
+    TraceRing trace(3);
+    TraceRing::Record record;
+    const unsigned char sentData[] = {0xFF, 0x01, 0xFF};
+    const unsigned char receivedData[] = {0xFF, 0x8F};
+
+    CHECK_EQUAL(4, trace.getCapacity());
+    CHECK_EQUAL(0, trace.getRecordCount());
+    CHECK_FALSE(trace.getRecord(0, record));
+
+    trace.add(TraceRing::DIRECTION_SENT, 0, sentData, sizeof(sentData));
+    trace.add(TraceRing::DIRECTION_RECEIVED, 2, receivedData, sizeof(receivedData));
+
+    CHECK_EQUAL(2, trace.getRecordCount());
+
+    CHECK_TRUE(trace.getRecord(0, record));
+    CHECK_EQUAL(TraceRing::DIRECTION_SENT, record.direction);
+    CHECK_EQUAL(0, record.status);
+    CHECK_EQUAL(sizeof(sentData), record.getDataSize());
+    CHECK_EQUAL(0, memcmp(sentData, record.data, sizeof(sentData)));
+
+    CHECK_TRUE(trace.getRecord(1, record));
+    CHECK_EQUAL(TraceRing::DIRECTION_RECEIVED, record.direction);
+    CHECK_EQUAL(2, record.status);
+    CHECK_EQUAL(sizeof(receivedData), record.getDataSize());
+    CHECK_EQUAL(0, memcmp(receivedData, record.data, sizeof(receivedData)));
+
+    // Once the ring is full, the oldest records are overwritten
+    for(
+            size_t recordIdx = 0;
+            recordIdx < 4;
+            ++recordIdx
+       )
+    {
+        trace.add(TraceRing::DIRECTION_SENT, 0, sentData, sizeof(sentData));
+    }
+
+    CHECK_EQUAL(6, trace.getRecordCount());
+    CHECK_FALSE(trace.getRecord(1, record));
+    CHECK_TRUE(trace.getRecord(2, record));
+    CHECK_TRUE(trace.getRecord(5, record));
+    CHECK_FALSE(trace.getRecord(6, record));
+}
+
+TEST(TraceRing, LongFrameTest)
+{
+    TraceRing trace(1);
+    TraceRing::Record record;
+    unsigned char frameData[TraceRing::MAX_DATA_SIZE + 10];
+
+    memset(frameData, 0x55, sizeof(frameData));
+    trace.add(TraceRing::DIRECTION_RECEIVED, 0, frameData, sizeof(frameData));
+
+    // The frame is cut, but its full size is kept
+    CHECK_TRUE(trace.getRecord(0, record));
+    CHECK_EQUAL(sizeof(frameData), record.size);
+    CHECK_EQUAL(TraceRing::MAX_DATA_SIZE, record.getDataSize());
+    CHECK_EQUAL(0, memcmp(frameData, record.data, TraceRing::MAX_DATA_SIZE));
+}
+
+TEST(TraceRing, FileTest)
+{
+    const char* dumpPath = "/tmp/TestTraceRing.dump";
+    const char* mapPath = "/tmp/TestTraceRing.map";
+    const unsigned char frameData[] = {0xFF, 0x01, 0xFF};
+    TraceRing trace(8);
+    TraceRing::Record record;
+    struct stat dumpStat;
+    struct stat mapStat;
+
+    trace.add(TraceRing::DIRECTION_SENT, 0, frameData, sizeof(frameData));
+
+    CHECK_TRUE(trace.dump(dumpPath));
+    CHECK_EQUAL(0, stat(dumpPath, &dumpStat));
+
+    // Records added before the file is mapped are kept
+    CHECK_TRUE(trace.mapFile(mapPath));
+    trace.add(TraceRing::DIRECTION_RECEIVED, 1, frameData, sizeof(frameData));
+
+    CHECK_EQUAL(2, trace.getRecordCount());
+    CHECK_TRUE(trace.getRecord(0, record));
+    CHECK_EQUAL(TraceRing::DIRECTION_SENT, record.direction);
+    CHECK_TRUE(trace.getRecord(1, record));
+    CHECK_EQUAL(TraceRing::DIRECTION_RECEIVED, record.direction);
+
+    // Dumped and mapped files share the same layout
+    CHECK_EQUAL(0, stat(mapPath, &mapStat));
+    CHECK_EQUAL(dumpStat.st_size, mapStat.st_size);
+    CHECK_TRUE(dumpStat.st_size > (off_t)(8 * sizeof(TraceRing::Record)));
+
+    CHECK_FALSE(trace.dump("/nonexistent/TestTraceRing.dump"));
+
+    unlink(dumpPath);
+    unlink(mapPath);
+}
 
 TEST_GROUP(RedBotPacketGenerator)
 {
@@ -903,7 +1882,7 @@ TEST_GROUP(RedBotPacketGenerator)
             char type
             )
     {
-        Packet* packet = myPacketGen.createPacket(type);
+        Packet* packet = myPacketGen.createPacket(type).release();
         myPackets.push_back(packet);
         return packet;
     }
@@ -967,3 +1946,43 @@ TEST(RedBotPacketGenerator, MotorDrive)
 {
     CHECK_PACKETGEN(RedBotPacket::BID_MDRIVE, MotorDrivePacket);
 }
+
+TEST(RedBotPacketGenerator, Frame)
+{
+    CHECK_PACKETGEN(RedBotPacket::BID_FRAME, FramePacket);
+}
+
+TEST(RedBotPacketGenerator, FrameValues)
+{
+    CHECK_PACKETGEN(RedBotPacket::BID_FRAMEVALUES, FrameValuesPacket);
+}
+
+TEST(RedBotPacketGenerator, Subscribe)
+{
+    CHECK_PACKETGEN(RedBotPacket::BID_SUBSCRIBE, SubscribePacket);
+}
+
+TEST(RedBotPacketGenerator, Version)
+{
+    CHECK_PACKETGEN(RedBotPacket::BID_VERSION, VersionPacket);
+}
+
+TEST(RedBotPacketGenerator, VersionInfo)
+{
+    CHECK_PACKETGEN(RedBotPacket::BID_VERSIONINFO, VersionInfoPacket);
+}
+
+TEST(RedBotPacketGenerator, Checksum)
+{
+    CHECK_PACKETGEN(RedBotPacket::BID_CHECKSUM, ChecksumPacket);
+}
+
+TEST(RedBotPacketGenerator, ChecksumInfo)
+{
+    CHECK_PACKETGEN(RedBotPacket::BID_CHECKSUMINFO, ChecksumInfoPacket);
+}
+
+TEST(RedBotPacketGenerator, NegativeAcknowledge)
+{
+    CHECK_PACKETGEN(RedBotPacket::BID_NAK, NegativeAcknowledgePacket);
+}
@@ -62,8 +62,10 @@ private:
 
   void AutonomousPeriodic()
   {
-    int leftTicks = myLeftEncoder.Get();
-    int rightTicks = myRightEncoder.Get();
+    double leftAge = 0.0;
+    double rightAge = 0.0;
+    int leftTicks = myLeftEncoder.GetWithAge(leftAge);
+    int rightTicks = myRightEncoder.GetWithAge(rightAge);
 
     if (leftTicks < (TICKS_PER_FT * NUM_FT))
       {
@@ -98,7 +100,8 @@ private:
 	      << "Right: " << rightTicks << ", "
 	      << "LDiff: " << leftDiff << ", "
 	      << "RDiff: " << rightDiff << ", "
-	      << "Dir: " << dir << std::endl;
+	      << "Dir: " << dir << ", "
+	      << "Age: " << (1000.0 * leftAge) << "/" << (1000.0 * rightAge) << " ms" << std::endl;
 	    myPrintCounter = 0;
 	  }
       }
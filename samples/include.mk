@@ -5,6 +5,7 @@ REDBOTCOMPONENTS_DIR = $(WPIRB_DIR)/redBotComponents
 
 LDFLAGS += \
 	-L$(WPIRB_DIR) -lwpirb \
+	-L$(WPIRB_DIR)/simulator -lsimulator \
 	-L$(REDBOTCOMPONENTS_DIR) -lredbotcomponents \
 	-L$(COMPONENT_DIR) -lcomponent -ldl -pthread
 
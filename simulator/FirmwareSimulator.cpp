@@ -0,0 +1,335 @@
+
+#include "FirmwareSimulator.h"
+#include "Packet.h"
+#include "WPIRBRobot.h"
+
+
+/**
+ * Makes simulated hardware current on the calling thread for a scope
+ */
+class CurrentHardwareScope
+{
+    public:
+
+        CurrentHardwareScope(
+                SimulatedHardware& hardware
+                ) :
+            myPreviousHardware(SimulatedHardware::GetCurrent())
+        {
+            SimulatedHardware::SetCurrent(&hardware);
+        }
+
+        ~CurrentHardwareScope()
+        {
+            SimulatedHardware::SetCurrent(myPreviousHardware);
+        }
+
+    private:
+
+        SimulatedHardware* myPreviousHardware;
+};
+
+
+FirmwareSimulator::FirmwareSimulator() :
+    myHardware(),
+    myFirmware(NULL)
+{
+    CurrentHardwareScope scope(myHardware);
+
+    myFirmware = new WPIRBRobot();
+    myFirmware->setup();
+}
+
+FirmwareSimulator::~FirmwareSimulator()
+{
+    delete myFirmware;
+}
+
+SimulatedHardware&
+FirmwareSimulator::getHardware()
+{
+    return myHardware;
+}
+
+void
+FirmwareSimulator::send(
+        const unsigned char*    data,
+        size_t                  dataSize
+        )
+{
+    CurrentHardwareScope scope(myHardware);
+
+    myHardware.receiveSerialData(data, dataSize);
+
+    // The firmware handles a byte per loop
+    while (myHardware.serialAvailable() > 0)
+    {
+        myFirmware->loop();
+    }
+}
+
+bool
+FirmwareSimulator::receive(
+        unsigned char& byte
+        )
+{
+    std::deque<unsigned char>& sentData = myHardware.getSentSerialData();
+    if (sentData.empty() == true)
+    {
+        return false;
+    }
+
+    byte = sentData.front();
+    sentData.pop_front();
+
+    return true;
+}
+
+void
+FirmwareSimulator::advance(
+        double seconds
+        )
+{
+    myHardware.advance(seconds);
+}
+
+
+SimulatedClock::SimulatedClock(
+        FirmwareSimulator& simulator
+        ) :
+    mySimulator(simulator)
+{
+}
+
+long long
+SimulatedClock::getTime()
+{
+    return (1000LL * mySimulator.getHardware().getTime());
+}
+
+void
+SimulatedClock::sleepUntil(
+        long long time
+        )
+{
+    long long currentTime = getTime();
+    if (time > currentTime)
+    {
+        long long sleepUsec = (time - currentTime + 999) / 1000;
+        mySimulator.advance(1e-6 * sleepUsec);
+    }
+}
+
+bool
+SimulatedClock::isRealTime() const
+{
+    return false;
+}
+
+
+InputSimulatorBuffer::InputSimulatorBuffer(
+        FirmwareSimulator& simulator
+        ) :
+    mySimulator(simulator),
+    myPacketSize(0),
+    myIsHeaderRead(false),
+    myIsPacketComplete(false),
+    myIsFrameDropped(false),
+    myLastReadByte(0)
+{
+}
+
+InputSimulatorBuffer::~InputSimulatorBuffer()
+{
+}
+
+bool
+InputSimulatorBuffer::readPacket()
+{
+    unsigned char curByte;
+
+    while(
+            (myIsPacketComplete == false) &&
+            (mySimulator.receive(curByte) == true)
+         )
+    {
+        if (myFraming == FRAMING_COBS)
+        {
+            parseCobsByte(curByte);
+        }
+        else
+        {
+            parseBoundedByte(curByte);
+        }
+    }
+
+    return isPacketComplete();
+}
+
+void
+InputSimulatorBuffer::parseBoundedByte(
+        unsigned char curByte
+        )
+{
+    if (curByte == (unsigned char)Packet::BINARY_BOUND)
+    {
+        if (myIsHeaderRead == false)
+        {
+            myIsHeaderRead = true;
+        }
+        else if (myLastReadByte == (unsigned char)Packet::BINARY_BOUND)
+        {
+            // If back-to-back packet boundaries are found, then clear the
+            // packet and use the current byte as the header
+            clear();
+            myIsHeaderRead = true;
+        }
+        else
+        {
+            myIsPacketComplete = true;
+        }
+    }
+    else if (myIsHeaderRead == false)
+    {
+        // Discard noise between packets
+        return;
+    }
+
+    if (myPacketSize >= MAX_PACKET_SIZE)
+    {
+        // Discard overlong packet
+        clear();
+        return;
+    }
+
+    myPacketData[myPacketSize++] = curByte;
+    myLastReadByte = curByte;
+}
+
+void
+InputSimulatorBuffer::parseCobsByte(
+        unsigned char curByte
+        )
+{
+    if (curByte == 0x00)
+    {
+        // Delimiter ends a non-empty frame
+        if(
+                (myIsFrameDropped == false) &&
+                (myPacketSize > 0)
+          )
+        {
+            myIsPacketComplete = true;
+        }
+
+        myIsFrameDropped = false;
+        return;
+    }
+
+    if (myIsFrameDropped == true)
+    {
+        return;
+    }
+
+    if (myPacketSize >= MAX_PACKET_SIZE)
+    {
+        // Discard overlong frame up to its delimiter
+        clear();
+        myIsFrameDropped = true;
+        return;
+    }
+
+    myPacketData[myPacketSize++] = curByte;
+}
+
+bool
+InputSimulatorBuffer::isPacketComplete() const
+{
+    return myIsPacketComplete;
+}
+
+std::istream&
+InputSimulatorBuffer::getInputStream()
+{
+    myByteBuffer.clear();
+    myByteBuffer.str(std::string((const char*)myPacketData, myPacketSize));
+
+    return myByteBuffer;
+}
+
+bool
+InputSimulatorBuffer::getPacketData(
+        const unsigned char*&   data,
+        size_t&                 dataSize
+        )
+{
+    data = myPacketData;
+    dataSize = myPacketSize;
+
+    return true;
+}
+
+void
+InputSimulatorBuffer::clear()
+{
+    myPacketSize = 0;
+    myIsPacketComplete = false;
+    myIsHeaderRead = false;
+}
+
+
+OutputSimulatorBuffer::OutputSimulatorBuffer(
+        FirmwareSimulator& simulator
+        ) :
+    mySimulator(simulator)
+{
+}
+
+OutputSimulatorBuffer::~OutputSimulatorBuffer()
+{
+}
+
+bool
+OutputSimulatorBuffer::writePacket()
+{
+    std::string packetData = myByteBuffer.str();
+    myByteBuffer.str("");
+
+    return writeData(
+            (const unsigned char*)packetData.data(),
+            packetData.size()
+            );
+}
+
+bool
+OutputSimulatorBuffer::writeData(
+        const unsigned char*    data,
+        size_t                  dataSize
+        )
+{
+    mySimulator.send(data, dataSize);
+
+    return true;
+}
+
+std::ostream&
+OutputSimulatorBuffer::getOutputStream()
+{
+    return myByteBuffer;
+}
+
+void
+OutputSimulatorBuffer::clear()
+{
+    myByteBuffer.clear();
+    myByteBuffer.str("");
+}
+
+void
+OutputSimulatorBuffer::resync()
+{
+    writeData(
+            (const unsigned char*)"\xFF\xFF\xFF\xFF\xFF",
+            5
+            );
+}
@@ -0,0 +1,318 @@
+#ifndef FIRMWARESIMULATOR_H
+#define FIRMWARESIMULATOR_H
+
+#include "IOBuffer.h"
+#include "Clock.h"
+#include "SimulatedHardware.h"
+
+class WPIRBRobot;
+
+/**
+ * Runs the robot firmware in process against simulated hardware
+ *
+ * Bytes sent to the robot are handed straight to the firmware, which is run
+ * until it has handled all of them, so every request is answered by the time
+ * it has been sent. No system calls are made and no time passes while
+ * packets are exchanged: virtual time only moves on when advanced, typically
+ * once per cycle of the robot program.
+ *
+ * Simulated robots are driven through the input and output simulator
+ * buffers, in place of those of a serial link. Each simulator may be used
+ * from any one thread at a time, and different simulators from different
+ * threads at once.
+ */
+class FirmwareSimulator
+{
+    public:
+
+        /**
+         * Default constructor
+         *
+         * The firmware is set up as on power up.
+         */
+        FirmwareSimulator();
+
+        /**
+         * Destructor
+         */
+        ~FirmwareSimulator();
+
+        /**
+         * Provides the hardware the firmware runs against
+         */
+        SimulatedHardware& getHardware();
+
+        /**
+         * Sends bytes to the robot and lets the firmware handle them
+         */
+        void send(
+                const unsigned char*    data,
+                size_t                  dataSize
+                );
+
+        /**
+         * Takes the next byte the robot has sent
+         *
+         * \return True if a byte was taken, false if the robot has sent
+         * nothing more
+         */
+        bool receive(
+                unsigned char& byte
+                );
+
+        /**
+         * Advances virtual time, moving the robot accordingly
+         */
+        void advance(
+                double seconds
+                );
+
+    private:
+
+        /**
+         * Hardware the firmware runs against
+         */
+        SimulatedHardware myHardware;
+
+        /**
+         * Robot firmware
+         */
+        WPIRBRobot* myFirmware;
+
+        // Disabled copiers
+        FirmwareSimulator(const FirmwareSimulator&);
+        FirmwareSimulator& operator=(const FirmwareSimulator&);
+};
+
+/**
+ * Clock keeping the virtual time of a simulated robot
+ *
+ * Sleeping advances the simulation to the time slept until, so a program
+ * using this as the clock of the process moves its robot on whenever it
+ * waits, just as a real robot moves on while its program waits.
+ */
+class SimulatedClock : public Clock
+{
+    public:
+
+        /**
+         * Constructor with simulator whose time to keep
+         */
+        SimulatedClock(
+                FirmwareSimulator& simulator
+                );
+
+        /**
+         * Provides the virtual time of the simulator
+         */
+        long long getTime();
+
+        /**
+         * Advances the simulator to the given time, unless already past it
+         *
+         * Time advances in whole microseconds, so the given time is rounded
+         * up to one.
+         */
+        void sleepUntil(
+                long long time
+                );
+
+        /**
+         * Indicates that the clock does not follow real time
+         */
+        bool isRealTime() const;
+
+    private:
+
+        /**
+         * Simulator whose time to keep
+         */
+        FirmwareSimulator& mySimulator;
+};
+
+/**
+ * Reads and buffers packets sent by a simulated robot
+ *
+ * Reads never wait: when the robot has sent no complete packet, there is none
+ * to read.
+ */
+class InputSimulatorBuffer : public InputBuffer
+{
+    public:
+
+        /**
+         * Largest packet that can be buffered, boundary bytes included
+         *
+         * Longer byte runs are discarded as noise.
+         */
+        static const size_t MAX_PACKET_SIZE = InputDescriptorBuffer::MAX_PACKET_SIZE;
+
+        /**
+         * Constructor with simulator to read packets from
+         */
+        InputSimulatorBuffer(
+                FirmwareSimulator& simulator
+                );
+
+        /**
+         * Destructor
+         */
+        ~InputSimulatorBuffer();
+
+        /**
+         * Attempts to read a packet from the bytes the robot has sent
+         *
+         * \return True if a complete packet is buffered, false otherwise
+         */
+        bool readPacket();
+
+        /**
+         * Indicates if a complete packet is currently buffered
+         */
+        bool isPacketComplete() const;
+
+        /**
+         * Provides an input stream to read complete packets from
+         */
+        std::istream& getInputStream();
+
+        /**
+         * Provides the bytes of the buffered packet without a stream
+         */
+        bool getPacketData(
+                const unsigned char*&   data,
+                size_t&                 dataSize
+                );
+
+        /**
+         * Clears the current packet from this buffer
+         *
+         * Bytes the robot sent past the current packet are kept.
+         */
+        void clear();
+
+    private:
+
+        /**
+         * Frames a single byte of bounded input into the current packet
+         */
+        void parseBoundedByte(
+                unsigned char curByte
+                );
+
+        /**
+         * Frames a single byte of COBS input into the current packet
+         */
+        void parseCobsByte(
+                unsigned char curByte
+                );
+
+        /**
+         * Simulator to read packets from
+         */
+        FirmwareSimulator& mySimulator;
+
+        /**
+         * Bytes of the current packet
+         */
+        unsigned char myPacketData[MAX_PACKET_SIZE];
+
+        /**
+         * Number of bytes in myPacketData
+         */
+        size_t myPacketSize;
+
+        /**
+         * Stream adapter over the current packet's bytes
+         */
+        std::stringstream myByteBuffer;
+
+        /**
+         * Indicates if the packet header byte has been read yet
+         */
+        bool myIsHeaderRead;
+
+        /**
+         * Indicates if complete packet is currently buffered
+         */
+        bool myIsPacketComplete;
+
+        /**
+         * Indicates if the rest of an overlong COBS frame is being discarded
+         */
+        bool myIsFrameDropped;
+
+        /**
+         * Last byte framed into the current packet
+         */
+        unsigned char myLastReadByte;
+};
+
+/**
+ * Writes packets to a simulated robot
+ *
+ * Packets are handled by the firmware as they are written, so their
+ * responses are ready to be read once the write returns.
+ */
+class OutputSimulatorBuffer : public OutputBuffer
+{
+    public:
+
+        /**
+         * Constructor with simulator to write packets to
+         */
+        OutputSimulatorBuffer(
+                FirmwareSimulator& simulator
+                );
+
+        /**
+         * Destructor
+         */
+        ~OutputSimulatorBuffer();
+
+        /**
+         * Writes the buffered packet to the robot
+         *
+         * \return True, as writes to a simulated robot always complete
+         */
+        bool writePacket();
+
+        /**
+         * Writes a single packet held in memory to the robot
+         *
+         * \return True, as writes to a simulated robot always complete
+         */
+        bool writeData(
+                const unsigned char*    data,
+                size_t                  dataSize
+                );
+
+        /**
+         * Provides an output stream to write complete packets to
+         */
+        std::ostream& getOutputStream();
+
+        /**
+         * Clears the contents of this buffer
+         */
+        void clear();
+
+        /**
+         * Sends a resynchronization sequence
+         */
+        void resync();
+
+    private:
+
+        /**
+         * Simulator to write packets to
+         */
+        FirmwareSimulator& mySimulator;
+
+        /**
+         * Buffer for packet bytes
+         */
+        std::stringstream myByteBuffer;
+};
+
+#endif /* ifndef FIRMWARESIMULATOR_H */
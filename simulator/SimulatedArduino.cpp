@@ -0,0 +1,116 @@
+
+#include "Arduino.h"
+#include "SimulatedHardware.h"
+
+// The Arduino core acts on the simulated hardware current on the calling
+// thread, and does nothing when there is none
+
+
+SerialHandler Serial;
+
+
+void
+SerialHandler::begin(
+        unsigned int baud
+        )
+{
+}
+
+unsigned int
+SerialHandler::available()
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    return (hardware != NULL) ? hardware->serialAvailable() : 0;
+}
+
+byte
+SerialHandler::read()
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    return (hardware != NULL) ? hardware->serialRead() : 0xFF;
+}
+
+void
+SerialHandler::write(
+        byte data
+        )
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    if (hardware != NULL)
+    {
+        hardware->serialWrite(data);
+    }
+}
+
+void
+SerialHandler::flush()
+{
+    // Bytes written are sent at once
+}
+
+void
+pinMode(
+        unsigned int    pin,
+        unsigned int    mode
+       )
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    if (hardware != NULL)
+    {
+        hardware->setPinMode(pin, (mode == OUTPUT));
+    }
+}
+
+void
+digitalWrite(
+        unsigned int    pin,
+        unsigned int    value
+        )
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    if (hardware != NULL)
+    {
+        hardware->digitalWrite(pin, (value == HIGH));
+    }
+}
+
+unsigned int
+digitalRead(
+        unsigned int    pin
+        )
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    if(
+            (hardware != NULL) &&
+            (hardware->digitalRead(pin) == true)
+      )
+    {
+        return HIGH;
+    }
+
+    return LOW;
+}
+
+unsigned int
+analogRead(
+        unsigned int    pin
+        )
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    return (hardware != NULL) ? hardware->analogRead(pin) : 0;
+}
+
+unsigned long
+millis()
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    return (hardware != NULL) ? (unsigned long)(hardware->getTime() / 1000) : 0;
+}
@@ -0,0 +1,334 @@
+
+#include "SimulatedHardware.h"
+#include <math.h>
+
+
+/**
+ * Longest step the motion of the robot is worked out over, in seconds
+ */
+static const double MAX_STEP_SECONDS = 0.001;
+
+thread_local SimulatedHardware* SimulatedHardware::ourCurrentHardware = NULL;
+
+
+SimulatedHardware::SimulatedHardware() :
+    myTime(0),
+    myReceivedData(),
+    mySentData(),
+    myX(0.0),
+    myY(0.0),
+    myHeading(0.0)
+{
+    for(
+            unsigned int pin = 0;
+            pin < NUM_DIGITAL_PINS;
+            ++pin
+       )
+    {
+        myIsOutput[pin] = false;
+        myOutputLevels[pin] = false;
+        myInputLevels[pin] = false;
+    }
+
+    for(
+            unsigned int pin = 0;
+            pin < NUM_ANALOG_PINS;
+            ++pin
+       )
+    {
+        myAnalogValues[pin] = 0;
+    }
+
+    for(
+            unsigned int wheel = 0;
+            wheel < NUM_WHEELS;
+            ++wheel
+       )
+    {
+        myMotorCommands[wheel] = 0;
+        myMaxWheelSpeeds[wheel] = DEFAULT_MAX_WHEEL_SPEED;
+        myWheelSpeeds[wheel] = 0.0;
+        myWheelDistances[wheel] = 0.0;
+    }
+}
+
+SimulatedHardware::~SimulatedHardware()
+{
+    if (ourCurrentHardware == this)
+    {
+        ourCurrentHardware = NULL;
+    }
+}
+
+void
+SimulatedHardware::advance(
+        double seconds
+        )
+{
+    // Motion is worked out in short steps, over which the wheel speeds are
+    // taken as constant
+    while (seconds > 0.0)
+    {
+        double stepSeconds = (seconds < MAX_STEP_SECONDS) ? seconds : MAX_STEP_SECONDS;
+        seconds -= stepSeconds;
+
+        double response = 1.0 - exp(-stepSeconds / DEFAULT_WHEEL_TIME_CONSTANT);
+        for(
+                unsigned int wheel = 0;
+                wheel < NUM_WHEELS;
+                ++wheel
+           )
+        {
+            double targetSpeed =
+                myMaxWheelSpeeds[wheel] * myMotorCommands[wheel] / MAX_MOTOR_COMMAND;
+
+            myWheelSpeeds[wheel] += response * (targetSpeed - myWheelSpeeds[wheel]);
+            myWheelDistances[wheel] += myWheelSpeeds[wheel] * stepSeconds;
+        }
+
+        double speed = 0.5 * (myWheelSpeeds[WHEEL_LEFT] + myWheelSpeeds[WHEEL_RIGHT]);
+        double turnRate =
+            (myWheelSpeeds[WHEEL_RIGHT] - myWheelSpeeds[WHEEL_LEFT]) / DEFAULT_TRACK_WIDTH;
+
+        myX += speed * cos(myHeading) * stepSeconds;
+        myY += speed * sin(myHeading) * stepSeconds;
+        myHeading += turnRate * stepSeconds;
+
+        myTime += (uint64_t)llround(stepSeconds * 1e6);
+    }
+}
+
+uint64_t
+SimulatedHardware::getTime() const
+{
+    return myTime;
+}
+
+void
+SimulatedHardware::setMaxWheelSpeed(
+        Wheel   wheel,
+        double  speed
+        )
+{
+    myMaxWheelSpeeds[wheel] = speed;
+}
+
+double
+SimulatedHardware::getWheelSpeed(
+        Wheel wheel
+        ) const
+{
+    return myWheelSpeeds[wheel];
+}
+
+int
+SimulatedHardware::getMotorCommand(
+        Wheel wheel
+        ) const
+{
+    return myMotorCommands[wheel];
+}
+
+double
+SimulatedHardware::getWheelDistance(
+        Wheel wheel
+        ) const
+{
+    return myWheelDistances[wheel];
+}
+
+double
+SimulatedHardware::getX() const
+{
+    return myX;
+}
+
+double
+SimulatedHardware::getY() const
+{
+    return myY;
+}
+
+double
+SimulatedHardware::getHeading() const
+{
+    return myHeading;
+}
+
+void
+SimulatedHardware::setDigitalInput(
+        unsigned int    pin,
+        bool            value
+        )
+{
+    if (pin < NUM_DIGITAL_PINS)
+    {
+        myInputLevels[pin] = value;
+    }
+}
+
+bool
+SimulatedHardware::getDigitalOutput(
+        unsigned int pin
+        ) const
+{
+    return (pin < NUM_DIGITAL_PINS) && myOutputLevels[pin];
+}
+
+bool
+SimulatedHardware::isOutput(
+        unsigned int pin
+        ) const
+{
+    return (pin < NUM_DIGITAL_PINS) && myIsOutput[pin];
+}
+
+void
+SimulatedHardware::setAnalogInput(
+        unsigned int pin,
+        unsigned int value
+        )
+{
+    if (pin < NUM_ANALOG_PINS)
+    {
+        myAnalogValues[pin] = value;
+    }
+}
+
+void
+SimulatedHardware::receiveSerialData(
+        const unsigned char*    data,
+        size_t                  dataSize
+        )
+{
+    myReceivedData.insert(myReceivedData.end(), data, data + dataSize);
+}
+
+std::deque<unsigned char>&
+SimulatedHardware::getSentSerialData()
+{
+    return mySentData;
+}
+
+SimulatedHardware*
+SimulatedHardware::GetCurrent()
+{
+    return ourCurrentHardware;
+}
+
+void
+SimulatedHardware::SetCurrent(
+        SimulatedHardware* hardware
+        )
+{
+    ourCurrentHardware = hardware;
+}
+
+unsigned int
+SimulatedHardware::serialAvailable() const
+{
+    return myReceivedData.size();
+}
+
+uint8_t
+SimulatedHardware::serialRead()
+{
+    if (myReceivedData.empty() == true)
+    {
+        // Arduinos read -1 from an empty serial buffer
+        return 0xFF;
+    }
+
+    uint8_t data = myReceivedData.front();
+    myReceivedData.pop_front();
+
+    return data;
+}
+
+void
+SimulatedHardware::serialWrite(
+        uint8_t data
+        )
+{
+    mySentData.push_back(data);
+}
+
+void
+SimulatedHardware::setPinMode(
+        unsigned int    pin,
+        bool            isOutput
+        )
+{
+    if (pin < NUM_DIGITAL_PINS)
+    {
+        myIsOutput[pin] = isOutput;
+    }
+}
+
+void
+SimulatedHardware::digitalWrite(
+        unsigned int    pin,
+        bool            value
+        )
+{
+    if (pin < NUM_DIGITAL_PINS)
+    {
+        myOutputLevels[pin] = value;
+    }
+}
+
+bool
+SimulatedHardware::digitalRead(
+        unsigned int pin
+        ) const
+{
+    if (pin >= NUM_DIGITAL_PINS)
+    {
+        return false;
+    }
+
+    // Outputs read back the level written to them
+    return myIsOutput[pin] ? myOutputLevels[pin] : myInputLevels[pin];
+}
+
+unsigned int
+SimulatedHardware::analogRead(
+        unsigned int pin
+        ) const
+{
+    return (pin < NUM_ANALOG_PINS) ? myAnalogValues[pin] : 0;
+}
+
+void
+SimulatedHardware::setMotorCommand(
+        Wheel   wheel,
+        int     command
+        )
+{
+    if (command > MAX_MOTOR_COMMAND)
+    {
+        command = MAX_MOTOR_COMMAND;
+    }
+    else if (command < -MAX_MOTOR_COMMAND)
+    {
+        command = -MAX_MOTOR_COMMAND;
+    }
+
+    myMotorCommands[wheel] = command;
+}
+
+long
+SimulatedHardware::getEncoderTicks(
+        Wheel wheel
+        ) const
+{
+    return (long)(myWheelDistances[wheel] * TICKS_PER_FOOT);
+}
+
+void
+SimulatedHardware::clearEncoder(
+        Wheel wheel
+        )
+{
+    myWheelDistances[wheel] = 0.0;
+}
@@ -0,0 +1,371 @@
+#ifndef SIMULATEDHARDWARE_H
+#define SIMULATEDHARDWARE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+
+/**
+ * Model of the hardware of a RedBot, for the firmware to run against
+ *
+ * This stands in for the Arduino board, its serial port and the RedBot's
+ * motors and wheel encoders. The firmware reaches the model through the
+ * Arduino and RedBot library functions, which act on the hardware current on
+ * the calling thread. Several simulated robots may thus run at once on
+ * different threads.
+ *
+ * Time is virtual: it only moves on when advanced, and the motion of the
+ * robot is worked out over each advance with a simple differential-drive
+ * model. Each motor's command sets the speed its wheel heads towards, and the
+ * wheel reaches it with a first-order lag. The encoders count the distance
+ * travelled by each wheel, backwards as negative counts.
+ */
+class SimulatedHardware
+{
+    public:
+
+        /**
+         * Number of digital pins
+         */
+        static const unsigned int NUM_DIGITAL_PINS = 20;
+
+        /**
+         * Number of analog inputs
+         */
+        static const unsigned int NUM_ANALOG_PINS = 8;
+
+        /**
+         * Largest motor command in either direction
+         */
+        static const int MAX_MOTOR_COMMAND = 255;
+
+        /**
+         * Encoder counts per foot travelled by a wheel
+         */
+        static const int TICKS_PER_FOOT = 286;
+
+        /**
+         * Default speed of a wheel at full command, in feet per second
+         */
+        static constexpr double DEFAULT_MAX_WHEEL_SPEED = 2.5;
+
+        /**
+         * Default time constant of the wheels' response to commands, in
+         * seconds
+         */
+        static constexpr double DEFAULT_WHEEL_TIME_CONSTANT = 0.1;
+
+        /**
+         * Default distance between the wheels, in feet
+         */
+        static constexpr double DEFAULT_TRACK_WIDTH = 0.55;
+
+        /**
+         * Wheels of the robot
+         */
+        enum Wheel
+        {
+            WHEEL_LEFT,
+            WHEEL_RIGHT,
+            NUM_WHEELS
+        };
+
+        /**
+         * Default constructor
+         *
+         * The robot starts at rest at the origin, heading along the x axis,
+         * with all pins as low inputs.
+         */
+        SimulatedHardware();
+
+        /**
+         * Destructor
+         *
+         * The hardware stops being current if it was.
+         */
+        ~SimulatedHardware();
+
+        /**
+         * Advances virtual time and moves the robot accordingly
+         */
+        void advance(
+                double seconds
+                );
+
+        /**
+         * Provides the virtual time elapsed, in microseconds
+         */
+        uint64_t getTime() const;
+
+        /**
+         * Sets the speed of a wheel at full command, in feet per second
+         *
+         * Giving the wheels different speeds makes the robot pull to one
+         * side, as mismatched motors do.
+         */
+        void setMaxWheelSpeed(
+                Wheel   wheel,
+                double  speed
+                );
+
+        /**
+         * Provides the speed of a wheel, in feet per second
+         */
+        double getWheelSpeed(
+                Wheel wheel
+                ) const;
+
+        /**
+         * Provides the last command given to a wheel's motor
+         *
+         * Positive commands drive the wheel forwards.
+         */
+        int getMotorCommand(
+                Wheel wheel
+                ) const;
+
+        /**
+         * Provides the distance a wheel travelled since its encoder was last
+         * cleared, in feet
+         */
+        double getWheelDistance(
+                Wheel wheel
+                ) const;
+
+        /**
+         * Provides the position of the robot along the x axis, in feet
+         */
+        double getX() const;
+
+        /**
+         * Provides the position of the robot along the y axis, in feet
+         */
+        double getY() const;
+
+        /**
+         * Provides the heading of the robot counterclockwise from the x axis,
+         * in radians
+         */
+        double getHeading() const;
+
+        /**
+         * Sets the level of a digital pin read as an input
+         */
+        void setDigitalInput(
+                unsigned int    pin,
+                bool            value
+                );
+
+        /**
+         * Provides the level the firmware last wrote to a digital pin
+         */
+        bool getDigitalOutput(
+                unsigned int pin
+                ) const;
+
+        /**
+         * Indicates if the firmware configured a digital pin as an output
+         */
+        bool isOutput(
+                unsigned int pin
+                ) const;
+
+        /**
+         * Sets the value of an analog input, from 0 to 1023
+         */
+        void setAnalogInput(
+                unsigned int pin,
+                unsigned int value
+                );
+
+        /**
+         * Queues bytes sent to the robot's serial port
+         */
+        void receiveSerialData(
+                const unsigned char*    data,
+                size_t                  dataSize
+                );
+
+        /**
+         * Provides the bytes the robot has sent on its serial port
+         */
+        std::deque<unsigned char>& getSentSerialData();
+
+        /**
+         * Provides the hardware current on this thread
+         *
+         * \return Current hardware, or NULL if there is none
+         */
+        static SimulatedHardware* GetCurrent();
+
+        /**
+         * Sets the hardware current on this thread
+         */
+        static void SetCurrent(
+                SimulatedHardware* hardware /**< Hardware, or NULL for none */
+                );
+
+        /**
+         * \name Firmware side
+         *
+         * These are called by the Arduino and RedBot library functions.
+         * @{
+         */
+
+        /**
+         * Provides the number of received bytes waiting to be read
+         */
+        unsigned int serialAvailable() const;
+
+        /**
+         * Reads a received byte
+         */
+        uint8_t serialRead();
+
+        /**
+         * Sends a byte
+         */
+        void serialWrite(
+                uint8_t data
+                );
+
+        /**
+         * Configures a digital pin as an input or an output
+         */
+        void setPinMode(
+                unsigned int    pin,
+                bool            isOutput
+                );
+
+        /**
+         * Writes the level of a digital pin
+         */
+        void digitalWrite(
+                unsigned int    pin,
+                bool            value
+                );
+
+        /**
+         * Reads the level of a digital pin
+         */
+        bool digitalRead(
+                unsigned int pin
+                ) const;
+
+        /**
+         * Reads an analog input
+         */
+        unsigned int analogRead(
+                unsigned int pin
+                ) const;
+
+        /**
+         * Sets the command of a wheel's motor
+         *
+         * Positive commands drive the wheel forwards.
+         */
+        void setMotorCommand(
+                Wheel   wheel,
+                int     command
+                );
+
+        /**
+         * Provides the count of a wheel's encoder
+         */
+        long getEncoderTicks(
+                Wheel wheel
+                ) const;
+
+        /**
+         * Clears the count of a wheel's encoder
+         */
+        void clearEncoder(
+                Wheel wheel
+                );
+
+        /** @} */
+
+    private:
+
+        /**
+         * Hardware current on this thread
+         */
+        static thread_local SimulatedHardware* ourCurrentHardware;
+
+        /**
+         * Virtual time elapsed, in microseconds
+         */
+        uint64_t myTime;
+
+        /**
+         * Bytes received on the serial port, waiting to be read
+         */
+        std::deque<unsigned char> myReceivedData;
+
+        /**
+         * Bytes sent on the serial port
+         */
+        std::deque<unsigned char> mySentData;
+
+        /**
+         * Indicates which digital pins are outputs
+         */
+        bool myIsOutput[NUM_DIGITAL_PINS];
+
+        /**
+         * Levels written to the digital pins
+         */
+        bool myOutputLevels[NUM_DIGITAL_PINS];
+
+        /**
+         * Levels of the digital pins read as inputs
+         */
+        bool myInputLevels[NUM_DIGITAL_PINS];
+
+        /**
+         * Values of the analog inputs
+         */
+        unsigned int myAnalogValues[NUM_ANALOG_PINS];
+
+        /**
+         * Commands of the wheels' motors
+         */
+        int myMotorCommands[NUM_WHEELS];
+
+        /**
+         * Speeds of the wheels at full command, in feet per second
+         */
+        double myMaxWheelSpeeds[NUM_WHEELS];
+
+        /**
+         * Speeds of the wheels, in feet per second
+         */
+        double myWheelSpeeds[NUM_WHEELS];
+
+        /**
+         * Distances travelled by the wheels since their encoders were
+         * cleared, in feet
+         */
+        double myWheelDistances[NUM_WHEELS];
+
+        /**
+         * Position of the robot along the x axis, in feet
+         */
+        double myX;
+
+        /**
+         * Position of the robot along the y axis, in feet
+         */
+        double myY;
+
+        /**
+         * Heading of the robot counterclockwise from the x axis, in radians
+         */
+        double myHeading;
+
+        // Disabled copiers
+        SimulatedHardware(const SimulatedHardware&);
+        SimulatedHardware& operator=(const SimulatedHardware&);
+};
+
+#endif /* ifndef SIMULATEDHARDWARE_H */
@@ -0,0 +1,84 @@
+
+#include "RedBot.h"
+#include "SimulatedHardware.h"
+
+using namespace rb;
+
+// The RedBot library acts on the simulated hardware current on the calling
+// thread. The left motor is mounted mirrored, so negative commands drive it
+// forwards.
+
+
+RedBotMotors::RedBotMotors()
+{
+}
+
+void
+RedBotMotors::rightMotor(
+        int speed
+        )
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    if (hardware != NULL)
+    {
+        hardware->setMotorCommand(SimulatedHardware::WHEEL_RIGHT, speed);
+    }
+}
+
+void
+RedBotMotors::leftMotor(
+        int speed
+        )
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    if (hardware != NULL)
+    {
+        hardware->setMotorCommand(SimulatedHardware::WHEEL_LEFT, -speed);
+    }
+}
+
+
+RedBotEncoder::RedBotEncoder(int leftPin, int rightPin)
+{
+}
+
+long
+RedBotEncoder::getTicks(WHEEL wheel)
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    if(
+            (hardware == NULL) ||
+            (wheel == BOTH)
+      )
+    {
+        return 0;
+    }
+
+    return hardware->getEncoderTicks(
+            (wheel == RIGHT) ? SimulatedHardware::WHEEL_RIGHT : SimulatedHardware::WHEEL_LEFT
+            );
+}
+
+void
+RedBotEncoder::clearEnc(WHEEL wheel)
+{
+    SimulatedHardware* hardware = SimulatedHardware::GetCurrent();
+
+    if (hardware == NULL)
+    {
+        return;
+    }
+
+    if (wheel != RIGHT)
+    {
+        hardware->clearEncoder(SimulatedHardware::WHEEL_LEFT);
+    }
+
+    if (wheel != LEFT)
+    {
+        hardware->clearEncoder(SimulatedHardware::WHEEL_RIGHT);
+    }
+}
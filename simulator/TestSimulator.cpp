@@ -0,0 +1,355 @@
+
+#include "FirmwareSimulator.h"
+#include "RedBot.h"
+#include "RedBotPacket.h"
+#include "IterativeRobot.h"
+#include "RedBotSpeedController.h"
+#include "RedBotEncoder.h"
+#include "DigitalInput.h"
+#include "DigitalOutput.h"
+#include "AnalogInput.h"
+#include "Timer.h"
+#include "CppUTest/TestHarness.h"
+#include <math.h>
+
+
+/**
+ * Program driving a differential-drive robot and reading its sensors
+ */
+class SimulatedProgram : public frc::IterativeRobot
+{
+    public:
+
+        SimulatedProgram() :
+            IterativeRobot(),
+            leftMotor(0),
+            rightMotor(1),
+            leftEncoder(false),
+            rightEncoder(true),
+            bumper(3),
+            light(12),
+            lineSensor(2),
+            leftThrust(0.0),
+            rightThrust(0.0)
+        {
+        }
+
+        void AutonomousPeriodic()
+        {
+            leftMotor.Set(leftThrust);
+            rightMotor.Set(rightThrust);
+            light.Set(bumper.Get());
+        }
+
+        RedBotSpeedController leftMotor;
+        RedBotSpeedController rightMotor;
+        RedBotEncoder leftEncoder;
+        RedBotEncoder rightEncoder;
+        frc::DigitalInput bumper;
+        frc::DigitalOutput light;
+        frc::AnalogInput lineSensor;
+
+        double leftThrust;
+        double rightThrust;
+};
+
+/**
+ * Program reading more inputs than the responses of a frame can hold
+ */
+class ManyInputsProgram : public frc::IterativeRobot
+{
+    public:
+
+        /**
+         * Number of digital inputs read
+         */
+        static const size_t NUM_DIGITAL_INPUTS = 12;
+
+        /**
+         * Number of analog inputs read
+         */
+        static const size_t NUM_ANALOG_INPUTS = 8;
+
+        ManyInputsProgram() :
+            IterativeRobot()
+        {
+            for(
+                    size_t inputIdx = 0;
+                    inputIdx < NUM_DIGITAL_INPUTS;
+                    ++inputIdx
+               )
+            {
+                digitalInputs[inputIdx] = new frc::DigitalInput(inputIdx + 1);
+            }
+
+            for(
+                    size_t inputIdx = 0;
+                    inputIdx < NUM_ANALOG_INPUTS;
+                    ++inputIdx
+               )
+            {
+                analogInputs[inputIdx] = new frc::AnalogInput(inputIdx);
+            }
+        }
+
+        ~ManyInputsProgram()
+        {
+            for(
+                    size_t inputIdx = 0;
+                    inputIdx < NUM_DIGITAL_INPUTS;
+                    ++inputIdx
+               )
+            {
+                delete digitalInputs[inputIdx];
+            }
+
+            for(
+                    size_t inputIdx = 0;
+                    inputIdx < NUM_ANALOG_INPUTS;
+                    ++inputIdx
+               )
+            {
+                delete analogInputs[inputIdx];
+            }
+        }
+
+        frc::DigitalInput* digitalInputs[NUM_DIGITAL_INPUTS];
+        frc::AnalogInput* analogInputs[NUM_ANALOG_INPUTS];
+};
+
+TEST_GROUP(Simulator)
+{
+    FirmwareSimulator* mySimulator;
+    InputSimulatorBuffer* myInputBuffer;
+    OutputSimulatorBuffer* myOutputBuffer;
+    SimulatedProgram* myProgram;
+    RedBot* myRobot;
+
+    void setup()
+    {
+        mySimulator = new FirmwareSimulator();
+        myInputBuffer = new InputSimulatorBuffer(*mySimulator);
+        myOutputBuffer = new OutputSimulatorBuffer(*mySimulator);
+        myProgram = new SimulatedProgram();
+        myRobot = new RedBot(
+                myProgram,
+                myInputBuffer,
+                myOutputBuffer,
+                new RedBotPacketGenerator()
+                );
+        myRobot->modeInit(FieldControlSystem::MODE_AUTO);
+    }
+
+    void teardown()
+    {
+        delete myRobot;
+        delete myProgram;
+        delete myOutputBuffer;
+        delete myInputBuffer;
+        delete mySimulator;
+
+        Clock::SetInstance(NULL);
+    }
+
+    /**
+     * Runs cycles of the program, advancing virtual time by each period
+     */
+    void runCycles(
+            size_t  cycleCount,
+            double  period = 0.02
+            )
+    {
+        for(
+                size_t cycleIdx = 0;
+                cycleIdx < cycleCount;
+                ++cycleIdx
+           )
+        {
+            myRobot->modePeriodic(FieldControlSystem::MODE_AUTO);
+            CHECK_EQUAL(RedBot::STATUS_GOOD, myRobot->getStatus());
+
+            mySimulator->advance(period);
+        }
+    }
+};
+
+TEST(Simulator, HardwareTest)
+{
+    SimulatedHardware hardware;
+
+    // Wheels take a few time constants to reach the commanded speed
+    hardware.setMotorCommand(SimulatedHardware::WHEEL_LEFT, 255);
+    hardware.setMotorCommand(SimulatedHardware::WHEEL_RIGHT, 255);
+    hardware.advance(1.0);
+
+    CHECK_EQUAL(1000000, hardware.getTime());
+    DOUBLES_EQUAL(
+            SimulatedHardware::DEFAULT_MAX_WHEEL_SPEED,
+            hardware.getWheelSpeed(SimulatedHardware::WHEEL_LEFT),
+            0.01
+            );
+    DOUBLES_EQUAL(
+            SimulatedHardware::DEFAULT_MAX_WHEEL_SPEED * 0.9,
+            hardware.getX(),
+            0.01
+            );
+    DOUBLES_EQUAL(0.0, hardware.getY(), 1e-9);
+    CHECK_EQUAL(
+            (long)(hardware.getX() * SimulatedHardware::TICKS_PER_FOOT),
+            hardware.getEncoderTicks(SimulatedHardware::WHEEL_RIGHT)
+            );
+
+    // Driving the wheels apart turns the robot on the spot
+    hardware.setMotorCommand(SimulatedHardware::WHEEL_LEFT, -255);
+    hardware.clearEncoder(SimulatedHardware::WHEEL_LEFT);
+    hardware.advance(1.0);
+
+    CHECK(hardware.getHeading() > 1.0);
+    CHECK(hardware.getEncoderTicks(SimulatedHardware::WHEEL_LEFT) < 0);
+    CHECK(hardware.getEncoderTicks(SimulatedHardware::WHEEL_RIGHT) > 0);
+}
+
+TEST(Simulator, DriveTest)
+{
+    myProgram->leftThrust = 0.5;
+    myProgram->rightThrust = 0.5;
+    myProgram->leftEncoder.Reset();
+    myProgram->rightEncoder.Reset();
+    runCycles(50);
+
+    // Both motors are driven forwards
+    SimulatedHardware& hardware = mySimulator->getHardware();
+    CHECK_EQUAL(127, hardware.getMotorCommand(SimulatedHardware::WHEEL_LEFT));
+    CHECK_EQUAL(127, hardware.getMotorCommand(SimulatedHardware::WHEEL_RIGHT));
+    CHECK_EQUAL(1000000, hardware.getTime());
+
+    // The program sees the distance travelled on both encoders
+    CHECK(myProgram->leftEncoder.Get() > 100);
+    CHECK_EQUAL(myProgram->leftEncoder.Get(), myProgram->rightEncoder.Get());
+    CHECK(hardware.getX() > 0.4);
+    DOUBLES_EQUAL(0.0, hardware.getHeading(), 1e-9);
+
+    // Mismatched motors pull the robot to the side of the slower one
+    hardware.setMaxWheelSpeed(SimulatedHardware::WHEEL_LEFT, 2.0);
+    runCycles(50);
+
+    CHECK(myProgram->leftEncoder.Get() < myProgram->rightEncoder.Get());
+    CHECK(hardware.getHeading() > 0.0);
+
+    // Driving backwards counts down
+    myProgram->leftThrust = -1.0;
+    myProgram->rightThrust = -1.0;
+    myProgram->leftEncoder.Reset();
+    runCycles(50);
+
+    CHECK_EQUAL(-255, hardware.getMotorCommand(SimulatedHardware::WHEEL_LEFT));
+    CHECK(myProgram->leftEncoder.Get() < 0);
+}
+
+TEST(Simulator, PinTest)
+{
+    SimulatedHardware& hardware = mySimulator->getHardware();
+    hardware.setAnalogInput(2, 612);
+    runCycles(3);
+
+    CHECK_FALSE(myProgram->bumper.Get());
+    CHECK_EQUAL(612, myProgram->lineSensor.Get());
+    CHECK_TRUE(hardware.isOutput(12));
+    CHECK_FALSE(hardware.isOutput(3));
+    CHECK_FALSE(hardware.getDigitalOutput(12));
+
+    // Inputs are followed by the program and written back to outputs
+    hardware.setDigitalInput(3, true);
+    runCycles(3);
+
+    CHECK_TRUE(myProgram->bumper.Get());
+    CHECK_TRUE(hardware.getDigitalOutput(12));
+}
+
+TEST(Simulator, ProtocolTest)
+{
+    myRobot->setMaxProtocolVersion(Packet::PROTOCOL_COBS);
+    myRobot->setChecksumType(Crc::TYPE_CRC16);
+    myRobot->setPipelineWindow(4);
+    myRobot->setFrameBatching(true);
+    myProgram->leftThrust = 1.0;
+    myProgram->rightThrust = 1.0;
+    runCycles(25);
+
+    CHECK_EQUAL(Packet::PROTOCOL_COBS, myRobot->getProtocolVersion());
+    CHECK_EQUAL(Crc::TYPE_CRC16, myRobot->getActiveChecksumType());
+    CHECK_EQUAL(0, myRobot->getRetransmitCount());
+    CHECK(myProgram->rightEncoder.Get() > 100);
+
+    // A resync returns the firmware to bounded packets, from which the link
+    // negotiates again
+    myRobot->resync();
+    runCycles(2);
+
+    CHECK_EQUAL(Packet::PROTOCOL_COBS, myRobot->getProtocolVersion());
+    CHECK_EQUAL(Crc::TYPE_CRC16, myRobot->getActiveChecksumType());
+}
+
+TEST(Simulator, ClockTest)
+{
+    SimulatedClock clock(*mySimulator);
+    Clock::SetInstance(&clock);
+
+    frc::Timer timer;
+    timer.Start();
+    myProgram->leftThrust = 1.0;
+    myProgram->rightThrust = 1.0;
+
+    // Sleeping on the clock runs the robot on without waiting in real time
+    size_t cycleCount = 0;
+    while (timer.HasPeriodPassed(2.0) == false)
+    {
+        myRobot->modePeriodic(FieldControlSystem::MODE_AUTO);
+        CHECK_EQUAL(RedBot::STATUS_GOOD, myRobot->getStatus());
+
+        clock.sleepUntil(clock.getTime() + (Clock::NSEC_PER_SEC / 50));
+        ++cycleCount;
+    }
+
+    CHECK_EQUAL(100, cycleCount);
+    CHECK_EQUAL(2000000, mySimulator->getHardware().getTime());
+    DOUBLES_EQUAL(2.0, frc::Timer::GetFPGATimestamp(), 1e-9);
+    CHECK(mySimulator->getHardware().getWheelDistance(SimulatedHardware::WHEEL_RIGHT) > 3.0);
+
+    // Times already passed leave the simulation where it is
+    clock.sleepUntil(Clock::NSEC_PER_SEC);
+    CHECK_EQUAL(2000000, mySimulator->getHardware().getTime());
+}
+
+TEST(Simulator, FrameResponseTest)
+{
+    ManyInputsProgram program;
+    RedBot robot(
+            &program,
+            myInputBuffer,
+            myOutputBuffer,
+            new RedBotPacketGenerator()
+            );
+    robot.setFrameBatching(true);
+    robot.modeInit(FieldControlSystem::MODE_AUTO);
+
+    SimulatedHardware& hardware = mySimulator->getHardware();
+    hardware.setAnalogInput(7, 300);
+    hardware.setDigitalInput(12, true);
+
+    // Frames are split so that their responses fit in a frame as well
+    for(
+            size_t cycleIdx = 0;
+            cycleIdx < 20;
+            ++cycleIdx
+       )
+    {
+        robot.modePeriodic(FieldControlSystem::MODE_AUTO);
+        CHECK_EQUAL(RedBot::STATUS_GOOD, robot.getStatus());
+
+        mySimulator->advance(0.02);
+    }
+
+    CHECK_EQUAL(300, program.analogInputs[7]->Get());
+    CHECK_TRUE(program.digitalInputs[11]->Get());
+}